@@ -0,0 +1,53 @@
+#ifndef ATG_ENGINE_SIM_ANGLE_BINNED_AGGREGATE_H
+#define ATG_ENGINE_SIM_ANGLE_BINNED_AGGREGATE_H
+
+#include "state_snapshot.h"
+
+// Values binned by crank angle over a cycle, with the sum and maximum kept
+// up to date as bins are written so that queries don't rescan the bins.
+// The maximum is only rescanned when the bin holding it is overwritten
+// with something smaller, which happens at most about once per cycle.
+class AngleBinnedAggregate {
+    public:
+        AngleBinnedAggregate();
+        ~AngleBinnedAggregate();
+
+        void initialize(int binCount);
+        void destroy();
+        void clear();
+
+        void set(int bin, double value);
+
+        // Sets every bin strictly between from and to, stepping by direction
+        // (1 or -1) and wrapping around the cycle
+        void fill(int from, int to, int direction, double value);
+
+        inline double get(int bin) const { return m_values[bin]; }
+        inline int getBinCount() const { return m_binCount; }
+        inline double getSum() const { return m_sum; }
+        inline double getMean() const { return (m_binCount > 0) ? m_sum / m_binCount : 0.0; }
+        double getMax() const;
+
+        // Same layout as writing the bins as a plain array
+        void writeState(StateWriter *writer) const;
+        void readState(StateReader *reader);
+
+    protected:
+        // Rounding in the running sum is flushed after this many writes per bin
+        static constexpr int ResumInterval = 64;
+
+        void setRange(int begin, int end, double value);
+        void resum();
+
+        double *m_values;
+        int m_binCount;
+
+        double m_sum;
+        int m_writesSinceResum;
+
+        mutable double m_max;
+        mutable int m_maxBin;
+        mutable bool m_maxValid;
+};
+
+#endif /* ATG_ENGINE_SIM_ANGLE_BINNED_AGGREGATE_H */
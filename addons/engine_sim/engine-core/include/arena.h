@@ -0,0 +1,107 @@
+#ifndef ATG_ENGINE_SIM_ARENA_H
+#define ATG_ENGINE_SIM_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Memory for one loaded simulation's buffers (filter histories, ring buffers,
+// flow tables, per-cylinder arrays), carved out of a few large cache-line
+// aligned chunks instead of one heap allocation each.
+//
+// Parts allocate their buffers with Arena::allocate(), which takes them from
+// the arena made current on this thread by an Arena::Scope, or from the heap
+// if there isn't one, so code running without an arena is unaffected.
+// Arena::free() returns heap buffers and ignores arena buffers; those are
+// reclaimed together when the arena is destroyed, which has to happen after
+// everything allocated from it. An arena is only ever allocated from by the
+// thread loading its simulation.
+class Arena {
+    public:
+        static constexpr size_t Alignment = 64;
+        static constexpr size_t DefaultChunkSize = 256 * 1024;
+
+        // What buffers are attributed to in getUsed()
+        enum class Category {
+            Engine,         // Parts: flow tables, per-cylinder arrays
+            Simulation,     // Simulator: kinematics, exhaust delay lines
+            Synthesizer,    // Audio and input buffers, filters, impulse responses
+            Count
+        };
+
+        // Makes `arena` current on this thread for the lifetime of the scope;
+        // allocations are attributed to Category::Engine until a
+        // CategoryScope says otherwise. A null arena means the heap.
+        class Scope {
+            public:
+                explicit Scope(Arena *arena);
+                ~Scope();
+
+            private:
+                Arena *m_previous;
+                Category m_previousCategory;
+        };
+
+        class CategoryScope {
+            public:
+                explicit CategoryScope(Category category);
+                ~CategoryScope();
+
+            private:
+                Category m_previous;
+        };
+
+    public:
+        Arena();
+        ~Arena();
+
+        // Further chunks are at least `chunkSize`
+        void initialize(size_t chunkSize = DefaultChunkSize);
+        void destroy();
+
+        size_t getUsed(Category category) const { return m_used[static_cast<int>(category)]; }
+        size_t getUsed() const;
+        size_t getReserved() const;
+
+        template <typename T_Data>
+        static T_Data *allocate(size_t count) {
+            static_assert(
+                std::is_trivially_destructible<T_Data>::value,
+                "Arena buffers are released without running destructors");
+
+            T_Data *buffer = static_cast<T_Data *>(allocateBytes(sizeof(T_Data) * count));
+            for (size_t i = 0; i < count; ++i) {
+                new (buffer + i) T_Data;
+            }
+
+            return buffer;
+        }
+
+        template <typename T_Data>
+        static void free(T_Data *buffer) {
+            freeBytes(buffer);
+        }
+
+    protected:
+        static void *allocateBytes(size_t size);
+        static void freeBytes(void *buffer);
+
+        uint8_t *allocateFromChunks(size_t size);
+
+        struct Chunk {
+            uint8_t *data;
+            size_t size;
+            size_t used;
+        };
+
+        std::vector<Chunk> m_chunks;
+        size_t m_chunkSize;
+        size_t m_used[static_cast<int>(Category::Count)];
+
+        static thread_local Arena *s_current;
+        static thread_local Category s_category;
+};
+
+#endif /* ATG_ENGINE_SIM_ARENA_H */
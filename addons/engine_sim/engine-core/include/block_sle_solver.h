@@ -0,0 +1,124 @@
+#ifndef ATG_ENGINE_SIM_BLOCK_SLE_SOLVER_H
+#define ATG_ENGINE_SIM_BLOCK_SLE_SOLVER_H
+
+#include "warm_start_sle_solver.h"
+
+#include <vector>
+
+// Direct solver for constraint graphs shaped like an engine: many small groups
+// of constraints (a piston and its rod) that only touch each other and a few
+// shared hub bodies (the crankshafts). With z = W_h * J_h^T * lambda for the
+// hub bodies, each group's multipliers are a closed-form function of z, so
+// eliminating the groups leaves a small dense system in z, and eliminating z
+// leaves one over the rows that only act on hubs. Neither grows with the
+// number of cylinders.
+//
+// The last system isn't solved exactly: rows acting on the same hub degree of
+// freedom (friction, starter and dyno on the crank) make it singular, so every
+// one of its diagonal entries gets a relative compliance of m_regularization.
+//
+// Torque limits only ever appear on hub rows, and are handled by clamping
+// and re-solving the small system. Anything that doesn't fit, or a solution
+// that doesn't check out, falls back to the iterative solver.
+class BlockSleSolver : public WarmStartSleSolver {
+    public:
+        static constexpr int HubDegree = 6;         // Bodies on more rows than this are hubs
+        static constexpr int MaxGroupSize = 16;
+        static constexpr int MaxBorderSize = 64;
+
+    public:
+        BlockSleSolver();
+        virtual ~BlockSleSolver();
+
+        virtual bool solve(
+            atg_scs::SparseMatrix<3> &J,
+            atg_scs::Matrix &W,
+            atg_scs::Matrix &right,
+            atg_scs::Matrix *result,
+            atg_scs::Matrix *previous) override;
+
+        virtual bool solveWithLimits(
+            atg_scs::SparseMatrix<3> &J,
+            atg_scs::Matrix &W,
+            atg_scs::Matrix &right,
+            atg_scs::Matrix &limits,
+            atg_scs::Matrix *result,
+            atg_scs::Matrix *previous) override;
+
+        // Solves that had to use the iterative solver, for diagnostics
+        int getFallbackCount() const { return m_fallbackCount; }
+
+        // Times the small system was solved for the last direct solve while
+        // settling which limited rows are clamped; 0 if it fell back.
+        // getLastIterations() is 0 for direct solves.
+        int getLastActiveSetPasses() const { return m_lastActiveSetPasses; }
+
+        double m_maxDirectResidual;
+        double m_regularization;                // Relative compliance on hub-only rows
+
+    protected:
+        struct Group {
+            int rowBegin = 0, rowCount = 0;     // Into m_groupRows
+            int hubBegin = 0, hubCount = 0;     // Into m_groupHubs
+            bool border = false;
+        };
+
+        bool solveBlocks(
+            atg_scs::SparseMatrix<3> &J,
+            atg_scs::Matrix &W,
+            atg_scs::Matrix &right,
+            atg_scs::Matrix *limits,
+            atg_scs::Matrix *result);
+        bool fallback(
+            atg_scs::SparseMatrix<3> &J,
+            atg_scs::Matrix &W,
+            atg_scs::Matrix &right,
+            atg_scs::Matrix *limits,
+            atg_scs::Matrix *result);
+
+        bool needsAnalysis(atg_scs::SparseMatrix<3> &J, atg_scs::Matrix &W, atg_scs::Matrix *limits);
+        void analyze(atg_scs::SparseMatrix<3> &J, atg_scs::Matrix &W, atg_scs::Matrix *limits);
+        double localProduct(atg_scs::SparseMatrix<3> &J, atg_scs::Matrix &W, int row0, int row1) const;
+        double calculateResidual(
+            atg_scs::SparseMatrix<3> &J,
+            atg_scs::Matrix &W,
+            atg_scs::Matrix &right,
+            atg_scs::Matrix *limits,
+            const double *lambda);
+
+        // Structure the analysis was done for
+        std::vector<uint8_t> m_blocks;
+        std::vector<char> m_bounded;
+        std::vector<char> m_massless;
+        int m_bodyCount;
+        bool m_structureValid;
+
+        std::vector<int> m_hubSlot;             // Per body, -1 if not a hub
+        std::vector<int> m_hubs;
+        std::vector<int> m_rowGroup;
+        std::vector<int> m_borderIndex;         // Per row, -1 if not on the border
+        std::vector<int> m_borderRows;
+        std::vector<Group> m_groups;
+        std::vector<int> m_groupRows;
+        std::vector<int> m_groupHubs;
+
+        // Scratch
+        std::vector<double> m_blockFactors;     // Per group: LU of D_g, D_g^-1 b_g, D_g^-1 J_hg
+        std::vector<int> m_blockOffsets;
+        std::vector<double> m_hubMatrix;
+        std::vector<double> m_hubRight;
+        std::vector<double> m_coupling;         // Hub part of the border rows
+        std::vector<double> m_couplingSolved;
+        std::vector<double> m_schur;            // Border rows with the hubs eliminated
+        std::vector<double> m_schurRight;
+        std::vector<double> m_work;
+        std::vector<int> m_pivots;
+        std::vector<char> m_fixed;
+        std::vector<double> m_solution;
+        std::vector<double> m_impulse;
+
+        int m_fallbackCount;
+        int m_lastActiveSetPasses;
+};
+
+#endif /* ATG_ENGINE_SIM_BLOCK_SLE_SOLVER_H */
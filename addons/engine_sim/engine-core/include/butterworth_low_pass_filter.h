@@ -53,6 +53,23 @@ public:
         return y;
     }
 
+    virtual void writeState(StateWriter *writer) const override {
+        for (int i = 0; i < 4; ++i) {
+            writer->write(m_x.read(i));
+            writer->write(m_y.read(i));
+        }
+    }
+
+    virtual void readState(StateReader *reader) override {
+        for (int i = 0; i < 4; ++i) {
+            T_Real x = 0, y = 0;
+            reader->read(&x);
+            reader->read(&y);
+            m_x.overwrite(x, i);
+            m_y.overwrite(y, i);
+        }
+    }
+
     inline void setCutoffFrequency(T_Real f_c, T_Real sampleRate) {
         const T_Real f = std::tan(static_cast<T_Real>(constants::pi) * f_c / sampleRate);
         const T_Real f_2 = f * f;
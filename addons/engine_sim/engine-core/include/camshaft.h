@@ -36,14 +36,24 @@ class Camshaft : public Part {
         double valveLift(int lobe) const;
         double sampleLobe(double theta) const;
 
-        void setLobeCenterline(int lobe, double crankAngle) { m_lobeAngles[lobe] = crankAngle / 2; }
+        // Lift at the given angle of the driving crankshaft (see Crankshaft::getAngle())
+        double valveLiftAt(int lobe, double crankAngle) const;
+
+        void setLobeCenterline(int lobe, double crankAngle) { m_lobeAngles[lobe] = crankAngle / 2; ++m_version; }
         double getLobeCenterline(int lobe) const { return m_lobeAngles[lobe]; }
 
         double getAngle() const;
+        double getAngleAt(double crankAngle) const;
 
         Function *getLobeProfile() const { return m_lobeProfile; }
+        Crankshaft *getCrankshaft() const { return m_crankshaft; }
+        void setAdvance(double advance) { m_advance = advance; ++m_version; }
         double getAdvance() const { return m_advance; }
         double getBaseRadius() const { return m_baseRadius; }
+        int getLobeCount() const { return m_lobes; }
+
+        // Changes whenever the lift curve does, for anything caching it
+        int getVersion() const { return m_version; }
 
     private:
         Crankshaft *m_crankshaft;
@@ -52,6 +62,7 @@ class Camshaft : public Part {
         double m_advance;
         double m_baseRadius;
         int m_lobes;
+        int m_version;
 };
 
 #endif /* ATG_ENGINE_SIM_CAMSHAFT_H */
@@ -0,0 +1,41 @@
+#ifndef ATG_ENGINE_SIM_CHAMBER_FORCE_BATCH_H
+#define ATG_ENGINE_SIM_CHAMBER_FORCE_BATCH_H
+
+#include "scs.h"
+
+class Engine;
+class CombustionChamber;
+
+// Applies the gas and friction forces of every combustion chamber from a
+// single force generator. Piston body indices and bore directions are kept
+// in flat arrays so that gathering piston speeds and scattering forces are
+// plain loops instead of one virtual call and one applyForce() per cylinder.
+//
+// Only the chamber forces are batched. Constraints are still evaluated one
+// virtual calculate() at a time: batching them needs a new interface in the
+// constraint solver, which lives in the simple-2d-constraint-solver
+// submodule.
+class ChamberForceBatch : public atg_scs::ForceGenerator {
+    public:
+        ChamberForceBatch();
+        virtual ~ChamberForceBatch();
+
+        // Pistons must already have been added to the system
+        void initialize(Engine *engine);
+        void destroy();
+
+        virtual void apply(atg_scs::SystemState *state) override;
+
+        int getCount() const { return m_count; }
+
+    protected:
+        CombustionChamber **m_chambers;
+        int *m_bodyIndex;
+        double *m_dx;
+        double *m_dy;
+        double *m_speed;
+        double *m_force;
+        int m_count;
+};
+
+#endif /* ATG_ENGINE_SIM_CHAMBER_FORCE_BATCH_H */
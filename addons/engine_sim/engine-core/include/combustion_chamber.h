@@ -8,6 +8,8 @@
 #include "cylinder_head.h"
 #include "units.h"
 #include "fuel.h"
+#include "angle_binned_aggregate.h"
+#include "engine_step_state.h"
 
 class Engine;
 class CombustionChamber : public atg_scs::ForceGenerator {
@@ -43,6 +45,18 @@ class CombustionChamber : public atg_scs::ForceGenerator {
             double viscousFrictionCoefficient = units::force(20, units::N);
         };
 
+        // Bore and deck geometry read on every step, exactly one cache line.
+        // The engine keeps these for all of its cylinders in one array so
+        // that stepping the mechanics walks them contiguously.
+        struct alignas(64) Geometry {
+            double crossSection = 0;            // Of the bore
+            double dx = 0, dy = 0;              // Bank direction
+            double bankX = 0, bankY = 0;
+            double deckHeight = 0;
+            double compressionHeight = 0;
+            double clearanceVolume = 0;         // Head volume less piston displacement
+        };
+
     public:
         CombustionChamber();
         virtual ~CombustionChamber();
@@ -50,13 +64,22 @@ class CombustionChamber : public atg_scs::ForceGenerator {
         void initialize(const Parameters &params);
         void destroy();
         void setEngine(Engine *engine) { m_engine = engine; }
+        void setGeometry(Geometry *geometry) { m_geometry = geometry; }
         virtual void apply(atg_scs::SystemState *system);
 
         CylinderHead *getCylinderHead() const { return m_head; }
         Piston *getPiston() const { return m_piston; }
+        Function *getMeanPistonSpeedToTurbulence() const { return m_meanPistonSpeedToTurbulence; }
 
         double getFrictionForce() const;
         double getVolume() const;
+
+        // Net force on the piston along the bore, from the pressure averaged
+        // over the last mechanical step; friction is based on the given
+        // piston speed
+        double getPressureForce() const { return m_pressureForce; }
+        double calculatePistonForce(double v_s) const;
+
         double pistonSpeed() const;
         double calculateMeanPistonSpeed() const;
         double calculateFiringPressure() const;
@@ -65,9 +88,24 @@ class CombustionChamber : public atg_scs::ForceGenerator {
         bool popLitLastFrame();
 
         void ignite();
-        void update(double dt);
+
+        // mechanicalFraction is how far through the current mechanical step
+        // the simulation is; volume and piston speed are interpolated from
+        // where the last mechanical step left them
+        void update(double dt, const EngineStepState &state, double mechanicalFraction = 1.0);
         void flow(double dt);
 
+        // Called after every simulation step, and additionally once a
+        // mechanical step is complete, to average the pressure force over it
+        void accumulatePressureForce();
+        void endMechanicalStep();
+
+        // Drops any partial mechanical step, after placement or a restore
+        void resetMechanicalStep();
+
+        void writeState(StateWriter *writer) const;
+        void readState(StateReader *reader);
+
         double lastEventAfr() const;
 
         double getLastIterationExhaustFlow() const { return m_exhaustFlow; }
@@ -91,16 +129,35 @@ class CombustionChamber : public atg_scs::ForceGenerator {
         double m_nBurntFuel;
 
     protected:
+        // What flow() needs from the piston, bank, head, intake and exhaust,
+        // resolved once in initialize() so that a substep touches this record
+        // instead of chasing through five objects
+        struct alignas(64) FlowRecord {
+            GasSystem *plenum = nullptr;
+            GasSystem *collector = nullptr;
+            double manifoldToRunnerFlowRate = 0;
+            double primaryToCollectorFlowRate = 0;
+            double plenumCrossSection = 0;
+            double intakeRunnerCrossSection = 0;
+            double exhaustRunnerCrossSection = 0;
+            double collectorCrossSection = 0;
+
+            double intakeVelocityDecay = 0;
+            double exhaustVelocityDecay = 0;
+            double boreCircumference = 0;
+            double boreRadius = 0;
+            double blowbyK = 0;
+        };
+
+        double calculatePressureForce() const;
         double calculateFrictionForce(double v) const;
-        void updateCycleStates();
+        void updateCycleStates(const EngineStepState &state);
 
         double m_intakeFlowRate;
         double m_exhaustFlowRate;
 
-        double m_manifoldToRunnerFlowRate;
-        double m_primaryToCollectorFlowRate;
-        double m_cylinderCrossSectionSurfaceArea;
-        double m_cylinderWidthApproximation;
+        FlowRecord m_flowRecord;
+        Geometry *m_geometry;
 
         double m_lastTimestepTotalExhaustFlow;
         double m_lastTimestepTotalIntakeFlow;
@@ -108,8 +165,17 @@ class CombustionChamber : public atg_scs::ForceGenerator {
 
         double m_crankcasePressure;
 
-        double *m_pressure;
-        double *m_pistonSpeed;
+        double m_volume;
+        double m_interpolatedPistonSpeed;
+        double m_mechanicalVolume;
+        double m_mechanicalPistonSpeed;
+        double m_pressureForce;
+        double m_pressureForceSum;
+        int m_pressureForceSamples;
+
+        // Over the last cycle, for the turbulence and firing pressure
+        AngleBinnedAggregate m_cyclePressure;
+        AngleBinnedAggregate m_cyclePistonSpeed;
         static constexpr int StateSamples = 256;
 
         bool m_litLastFrame;
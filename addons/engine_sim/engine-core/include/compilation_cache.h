@@ -0,0 +1,71 @@
+#ifndef ATG_ENGINE_SIM_COMPILATION_CACHE_H
+#define ATG_ENGINE_SIM_COMPILATION_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Compiled scripts kept in memory, keyed by entry script. Along with the
+// compiled data, an entry records every file the script imports (directly or
+// not) and a hash of its contents, and is only returned while the imports
+// still resolve to the same files with the same contents. Imports are
+// resolved like the script compiler does: relative to the importing file,
+// then through the search paths in order.
+//
+// Safe to use from several threads.
+class CompilationCache {
+    public:
+        static constexpr int DefaultCapacity = 32;
+
+        struct Dependency {
+            std::string path;
+            uint64_t hash;
+        };
+
+    public:
+        CompilationCache();
+        ~CompilationCache();
+
+        void setCapacity(int capacity);
+        int getCapacity() const { return m_capacity; }
+
+        bool find(
+            const std::string &scriptPath,
+            const std::vector<std::string> &searchPaths,
+            std::vector<uint8_t> *data);
+        void store(
+            const std::string &scriptPath,
+            const std::vector<std::string> &searchPaths,
+            const uint8_t *data,
+            size_t size);
+        void clear();
+
+        int getEntryCount();
+
+        // The script and everything it imports, in the order first reached.
+        // Returns false if a file can't be read or an import can't be resolved.
+        static bool collectDependencies(
+            const std::string &scriptPath,
+            const std::vector<std::string> &searchPaths,
+            std::vector<Dependency> *dependencies);
+
+    protected:
+        struct Entry {
+            std::string scriptPath;
+            std::vector<Dependency> dependencies;
+            std::vector<uint8_t> data;
+        };
+
+        static std::string normalize(const std::string &path);
+
+        // Most recently used first
+        std::list<Entry> m_entries;
+        int m_capacity;
+
+        std::mutex m_lock;
+};
+
+#endif /* ATG_ENGINE_SIM_COMPILATION_CACHE_H */
@@ -11,6 +11,8 @@ class ConvolutionFilter : public Filter {
         void initialize(int samples);
         virtual float f(float sample) override;
         virtual void destroy();
+        virtual void writeState(StateWriter *writer) const override;
+        virtual void readState(StateReader *reader) override;
 
         int getSampleCount() const { return m_sampleCount; }
         float *getImpulseResponse() { return m_impulseResponse; }
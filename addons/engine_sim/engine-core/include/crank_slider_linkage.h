@@ -0,0 +1,74 @@
+#ifndef ATG_ENGINE_SIM_CRANK_SLIDER_LINKAGE_H
+#define ATG_ENGINE_SIM_CRANK_SLIDER_LINKAGE_H
+
+#include "scs.h"
+
+class Engine;
+class Crankshaft;
+class ConnectingRod;
+class CylinderBank;
+
+// Reduced-coordinate crank-slider. Pistons and connecting rods are not
+// simulated as free bodies; their positions and velocities are closed-form
+// functions of the angle of the crankshaft driving them. Chamber forces are
+// mapped to crank torque through the kinematic Jacobian, and the
+// reciprocating masses show up as an angle-dependent crank inertia plus the
+// matching velocity-squared torque.
+class CrankSliderLinkage : public atg_scs::ForceGenerator {
+    public:
+        // Position of a point and its first and second derivatives with
+        // respect to crank angle
+        struct Point {
+            double x = 0, y = 0;
+            double dx = 0, dy = 0;
+            double ddx = 0, ddy = 0;
+        };
+
+        struct Cylinder {
+            double s = 0, ds = 0, dds = 0;          // Wrist pin travel along the bank
+            double phi = 0, dphi = 0, ddphi = 0;    // Rod angle (big end to little end)
+            double sideRatio = 0;                   // Tangent of the rod's angle to the bank
+            Point bigEnd;
+            Point rodCenter;                        // Rod body origin
+        };
+
+    public:
+        CrankSliderLinkage();
+        virtual ~CrankSliderLinkage();
+
+        void initialize(Engine *engine);
+        void destroy();
+
+        // Places the pistons and rods from the current crank state and sets
+        // each crankshaft's effective inertia for the next step
+        void update();
+
+        virtual void apply(atg_scs::SystemState *state) override;
+
+        const Cylinder &getCylinder(int i) const { return m_cylinders[i]; }
+
+        static void crankJournal(Crankshaft *crankshaft, int journal, double theta, Point *target);
+        static void slaveJournal(ConnectingRod *master, const Cylinder &masterCylinder, int journal, Point *target);
+        static void solveCylinder(const CylinderBank *bank, const ConnectingRod *rod, const Point &bigEnd, Cylinder *target);
+
+    protected:
+        void solve(const double *theta);
+        double reciprocatingInertia(int cylinder, double *inertiaDerivative) const;
+
+        Engine *m_engine;
+
+        Cylinder *m_cylinders;
+        int *m_order;               // Master rods before their slaves
+        int *m_masterCylinder;      // -1 for rods on a crank journal
+        int *m_crankshaftIndex;
+        int m_cylinderCount;
+
+        double *m_baseInertia;
+        double *m_inertia;
+        double *m_crankAngle;
+        double *m_torque;
+        double *m_inertiaDerivative;
+        int m_crankshaftCount;
+};
+
+#endif /* ATG_ENGINE_SIM_CRANK_SLIDER_LINKAGE_H */
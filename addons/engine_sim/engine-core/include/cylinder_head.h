@@ -7,11 +7,14 @@
 #include "camshaft.h"
 #include "exhaust_system.h"
 #include "intake.h"
+#include "engine_step_state.h"
 
 class Valvetrain;
 class CylinderBank;
 class CylinderHead : public Part {
     public:
+        static constexpr int FlowTableResolution = 720;     // Cells per 720 degree cycle
+
         struct Parameters {
             CylinderBank *Bank;
 
@@ -50,6 +53,17 @@ class CylinderHead : public Part {
         double intakeValveLift(int cylinder) const;
         double exhaustValveLift(int cylinder) const;
 
+        // Bakes port flow (and exhaust lift, for the synthesizer) against
+        // crank angle for every cylinder and cam mode. Once built, the flow
+        // and exhaust lift queries are table lookups at the crank position
+        // and cam mode captured by the last updateFlowTables(), which also
+        // rebuilds the tables of any camshaft whose profile changed.
+        void buildFlowTables();
+        void updateFlowTables();
+        void updateFlowTables(const EngineStepState &state);
+        void destroyFlowTables();
+        bool hasFlowTables() const { return m_flowTables != nullptr; }
+
         inline ExhaustSystem *getExhaustSystem(int cylinderIndex) const { return m_cylinders[cylinderIndex].exhaustSystem; }
         void setAllExhaustSystems(ExhaustSystem *system);
         void setExhaustSystem(int i, ExhaustSystem *system);
@@ -77,9 +91,40 @@ class CylinderHead : public Part {
         Camshaft *getExhaustCamshaft();
         Camshaft *getIntakeCamshaft();
 
+        inline Valvetrain *getValvetrain() const { return m_valvetrain; }
+        inline Function *getIntakePortFlow() const { return m_intakePortFlow; }
+        inline Function *getExhaustPortFlow() const { return m_exhaustPortFlow; }
+
     protected:
+        enum FlowTable {
+            IntakeFlow,
+            ExhaustFlow,
+            ExhaustLift,
+            FlowTableCount
+        };
+
+        // A position in the tables: cell index and fraction through it
+        struct TablePosition {
+            int cell = 0;
+            double s = 0.0;
+        };
+
+        double *getFlowTable(int mode, int cylinder, FlowTable table) const;
+        void buildFlowTables(int mode, bool intake);
+        void updateFlowTables(int camMode);
+        static TablePosition findTablePosition(const Camshaft *camshaft);
+        double sampleFlowTable(FlowTable table, int cylinder, const TablePosition &p) const;
+
         Cylinder *m_cylinders;
 
+        double *m_flowTables;
+        int m_camModeCount;
+        int *m_intakeVersions;
+        int *m_exhaustVersions;
+        int m_activeCamMode;
+        TablePosition m_intakePosition;
+        TablePosition m_exhaustPosition;
+
         CylinderBank *m_bank;
         Valvetrain *m_valvetrain;
 
@@ -11,6 +11,7 @@ class DelayFilter : public Filter {
 public:
     DelayFilter() {
         m_latencySamples = 0;
+        m_sampleRate = 0.0;
     }
 
     virtual ~DelayFilter() {
@@ -21,8 +22,27 @@ public:
         const int samples = static_cast<int>(std::round(delay * audioFrequency));
         const int capacity = samples + 32;
 
+        m_history.destroy();
         m_history.initialize(capacity);
         m_latencySamples = samples;
+        m_sampleRate = audioFrequency;
+    }
+
+    // Histories are only compatible between filters running at the same
+    // sample rate
+    virtual void writeState(StateWriter *writer) const override {
+        writer->write(m_sampleRate);
+        m_history.writeState(writer);
+    }
+
+    virtual void readState(StateReader *reader) override {
+        double sampleRate = 0;
+        if (!reader->read(&sampleRate) || sampleRate != m_sampleRate) {
+            reader->invalidate();
+            return;
+        }
+
+        m_history.readState(reader);
     }
 
     virtual float f(float sample) override {
@@ -45,6 +65,7 @@ public:
 
 protected:
     int m_latencySamples;
+    double m_sampleRate;
     RingBuffer<double> m_history;
 };
 
@@ -9,6 +9,8 @@ class DerivativeFilter : public Filter {
         virtual ~DerivativeFilter();
 
         virtual float f(float sample) override;
+        virtual void writeState(StateWriter *writer) const override;
+        virtual void readState(StateReader *reader) override;
 
         float m_dt;
 
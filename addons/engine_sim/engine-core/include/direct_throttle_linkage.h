@@ -16,7 +16,12 @@ public:
     void initialize(const Parameters &params);
 
     virtual void setSpeedControl(double s);
-    virtual void update(double dt, Engine *engine);
+    virtual void update(double dt, const EngineStepState &state, Engine *engine);
+
+    virtual void writeState(StateWriter *writer) const override;
+    virtual void readState(StateReader *reader) override;
+
+    inline double getGamma() const { return m_gamma; }
 
 protected:
     double m_gamma;
@@ -0,0 +1,63 @@
+#ifndef ATG_ENGINE_SIM_DYNO_SWEEP_H
+#define ATG_ENGINE_SIM_DYNO_SWEEP_H
+
+#include "units.h"
+
+class Engine;
+class Vehicle;
+class Transmission;
+
+// Headless power curve. The speed range is split into contiguous chunks, one
+// per instance, and each chunk is swept on its own thread by a
+// PistonEngineSimulator with the dynamometer in hold mode and the
+// synthesizer disabled. Every instance must be a separately loaded copy of
+// the same engine since simulators can't share parts. Each point starts from
+// the state the instance was loaded in, so the curve doesn't depend on how
+// the range was split.
+class DynoSweep {
+    public:
+        struct Parameters {
+            double minSpeed = -1.0;     // Defaults to the engine's dyno minimum speed
+            double maxSpeed = -1.0;     // Defaults to the engine's dyno maximum speed
+            double speedStep = -1.0;    // Defaults to the engine's dyno hold step
+            double speedControl = 1.0;
+            double frameTime = (1 / 60.0) * units::sec;
+            double minSettleTime = 0.25 * units::sec;
+            double maxSettleTime = 4.0 * units::sec;
+            double settleWindow = 0.1 * units::sec;
+            double settleTolerance = 0.005;     // Relative change per window
+            double settleTorqueTolerance = units::torque(0.5, units::ft_lb); // Floor near zero torque
+            int fluidSimulationSteps = 8;
+        };
+
+        struct Instance {
+            Engine *engine = nullptr;
+            Vehicle *vehicle = nullptr;
+            Transmission *transmission = nullptr;
+        };
+
+        struct Point {
+            double speed = 0.0;
+            double torque = 0.0;
+            double power = 0.0;
+            bool settled = false;   // False if maxSettleTime was reached first
+        };
+
+    public:
+        DynoSweep();
+        ~DynoSweep();
+
+        bool run(const Instance *instances, int instanceCount, const Parameters &params);
+        void destroy();
+
+        int getPointCount() const { return m_pointCount; }
+        const Point &getPoint(int i) const { return m_points[i]; }
+
+    protected:
+        static void sweep(const Instance &instance, const Parameters &params, Point *points, int pointCount);
+
+        Point *m_points;
+        int m_pointCount;
+};
+
+#endif /* ATG_ENGINE_SIM_DYNO_SWEEP_H */
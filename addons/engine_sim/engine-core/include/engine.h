@@ -12,6 +12,7 @@
 #include "ignition_module.h"
 #include "intake.h"
 #include "combustion_chamber.h"
+#include "engine_step_state.h"
 #include "units.h"
 #include "throttle.h"
 
@@ -61,10 +62,15 @@ class Engine : public Part {
         virtual void setThrottle(double throttle);
         virtual double getThrottle() const;
         virtual double getThrottlePlateAngle() const;
+        Throttle *getThrottleLinkage() const { return m_throttle; }
         virtual void calculateDisplacement();
         double getDisplacement() const { return m_displacement; }
         virtual double getIntakeFlowRate() const;
-        virtual void update(double dt);
+        virtual void update(double dt, const EngineStepState &state);
+
+        // Throttle, ignition and gas state; rigid bodies belong to the simulator
+        virtual void writeState(StateWriter *writer) const;
+        virtual void readState(StateReader *reader);
 
         virtual double getManifoldPressure() const;
         virtual double getIntakeAfr() const;
@@ -122,6 +128,7 @@ class Engine : public Part {
         Piston *m_pistons;
         ConnectingRod *m_connectingRods;
         CombustionChamber *m_combustionChambers;
+        CombustionChamber::Geometry *m_chamberGeometry;
         int m_cylinderCount;
 
         double m_starterTorque;
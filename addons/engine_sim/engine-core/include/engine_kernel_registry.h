@@ -0,0 +1,32 @@
+#ifndef ATG_ENGINE_SIM_ENGINE_KERNEL_REGISTRY_H
+#define ATG_ENGINE_SIM_ENGINE_KERNEL_REGISTRY_H
+
+#include <string>
+
+class Engine;
+class PistonEngineSimulator;
+
+// Specialized simulators generated by engine-sim-aot, looked up by engine
+// name. A kernel is only used if the engine still matches the layout it was
+// generated from; otherwise the generic simulator runs.
+class EngineKernelRegistry {
+    public:
+        struct Kernel {
+            const char *engineName;
+            bool (*matches)(Engine *engine);
+            PistonEngineSimulator *(*create)();
+        };
+
+    public:
+        static void add(const Kernel &kernel);
+        static const Kernel *find(const std::string &engineName);
+
+        // Returns nullptr if there's no usable kernel for the engine
+        static PistonEngineSimulator *createSimulator(Engine *engine);
+};
+
+// Registers every kernel built into the runtime. Defined in the generated
+// engine_kernel_index.cpp (see ENGINE_SIM_KERNEL_DIR); safe to call repeatedly.
+void registerEngineKernels();
+
+#endif /* ATG_ENGINE_SIM_ENGINE_KERNEL_REGISTRY_H */
@@ -0,0 +1,69 @@
+#ifndef ATG_ENGINE_SIM_ENGINE_MAP_H
+#define ATG_ENGINE_SIM_ENGINE_MAP_H
+
+#include <string>
+
+// Steady-state engine behaviour tabulated over a uniform
+// (crank speed x speed control) grid. Speed control is the same 0-1 input
+// passed to Engine::setSpeedControl().
+class EngineMap {
+    public:
+        static constexpr unsigned int FileVersion = 1;
+
+        struct Parameters {
+            int speedSamples = 16;
+            int speedControlSamples = 6;
+            double minSpeed = 0.0;
+            double maxSpeed = 0.0;
+        };
+
+        struct Sample {
+            double torque = 0.0;            // Brake torque
+            double airflow = 0.0;           // Intake flow rate
+            double manifoldPressure = 0.0;
+            double fuelFlow = 0.0;          // Fuel mass per second
+        };
+
+    public:
+        EngineMap();
+        ~EngineMap();
+
+        void initialize(const Parameters &params);
+        void destroy();
+
+        bool write(const std::string &path) const;
+        bool read(const std::string &path);
+
+        void setSample(int speedIndex, int speedControlIndex, const Sample &sample);
+        const Sample &getSample(int speedIndex, int speedControlIndex) const;
+
+        // Torque with the ignition disabled and the throttle closed
+        void setMotoringTorque(int speedIndex, double torque);
+        double getMotoringTorque(int speedIndex) const { return m_motoringTorque[speedIndex]; }
+
+        // Bilinear lookup, clamped to the grid
+        Sample sample(double speed, double speedControl) const;
+        double sampleMotoringTorque(double speed) const;
+
+        double getSpeed(int speedIndex) const;
+        double getSpeedControl(int speedControlIndex) const;
+
+        int getSpeedSampleCount() const { return m_speedSamples; }
+        int getSpeedControlSampleCount() const { return m_speedControlSamples; }
+        double getMinSpeed() const { return m_minSpeed; }
+        double getMaxSpeed() const { return m_maxSpeed; }
+        bool isEmpty() const { return m_samples == nullptr; }
+
+    protected:
+        void locate(double speed, int *i0, double *s) const;
+
+        Sample *m_samples;
+        double *m_motoringTorque;
+
+        int m_speedSamples;
+        int m_speedControlSamples;
+        double m_minSpeed;
+        double m_maxSpeed;
+};
+
+#endif /* ATG_ENGINE_SIM_ENGINE_MAP_H */
@@ -0,0 +1,45 @@
+#ifndef ATG_ENGINE_SIM_ENGINE_MAP_BUILDER_H
+#define ATG_ENGINE_SIM_ENGINE_MAP_BUILDER_H
+
+#include "engine_map.h"
+#include "units.h"
+
+class Engine;
+class Vehicle;
+class Transmission;
+class PistonEngineSimulator;
+
+// Runs the full simulation headlessly with the dynamometer holding each grid
+// speed and tabulates the settled results into an EngineMap. The engine's
+// state is modified, so build from a dedicated instance or before loading the
+// engine into another simulator.
+class EngineMapBuilder {
+    public:
+        struct Parameters {
+            int speedSamples = 16;
+            int speedControlSamples = 6;
+            double minSpeed = -1.0;     // Defaults to the starter speed
+            double maxSpeed = -1.0;     // Defaults to the redline
+            double settleTime = 0.5 * units::sec;
+            double measureTime = 0.25 * units::sec;
+            double frameTime = (1 / 60.0) * units::sec;
+            int fluidSimulationSteps = 2;
+        };
+
+    public:
+        EngineMapBuilder();
+        ~EngineMapBuilder();
+
+        bool build(
+            Engine *engine,
+            Vehicle *vehicle,
+            Transmission *transmission,
+            const Parameters &params,
+            EngineMap *map);
+
+    protected:
+        void run(PistonEngineSimulator *simulator, double t, double frameTime);
+        EngineMap::Sample measure(PistonEngineSimulator *simulator, double t, double frameTime);
+};
+
+#endif /* ATG_ENGINE_SIM_ENGINE_MAP_BUILDER_H */
@@ -0,0 +1,81 @@
+#ifndef ATG_ENGINE_SIM_ENGINE_PACK_H
+#define ATG_ENGINE_SIM_ENGINE_PACK_H
+
+#include "simulator.h"
+#include "state_snapshot.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Compiled form of an engine script: the objects a script produces once it
+// has executed (part parameters, function samples, cam lobes, the firing
+// order, impulse response references and simulator parameters) written
+// field by field in a flat little-endian layout. Rebuilding those objects
+// from a pack doesn't need the script interpreter. read() accepts any byte
+// range holding a pack; load() reads the whole file into memory first.
+class EnginePack {
+    public:
+        static constexpr uint32_t FileVersion = 1;
+
+        // Functions built by read(). Parts only keep raw pointers to their
+        // functions, so they are held here and freed along with the last
+        // Objects that refers to them.
+        class FunctionSet {
+            public:
+                FunctionSet() = default;
+                FunctionSet(const FunctionSet &) = delete;
+                FunctionSet &operator=(const FunctionSet &) = delete;
+                ~FunctionSet();
+
+                std::vector<Function *> functions;
+        };
+
+        struct Objects {
+            Engine *engine = nullptr;
+            Vehicle *vehicle = nullptr;             // Optional
+            Transmission *transmission = nullptr;   // Optional
+            Simulator::Parameters simulatorParameters;
+
+            // Null when the engine's functions belong to someone else, e.g.
+            // the script that created them
+            std::shared_ptr<FunctionSet> functions;
+        };
+
+    public:
+        // Impulse response filenames under `referenceDirectory` are stored
+        // relative to it, so that a pack can sit next to its sound library.
+        // Fails, writing nothing, on parts the format can't describe (e.g. a
+        // throttle that is neither a governor nor a direct linkage).
+        static bool write(
+            const Objects &objects,
+            StateWriter *writer,
+            const std::string &referenceDirectory = "");
+        static bool save(const Objects &objects, const std::string &path);
+
+        // The whole pack is validated before anything is built, so on
+        // failure `out` is left empty
+        static bool read(StateReader *reader, Objects *out);
+        static bool load(const std::string &path, Objects *out);
+
+        // New objects with the same definition as `prototype` and their own
+        // simulation state, built without a script or file. Functions are
+        // only sampled once compiled, so the copy uses the prototype's
+        // rather than duplicating them, and shares its `functions`: those
+        // built by read() are freed with whichever of the prototype and its
+        // copies is released last. Functions the prototype doesn't own
+        // (`functions` is null) must outlive the copy.
+        static void instantiate(const Objects &prototype, Objects *out);
+
+        static void release(Objects *objects);
+
+    protected:
+        static bool writePack(
+            const Objects &objects,
+            StateWriter *writer,
+            const std::string &referenceDirectory,
+            std::vector<const Function *> *functionOrder);
+};
+
+#endif /* ATG_ENGINE_SIM_ENGINE_PACK_H */
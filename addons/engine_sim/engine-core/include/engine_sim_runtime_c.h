@@ -23,10 +23,117 @@ typedef struct es_runtime_t es_runtime_t;
 ES_RUNTIME_API es_runtime_t *es_runtime_create(void);
 ES_RUNTIME_API void es_runtime_destroy(es_runtime_t *rt);
 
+// New runtime running the same engine as `prototype`, e.g. for traffic using
+// one script. Nothing is compiled or read from disk: the clone shares the
+// prototype's functions (timing, lobe, flow and fuel curves), copies its
+// impulse responses and settings, and only allocates its own simulation
+// state, which starts out fresh. Returns null if nothing is loaded. The
+// prototype can be destroyed before its clones: the shared functions are
+// freed with the last runtime using them.
+ES_RUNTIME_API es_runtime_t *es_runtime_clone(const es_runtime_t *prototype);
+
 // Loads an Engine/Vehicle/Transmission from a .mr script (piranha).
 // Returns false if PIRANHA_ENABLED is OFF, compilation fails, or output is missing required objects.
 ES_RUNTIME_API bool es_runtime_load_script(es_runtime_t *rt, const char *script_path);
 
+// Compiled scripts are cached in memory for the whole process and reused while
+// neither the script nor anything it imports has changed (compared by
+// contents). Clearing is only needed to free the memory.
+ES_RUNTIME_API void es_runtime_clear_compilation_cache(void);
+
+// Engine packs: the objects an engine script builds, compiled ahead of time
+// into a versioned binary file (see EnginePack). Loading a pack needs no
+// script interpreter and skips compilation entirely; impulse responses are
+// looked up relative to the pack. Exporting requires PIRANHA_ENABLED. A pack
+// has to be re-exported when its script changes.
+ES_RUNTIME_API bool es_runtime_export_pack(const char *script_path, const char *out_pack_path);
+ES_RUNTIME_API bool es_runtime_load_pack(es_runtime_t *rt, const char *pack_path);
+
+// Background loading, e.g. to preload the next vehicles while the current one
+// keeps playing. The script is compiled and its simulation prepared (impulse
+// responses read, synthesizer set up) on a worker thread, and `rt` is left
+// untouched until es_runtime_swap_load(). Several loads can be in flight at
+// once. Load options are taken from `rt` when the load starts. Returns null if
+// PIRANHA_ENABLED is OFF.
+typedef struct es_load_t es_load_t;
+
+typedef enum es_load_status_t {
+    ES_LOAD_PENDING = 0,
+    ES_LOAD_READY = 1,
+    ES_LOAD_FAILED = 2
+} es_load_status_t;
+
+ES_RUNTIME_API es_load_t *es_runtime_load_script_async(es_runtime_t *rt, const char *script_path);
+ES_RUNTIME_API es_load_status_t es_load_get_status(const es_load_t *load);  // Doesn't block
+ES_RUNTIME_API es_load_status_t es_load_wait(es_load_t *load);
+// Makes a finished load the active simulation, waiting for it if needed. With
+// `crossfade_seconds` > 0 the previous engine keeps running for that long
+// (stepped by the frame calls) while es_runtime_read_audio crossfades its
+// audio into the new one's; otherwise it's destroyed right away. Like the
+// other loads, a swap must not run concurrently with es_runtime_read_audio.
+// Returns false if the load failed. The load still has to be released.
+ES_RUNTIME_API bool es_runtime_swap_load(es_runtime_t *rt, es_load_t *load, double crossfade_seconds);
+// Waits for the worker and destroys anything that wasn't swapped in
+ES_RUNTIME_API void es_load_release(es_load_t *load);
+
+// Reduced-coordinate kinematics: pistons and connecting rods follow the crank
+// analytically instead of being solved as constrained bodies, which leaves only
+// the crankshafts, drivetrain and vehicle in the constraint solve. Takes effect
+// on the next es_runtime_load_script or es_runtime_load_pack. Off by default.
+ES_RUNTIME_API void es_runtime_set_reduced_kinematics(es_runtime_t *rt, bool enabled);
+
+// Mean-value surrogate: the script's engine is swept over an RPM x speed control
+// grid with the full simulation, and the tabulated torque/airflow/fuel map then
+// drives a single crank inertia. Intended for AI traffic and previews; no audio.
+// Building a map runs headlessly and takes a few seconds of CPU per engine.
+ES_RUNTIME_API bool es_runtime_build_engine_map(const char *script_path, const char *out_map_path);
+// Uses the map at `map_path` if it can be read, otherwise builds one (and writes it
+// to `map_path` when given).
+ES_RUNTIME_API bool es_runtime_load_script_mean_value(es_runtime_t *rt, const char *script_path, const char *map_path);
+
+// Headless full-load dyno sweep. `instances` copies of the script's engine are
+// loaded and the RPM range is split between them, each running on its own thread
+// with the dynamometer holding speed and no audio. RPM arguments <= 0 use the
+// engine's dyno settings; `instances` <= 0 uses the hardware thread count.
+// Writes up to `max_points` points and returns the total number in the sweep,
+// or -1 on failure.
+typedef struct es_dyno_point_t {
+    double rpm;
+    double torque_nm;
+    double power_w;
+    bool settled;       // False if the torque was still drifting when sampled
+} es_dyno_point_t;
+
+ES_RUNTIME_API int es_runtime_dyno_sweep(
+    const char *script_path,
+    double min_rpm,
+    double max_rpm,
+    double step_rpm,
+    int instances,
+    es_dyno_point_t *out_points,
+    int max_points);
+
+// Offline render of the loaded simulation to a mono PCM16 WAV file. Physics and
+// synthesis run synchronously on the calling thread as fast as possible, with
+// the audio thread paused and no latency control. `control_track` is sorted by
+// time; speed control is interpolated between points and the other controls
+// hold until the next point. A null or empty track keeps the current controls.
+typedef struct es_control_point_t {
+    double time;            // Seconds from the start of the render
+    double speed_control;   // 0..1
+    bool starter_enabled;
+    bool ignition_enabled;
+    int gear;               // -1 = neutral
+    double clutch_pressure; // 0..1
+} es_control_point_t;
+
+ES_RUNTIME_API bool es_runtime_render_offline(
+    es_runtime_t *rt,
+    const es_control_point_t *control_track,
+    int control_point_count,
+    double seconds,
+    const char *out_wav_path);
+
 // Simulation controls
 ES_RUNTIME_API bool es_runtime_has_simulation(const es_runtime_t *rt);
 ES_RUNTIME_API void es_runtime_set_speed_control(es_runtime_t *rt, double speed_control_0_to_1);
@@ -40,6 +147,17 @@ ES_RUNTIME_API void es_runtime_start_frame(es_runtime_t *rt, double dt_seconds);
 ES_RUNTIME_API bool es_runtime_simulate_step(es_runtime_t *rt);  // returns false when frame complete
 ES_RUNTIME_API void es_runtime_end_frame(es_runtime_t *rt);
 
+// Simulation thread: instead of being stepped by the frame calls above, the
+// runtime steps itself on a thread of its own, paced to keep the synthesizer
+// near its latency target, and the frame calls do nothing. Controls are then
+// queued and applied by the thread between steps; they must all come from one
+// thread. Getters report a snapshot the thread publishes after every frame.
+// Loading stops the thread and starts it again with the new engine; saving or
+// loading state, offline renders, swaps and cloning wait for the current
+// frame to finish. Off by default.
+ES_RUNTIME_API void es_runtime_set_simulation_thread_enabled(es_runtime_t *rt, bool enabled);
+ES_RUNTIME_API bool es_runtime_is_simulation_thread_enabled(const es_runtime_t *rt);
+
 // Audio: call from your audio thread/callback.
 // Reads up to `samples` PCM16 samples; returns how many were available (the remainder is zero-filled).
 ES_RUNTIME_API int es_runtime_read_audio(es_runtime_t *rt, int samples, int16_t *out_pcm16);
@@ -47,6 +165,14 @@ ES_RUNTIME_API int es_runtime_read_audio(es_runtime_t *rt, int samples, int16_t
 // Optional: blocks until the synthesizer thread processes the most recent input block.
 ES_RUNTIME_API void es_runtime_wait_audio_processed(es_runtime_t *rt);
 
+// Snapshots of the loaded simulation (physics, gas state, filter histories and
+// buffered audio). A snapshot only loads into a runtime running the same engine
+// script; on failure the simulation is left untouched.
+// By convention an engine's idle snapshot is stored next to it as
+// `<script>.idle.state` (see engine-sim-snapshot).
+ES_RUNTIME_API bool es_runtime_save_state(es_runtime_t *rt, const char *path);
+ES_RUNTIME_API bool es_runtime_load_state(es_runtime_t *rt, const char *path);
+
 // Engine state queries
 ES_RUNTIME_API double es_runtime_get_engine_speed(es_runtime_t *rt);  // Returns engine RPM
 ES_RUNTIME_API double es_runtime_get_engine_speed_raw(es_runtime_t *rt);  // Unfiltered engine RPM
@@ -61,6 +187,103 @@ ES_RUNTIME_API double es_runtime_get_simulation_speed(es_runtime_t *rt);
 ES_RUNTIME_API void es_runtime_set_simulation_frequency(es_runtime_t *rt, double freq);
 ES_RUNTIME_API double es_runtime_get_simulation_frequency(es_runtime_t *rt);
 
+// Steps the rigid-body solve once every `divisor` simulation steps while the
+// gas dynamics, ignition and audio keep the full simulation frequency, e.g. a
+// 20000 Hz simulation with a divisor of 4 solves the mechanics at 5000 Hz.
+// Chamber volumes are interpolated in between and chamber forces averaged.
+// 1 (the default) steps everything together.
+ES_RUNTIME_API void es_runtime_set_mechanical_step_divisor(es_runtime_t *rt, int divisor);
+ES_RUNTIME_API int es_runtime_get_mechanical_step_divisor(const es_runtime_t *rt);
+
+// Level-of-detail tiers, cheapest last. A new tier takes effect at the next
+// es_runtime_start_frame; simulation state is preserved across switches and
+// the audio fades out/in instead of cutting.
+typedef enum es_quality_tier_t {
+    ES_QUALITY_TIER_FULL = 0,           // Script frequency, full fluid substeps, audio
+    ES_QUALITY_TIER_REDUCED = 1,        // Half frequency, audio
+    ES_QUALITY_TIER_PHYSICS_ONLY = 2,   // Half frequency, one fluid substep, no audio
+    ES_QUALITY_TIER_FROZEN = 3          // No stepping; engine speed held
+} es_quality_tier_t;
+
+ES_RUNTIME_API void es_runtime_set_quality_tier(es_runtime_t *rt, es_quality_tier_t tier);
+ES_RUNTIME_API es_quality_tier_t es_runtime_get_quality_tier(const es_runtime_t *rt);  // Tier currently in effect
+
+// Constraint solver convergence. Residuals are relative to the largest entry of
+// the right-hand side. Frame values cover the steps since the last
+// es_runtime_start_frame; a high iteration count or unconverged steps at idle
+// usually mean the engine script is numerically stiff. Steps the default
+// direct solver handles without falling back count as 0 iterations.
+typedef struct es_solver_stats_t {
+    int last_iterations;
+    double last_residual;
+    int frame_steps;
+    double frame_mean_iterations;
+    int frame_max_iterations;
+    double frame_max_residual;
+    int frame_unconverged_steps;    // Steps that hit the iteration cap
+} es_solver_stats_t;
+
+// Returns false if nothing is loaded or the simulation doesn't use the iterative solver
+ES_RUNTIME_API bool es_runtime_get_solver_stats(const es_runtime_t *rt, es_solver_stats_t *out_stats);
+
+// Memory held by the loaded engine's buffers (flow tables, kinematics, filter
+// histories, audio and impulse responses). Each load gets its own arena for
+// these, released with the engine; nothing in it is shared with other
+// runtimes. The part objects themselves and response curves shared by clones
+// aren't counted.
+typedef struct es_memory_usage_t {
+    uint64_t engine_bytes;          // Parts
+    uint64_t simulation_bytes;      // Simulator state, exhaust delay lines
+    uint64_t synthesizer_bytes;     // Audio buffers, filters, impulse responses
+    uint64_t arena_used_bytes;      // Sum of the above
+    uint64_t arena_reserved_bytes;  // Allocated from the system
+} es_memory_usage_t;
+
+// Returns false if nothing is loaded
+ES_RUNTIME_API bool es_runtime_get_memory_usage(const es_runtime_t *rt, es_memory_usage_t *out_usage);
+
+// Everything a HUD or gauge cluster shows, in one call. The simulation
+// publishes it at the end of every frame, from es_runtime_end_frame or the
+// simulation thread, and it can be read from any thread without waiting on
+// the simulation. Units are SI.
+//
+// Set `size` to sizeof(es_telemetry_t) before the call; a library with a
+// newer, larger struct only fills the first `size` bytes, and `version` tells
+// which fields it knew about.
+#define ES_TELEMETRY_VERSION 1
+#define ES_TELEMETRY_MAX_CYLINDERS 16
+
+typedef enum es_telemetry_flags_t {
+    ES_TELEMETRY_CYLINDERS = 1 << 0     // Fill the per-cylinder arrays
+} es_telemetry_flags_t;
+
+typedef struct es_telemetry_t {
+    uint32_t version;                   // ES_TELEMETRY_VERSION of the library
+    uint32_t size;                      // Set by the caller
+    uint64_t frame;                     // Increases with every published frame
+
+    double engine_speed_rpm;            // Filtered, as es_runtime_get_engine_speed
+    double engine_speed_raw_rpm;
+    double throttle;                    // 0..1
+    double clutch_pressure;             // 0..1
+    int gear;                           // -1 = neutral
+    double manifold_pressure_pa;        // Mean over the intakes
+    double intake_afr;                  // Air-fuel mass ratio in the intakes
+    double dyno_torque_nm;              // Filtered torque at the dynamometer
+    double vehicle_speed_mps;
+
+    // Without ES_TELEMETRY_CYLINDERS, cylinder_count is 0 and the arrays are
+    // not written. Engines with more than ES_TELEMETRY_MAX_CYLINDERS
+    // cylinders report the first ones.
+    int cylinder_count;
+    double cylinder_pressure_pa[ES_TELEMETRY_MAX_CYLINDERS];
+    double cylinder_temperature_k[ES_TELEMETRY_MAX_CYLINDERS];
+} es_telemetry_t;
+
+// `flags` is a combination of es_telemetry_flags_t. Returns false if nothing is
+// loaded or `size` is too small for the fields before the per-cylinder arrays.
+ES_RUNTIME_API bool es_runtime_get_telemetry(const es_runtime_t *rt, es_telemetry_t *out_telemetry, uint32_t flags);
+
 // Transmission/clutch control
 // Gear semantics match engine-core Transmission::changeGear:
 // -1 = neutral (disengaged)
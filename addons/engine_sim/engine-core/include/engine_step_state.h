@@ -0,0 +1,23 @@
+#ifndef ATG_ENGINE_SIM_ENGINE_STEP_STATE_H
+#define ATG_ENGINE_SIM_ENGINE_STEP_STATE_H
+
+class Crankshaft;
+
+// Engine quantities that every subsystem reads during a simulation step.
+// Filled in once by the simulator after the mechanical update, so ignition,
+// the chambers, the valvetrain and the throttle all see the same values
+// instead of each re-deriving them from the crankshaft bodies.
+struct EngineStepState {
+    const Crankshaft *outputCrankshaft = nullptr;
+
+    double crankAngle = 0;          // Output crankshaft angle from TDC
+    double cycleAngle = 0;          // Position in the 4-stroke cycle [0, 4pi)
+    double angularVelocity = 0;     // Signed, of the output crankshaft
+    double speed = 0;               // Matches Engine::getSpeed()
+    double rpm = 0;
+    double manifoldPressure = 0;
+    double throttle = 0;
+    bool spinningCw = true;
+};
+
+#endif /* ATG_ENGINE_SIM_ENGINE_STEP_STATE_H */
@@ -30,11 +30,15 @@ class ExhaustSystem : public Part {
 
         void process(double dt);
 
+        void writeState(StateWriter *writer) const;
+        void readState(StateReader *reader);
+
         inline int getIndex() const { return m_index; }
         inline double getLength() const { return m_length; }
         inline double getFlow() const { return m_flow; }
         inline double getAudioVolume() const { return m_audioVolume; }
         inline double getPrimaryFlowRate() const { return m_primaryFlowRate; }
+        inline double getOutletFlowRate() const { return m_outletFlowRate; }
         inline double getCollectorCrossSectionArea() const { return m_collectorCrossSectionArea; }
         inline double getPrimaryTubeLength() const { return m_primaryTubeLength; }
         inline double getVelocityDecay() const { return m_velocityDecay; }
@@ -1,6 +1,8 @@
 #ifndef ATG_ENGINE_SIM_FILTER_H
 #define ATG_ENGINE_SIM_FILTER_H
 
+#include "state_snapshot.h"
+
 class Filter {
     public:
         Filter();
@@ -8,6 +10,10 @@ class Filter {
 
         virtual float f(float sample);
         virtual void destroy();
+
+        // Filter history for snapshots; coefficients aren't included
+        virtual void writeState(StateWriter *writer) const;
+        virtual void readState(StateReader *reader);
 };
 
 #endif /* ATG_ENGINE_SIM_FILTER_H */
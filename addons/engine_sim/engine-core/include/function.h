@@ -5,7 +5,13 @@
 
 class Function {
     protected:
-        static GaussianFilter *DefaultGaussianFilter;
+        // Built on first use; safe to reach from several threads at once
+        static GaussianFilter *getDefaultGaussianFilter();
+
+    public:
+        static constexpr int DefaultCompiledResolution = 256;
+        static constexpr int MaxCompiledResolution = 16384;
+        static constexpr double DefaultCompiledMaxError = 1E-4;
 
     public:
         Function();
@@ -15,11 +21,29 @@ class Function {
         void resize(int newCapacity);
         void destroy();
 
-        void setInputScale(double s) { m_inputScale = s; }
+        void setInputScale(double s);
         void setOutputScale(double s) { m_outputScale = s; }
         void addSample(double x, double y);
 
+        // Adds samples in any order with a single sort, instead of one
+        // ordered insertion per sample
+        void addSamples(const double *x, const double *y, int count);
+
+        // Bakes the triangle-filtered function into a uniform grid so that
+        // sampleTriangle() is a single linear interpolation. The grid is
+        // refined from the given resolution until it stays within maxError
+        // of the filtered function, relative to its range; if no grid up to
+        // MaxCompiledResolution does, the function keeps sampling exactly.
+        // Adding samples or changing the input scale drops the grid.
+        bool compile(
+            int resolution = DefaultCompiledResolution,
+            double maxError = DefaultCompiledMaxError);
+        void clearCompiled();
+        bool isCompiled() const { return m_compiled != nullptr; }
+        int getCompiledResolution() const { return m_compiledSize - 1; }
+
         double sampleTriangle(double x) const;
+        double sampleTriangleExact(double x) const;
         double sampleGaussian(double x) const;
         double triangle(double x) const;
         int closestSample(double x) const;
@@ -29,7 +53,16 @@ class Function {
         void getDomain(double *x0, double *x1);
         void getRange(double *y0, double *y1);
 
+        inline int getSampleCount() const { return m_size; }
+        inline double getSampleX(int i) const { return m_x[i]; }
+        inline double getSampleY(int i) const { return m_y[i]; }
+        inline double getFilterRadius() const { return m_filterRadius; }
+        inline double getInputScale() const { return m_inputScale; }
+        inline double getOutputScale() const { return m_outputScale; }
+
     protected:
+        double evaluateTriangle(double x) const;
+
         double *m_x;
         double *m_y;
 
@@ -44,6 +77,11 @@ class Function {
         int m_size;
 
         GaussianFilter *m_gaussianFilter;
+
+        double *m_compiled;
+        int m_compiledSize;
+        double m_compiledX0;
+        double m_compiledInvStep;
 };
 
 #endif /* ATG_ENGINE_SIM_FUNCTION_H */
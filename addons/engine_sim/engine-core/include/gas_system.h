@@ -2,6 +2,7 @@
 #define ATG_ENGINE_SIM_GAS_SYSTEM_H
 
 #include "constants.h"
+#include "state_snapshot.h"
 #include "units.h"
 
 #include <cfloat>
@@ -77,6 +78,9 @@ class GasSystem {
         void updateVelocity(double dt, double beta = 1.0);
         void dissipateVelocity(double dt, double timeConstant);
 
+        void writeState(StateWriter *writer) const;
+        void readState(StateReader *reader);
+
         static double flow(const FlowParameters &params);
         double flow(double k_flow, double dt, double P_env, double T_env, const Mix &mix = Mix{});
 
@@ -22,7 +22,18 @@ public:
     void initialize(const Parameters &params);
 
     virtual void setSpeedControl(double s);
-    virtual void update(double dt, Engine *engine);
+    virtual void update(double dt, const EngineStepState &state, Engine *engine);
+
+    virtual void writeState(StateWriter *writer) const override;
+    virtual void readState(StateReader *reader) override;
+
+    inline double getMinSpeed() const { return m_minSpeed; }
+    inline double getMaxSpeed() const { return m_maxSpeed; }
+    inline double getMinVelocity() const { return m_minVelocity; }
+    inline double getMaxVelocity() const { return m_maxVelocity; }
+    inline double getKs() const { return m_k_s; }
+    inline double getKd() const { return m_k_d; }
+    inline double getGamma() const { return m_gamma; }
 
 protected:
     double m_minSpeed;
@@ -4,7 +4,9 @@
 #include "part.h"
 
 #include "crankshaft.h"
+#include "engine_step_state.h"
 #include "function.h"
+#include "state_snapshot.h"
 #include "units.h"
 
 class IgnitionModule : public Part {
@@ -32,20 +34,48 @@ class IgnitionModule : public Part {
         void initialize(const Parameters &params);
         void setFiringOrder(int cylinderIndex, double angle);
         void reset();
-        void update(double dt);
+        void update(double dt, const EngineStepState &state);
 
         bool getIgnitionEvent(int index) const;
         void resetIgnitionEvents();
 
         double getTimingAdvance();
+        double getTimingAdvance(double angularVelocity) const;
+
+        inline Function *getTimingCurve() const { return m_timingCurve; }
+        inline Crankshaft *getCrankshaft() const { return m_crankshaft; }
+        inline double getRevLimit() const { return m_revLimit; }
+        inline double getLimiterDuration() const { return m_limiterDuration; }
+        inline double getFiringAngle(int cylinderIndex) const { return m_plugs[cylinderIndex].angle; }
+        inline bool isPlugEnabled(int cylinderIndex) const { return m_plugs[cylinderIndex].enabled; }
+
+        void writeState(StateWriter *writer) const;
+        void readState(StateReader *reader);
 
         bool m_enabled;
 
     protected:
+        // Enabled plugs ordered by firing angle before timing advance. The
+        // advance shifts every plug by the same amount, so the order holds
+        // and each step only has to walk the plugs inside the swept window.
+        struct ScheduledEvent {
+            double angle;
+            int plug;
+        };
+
         SparkPlug *getPlug(int i);
 
+        void buildSchedule();
+        int findNextEvent(double angle) const;
+        bool isNextEvent(int event, double angle) const;
+        void fireEvents(double start, double window, bool forward);
+
         Function *m_timingCurve;
         SparkPlug *m_plugs;
+        ScheduledEvent *m_schedule;
+        int m_scheduleSize;
+        int m_cursor;
+        bool m_scheduleValid;
         Crankshaft *m_crankshaft;
         int m_cylinderCount;
 
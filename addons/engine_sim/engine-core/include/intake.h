@@ -45,11 +45,19 @@ class Intake : public Part {
 
         void process(double dt);
 
+        void writeState(StateWriter *writer) const;
+        void readState(StateReader *reader);
+
         inline double getRunnerFlowRate() const { return m_runnerFlowRate; }
         inline double getThrottlePlatePosition() const { return m_idleThrottlePlatePosition * m_throttle; }
         inline double getRunnerLength() const { return m_runnerLength; }
         inline double getPlenumCrossSectionArea() const { return m_crossSectionArea; }
         inline double getVelocityDecay() const { return m_velocityDecay; }
+        inline double getPlenumVolume() const { return m_plenumVolume; }
+        inline double getInputFlowK() const { return m_inputFlowK; }
+        inline double getIdleFlowK() const { return m_idleFlowK; }
+        inline double getMolecularAfr() const { return m_molecularAfr; }
+        inline double getIdleThrottlePlatePosition() const { return m_idleThrottlePlatePosition; }
 
         GasSystem m_system;
         double m_throttle;
@@ -59,6 +67,7 @@ class Intake : public Part {
         double m_totalFuelInjected;
 
     protected:
+        double m_plenumVolume;
         double m_crossSectionArea;
         double m_inputFlowK;
         double m_idleFlowK;
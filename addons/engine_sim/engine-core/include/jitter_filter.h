@@ -18,6 +18,8 @@ public:
         float noiseCutoffFrequency,
         float audioFrequency);
     virtual float f(float sample) override;
+    virtual void writeState(StateWriter *writer) const override;
+    virtual void readState(StateReader *reader) override;
 
     __forceinline float fast_f(float sample, float jitterScale = 1.0f) {
         m_history[m_offset] = sample;
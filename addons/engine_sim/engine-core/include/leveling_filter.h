@@ -11,6 +11,8 @@ class LevelingFilter : public Filter {
         virtual ~LevelingFilter();
 
         virtual float f(float sample);
+        virtual void writeState(StateWriter *writer) const override;
+        virtual void readState(StateReader *reader) override;
         float getAttenuation() const { return m_attenuation; }
 
     protected:
@@ -11,6 +11,8 @@ class LowPassFilter : public Filter {
         virtual ~LowPassFilter();
 
         virtual float f(float sample) override;
+        virtual void writeState(StateWriter *writer) const override;
+        virtual void readState(StateReader *reader) override;
 
         __forceinline float fast_f(float sample) {
             const float alpha = m_dt / (m_rc + m_dt);
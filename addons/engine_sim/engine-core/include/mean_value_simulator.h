@@ -0,0 +1,64 @@
+#ifndef ATG_ENGINE_SIM_MEAN_VALUE_SIMULATOR_H
+#define ATG_ENGINE_SIM_MEAN_VALUE_SIMULATOR_H
+
+#include "simulator.h"
+
+#include "engine_map.h"
+
+#include "scs.h"
+
+// Applies a prescribed torque to the crankshaft body
+class CrankTorqueGenerator : public atg_scs::ForceGenerator {
+    public:
+        CrankTorqueGenerator();
+        virtual ~CrankTorqueGenerator();
+
+        virtual void apply(atg_scs::SystemState *system) override;
+
+        atg_scs::RigidBody *m_body;
+        double m_torque;
+};
+
+// Replaces the crank-slider and gas dynamics with a single crank inertia
+// driven by torque looked up from an EngineMap. The transmission, vehicle,
+// dyno and starter are simulated as usual. No audio is produced.
+class MeanValueSimulator : public Simulator {
+    public:
+        MeanValueSimulator();
+        virtual ~MeanValueSimulator() override;
+
+        void loadSimulation(
+            Engine *engine,
+            Vehicle *vehicle,
+            Transmission *transmission,
+            const EngineMap *map);
+
+        virtual double getTotalExhaustFlow() const override;
+        virtual void destroy() override;
+
+        double getAirflow() const { return m_current.airflow; }
+        double getManifoldPressure() const { return m_current.manifoldPressure; }
+        double getFuelFlow() const { return m_current.fuelFlow; }
+        double getEngineTorque() const { return m_current.torque; }
+
+    protected:
+        virtual void simulateStep_() override;
+        virtual void writeToSynthesizer() override;
+        virtual void writeState_(StateWriter *writer) const override;
+        virtual void readState_(StateReader *reader) override;
+
+    protected:
+        const EngineMap *m_map;
+        EngineMap::Sample m_current;
+
+        CrankTorqueGenerator m_crankTorque;
+        atg_scs::FixedPositionConstraint m_crankConstraint;
+        atg_scs::RigidBody m_vehicleMass;
+        VehicleDragConstraint m_vehicleDrag;
+
+        Engine *m_engine;
+        Transmission *m_transmission;
+        Vehicle *m_vehicle;
+};
+
+#endif /* ATG_ENGINE_SIM_MEAN_VALUE_SIMULATOR_H */
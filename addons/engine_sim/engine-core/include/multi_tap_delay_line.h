@@ -0,0 +1,64 @@
+#ifndef ATG_ENGINE_SIM_MULTI_TAP_DELAY_LINE_H
+#define ATG_ENGINE_SIM_MULTI_TAP_DELAY_LINE_H
+
+#include "state_snapshot.h"
+
+// Sums several inputs, each delayed by its own amount, into one output.
+// Rather than keeping a history per input, every sample is added straight
+// into the output slot it will come out of, so each input costs one add
+// and the output one read per step.
+class MultiTapDelayLine {
+    public:
+        MultiTapDelayLine();
+        ~MultiTapDelayLine();
+
+        void initialize(int tapCount, double sampleRate);
+        void destroy();
+
+        // Delay in seconds, rounded to whole samples at the current rate
+        void setTapDelay(int tap, double delay);
+        inline int getTapLatency(int tap) const { return m_tapLatency[tap]; }
+        inline int getTapCount() const { return m_tapCount; }
+
+        // Samples still on their way out are linearly resampled so the
+        // output stays continuous
+        void setSampleRate(double sampleRate);
+        inline double getSampleRate() const { return m_sampleRate; }
+
+        // Add to every tap for a step, then take that step's output
+        inline void add(int tap, double sample) {
+            m_buffer[(m_position + m_tapLatency[tap]) & m_mask] += sample;
+        }
+
+        inline double next() {
+            const double v = m_buffer[m_position];
+            m_buffer[m_position] = 0;
+            m_position = (m_position + 1) & m_mask;
+
+            return v;
+        }
+
+        // Pending output is restored at the rate it was saved with and then
+        // resampled to the current rate
+        void writeState(StateWriter *writer) const;
+        void readState(StateReader *reader);
+
+    protected:
+        void updateLatencies();
+        void reserve(int latency);
+        void setPending(const double *pending, int count, double ratio);
+
+        double *m_buffer;
+        int m_capacity;             // Power of two
+        int m_mask;
+        int m_position;
+
+        double *m_tapDelay;
+        int *m_tapLatency;
+        int m_tapCount;
+        int m_maxLatency;
+
+        double m_sampleRate;
+};
+
+#endif /* ATG_ENGINE_SIM_MULTI_TAP_DELAY_LINE_H */
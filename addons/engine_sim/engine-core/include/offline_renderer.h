@@ -0,0 +1,54 @@
+#ifndef ATG_ENGINE_SIM_OFFLINE_RENDERER_H
+#define ATG_ENGINE_SIM_OFFLINE_RENDERER_H
+
+#include "units.h"
+
+#include <cstdint>
+#include <string>
+
+class Simulator;
+
+// Renders a loaded simulation straight to a mono PCM16 WAV file on the
+// calling thread, as fast as the CPU allows. Physics is stepped in fixed
+// blocks and the synthesizer input from each block is rendered immediately,
+// so the audio thread and the latency controller are bypassed.
+class OfflineRenderer {
+    public:
+        // Controls at a point in time. Speed control is interpolated between
+        // points; everything else holds until the next point.
+        struct ControlPoint {
+            double time = 0.0;
+            double speedControl = 0.0;
+            bool starterEnabled = false;
+            bool ignitionEnabled = true;
+            int gear = -1;
+            double clutchPressure = 1.0;
+        };
+
+        struct Parameters {
+            double duration = 5.0 * units::sec;
+            double blockTime = 0.01 * units::sec;
+        };
+
+    public:
+        OfflineRenderer();
+        ~OfflineRenderer();
+
+        // The rendering thread is stopped for the duration of the render and
+        // restarted afterwards if it was running
+        bool render(
+            Simulator *simulator,
+            const ControlPoint *track,
+            int pointCount,
+            const Parameters &params,
+            const std::string &path);
+
+        int64_t getSamplesWritten() const { return m_samplesWritten; }
+
+    protected:
+        static void applyControls(Simulator *simulator, const ControlPoint *track, int pointCount, double t);
+
+        int64_t m_samplesWritten;
+};
+
+#endif /* ATG_ENGINE_SIM_OFFLINE_RENDERER_H */
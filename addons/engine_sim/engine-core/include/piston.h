@@ -31,6 +31,8 @@ class Piston : public Part {
         double relativeY() const;
 
         double calculateCylinderWallForce() const;
+        // Used instead of the cylinder constraint's force when there is none
+        void setCylinderWallForce(double force) { m_cylinderWallForce = force; }
         inline ConnectingRod *getRod() const { return m_rod; }
         inline CylinderBank *getCylinderBank() const { return m_bank; }
         inline int getCylinderIndex() const { return m_cylinderIndex; }
@@ -50,6 +52,7 @@ class Piston : public Part {
         double m_wristPinLocation;
         double m_mass;
         double m_blowby_k;
+        double m_cylinderWallForce;
 };
 
 void Piston::setCylinderConstraint(atg_scs::LineConstraint *constraint) {
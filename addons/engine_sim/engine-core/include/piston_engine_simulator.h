@@ -12,13 +12,25 @@
 #include "starter_motor.h"
 #include "derivative_filter.h"
 #include "vehicle_drag_constraint.h"
-#include "delay_filter.h"
+#include "multi_tap_delay_line.h"
+#include "crank_slider_linkage.h"
+#include "chamber_force_batch.h"
 
 #include "scs.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <type_traits>
+#include <utility>
 
 class PistonEngineSimulator : public Simulator {
+    public:
+        enum class Kinematics {
+            Constraints,            // Pistons and rods are constrained rigid bodies
+            ReducedCoordinates      // Pistons and rods follow the crank analytically
+        };
+
     public:
         PistonEngineSimulator();
         virtual ~PistonEngineSimulator() override;
@@ -31,24 +43,81 @@ class PistonEngineSimulator : public Simulator {
 
         void setFluidSimulationSteps(int steps) { m_fluidSimulationSteps = steps; }
         int getFluidSimulationSteps() const { return m_fluidSimulationSteps; }
-        int getFluidSimulationFrequency() const { return m_fluidSimulationSteps * getSimulationFrequency(); }
+        int getFluidSimulationFrequency() const { return getActiveFluidSimulationSteps() * getSimulationFrequency(); }
+        int getActiveFluidSimulationSteps() const;
+
+        // Must be set before the simulation is loaded
+        void setKinematics(Kinematics kinematics) { m_kinematics = kinematics; }
+        Kinematics getKinematics() const { return m_kinematics; }
 
         virtual double getAverageOutputSignal() const override;
 
+        // Which exhaust channel each cylinder's pulse goes to, with what gain
+        // and after how long (s)
+        struct ExhaustRoute {
+            int channel;
+            int tap;
+            double gain;
+            double delay;
+        };
+
+        // Fills one route per cylinder; depends only on the engine's layout
+        static void resolveExhaustRoutes(Engine *engine, ExhaustRoute *routes);
+
         DerivativeFilter m_derivativeFilter;
 
     protected:
         virtual void simulateStep_() override;
+        virtual void onSimulationFrequencyChanged(int previousFrequency) override;
+        virtual void writeState_(StateWriter *writer) const override;
+        virtual void readState_(StateReader *reader) override;
 
     protected:
         void placeAndInitialize();
         void placeCylinder(int i);
+        void initializeExhaustRouting();
+
+        // Pressure pulse a cylinder sends down its exhaust before scaling
+        static inline double exhaustPulse(const CombustionChamber *chamber) {
+            const GasSystem &runner = chamber->m_exhaustRunnerAndPrimary;
+            return (runner.pressure() - units::pressure(1.0, units::atm))
+                + 0.1 * runner.dynamicPressure(1.0, 0.0)
+                + 0.1 * runner.dynamicPressure(-1.0, 0.0);
+        }
         
     protected:
         virtual void writeToSynthesizer() override;
 
+        // The bodies of simulateStep_() and writeToSynthesizer(). Counts are
+        // either ints or std::integral_constant, in which case the loop over
+        // them is unrolled; SpecializedPistonEngineSimulator passes the
+        // counts its layout was generated with.
+        template <typename Cylinders, typename Banks, typename ExhaustSystems, typename Intakes>
+        void stepEngine(Cylinders cylinders, Banks banks, ExhaustSystems exhaustSystems, Intakes intakes);
+
+        template <typename Cylinders, typename ExhaustSystems>
+        void writeExhaustPulses(Cylinders cylinders, ExhaustSystems exhaustSystems, const ExhaustRoute *routes);
+
+        template <typename F>
+        static inline void forEach(int n, F &&f) {
+            for (int i = 0; i < n; ++i) {
+                f(i);
+            }
+        }
+
+        template <int N, typename F>
+        static inline void forEach(std::integral_constant<int, N>, F &&f) {
+            unroll(f, std::make_integer_sequence<int, N>());
+        }
+
+        template <typename F, int ... I>
+        static inline void unroll(F &f, std::integer_sequence<int, I...>) {
+            (f(std::integral_constant<int, I>()), ...);
+        }
+
     protected:
-        DelayFilter *m_delayFilters;
+        ExhaustRoute *m_exhaustRoutes;              // Fixed once the engine is loaded
+        MultiTapDelayLine *m_exhaustDelayLines;     // One per exhaust system
 
         atg_scs::FixedPositionConstraint *m_crankConstraints;
         atg_scs::ClutchConstraint *m_crankshaftLinks;
@@ -57,6 +126,8 @@ class PistonEngineSimulator : public Simulator {
         atg_scs::LinkConstraint *m_linkConstraints;
         atg_scs::RigidBody m_vehicleMass;
         VehicleDragConstraint m_vehicleDrag;
+        CrankSliderLinkage m_crankSlider;
+        ChamberForceBatch m_chamberForces;
 
         std::chrono::steady_clock::time_point m_simulationStart;
         std::chrono::steady_clock::time_point m_simulationEnd;
@@ -68,6 +139,101 @@ class PistonEngineSimulator : public Simulator {
         double *m_exhaustFlowStagingBuffer;
 
         int m_fluidSimulationSteps;
+        Kinematics m_kinematics;
 };
 
+template <typename Cylinders, typename Banks, typename ExhaustSystems, typename Intakes>
+void PistonEngineSimulator::stepEngine(
+    Cylinders cylinders,
+    Banks banks,
+    ExhaustSystems exhaustSystems,
+    Intakes intakes)
+{
+    if (m_kinematics == Kinematics::ReducedCoordinates) {
+        m_crankSlider.update();
+    }
+
+    Engine *engine = m_engine;
+    const EngineStepState &state = getStepState();
+    forEach(banks, [&](auto i) {
+        engine->getHead(i)->updateFlowTables(state);
+    });
+
+    const double timestep = getTimestep();
+    IgnitionModule *im = engine->getIgnitionModule();
+    im->update(timestep, state);
+
+    // Pistons in reduced mode already follow the interpolated crank angle
+    const double mechanicalFraction = (m_kinematics == Kinematics::ReducedCoordinates)
+        ? 1.0
+        : getMechanicalStepFraction();
+
+    forEach(cylinders, [&](auto i) {
+        CombustionChamber *chamber = engine->getChamber(i);
+        if (im->getIgnitionEvent(i)) {
+            chamber->ignite();
+        }
+        chamber->update(timestep, state, mechanicalFraction);
+    });
+
+    forEach(cylinders, [&](auto i) {
+        engine->getChamber(i)->resetLastTimestepExhaustFlow();
+        engine->getChamber(i)->resetLastTimestepIntakeFlow();
+    });
+
+    const int fluidSimulationSteps = getActiveFluidSimulationSteps();
+    const double fluidTimestep = timestep / fluidSimulationSteps;
+    for (int step = 0; step < fluidSimulationSteps; ++step) {
+        forEach(exhaustSystems, [&](auto i) {
+            engine->getExhaustSystem(i)->process(fluidTimestep);
+        });
+
+        forEach(intakes, [&](auto i) {
+            Intake *intake = engine->getIntake(i);
+            intake->process(fluidTimestep);
+            intake->m_flowRate += intake->m_flow;
+        });
+
+        forEach(cylinders, [&](auto i) {
+            engine->getChamber(i)->flow(fluidTimestep);
+        });
+    }
+
+    const bool mechanicalStepComplete = isMechanicalStepComplete();
+    forEach(cylinders, [&](auto i) {
+        CombustionChamber *chamber = engine->getChamber(i);
+        chamber->accumulatePressureForce();
+        if (mechanicalStepComplete) {
+            chamber->endMechanicalStep();
+        }
+    });
+
+    im->resetIgnitionEvents();
+}
+
+template <typename Cylinders, typename ExhaustSystems>
+void PistonEngineSimulator::writeExhaustPulses(
+    Cylinders cylinders,
+    ExhaustSystems exhaustSystems,
+    const ExhaustRoute *routes)
+{
+    const double attenuation = std::min(std::abs(filteredEngineSpeed()), 40.0) / 40.0;
+    const double attenuation_3 = attenuation * attenuation * attenuation;
+    const double pulseScale = attenuation_3 * 1600;
+
+    forEach(cylinders, [&](auto i) {
+        const ExhaustRoute &route = routes[i];
+        m_exhaustDelayLines[route.channel].add(
+            route.tap,
+            route.gain * pulseScale * exhaustPulse(m_engine->getChamber(i)));
+    });
+
+    const double gain = getSynthesizerGain();
+    forEach(exhaustSystems, [&](auto i) {
+        m_exhaustFlowStagingBuffer[i] = gain * m_exhaustDelayLines[i].next();
+    });
+
+    synthesizer().writeInput(m_exhaustFlowStagingBuffer);
+}
+
 #endif /* ATG_ENGINE_SIM_PISTON_ENGINE_SIMULATOR_H */
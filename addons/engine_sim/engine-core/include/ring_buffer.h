@@ -1,7 +1,9 @@
 #ifndef ATG_ENGINE_SIM_RING_BUFFER_H
 #define ATG_ENGINE_SIM_RING_BUFFER_H
 
+#include "arena.h"
 #include "part.h"
+#include "state_snapshot.h"
 
 #include <cstring>
 
@@ -20,7 +22,7 @@ public:
     }
 
     void initialize(size_t capacity) {
-        m_buffer = new T_Data[capacity];
+        m_buffer = Arena::allocate<T_Data>(capacity);
         m_capacity = capacity;
         m_writeIndex = 0;
         m_start = 0;
@@ -28,7 +30,7 @@ public:
 
     void destroy() {
         if (m_buffer != nullptr) {
-            delete[] m_buffer;
+            Arena::free(m_buffer);
             m_buffer = nullptr;
         }
 
@@ -141,6 +143,33 @@ public:
         return m_start;
     }
 
+    // Only the buffered contents are stored; a snapshot that doesn't fit
+    // in this buffer's capacity is rejected
+    void writeState(StateWriter *writer) const {
+        const uint32_t n = static_cast<uint32_t>(size());
+        writer->write(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            writer->write(read(i));
+        }
+    }
+
+    void readState(StateReader *reader) {
+        uint32_t n = 0;
+        if (!reader->read(&n)) return;
+        if (n >= m_capacity) {
+            reader->invalidate();
+            return;
+        }
+
+        m_start = 0;
+        m_writeIndex = 0;
+        for (uint32_t i = 0; i < n; ++i) {
+            T_Data data;
+            if (!reader->read(&data)) return;
+            write(data);
+        }
+    }
+
 private:
     T_Data *m_buffer;
     size_t m_capacity;
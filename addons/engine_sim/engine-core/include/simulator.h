@@ -2,6 +2,8 @@
 #define ATG_ENGINE_SIM_SIMULATOR_H
 
 #include "engine.h"
+#include "angle_binned_aggregate.h"
+#include "engine_step_state.h"
 #include "transmission.h"
 #include "vehicle.h"
 #include "synthesizer.h"
@@ -9,10 +11,11 @@
 #include "starter_motor.h"
 #include "derivative_filter.h"
 #include "vehicle_drag_constraint.h"
-#include "delay_filter.h"
-#include "engine.h"
+#include "state_snapshot.h"
+#include "block_sle_solver.h"
 
 #include <chrono>
+#include <string>
 
 class Simulator {
 public:
@@ -25,13 +28,41 @@ public:
         SystemType systemType = SystemType::NsvOptimized;
     };
 
+    // Level-of-detail tiers, cheapest last. Changes take effect at the next
+    // startFrame() so a frame is never simulated with mixed settings. Frozen
+    // holds engine speed rather than extrapolating it: without stepping there
+    // is no torque to extrapolate from, and a held value can't drift however
+    // long the engine stays in that tier.
+    enum class QualityTier {
+        Full,           // Script frequency, full fluid substeps, synthesizer
+        Reduced,        // Reduced frequency, full fluid substeps, synthesizer
+        PhysicsOnly,    // Reduced frequency, a single fluid substep, synthesizer input faded out
+        Frozen          // No stepping; engine speed held at its last value
+    };
+
+    // Constraint solver convergence. "Last" is the most recent step, the
+    // frame values cover the steps since the last startFrame().
+    struct SolverStatistics {
+        int lastIterations = 0;
+        double lastResidual = 0.0;
+        int frameSteps = 0;
+        int frameIterations = 0;
+        int frameMaxIterations = 0;
+        double frameMaxResidual = 0.0;
+        int frameUnconvergedSteps = 0;
+    };
+
     static constexpr int DynoTorqueSamples = 512;
+    static constexpr int ReducedQualityFrequencyDivisor = 2;
+    static constexpr double SynthesizerFadeTime = 0.05;
+    static constexpr uint32_t StateVersion = 3;
 
 public:
     Simulator();
     virtual ~Simulator();
 
     virtual void initialize(const Parameters &params);
+    const Parameters &getParameters() const { return m_parameters; }
     void loadSimulation(Engine *engine, Vehicle *vehicle, Transmission *transmission);
     void releaseSimulation();
 
@@ -54,12 +85,35 @@ public:
     Vehicle *getVehicle() const { return m_vehicle; }
     atg_scs::RigidBodySystem *getSystem() { return m_system; }
 
-    void setSimulationFrequency(int frequency) { m_simulationFrequency = frequency; }
+    void setSimulationFrequency(int frequency);
     int getSimulationFrequency() const { return m_simulationFrequency; }
+    int getFullQualitySimulationFrequency() const { return m_fullQualitySimulationFrequency; }
+
+    // The rigid-body system can be stepped once every few simulation steps
+    // while gas dynamics, ignition and the synthesizer keep the full rate.
+    // A new divisor takes effect at the start of the next mechanical step.
+    void setMechanicalStepDivisor(int divisor);
+    int getMechanicalStepDivisor() const { return m_mechanicalStepDivisor; }
+    double getMechanicalFrequency() const {
+        return static_cast<double>(m_simulationFrequency) / m_mechanicalStepDivisor;
+    }
+
+    void setQualityTier(QualityTier tier) { m_pendingQualityTier = tier; }
+    QualityTier getQualityTier() const { return m_qualityTier; }
+    bool isSynthesizerActive() const {
+        return m_synthesizerEnabled && (m_synthesizerGain > 0 || m_synthesizerGainTarget > 0);
+    }
+    void setSynthesizerEnabled(bool enabled) { m_synthesizerEnabled = enabled; }
+    bool isSynthesizerEnabled() const { return m_synthesizerEnabled; }
+    double getSynthesizerGain() const { return m_synthesizerGain; }
 
     double getTimestep() const { return 1.0 / m_simulationFrequency; }
 
     void setTargetSynthesizerLatency(double latency) { m_targetSynthesizerLatency = latency; }
+    // With latency control off every frame simulates exactly its duration,
+    // which is what offline rendering wants
+    void setLatencyControlEnabled(bool enabled) { m_latencyControlEnabled = enabled; }
+    bool isLatencyControlEnabled() const { return m_latencyControlEnabled; }
     double getTargetSynthesizerLatency() const { return m_targetSynthesizerLatency; }
     double getSynthesizerInputLatency() const { return m_synthesizer.getLatency(); }
     double getSynthesizerInputLatencyTarget() const;
@@ -69,6 +123,10 @@ public:
     int getCurrentIteration() const { return m_currentIteration; }
     double getAverageProcessingTime() const { return m_physicsProcessingTime; }
 
+    // Null when the generic system is in use
+    WarmStartSleSolver *getSleSolver() const { return m_sleSolver; }
+    const SolverStatistics &getSolverStatistics() const { return m_solverStatistics; }
+
     int simulationSteps() const { return m_steps; }
 
     virtual double getFilteredDynoTorque() const;
@@ -77,6 +135,17 @@ public:
 
     double filteredEngineSpeed() const { return m_filteredEngineSpeed; }
 
+    // Engine state as of the current simulation step
+    const EngineStepState &getStepState() const { return m_stepState; }
+
+    // Snapshots of the full mutable state of a loaded simulation. A snapshot
+    // can only be restored into a simulation of the same engine; on a
+    // mismatch or a truncated stream readState() leaves the simulation as it was.
+    void writeState(StateWriter *writer);
+    bool readState(StateReader *reader);
+    bool saveState(const std::string &path);
+    bool loadState(const std::string &path);
+
     Dynamometer m_dyno;
     StarterMotor m_starterMotor;
 
@@ -84,13 +153,34 @@ protected:
     void initializeSynthesizer();
     virtual void simulateStep_();
     virtual void writeToSynthesizer() = 0;
+    virtual void onSimulationFrequencyChanged(int previousFrequency);
+    virtual void writeState_(StateWriter *writer) const;
+    virtual void readState_(StateReader *reader);
+
+    // How far through the current mechanical step the simulation is at the
+    // end of this simulation step, in (0, 1]
+    double getMechanicalStepFraction() const {
+        return static_cast<double>(m_mechanicalStepPhase) / m_mechanicalStepDivisor;
+    }
+    bool isMechanicalStepComplete() const { return m_mechanicalStepPhase >= m_mechanicalStepDivisor; }
+
+    static void writeBodyState(const atg_scs::RigidBody &body, StateWriter *writer);
+    static void readBodyState(atg_scs::RigidBody *body, StateReader *reader);
 
     atg_scs::RigidBodySystem *m_system;
+    WarmStartSleSolver *m_sleSolver;
 
 private:
+    void updateSolverStatistics();
+    void updateStepState();
+
     void updateFilteredEngineSpeed(double dt);
+    void updateQualityTier();
+    bool readSnapshot(StateReader *reader);
 
 private:
+    Parameters m_parameters;
+
     atg_scs::RigidBody m_vehicleMass;
     VehicleDragConstraint m_vehicleDrag;
 
@@ -105,13 +195,30 @@ private:
     Vehicle *m_vehicle;
 
     double m_physicsProcessingTime;
+    SolverStatistics m_solverStatistics;
 
     int m_simulationFrequency;
+    int m_fullQualitySimulationFrequency;
+
+    int m_mechanicalStepDivisor;
+    int m_pendingMechanicalStepDivisor;
+    int m_mechanicalStepPhase;
+    double m_mechanicalStartAngle;
+    double m_mechanicalEndAngle;
+
+    EngineStepState m_stepState;
+
+    QualityTier m_qualityTier;
+    QualityTier m_pendingQualityTier;
+    double m_synthesizerGain;
+    double m_synthesizerGainTarget;
+    bool m_synthesizerEnabled;
 
     double m_targetSynthesizerLatency;
+    bool m_latencyControlEnabled;
     double m_simulationSpeed;
 
-    double *m_dynoTorqueSamples;
+    AngleBinnedAggregate m_dynoTorque;
     int m_lastDynoTorqueSample;
 
     double m_filteredEngineSpeed;
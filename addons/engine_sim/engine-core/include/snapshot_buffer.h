@@ -0,0 +1,79 @@
+#ifndef ATG_ENGINE_SIM_SNAPSHOT_BUFFER_H
+#define ATG_ENGINE_SIM_SNAPSHOT_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Latest value of a plain struct published by one writer thread, readable from
+// any thread without locks. The writer alternates between two slots, so a
+// reader copying the newest one only has to retry if the writer laps it; each
+// slot's sequence number is odd while it's being written.
+template <typename T_Data>
+class SnapshotBuffer {
+    static_assert(std::is_trivially_copyable<T_Data>::value, "Snapshots are copied bytewise");
+
+public:
+    SnapshotBuffer() {
+        m_published.store(0, std::memory_order_relaxed);
+        for (Slot &slot : m_slots) {
+            slot.sequence.store(0, std::memory_order_relaxed);
+            std::memset(&slot.data, 0, sizeof(T_Data));
+        }
+    }
+
+    // Writer
+    void publish(const T_Data &data) {
+        const uint64_t next = m_published.load(std::memory_order_relaxed) + 1;
+        Slot &slot = m_slots[next & 1];
+
+        const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memcpy(&slot.data, &data, sizeof(T_Data));
+
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        m_published.store(next, std::memory_order_release);
+    }
+
+    // Returns false if nothing has been published yet
+    bool read(T_Data *data) const {
+        while (true) {
+            const uint64_t published = m_published.load(std::memory_order_acquire);
+            if (published == 0) {
+                return false;
+            }
+
+            const Slot &slot = m_slots[published & 1];
+            const uint32_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+
+            std::memcpy(data, &slot.data, sizeof(T_Data));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+    }
+
+    // Number of snapshots published so far
+    uint64_t getVersion() const {
+        return m_published.load(std::memory_order_acquire);
+    }
+
+protected:
+    struct Slot {
+        alignas(64) std::atomic<uint32_t> sequence;
+        T_Data data;
+    };
+
+    Slot m_slots[2];
+    std::atomic<uint64_t> m_published;
+};
+
+#endif /* ATG_ENGINE_SIM_SNAPSHOT_BUFFER_H */
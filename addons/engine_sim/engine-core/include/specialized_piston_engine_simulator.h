@@ -0,0 +1,82 @@
+#ifndef ATG_ENGINE_SIM_SPECIALIZED_PISTON_ENGINE_SIMULATOR_H
+#define ATG_ENGINE_SIM_SPECIALIZED_PISTON_ENGINE_SIMULATOR_H
+
+#include "piston_engine_simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+// Piston engine simulator with the engine's topology fixed at compile time.
+// Layout is generated by engine-sim-aot from a compiled script and provides:
+//
+//     static constexpr int CylinderCount, CylinderBankCount;
+//     static constexpr int ExhaustSystemCount, IntakeCount;
+//     static constexpr PistonEngineSimulator::ExhaustRoute ExhaustRoutes[CylinderCount];
+//
+// Stepping is PistonEngineSimulator's own, instantiated with the layout's
+// counts as compile-time constants so that per-cylinder loops are unrolled
+// and the exhaust routing is baked in.
+template <typename Layout>
+class SpecializedPistonEngineSimulator : public PistonEngineSimulator {
+    public:
+        // True if the engine still has the layout the kernel was generated
+        // from, i.e. the script hasn't changed since
+        static bool matches(Engine *engine);
+
+    protected:
+        template <int N>
+        using Count = std::integral_constant<int, N>;
+
+        virtual void simulateStep_() override;
+        virtual void writeToSynthesizer() override;
+};
+
+template <typename Layout>
+bool SpecializedPistonEngineSimulator<Layout>::matches(Engine *engine) {
+    if (engine->getCylinderCount() != Layout::CylinderCount
+        || engine->getCylinderBankCount() != Layout::CylinderBankCount
+        || engine->getExhaustSystemCount() != Layout::ExhaustSystemCount
+        || engine->getIntakeCount() != Layout::IntakeCount)
+    {
+        return false;
+    }
+
+    auto close = [](double a, double b) {
+        return std::abs(a - b) <= 1E-9 * std::max(std::abs(a), std::abs(b));
+    };
+
+    ExhaustRoute routes[Layout::CylinderCount];
+    resolveExhaustRoutes(engine, routes);
+    for (int i = 0; i < Layout::CylinderCount; ++i) {
+        const ExhaustRoute &baked = Layout::ExhaustRoutes[i];
+        if (routes[i].channel != baked.channel
+            || routes[i].tap != baked.tap
+            || !close(routes[i].gain, baked.gain)
+            || !close(routes[i].delay, baked.delay))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename Layout>
+void SpecializedPistonEngineSimulator<Layout>::simulateStep_() {
+    stepEngine(
+        Count<Layout::CylinderCount>(),
+        Count<Layout::CylinderBankCount>(),
+        Count<Layout::ExhaustSystemCount>(),
+        Count<Layout::IntakeCount>());
+}
+
+template <typename Layout>
+void SpecializedPistonEngineSimulator<Layout>::writeToSynthesizer() {
+    writeExhaustPulses(
+        Count<Layout::CylinderCount>(),
+        Count<Layout::ExhaustSystemCount>(),
+        Layout::ExhaustRoutes);
+}
+
+#endif /* ATG_ENGINE_SIM_SPECIALIZED_PISTON_ENGINE_SIMULATOR_H */
@@ -0,0 +1,59 @@
+#ifndef ATG_ENGINE_SIM_SPSC_QUEUE_H
+#define ATG_ENGINE_SIM_SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded queue between one producer thread and one consumer thread. Neither
+// side blocks or allocates; push() fails when the queue is full.
+template <typename T_Data, size_t T_Capacity>
+class SpscQueue {
+    static_assert((T_Capacity & (T_Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue() {
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+    }
+
+    // Producer
+    bool push(const T_Data &data) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == T_Capacity) {
+            return false;
+        }
+
+        m_items[tail & (T_Capacity - 1)] = data;
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Consumer
+    bool pop(T_Data *data) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        *data = m_items[head & (T_Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    size_t size() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return T_Capacity; }
+
+protected:
+    // On separate cache lines so the two sides don't contend
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+
+    T_Data m_items[T_Capacity];
+};
+
+#endif /* ATG_ENGINE_SIM_SPSC_QUEUE_H */
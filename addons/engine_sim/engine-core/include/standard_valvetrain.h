@@ -22,6 +22,9 @@ public:
     virtual Camshaft *getActiveIntakeCamshaft() override;
     virtual Camshaft *getActiveExhaustCamshaft() override;
 
+    virtual Camshaft *getIntakeCamshaft(int) override { return m_intakeCamshaft; }
+    virtual Camshaft *getExhaustCamshaft(int) override { return m_exhaustCamshaft; }
+
 private:
     Camshaft *m_intakeCamshaft;
     Camshaft *m_exhaustCamshaft;
@@ -0,0 +1,81 @@
+#ifndef ATG_ENGINE_SIM_STATE_SNAPSHOT_H
+#define ATG_ENGINE_SIM_STATE_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Flat binary stream for simulation snapshots. Parts append their mutable
+// state in a fixed order and read it back in the same order; the layout is
+// only meaningful for the exact engine that produced it, which the simulator
+// checks before restoring.
+class StateWriter {
+    public:
+        StateWriter();
+        ~StateWriter();
+
+        template <typename T_Data>
+        void write(const T_Data &data) {
+            static_assert(std::is_trivially_copyable<T_Data>::value, "Snapshot data must be trivially copyable");
+            writeBytes(&data, sizeof(T_Data));
+        }
+
+        template <typename T_Data>
+        void write(const T_Data *data, int n) {
+            static_assert(std::is_trivially_copyable<T_Data>::value, "Snapshot data must be trivially copyable");
+            if (n > 0) writeBytes(data, sizeof(T_Data) * n);
+        }
+
+        void writeBytes(const void *data, size_t size);
+
+        bool save(const std::string &path) const;
+
+        const uint8_t *getData() const { return m_data.data(); }
+        size_t getSize() const { return m_data.size(); }
+
+    protected:
+        std::vector<uint8_t> m_data;
+};
+
+// Reads fail once the stream is exhausted and every later read then fails
+// too, so callers can read a block of fields and check isValid() once.
+class StateReader {
+    public:
+        StateReader();
+        StateReader(const uint8_t *data, size_t size);
+        ~StateReader();
+
+        template <typename T_Data>
+        bool read(T_Data *data) {
+            static_assert(std::is_trivially_copyable<T_Data>::value, "Snapshot data must be trivially copyable");
+            return readBytes(data, sizeof(T_Data));
+        }
+
+        template <typename T_Data>
+        bool read(T_Data *data, int n) {
+            static_assert(std::is_trivially_copyable<T_Data>::value, "Snapshot data must be trivially copyable");
+            return (n <= 0) || readBytes(data, sizeof(T_Data) * n);
+        }
+
+        bool readBytes(void *data, size_t size);
+        bool skip(size_t size);
+
+        bool load(const std::string &path);
+        void invalidate() { m_valid = false; }
+
+        bool isValid() const { return m_valid; }
+        bool isAtEnd() const { return m_offset == m_size; }
+        size_t getRemaining() const { return m_size - m_offset; }
+        const uint8_t *getCurrent() const { return m_data + m_offset; }
+
+    protected:
+        std::vector<uint8_t> m_storage;
+        const uint8_t *m_data;
+        size_t m_size;
+        size_t m_offset;
+        bool m_valid;
+};
+
+#endif /* ATG_ENGINE_SIM_STATE_SNAPSHOT_H */
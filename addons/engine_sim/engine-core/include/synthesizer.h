@@ -64,6 +64,9 @@ class Synthesizer {
             unsigned int samples,
             float volume,
             int index);
+        // Impulse responses already loaded into `source`, which has to have
+        // the same input channel count
+        void copyImpulseResponses(Synthesizer &source);
         void startAudioRenderingThread();
         void endAudioRenderingThread();
         void destroy();
@@ -88,10 +91,21 @@ class Synthesizer {
 
         int16_t renderAudio(int inputOffset);
 
+        // Renders all pending input into `target` on the calling thread. Only
+        // valid while the rendering thread is stopped.
+        int renderPending(int16_t *target, int maxSamples);
+        bool isRenderingThreadRunning() const { return m_thread != nullptr; }
+        float getAudioSampleRate() const { return m_audioSampleRate; }
+
         double getLevelerGain();
         AudioParameters getAudioParameters();
         void setAudioParameters(const AudioParameters &params);
 
+        // Filter histories, pending input and rendered audio; safe to call
+        // while the rendering thread is running
+        void writeState(StateWriter *writer);
+        bool readState(StateReader *reader);
+
     //protected:
         ButterworthLowPassFilter<float> m_antialiasing;
         LevelingFilter m_levelingFilter;
@@ -2,6 +2,8 @@
 #define ATG_ENGINE_SIM_THROTTLE_H
 
 #include "part.h"
+#include "engine_step_state.h"
+#include "state_snapshot.h"
 
 class Engine;
 class Throttle {
@@ -10,7 +12,10 @@ public:
     virtual ~Throttle();
 
     virtual void setSpeedControl(double s);
-    virtual void update(double dt, Engine *engine);
+    virtual void update(double dt, const EngineStepState &state, Engine *engine);
+
+    virtual void writeState(StateWriter *writer) const;
+    virtual void readState(StateReader *reader);
 
     inline double getSpeedControl() const { return m_speedControl; }
 
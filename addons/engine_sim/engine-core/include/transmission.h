@@ -25,8 +25,13 @@ class Transmission {
             Vehicle *vehicle,
             Engine *engine);
         void changeGear(int newGear);
+
+        void writeState(StateWriter *writer) const;
+        void readState(StateReader *reader);
         inline int getGear() const { return m_gear; }
         inline int getGearCount() const { return m_gearCount; }
+        inline double getGearRatio(int gear) const { return m_gearRatios[gear]; }
+        inline double getMaxClutchTorque() const { return m_maxClutchTorque; }
         inline void setClutchPressure(double pressure) { m_clutchPressure = pressure; }
         inline double getClutchPressure() const { return m_clutchPressure; }
 
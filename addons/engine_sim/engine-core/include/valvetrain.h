@@ -1,6 +1,8 @@
 #ifndef ATG_ENGINE_SIM_VALVETRAIN_H
 #define ATG_ENGINE_SIM_VALVETRAIN_H
 
+#include "engine_step_state.h"
+
 class Camshaft;
 class Valvetrain {
 public:
@@ -12,6 +14,14 @@ public:
 
     virtual Camshaft *getActiveIntakeCamshaft() = 0;
     virtual Camshaft *getActiveExhaustCamshaft() = 0;
+
+    // Sets of camshafts the valvetrain switches between, e.g. VTEC's normal
+    // and high-lift cams
+    virtual int getCamModeCount() const { return 1; }
+    virtual int getActiveCamMode() const { return 0; }
+    virtual int getActiveCamMode(const EngineStepState &) const { return getActiveCamMode(); }
+    virtual Camshaft *getIntakeCamshaft(int mode) = 0;
+    virtual Camshaft *getExhaustCamshaft(int mode) = 0;
 };
 
 #endif /* ATG_ENGINE_SIM_VALVETRAIN_H */
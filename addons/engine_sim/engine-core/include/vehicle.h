@@ -2,6 +2,7 @@
 #define ATG_ENGINE_SIM_VEHICLE_H
 
 #include "scs.h"
+#include "state_snapshot.h"
 
 class Vehicle {
     public:
@@ -32,6 +33,9 @@ class Vehicle {
         inline void resetTravelledDistance() { m_travelledDistance = 0; }
         double linearForceToVirtualTorque(double force) const;
 
+        void writeState(StateWriter *writer) const;
+        void readState(StateReader *reader);
+
     protected:
         atg_scs::RigidBody *m_rotatingMass;
 
@@ -33,8 +33,25 @@ public:
     virtual Camshaft *getActiveIntakeCamshaft() override;
     virtual Camshaft *getActiveExhaustCamshaft() override;
 
-private:
+    // Mode 1 is VTEC engaged
+    virtual int getCamModeCount() const override { return 2; }
+    virtual int getActiveCamMode() const override { return isVtecEnabled() ? 1 : 0; }
+    virtual int getActiveCamMode(const EngineStepState &state) const override {
+        return isVtecEnabled(state) ? 1 : 0;
+    }
+    virtual Camshaft *getIntakeCamshaft(int mode) override;
+    virtual Camshaft *getExhaustCamshaft(int mode) override;
+
     bool isVtecEnabled() const;
+    bool isVtecEnabled(const EngineStepState &state) const;
+
+    inline double getMinRpm() const { return m_minRpm; }
+    inline double getMinSpeed() const { return m_minSpeed; }
+    inline double getManifoldVacuum() const { return m_manifoldVacuum; }
+    inline double getMinThrottlePosition() const { return m_minThrottlePosition; }
+
+private:
+    bool isVtecEnabled(double manifoldPressure, double speed, double throttle) const;
 
     Camshaft *m_intakeCamshaft;
     Camshaft *m_exhaustCamshaft;
@@ -0,0 +1,59 @@
+#ifndef ATG_ENGINE_SIM_WARM_START_SLE_SOLVER_H
+#define ATG_ENGINE_SIM_WARM_START_SLE_SOLVER_H
+
+#include "scs.h"
+
+// Projected Gauss-Seidel solver for the constraint multipliers. Each solve
+// starts from the multipliers of the previous one when the constraint count
+// hasn't changed, and stops once the largest projected row residual is small
+// relative to the right-hand side instead of running a fixed iteration count.
+class WarmStartSleSolver : public atg_scs::SleSolver {
+    public:
+        WarmStartSleSolver();
+        virtual ~WarmStartSleSolver();
+
+        virtual bool solve(
+            atg_scs::SparseMatrix<3> &J,
+            atg_scs::Matrix &W,
+            atg_scs::Matrix &right,
+            atg_scs::Matrix *result,
+            atg_scs::Matrix *previous) override;
+
+        virtual bool solveWithLimits(
+            atg_scs::SparseMatrix<3> &J,
+            atg_scs::Matrix &W,
+            atg_scs::Matrix &right,
+            atg_scs::Matrix &limits,
+            atg_scs::Matrix *result,
+            atg_scs::Matrix *previous) override;
+
+        // Forget the stored multipliers so the next solve starts cold
+        void reset();
+
+        int getLastIterations() const { return m_lastIterations; }
+        double getLastResidual() const { return m_lastResidual; }
+        bool didLastSolveConverge() const { return m_lastConverged; }
+
+        int m_maxIterations;
+        double m_relativeTolerance;
+        double m_absoluteTolerance;
+        bool m_warmStart;
+
+    protected:
+        bool solve_(
+            atg_scs::SparseMatrix<3> &J,
+            atg_scs::Matrix &W,
+            atg_scs::Matrix &right,
+            atg_scs::Matrix *limits,
+            atg_scs::Matrix *result);
+
+        atg_scs::Matrix m_lambda;
+        atg_scs::Matrix m_impulse;      // W * J^T * lambda
+        atg_scs::Matrix m_diagonal;     // Inverse of the diagonal of J * W * J^T
+
+        int m_lastIterations;
+        double m_lastResidual;
+        bool m_lastConverged;
+};
+
+#endif /* ATG_ENGINE_SIM_WARM_START_SLE_SOLVER_H */
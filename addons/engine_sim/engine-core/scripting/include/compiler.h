@@ -26,7 +26,9 @@ namespace es_script {
         };
 
     private:
-        static Output *s_output;
+        // Output of the script executing on this thread. Each compiler has
+        // its own, so scripts can be compiled on several threads at once.
+        static thread_local Output *s_output;
 
     public:
         Compiler();
@@ -35,7 +37,13 @@ namespace es_script {
         static Output *output();
 
         void initialize();
+
+        // Searched before the compiled script's own directories
         void addSearchPath(const std::string &path);
+
+        // Where compile() looks for imports, highest priority first
+        static std::vector<std::string> getSearchPaths(const std::string &scriptPath);
+
         bool compile(const piranha::IrPath &path);
         Output execute();
         void destroy();
@@ -43,14 +51,13 @@ namespace es_script {
     private:
         void printError(const piranha::CompilationError *err, std::ostream &out) const;
 
-        void addSearchPathOnce(const std::string &path);
-
     private:
         LanguageRules m_rules;
         piranha::Compiler *m_compiler;
         piranha::NodeProgram m_program;
+        std::vector<std::string> m_searchPaths;
 
-        std::vector<std::string> m_dynamicSearchPaths;
+        Output m_output;
     };
 
 } /* namespace es_script */
@@ -42,6 +42,9 @@ namespace es_script {
         void addFunction(FunctionNode *node, Function *function);
         Function *getFunction(FunctionNode *node) const;
 
+        // Bakes every function generated so far into a lookup table
+        void compileFunctions();
+
         void addImpulseResponse(ImpulseResponseNode *node, ImpulseResponse *impulse);
         ImpulseResponse *getImpulseResponse(ImpulseResponseNode *node) const;
 
@@ -109,11 +109,15 @@ namespace es_script {
             
             Function *meanPistonSpeedToTurbulence = new Function;
             meanPistonSpeedToTurbulence->initialize(30, 1);
+            double speeds[30], turbulence[30];
             for (int i = 0; i < 30; ++i) {
-                const double s = (double)i;
-                meanPistonSpeedToTurbulence->addSample(s, s * 0.5);
+                speeds[i] = (double)i;
+                turbulence[i] = speeds[i] * 0.5;
             }
 
+            meanPistonSpeedToTurbulence->addSamples(speeds, turbulence, 30);
+            meanPistonSpeedToTurbulence->compile();
+
             Fuel *fuel = engine->getFuel();
             m_fuel->generate(fuel, &context);
 
@@ -129,6 +133,8 @@ namespace es_script {
                 ccParams.Head = engine->getHead(ccParams.Piston->getCylinderBank()->getIndex());
                 engine->getChamber(i)->initialize(ccParams);
             }
+
+            context.compileFunctions();
         }
 
         void addCrankshaft(CrankshaftNode *crankshaft) {
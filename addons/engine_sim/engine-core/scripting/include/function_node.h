@@ -36,10 +36,16 @@ namespace es_script {
                 Function *function = new Function;
                 function->initialize((int)m_samples.size(), m_filterRadius);
 
+                std::vector<double> x, y;
+                x.reserve(m_samples.size());
+                y.reserve(m_samples.size());
                 for (const Sample &sample : m_samples) {
-                    function->addSample(sample.x, sample.y);
+                    x.push_back(sample.x);
+                    y.push_back(sample.y);
                 }
 
+                function->addSamples(x.data(), y.data(), (int)m_samples.size());
+
                 context->addFunction(this, function);
                 return function;
             }
@@ -1,14 +1,22 @@
 #include "../include/compiler.h"
 
+#include <algorithm>
+#include <cassert>
 #include <chrono>
 #include <ctime>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <mutex>
 #include <sstream>
 #include <string>
 
-es_script::Compiler::Output *es_script::Compiler::s_output = nullptr;
+thread_local es_script::Compiler::Output *es_script::Compiler::s_output = nullptr;
+
+namespace {
+    // Compilers on other threads may be writing the same logs
+    std::mutex s_logLock;
+}
 
 es_script::Compiler::Compiler() {
     m_compiler = nullptr;
@@ -19,10 +27,8 @@ es_script::Compiler::~Compiler() {
 }
 
 es_script::Compiler::Output *es_script::Compiler::output() {
-    if (s_output == nullptr) {
-        s_output = new Output;
-    }
-
+    // Only script actions write output, and only while execute() runs them
+    assert(s_output != nullptr);
     return s_output;
 }
 
@@ -33,24 +39,36 @@ void es_script::Compiler::initialize() {
 }
 
 void es_script::Compiler::addSearchPath(const std::string &path) {
-    if (m_compiler != nullptr) {
-        m_compiler->addSearchPath(path);
-    }
+    m_searchPaths.push_back(path);
 }
 
-void es_script::Compiler::addSearchPathOnce(const std::string &path) {
-    if (path.empty()) {
-        return;
-    }
+std::vector<std::string> es_script::Compiler::getSearchPaths(const std::string &scriptPath) {
+    std::vector<std::string> paths;
 
-    for (const std::string &existing : m_dynamicSearchPaths) {
-        if (existing == path) {
-            return;
+    // Highest priority: script directory and its ancestors.
+    try {
+        std::filesystem::path dir = std::filesystem::path(scriptPath).parent_path();
+        for (int i = 0; i < 6 && !dir.empty(); ++i) {
+            std::string dir_str = dir.string();
+            if (!dir_str.empty() && dir_str.back() != '/') {
+                dir_str.push_back('/');
+            }
+            if (std::find(paths.begin(), paths.end(), dir_str) == paths.end()) {
+                paths.push_back(dir_str);
+            }
+            dir = dir.parent_path();
         }
     }
+    catch (...) {
+        // Best effort only.
+    }
 
-    m_dynamicSearchPaths.push_back(path);
-    addSearchPath(path);
+    // Lower priority: cwd-relative fallbacks for legacy layouts.
+    for (const char *fallback : { "./", "../", "../../", "../../../", "../../es/", "../es/", "es/" }) {
+        paths.push_back(fallback);
+    }
+
+    return paths;
 }
 
 bool es_script::Compiler::compile(const piranha::IrPath &path) {
@@ -65,38 +83,21 @@ bool es_script::Compiler::compile(const piranha::IrPath &path) {
         m_compiler = nullptr;
     }
 
-    m_dynamicSearchPaths.clear();
     m_compiler = new piranha::Compiler(&m_rules);
     m_compiler->setFileExtension(".mr");
 
-    // Highest priority: script directory and its ancestors.
-    try {
-        std::filesystem::path script_path(path.toString());
-        std::filesystem::path dir = script_path.parent_path();
-        for (int i = 0; i < 6 && !dir.empty(); ++i) {
-            std::string dir_str = dir.string();
-            if (!dir_str.empty() && dir_str.back() != '/') {
-                dir_str.push_back('/');
-            }
-            addSearchPathOnce(dir_str);
-            dir = dir.parent_path();
-        }
-    }
-    catch (...) {
-        // Best effort only.
+    for (const std::string &searchPath : m_searchPaths) {
+        m_compiler->addSearchPath(searchPath);
     }
 
-    // Lower priority: cwd-relative fallbacks for legacy layouts.
-    addSearchPath("./");
-    addSearchPath("../");
-    addSearchPath("../../");
-    addSearchPath("../../../");
-    addSearchPath("../../es/");
-    addSearchPath("../es/");
-    addSearchPath("es/");
+    for (const std::string &searchPath : getSearchPaths(path.toString())) {
+        m_compiler->addSearchPath(searchPath);
+    }
 
     std::ostringstream log;
     {
+        // std::localtime() shares one buffer between threads
+        std::lock_guard<std::mutex> lock(s_logLock);
         const auto now = std::chrono::system_clock::now();
         const std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
         log << "engine-sim script compile log: "
@@ -138,6 +139,7 @@ bool es_script::Compiler::compile(const piranha::IrPath &path) {
     // 1) Current working directory (legacy behavior): ./error_log.log
     // 2) Next to the script being compiled (more discoverable): <script_dir>/error_log.log
     {
+        std::lock_guard<std::mutex> lock(s_logLock);
         const std::string log_text = log.str();
 
         // Legacy log location
@@ -167,13 +169,18 @@ bool es_script::Compiler::compile(const piranha::IrPath &path) {
 }
 
 es_script::Compiler::Output es_script::Compiler::execute() {
+    m_output = Output();
+
+    Output *previous = s_output;
+    s_output = &m_output;
     const bool result = m_program.execute();
+    s_output = previous;
 
     if (!result) {
         // Todo: Runtime error
     }
 
-    return *output();
+    return m_output;
 }
 
 void es_script::Compiler::destroy() {
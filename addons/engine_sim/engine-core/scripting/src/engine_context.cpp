@@ -85,6 +85,12 @@ Function *es_script::EngineContext::getFunction(FunctionNode *exhaust) const {
     else return nullptr;
 }
 
+void es_script::EngineContext::compileFunctions() {
+    for (auto &entry : m_functions) {
+        entry.second->compile();
+    }
+}
+
 void es_script::EngineContext::addImpulseResponse(
     ImpulseResponseNode *node,
     ImpulseResponse *impulse)
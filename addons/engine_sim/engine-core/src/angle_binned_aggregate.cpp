@@ -0,0 +1,154 @@
+#include "../include/angle_binned_aggregate.h"
+
+#include "../include/arena.h"
+
+#include <assert.h>
+
+AngleBinnedAggregate::AngleBinnedAggregate() {
+    m_values = nullptr;
+    m_binCount = 0;
+    m_sum = 0.0;
+    m_writesSinceResum = 0;
+    m_max = 0.0;
+    m_maxBin = -1;
+    m_maxValid = false;
+}
+
+AngleBinnedAggregate::~AngleBinnedAggregate() {
+    assert(m_values == nullptr);
+}
+
+void AngleBinnedAggregate::initialize(int binCount) {
+    destroy();
+
+    m_binCount = binCount;
+    m_values = Arena::allocate<double>(binCount);
+    clear();
+}
+
+void AngleBinnedAggregate::destroy() {
+    Arena::free(m_values);
+
+    m_values = nullptr;
+    m_binCount = 0;
+    m_sum = 0.0;
+    m_maxValid = false;
+}
+
+void AngleBinnedAggregate::clear() {
+    for (int i = 0; i < m_binCount; ++i) {
+        m_values[i] = 0.0;
+    }
+
+    m_sum = 0.0;
+    m_writesSinceResum = 0;
+    m_max = 0.0;
+    m_maxBin = 0;
+    m_maxValid = (m_binCount > 0);
+}
+
+void AngleBinnedAggregate::set(int bin, double value) {
+    assert(bin >= 0 && bin < m_binCount);
+
+    const double previous = m_values[bin];
+    m_values[bin] = value;
+    m_sum += value - previous;
+
+    if (m_maxValid) {
+        if (value >= m_max) {
+            m_max = value;
+            m_maxBin = bin;
+        }
+        else if (bin == m_maxBin) {
+            m_maxValid = false;
+        }
+    }
+
+    if (++m_writesSinceResum >= ResumInterval * m_binCount) {
+        resum();
+    }
+}
+
+void AngleBinnedAggregate::fill(int from, int to, int direction, double value) {
+    if (from == to || m_binCount == 0) return;
+
+    // At most two contiguous runs, one on either side of the wrap
+    int begin, end;
+    if (direction > 0) {
+        begin = from + 1;
+        end = to;
+    }
+    else {
+        begin = to + 1;
+        end = from;
+    }
+
+    if (begin >= m_binCount) begin = 0;
+    if (begin <= end) {
+        setRange(begin, end, value);
+    }
+    else {
+        setRange(begin, m_binCount, value);
+        setRange(0, end, value);
+    }
+}
+
+double AngleBinnedAggregate::getMax() const {
+    if (!m_maxValid && m_binCount > 0) {
+        m_maxBin = 0;
+        for (int i = 1; i < m_binCount; ++i) {
+            if (m_values[i] > m_values[m_maxBin]) m_maxBin = i;
+        }
+
+        m_max = m_values[m_maxBin];
+        m_maxValid = true;
+    }
+
+    return m_max;
+}
+
+void AngleBinnedAggregate::writeState(StateWriter *writer) const {
+    writer->write(m_values, m_binCount);
+}
+
+void AngleBinnedAggregate::readState(StateReader *reader) {
+    reader->read(m_values, m_binCount);
+    resum();
+    m_maxValid = false;
+}
+
+void AngleBinnedAggregate::setRange(int begin, int end, double value) {
+    if (begin >= end) return;
+
+    double removed = 0.0;
+    for (int i = begin; i < end; ++i) {
+        removed += m_values[i];
+        m_values[i] = value;
+    }
+
+    m_sum += value * (end - begin) - removed;
+
+    if (m_maxValid) {
+        if (value >= m_max) {
+            m_max = value;
+            m_maxBin = begin;
+        }
+        else if (m_maxBin >= begin && m_maxBin < end) {
+            m_maxValid = false;
+        }
+    }
+
+    m_writesSinceResum += end - begin;
+    if (m_writesSinceResum >= ResumInterval * m_binCount) {
+        resum();
+    }
+}
+
+void AngleBinnedAggregate::resum() {
+    m_sum = 0.0;
+    for (int i = 0; i < m_binCount; ++i) {
+        m_sum += m_values[i];
+    }
+
+    m_writesSinceResum = 0;
+}
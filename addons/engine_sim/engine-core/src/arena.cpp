@@ -0,0 +1,127 @@
+#include "../include/arena.h"
+
+#include <algorithm>
+#include <assert.h>
+
+thread_local Arena *Arena::s_current = nullptr;
+thread_local Arena::Category Arena::s_category = Arena::Category::Engine;
+
+namespace {
+    // Every buffer is preceded by one alignment unit recording where it came
+    // from, so that free() works without knowing the arena
+    enum class Source : uint8_t {
+        Heap,
+        Arena
+    };
+
+    constexpr size_t HeaderSize = Arena::Alignment;
+
+    size_t alignUp(size_t size) {
+        return (size + Arena::Alignment - 1) & ~(Arena::Alignment - 1);
+    }
+} /* namespace */
+
+Arena::Scope::Scope(Arena *arena) {
+    m_previous = s_current;
+    m_previousCategory = s_category;
+
+    s_current = arena;
+    s_category = Category::Engine;
+}
+
+Arena::Scope::~Scope() {
+    s_current = m_previous;
+    s_category = m_previousCategory;
+}
+
+Arena::CategoryScope::CategoryScope(Category category) {
+    m_previous = s_category;
+    s_category = category;
+}
+
+Arena::CategoryScope::~CategoryScope() {
+    s_category = m_previous;
+}
+
+Arena::Arena() {
+    m_chunkSize = DefaultChunkSize;
+    std::fill(m_used, m_used + static_cast<int>(Category::Count), 0);
+}
+
+Arena::~Arena() {
+    assert(m_chunks.empty());
+}
+
+void Arena::initialize(size_t chunkSize) {
+    m_chunkSize = alignUp(std::max(chunkSize, Alignment));
+}
+
+void Arena::destroy() {
+    for (const Chunk &chunk : m_chunks) {
+        ::operator delete(chunk.data, std::align_val_t(Alignment));
+    }
+
+    m_chunks.clear();
+    std::fill(m_used, m_used + static_cast<int>(Category::Count), 0);
+}
+
+size_t Arena::getUsed() const {
+    size_t used = 0;
+    for (const size_t categoryUsed : m_used) {
+        used += categoryUsed;
+    }
+
+    return used;
+}
+
+size_t Arena::getReserved() const {
+    size_t reserved = 0;
+    for (const Chunk &chunk : m_chunks) {
+        reserved += chunk.size;
+    }
+
+    return reserved;
+}
+
+void *Arena::allocateBytes(size_t size) {
+    const size_t total = HeaderSize + alignUp(size);
+
+    uint8_t *block = nullptr;
+    Source source = Source::Heap;
+    if (s_current != nullptr) {
+        block = s_current->allocateFromChunks(total);
+        s_current->m_used[static_cast<int>(s_category)] += total;
+        source = Source::Arena;
+    }
+    else {
+        block = static_cast<uint8_t *>(::operator new(total, std::align_val_t(Alignment)));
+    }
+
+    block[0] = static_cast<uint8_t>(source);
+    return block + HeaderSize;
+}
+
+void Arena::freeBytes(void *buffer) {
+    if (buffer == nullptr) return;
+
+    uint8_t *block = static_cast<uint8_t *>(buffer) - HeaderSize;
+    if (block[0] == static_cast<uint8_t>(Source::Heap)) {
+        ::operator delete(block, std::align_val_t(Alignment));
+    }
+}
+
+uint8_t *Arena::allocateFromChunks(size_t size) {
+    if (m_chunks.empty() || m_chunks.back().size - m_chunks.back().used < size) {
+        Chunk chunk;
+        chunk.size = std::max(m_chunkSize, size);
+        chunk.used = 0;
+        chunk.data = static_cast<uint8_t *>(::operator new(chunk.size, std::align_val_t(Alignment)));
+        m_chunks.push_back(chunk);
+    }
+
+    Chunk &chunk = m_chunks.back();
+    uint8_t *block = chunk.data + chunk.used;
+    chunk.used += size;
+
+    return block;
+}
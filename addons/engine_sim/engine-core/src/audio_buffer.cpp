@@ -1,5 +1,7 @@
 #include "../include/audio_buffer.h"
 
+#include "../include/arena.h"
+
 #include <assert.h>
 
 AudioBuffer::AudioBuffer() {
@@ -17,14 +19,14 @@ AudioBuffer::~AudioBuffer() {
 void AudioBuffer::initialize(int sampleRate, int bufferSize) {
     m_writePointer = 0;
     m_sampleRate = sampleRate;
-    m_samples = new int16_t[bufferSize];
+    m_samples = Arena::allocate<int16_t>(bufferSize);
     memset(m_samples, 0, sizeof(int16_t) * bufferSize);
     m_bufferSize = bufferSize;
     m_offsetToSeconds = 1 / (double)sampleRate;
 }
 
 void AudioBuffer::destroy() {
-    delete[] m_samples;
+    Arena::free(m_samples);
 
     m_samples = nullptr;
     m_bufferSize = 0;
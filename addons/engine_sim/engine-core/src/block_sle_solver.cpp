@@ -0,0 +1,669 @@
+#include "../include/block_sle_solver.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+constexpr int BodiesPerRow = 2;
+constexpr int BlockSize = 3;
+constexpr uint8_t NoBlock = 0xFF;
+
+bool isBounded(atg_scs::Matrix *limits, int row) {
+    if (limits == nullptr) return false;
+    return limits->get(0, row) > -DBL_MAX / 2 || limits->get(1, row) < DBL_MAX / 2;
+}
+
+// In-place LU decomposition with partial pivoting of a row-major n x n matrix
+bool luFactor(double *a, int *pivots, int n) {
+    double scale = 0.0;
+    for (int i = 0; i < n * n; ++i) scale = std::max(scale, std::abs(a[i]));
+    if (scale == 0 || !std::isfinite(scale)) return false;
+
+    for (int k = 0; k < n; ++k) {
+        int pivot = k;
+        for (int i = k + 1; i < n; ++i) {
+            if (std::abs(a[i * n + k]) > std::abs(a[pivot * n + k])) pivot = i;
+        }
+
+        if (std::abs(a[pivot * n + k]) <= 1E-15 * scale) return false;
+
+        pivots[k] = pivot;
+        if (pivot != k) {
+            for (int j = 0; j < n; ++j) std::swap(a[k * n + j], a[pivot * n + j]);
+        }
+
+        const double inv = 1.0 / a[k * n + k];
+        for (int i = k + 1; i < n; ++i) {
+            const double f = (a[i * n + k] *= inv);
+            if (f == 0) continue;
+
+            for (int j = k + 1; j < n; ++j) {
+                a[i * n + j] -= f * a[k * n + j];
+            }
+        }
+    }
+
+    return true;
+}
+
+void luSolve(const double *a, const int *pivots, int n, double *b) {
+    for (int k = 0; k < n; ++k) {
+        if (pivots[k] != k) std::swap(b[k], b[pivots[k]]);
+    }
+
+    for (int i = 1; i < n; ++i) {
+        for (int j = 0; j < i; ++j) b[i] -= a[i * n + j] * b[j];
+    }
+
+    for (int i = n - 1; i >= 0; --i) {
+        for (int j = i + 1; j < n; ++j) b[i] -= a[i * n + j] * b[j];
+        b[i] /= a[i * n + i];
+    }
+}
+
+int findRoot(std::vector<int> &parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+
+    return i;
+}
+
+} // namespace
+
+BlockSleSolver::BlockSleSolver() {
+    m_maxDirectResidual = 1E-6;
+    m_regularization = 1E-9;
+    m_bodyCount = 0;
+    m_structureValid = false;
+    m_fallbackCount = 0;
+    m_lastActiveSetPasses = 0;
+}
+
+BlockSleSolver::~BlockSleSolver() {
+    /* void */
+}
+
+bool BlockSleSolver::solve(
+    atg_scs::SparseMatrix<3> &J,
+    atg_scs::Matrix &W,
+    atg_scs::Matrix &right,
+    atg_scs::Matrix *result,
+    atg_scs::Matrix *previous)
+{
+    (void)previous;
+    return solveBlocks(J, W, right, nullptr, result);
+}
+
+bool BlockSleSolver::solveWithLimits(
+    atg_scs::SparseMatrix<3> &J,
+    atg_scs::Matrix &W,
+    atg_scs::Matrix &right,
+    atg_scs::Matrix &limits,
+    atg_scs::Matrix *result,
+    atg_scs::Matrix *previous)
+{
+    (void)previous;
+    return solveBlocks(J, W, right, &limits, result);
+}
+
+bool BlockSleSolver::fallback(
+    atg_scs::SparseMatrix<3> &J,
+    atg_scs::Matrix &W,
+    atg_scs::Matrix &right,
+    atg_scs::Matrix *limits,
+    atg_scs::Matrix *result)
+{
+    ++m_fallbackCount;
+    m_lastActiveSetPasses = 0;
+    return solve_(J, W, right, limits, result);
+}
+
+bool BlockSleSolver::needsAnalysis(atg_scs::SparseMatrix<3> &J, atg_scs::Matrix &W, atg_scs::Matrix *limits) {
+    const int n = J.getHeight();
+    const int bodyCount = W.getHeight() / BlockSize;
+
+    if (bodyCount != m_bodyCount || static_cast<int>(m_bounded.size()) != n) return true;
+
+    for (int i = 0; i < n; ++i) {
+        if (m_bounded[i] != static_cast<char>(isBounded(limits, i))) return true;
+        for (int k = 0; k < BodiesPerRow; ++k) {
+            if (m_blocks[i * BodiesPerRow + k] != J.getBlockIndex(i, k)) return true;
+        }
+    }
+
+    for (int b = 0; b < bodyCount; ++b) {
+        const bool massless =
+            W.get(0, b * 3 + 0) == 0 && W.get(0, b * 3 + 1) == 0 && W.get(0, b * 3 + 2) == 0;
+        if (m_massless[b] != static_cast<char>(massless)) return true;
+    }
+
+    return false;
+}
+
+double BlockSleSolver::localProduct(atg_scs::SparseMatrix<3> &J, atg_scs::Matrix &W, int row0, int row1) const {
+    double sum = 0.0;
+    for (int k0 = 0; k0 < BodiesPerRow; ++k0) {
+        const uint8_t block = J.getBlockIndex(row0, k0);
+        if (block == NoBlock || m_hubSlot[block] != -1) continue;
+
+        for (int k1 = 0; k1 < BodiesPerRow; ++k1) {
+            if (J.getBlockIndex(row1, k1) != block) continue;
+
+            for (int s = 0; s < BlockSize; ++s) {
+                sum += J.get(row0, k0, s) * W.get(0, block * BlockSize + s) * J.get(row1, k1, s);
+            }
+        }
+    }
+
+    return sum;
+}
+
+void BlockSleSolver::analyze(atg_scs::SparseMatrix<3> &J, atg_scs::Matrix &W, atg_scs::Matrix *limits) {
+    const int n = J.getHeight();
+    m_bodyCount = W.getHeight() / BlockSize;
+
+    m_blocks.resize(static_cast<size_t>(n) * BodiesPerRow);
+    m_bounded.resize(n);
+    m_massless.resize(m_bodyCount);
+
+    for (int i = 0; i < n; ++i) {
+        m_bounded[i] = isBounded(limits, i);
+        for (int k = 0; k < BodiesPerRow; ++k) {
+            const uint8_t block = J.getBlockIndex(i, k);
+            m_blocks[i * BodiesPerRow + k] = block;
+        }
+    }
+
+    for (int b = 0; b < m_bodyCount; ++b) {
+        m_massless[b] =
+            W.get(0, b * 3 + 0) == 0 && W.get(0, b * 3 + 1) == 0 && W.get(0, b * 3 + 2) == 0;
+    }
+
+    // Hubs are the bodies shared by many rows; everything else is local to
+    // the rows it touches
+    std::vector<int> degree(m_bodyCount, 0);
+    for (int i = 0; i < n; ++i) {
+        for (int k = 0; k < BodiesPerRow; ++k) {
+            const uint8_t block = m_blocks[i * BodiesPerRow + k];
+            if (block != NoBlock && block < m_bodyCount && !m_massless[block]) ++degree[block];
+        }
+    }
+
+    m_hubSlot.assign(m_bodyCount, -1);
+    m_hubs.clear();
+    for (int b = 0; b < m_bodyCount; ++b) {
+        if (degree[b] > HubDegree) {
+            m_hubSlot[b] = static_cast<int>(m_hubs.size());
+            m_hubs.push_back(b);
+        }
+    }
+
+    // Rows sharing a local body end up in the same group
+    std::vector<int> parent(n), firstRow(m_bodyCount, -1);
+    for (int i = 0; i < n; ++i) parent[i] = i;
+
+    for (int i = 0; i < n; ++i) {
+        for (int k = 0; k < BodiesPerRow; ++k) {
+            const uint8_t block = m_blocks[i * BodiesPerRow + k];
+            if (block == NoBlock || block >= m_bodyCount) continue;
+            if (m_massless[block] || m_hubSlot[block] != -1) continue;
+
+            if (firstRow[block] == -1) firstRow[block] = i;
+            else parent[findRoot(parent, i)] = findRoot(parent, firstRow[block]);
+        }
+    }
+
+    std::vector<int> groupOfRoot(n, -1);
+    m_rowGroup.assign(n, -1);
+    m_groups.clear();
+    for (int i = 0; i < n; ++i) {
+        const int root = findRoot(parent, i);
+        if (groupOfRoot[root] == -1) {
+            groupOfRoot[root] = static_cast<int>(m_groups.size());
+            m_groups.push_back(Group());
+        }
+
+        m_rowGroup[i] = groupOfRoot[root];
+        ++m_groups[m_rowGroup[i]].rowCount;
+    }
+
+    int offset = 0;
+    for (Group &group : m_groups) {
+        group.rowBegin = offset;
+        offset += group.rowCount;
+        group.rowCount = 0;
+    }
+
+    m_groupRows.resize(n);
+    for (int i = 0; i < n; ++i) {
+        Group &group = m_groups[m_rowGroup[i]];
+        m_groupRows[group.rowBegin + group.rowCount++] = i;
+    }
+
+    // Groups that can't be eliminated (bounded rows, hub-only rows or a
+    // singular block) are solved together with the hubs
+    m_groupHubs.clear();
+    std::vector<double> block;
+    std::vector<int> pivots;
+    for (Group &group : m_groups) {
+        const int r = group.rowCount;
+        group.border = (r > MaxGroupSize);
+
+        bool hasLocalBody = false;
+        for (int a = 0; a < r && !group.border; ++a) {
+            const int row = m_groupRows[group.rowBegin + a];
+            if (m_bounded[row]) group.border = true;
+
+            for (int k = 0; k < BodiesPerRow; ++k) {
+                const uint8_t b = m_blocks[row * BodiesPerRow + k];
+                if (b != NoBlock && b < m_bodyCount && !m_massless[b] && m_hubSlot[b] == -1) {
+                    hasLocalBody = true;
+                }
+            }
+        }
+
+        if (!hasLocalBody) group.border = true;
+
+        if (!group.border) {
+            block.resize(static_cast<size_t>(r) * r);
+            pivots.resize(r);
+            for (int a = 0; a < r; ++a) {
+                for (int c = 0; c < r; ++c) {
+                    block[a * r + c] = localProduct(
+                        J, W, m_groupRows[group.rowBegin + a], m_groupRows[group.rowBegin + c]);
+                }
+            }
+
+            group.border = !luFactor(block.data(), pivots.data(), r);
+        }
+
+        group.hubBegin = static_cast<int>(m_groupHubs.size());
+        group.hubCount = 0;
+        if (group.border) continue;
+
+        for (int a = 0; a < r; ++a) {
+            const int row = m_groupRows[group.rowBegin + a];
+            for (int k = 0; k < BodiesPerRow; ++k) {
+                const uint8_t b = m_blocks[row * BodiesPerRow + k];
+                if (b == NoBlock || b >= m_bodyCount || m_hubSlot[b] == -1) continue;
+
+                const int slot = m_hubSlot[b];
+                const auto begin = m_groupHubs.begin() + group.hubBegin;
+                if (std::find(begin, m_groupHubs.end(), slot) == m_groupHubs.end()) {
+                    m_groupHubs.push_back(slot);
+                    ++group.hubCount;
+                }
+            }
+        }
+    }
+
+    m_borderIndex.assign(n, -1);
+    m_borderRows.clear();
+    for (int i = 0; i < n; ++i) {
+        if (m_groups[m_rowGroup[i]].border) {
+            m_borderIndex[i] = static_cast<int>(m_borderRows.size());
+            m_borderRows.push_back(i);
+        }
+    }
+
+    m_blockOffsets.resize(m_groups.size());
+    int scratch = 0;
+    for (size_t g = 0; g < m_groups.size(); ++g) {
+        const Group &group = m_groups[g];
+        m_blockOffsets[g] = scratch;
+        if (group.border) continue;
+
+        const int r = group.rowCount;
+        scratch += r * r + r + r * BlockSize * group.hubCount;
+    }
+
+    const size_t hubDofs = m_hubs.size() * BlockSize;
+    const size_t borderRows = m_borderRows.size();
+    m_blockFactors.resize(scratch);
+    m_pivots.resize(std::max(static_cast<size_t>(n), std::max(hubDofs, borderRows)));
+    m_hubMatrix.resize(hubDofs * hubDofs);
+    m_hubRight.resize(hubDofs);
+    m_coupling.resize(borderRows * hubDofs);
+    m_couplingSolved.resize(borderRows * hubDofs);
+    m_schur.resize(borderRows * borderRows);
+    m_schurRight.resize(borderRows);
+    m_work.resize(std::max(borderRows * borderRows + borderRows, static_cast<size_t>(MaxGroupSize)));
+    m_fixed.resize(borderRows);
+    m_solution.resize(n);
+
+    m_structureValid = hubDofs <= MaxBorderSize && borderRows <= MaxBorderSize;
+}
+
+bool BlockSleSolver::solveBlocks(
+    atg_scs::SparseMatrix<3> &J,
+    atg_scs::Matrix &W,
+    atg_scs::Matrix &right,
+    atg_scs::Matrix *limits,
+    atg_scs::Matrix *result)
+{
+    const int n = J.getHeight();
+    if (n == 0) return solve_(J, W, right, limits, result);
+
+    if (needsAnalysis(J, W, limits)) {
+        analyze(J, W, limits);
+    }
+
+    if (!m_structureValid) {
+        return fallback(J, W, right, limits, result);
+    }
+
+    const int hubDofs = static_cast<int>(m_hubs.size()) * BlockSize;
+    const int borderRows = static_cast<int>(m_borderRows.size());
+
+    // Hub equations: H z - C^T lambda_b = h, with H = W_h^-1 + sum(J_hg^T D_g^-1 J_hg)
+    double *H = m_hubMatrix.data();
+    double *h = m_hubRight.data();
+    std::fill(m_hubMatrix.begin(), m_hubMatrix.end(), 0.0);
+    std::fill(m_hubRight.begin(), m_hubRight.end(), 0.0);
+
+    for (int d = 0; d < hubDofs; ++d) {
+        const double w = W.get(0, m_hubs[d / BlockSize] * BlockSize + d % BlockSize);
+        H[d * hubDofs + d] = (w > 0) ? 1.0 / w : 0.0;
+    }
+
+    // Eliminate each group: lambda_g = D_g^-1 (b_g - J_hg z)
+    for (size_t g = 0; g < m_groups.size(); ++g) {
+        const Group &group = m_groups[g];
+        if (group.border) continue;
+
+        const int r = group.rowCount;
+        const int hc = group.hubCount * BlockSize;
+        const int *rows = &m_groupRows[group.rowBegin];
+        const int *hubs = &m_groupHubs[group.hubBegin];
+        double *D = &m_blockFactors[m_blockOffsets[g]];
+        double *y = D + r * r;
+        double *Y = y + r;          // Column-major, r x hc
+        int *pivots = &m_pivots[group.rowBegin];
+
+        for (int a = 0; a < r; ++a) {
+            for (int c = 0; c < r; ++c) {
+                D[a * r + c] = localProduct(J, W, rows[a], rows[c]);
+            }
+
+            y[a] = right.get(0, rows[a]);
+        }
+
+        std::fill(Y, Y + r * hc, 0.0);
+        for (int a = 0; a < r; ++a) {
+            for (int k = 0; k < BodiesPerRow; ++k) {
+                const uint8_t b = J.getBlockIndex(rows[a], k);
+                if (b == NoBlock || m_hubSlot[b] == -1) continue;
+
+                const int slot = static_cast<int>(std::find(hubs, hubs + group.hubCount, m_hubSlot[b]) - hubs);
+                for (int s = 0; s < BlockSize; ++s) {
+                    Y[(slot * BlockSize + s) * r + a] += J.get(rows[a], k, s);
+                }
+            }
+        }
+
+        if (!luFactor(D, pivots, r)) {
+            return fallback(J, W, right, limits, result);
+        }
+
+        // Y holds J_hg until the end of this block, then D_g^-1 J_hg
+        luSolve(D, pivots, r, y);
+        for (int c = 0; c < hc; ++c) {
+            const int d_c = hubs[c / BlockSize] * BlockSize + c % BlockSize;
+            double Jy = 0.0;
+            for (int a = 0; a < r; ++a) Jy += Y[c * r + a] * y[a];
+            h[d_c] += Jy;
+        }
+
+        double *column = m_work.data();
+        for (int c1 = 0; c1 < hc; ++c1) {
+            std::copy(Y + c1 * r, Y + (c1 + 1) * r, column);
+            luSolve(D, pivots, r, column);
+
+            const int d_1 = hubs[c1 / BlockSize] * BlockSize + c1 % BlockSize;
+            for (int c0 = 0; c0 < hc; ++c0) {
+                const int d_0 = hubs[c0 / BlockSize] * BlockSize + c0 % BlockSize;
+                double P = 0.0;
+                for (int a = 0; a < r; ++a) P += Y[c0 * r + a] * column[a];
+                H[d_0 * hubDofs + d_1] += P;
+            }
+        }
+
+        for (int c = 0; c < hc; ++c) {
+            luSolve(D, pivots, r, Y + c * r);
+        }
+    }
+
+    // Rows that only act on hubs (and bodies no other group uses):
+    // C z + D_b lambda_b = b_b
+    double *C = m_coupling.data();
+    std::fill(m_coupling.begin(), m_coupling.end(), 0.0);
+    for (int i = 0; i < borderRows; ++i) {
+        const int row = m_borderRows[i];
+        for (int k = 0; k < BodiesPerRow; ++k) {
+            const uint8_t b = J.getBlockIndex(row, k);
+            if (b == NoBlock || m_hubSlot[b] == -1) continue;
+
+            for (int s = 0; s < BlockSize; ++s) {
+                C[i * hubDofs + m_hubSlot[b] * BlockSize + s] += J.get(row, k, s);
+            }
+        }
+    }
+
+    // Hub degrees of freedom with infinite mass don't move
+    for (int d = 0; d < hubDofs; ++d) {
+        if (W.get(0, m_hubs[d / BlockSize] * BlockSize + d % BlockSize) > 0) continue;
+
+        for (int j = 0; j < hubDofs; ++j) H[d * hubDofs + j] = H[j * hubDofs + d] = 0.0;
+        for (int i = 0; i < borderRows; ++i) C[i * hubDofs + d] = 0.0;
+        H[d * hubDofs + d] = 1.0;
+        h[d] = 0.0;
+    }
+
+    // z = H^-1 (C^T lambda_b + h), which leaves
+    // (D_b + C H^-1 C^T) lambda_b = b_b - C H^-1 h
+    int *pivots = m_pivots.data();
+    if (hubDofs > 0 && !luFactor(H, pivots, hubDofs)) {
+        return fallback(J, W, right, limits, result);
+    }
+
+    double *HinvCt = m_couplingSolved.data();     // Column i is H^-1 C_i^T
+    for (int i = 0; i < borderRows; ++i) {
+        std::copy(C + i * hubDofs, C + (i + 1) * hubDofs, HinvCt + i * hubDofs);
+        luSolve(H, pivots, hubDofs, HinvCt + i * hubDofs);
+    }
+
+    luSolve(H, pivots, hubDofs, h);
+
+    double *S = m_schur.data();
+    double *t = m_schurRight.data();
+    for (int i = 0; i < borderRows; ++i) {
+        const int row = m_borderRows[i];
+        const Group &group = m_groups[m_rowGroup[row]];
+
+        double Ch = 0.0;
+        for (int d = 0; d < hubDofs; ++d) Ch += C[i * hubDofs + d] * h[d];
+        t[i] = right.get(0, row) - Ch;
+
+        for (int j = 0; j < borderRows; ++j) {
+            double CHC = 0.0;
+            for (int d = 0; d < hubDofs; ++d) CHC += C[i * hubDofs + d] * HinvCt[j * hubDofs + d];
+            S[i * borderRows + j] = CHC;
+        }
+
+        for (int a = 0; a < group.rowCount; ++a) {
+            const int other = m_groupRows[group.rowBegin + a];
+            S[i * borderRows + m_borderIndex[other]] += localProduct(J, W, row, other);
+        }
+
+        // Rows acting on the same degree of freedom (friction, starter and
+        // dyno on the crank) make S singular; a little compliance picks the
+        // solution that shares the load
+        const double diagonal = S[i * borderRows + i];
+        if (diagonal > 0) S[i * borderRows + i] += m_regularization * diagonal;
+        else {
+            for (int j = 0; j < borderRows; ++j) S[i * borderRows + j] = 0.0;
+            S[i * borderRows + i] = 1.0;
+            t[i] = 0.0;
+        }
+    }
+
+    // Active set over the bounded rows: rows pushed past a limit are held at
+    // it, rows held at a limit that would rather pull away are released, and
+    // the system is solved again until nothing changes
+    std::fill(m_fixed.begin(), m_fixed.end(), 0);
+    double *work = m_work.data();
+    double *x = work + static_cast<size_t>(borderRows) * borderRows;
+    const int maxPasses = 3 * borderRows + 2;
+    int passes = 0;
+    bool done = false;
+    while (!done && passes < maxPasses) {
+        ++passes;
+
+        std::copy(S, S + static_cast<size_t>(borderRows) * borderRows, work);
+        std::copy(t, t + borderRows, x);
+
+        for (int i = 0; i < borderRows; ++i) {
+            if (!m_fixed[i]) continue;
+
+            const int row = m_borderRows[i];
+            for (int j = 0; j < borderRows; ++j) work[i * borderRows + j] = 0.0;
+            work[i * borderRows + i] = 1.0;
+            x[i] = (m_fixed[i] < 0) ? limits->get(0, row) : limits->get(1, row);
+        }
+
+        if (borderRows > 0 && !luFactor(work, pivots, borderRows)) {
+            return fallback(J, W, right, limits, result);
+        }
+
+        luSolve(work, pivots, borderRows, x);
+
+        done = true;
+        for (int i = 0; i < borderRows && limits != nullptr; ++i) {
+            const int row = m_borderRows[i];
+            if (!m_bounded[row]) continue;
+
+            if (m_fixed[i] == 0) {
+                if (x[i] < limits->get(0, row)) { m_fixed[i] = -1; done = false; }
+                else if (x[i] > limits->get(1, row)) { m_fixed[i] = 1; done = false; }
+                continue;
+            }
+
+            double w = -t[i];
+            for (int j = 0; j < borderRows; ++j) w += S[i * borderRows + j] * x[j];
+
+            if ((m_fixed[i] < 0 && w < 0) || (m_fixed[i] > 0 && w > 0)) {
+                m_fixed[i] = 0;
+                done = false;
+            }
+        }
+    }
+
+    if (!done) {
+        return fallback(J, W, right, limits, result);
+    }
+
+    double *z = h;
+    for (int i = 0; i < borderRows; ++i) {
+        if (m_fixed[i] != 0) {
+            x[i] = (m_fixed[i] < 0) ? limits->get(0, m_borderRows[i]) : limits->get(1, m_borderRows[i]);
+        }
+
+        m_solution[m_borderRows[i]] = x[i];
+        for (int d = 0; d < hubDofs; ++d) z[d] += HinvCt[i * hubDofs + d] * x[i];
+    }
+
+    for (size_t g = 0; g < m_groups.size(); ++g) {
+        const Group &group = m_groups[g];
+        if (group.border) continue;
+
+        const int r = group.rowCount;
+        const int hc = group.hubCount * BlockSize;
+        const int *hubs = &m_groupHubs[group.hubBegin];
+        const double *y = &m_blockFactors[m_blockOffsets[g]] + r * r;
+        const double *Y = y + r;
+
+        for (int a = 0; a < r; ++a) {
+            double lambda = y[a];
+            for (int c = 0; c < hc; ++c) {
+                lambda -= Y[c * r + a] * z[hubs[c / BlockSize] * BlockSize + c % BlockSize];
+            }
+
+            m_solution[m_groupRows[group.rowBegin + a]] = lambda;
+        }
+    }
+
+    // Keep the iterative solver warm in case a later step needs it
+    if (m_lambda.getHeight() != n) m_lambda.initialize(1, n, 0.0);
+    for (int i = 0; i < n; ++i) m_lambda.set(0, i, m_solution[i]);
+
+    const double residual = calculateResidual(J, W, right, limits, m_solution.data());
+    if (!(residual <= m_maxDirectResidual)) {
+        return fallback(J, W, right, limits, result);
+    }
+
+    // Nothing was iterated; the active-set passes are reported separately
+    m_lastIterations = 0;
+    m_lastActiveSetPasses = passes;
+    m_lastResidual = residual;
+    m_lastConverged = true;
+
+    result->initialize(1, n, 0.0);
+    for (int i = 0; i < n; ++i) {
+        result->set(0, i, m_solution[i]);
+    }
+
+    return true;
+}
+
+double BlockSleSolver::calculateResidual(
+    atg_scs::SparseMatrix<3> &J,
+    atg_scs::Matrix &W,
+    atg_scs::Matrix &right,
+    atg_scs::Matrix *limits,
+    const double *lambda)
+{
+    const int n = J.getHeight();
+    m_impulse.assign(W.getHeight(), 0.0);
+
+    double rightNorm = 0.0;
+    for (int i = 0; i < n; ++i) {
+        rightNorm = std::max(rightNorm, std::abs(right.get(0, i)));
+        for (int k = 0; k < BodiesPerRow; ++k) {
+            const uint8_t b = J.getBlockIndex(i, k);
+            if (b == NoBlock) continue;
+
+            for (int s = 0; s < BlockSize; ++s) {
+                const int index = b * BlockSize + s;
+                m_impulse[index] += W.get(0, index) * J.get(i, k, s) * lambda[i];
+            }
+        }
+    }
+
+    double maxResidual = 0.0;
+    for (int i = 0; i < n; ++i) {
+        double Ax = 0.0;
+        for (int k = 0; k < BodiesPerRow; ++k) {
+            const uint8_t b = J.getBlockIndex(i, k);
+            if (b == NoBlock) continue;
+
+            for (int s = 0; s < BlockSize; ++s) {
+                Ax += J.get(i, k, s) * m_impulse[b * BlockSize + s];
+            }
+        }
+
+        const double r = right.get(0, i) - Ax;
+        if (limits != nullptr) {
+            // A row held at a limit only has to push the right way
+            if (lambda[i] <= limits->get(0, i) && r <= 0) continue;
+            if (lambda[i] >= limits->get(1, i) && r >= 0) continue;
+        }
+
+        maxResidual = std::max(maxResidual, std::abs(r));
+    }
+
+    return (rightNorm > 0) ? maxResidual / rightNorm : maxResidual;
+}
@@ -1,5 +1,6 @@
 #include "../include/camshaft.h"
 
+#include "../include/arena.h"
 #include "../include/crankshaft.h"
 #include "../include/constants.h"
 #include "../include/units.h"
@@ -14,6 +15,7 @@ Camshaft::Camshaft() {
     m_lobes = 0;
     m_advance = 0;
     m_baseRadius = 0;
+    m_version = 0;
 }
 
 Camshaft::~Camshaft() {
@@ -21,7 +23,7 @@ Camshaft::~Camshaft() {
 }
 
 void Camshaft::initialize(const Parameters &params) {
-    m_lobeAngles = new double[params.lobes];
+    m_lobeAngles = Arena::allocate<double>(params.lobes);
     memset(m_lobeAngles, 0, sizeof(double) * params.lobes);
 
     m_lobes = params.lobes;
@@ -29,10 +31,11 @@ void Camshaft::initialize(const Parameters &params) {
     m_lobeProfile = params.lobeProfile;
     m_advance = params.advance;
     m_baseRadius = params.baseRadius;
+    ++m_version;
 }
 
 void Camshaft::destroy() {
-    delete[] m_lobeAngles;
+    Arena::free(m_lobeAngles);
     m_lobeAngles = nullptr;
 
     m_lobes = 0;
@@ -42,6 +45,10 @@ double Camshaft::valveLift(int lobe) const {
     return sampleLobe(getAngle() + m_lobeAngles[lobe]);
 }
 
+double Camshaft::valveLiftAt(int lobe, double crankAngle) const {
+    return sampleLobe(getAngleAt(crankAngle) + m_lobeAngles[lobe]);
+}
+
 double Camshaft::sampleLobe(double theta) const {
     double clampedTheta = std::fmod(theta, 2 * constants::pi);
     if (clampedTheta < 0) clampedTheta += 2 * constants::pi;
@@ -51,8 +58,12 @@ double Camshaft::sampleLobe(double theta) const {
 }
 
 double Camshaft::getAngle() const {
+    return getAngleAt(m_crankshaft->getAngle());
+}
+
+double Camshaft::getAngleAt(double crankAngle) const {
     const double angle =
-        std::fmod((m_crankshaft->getAngle() + m_advance) * 0.5, 2 * constants::pi);
+        std::fmod((crankAngle + m_advance) * 0.5, 2 * constants::pi);
     return (angle < 0)
         ?  angle + 2 * constants::pi
         :  angle;
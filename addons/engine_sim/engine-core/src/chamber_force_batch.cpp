@@ -0,0 +1,89 @@
+#include "../include/chamber_force_batch.h"
+
+#include "../include/arena.h"
+#include "../include/combustion_chamber.h"
+#include "../include/cylinder_bank.h"
+#include "../include/engine.h"
+#include "../include/piston.h"
+
+#include <assert.h>
+
+ChamberForceBatch::ChamberForceBatch() {
+    m_chambers = nullptr;
+    m_bodyIndex = nullptr;
+    m_dx = nullptr;
+    m_dy = nullptr;
+    m_speed = nullptr;
+    m_force = nullptr;
+    m_count = 0;
+}
+
+ChamberForceBatch::~ChamberForceBatch() {
+    assert(m_chambers == nullptr);
+}
+
+void ChamberForceBatch::initialize(Engine *engine) {
+    m_count = engine->getCylinderCount();
+
+    m_chambers = Arena::allocate<CombustionChamber *>(m_count);
+    m_bodyIndex = Arena::allocate<int>(m_count);
+    m_dx = Arena::allocate<double>(m_count);
+    m_dy = Arena::allocate<double>(m_count);
+    m_speed = Arena::allocate<double>(m_count);
+    m_force = Arena::allocate<double>(m_count);
+
+    for (int i = 0; i < m_count; ++i) {
+        CombustionChamber *chamber = engine->getChamber(i);
+        const CylinderBank *bank = chamber->getCylinderHead()->getCylinderBank();
+
+        m_chambers[i] = chamber;
+        m_bodyIndex[i] = chamber->getPiston()->m_body.index;
+        m_dx[i] = bank->getDx();
+        m_dy[i] = bank->getDy();
+        m_speed[i] = 0.0;
+        m_force[i] = 0.0;
+    }
+}
+
+void ChamberForceBatch::destroy() {
+    Arena::free(m_chambers);
+    Arena::free(m_bodyIndex);
+    Arena::free(m_dx);
+    Arena::free(m_dy);
+    Arena::free(m_speed);
+    Arena::free(m_force);
+
+    m_chambers = nullptr;
+    m_bodyIndex = nullptr;
+    m_dx = nullptr;
+    m_dy = nullptr;
+    m_speed = nullptr;
+    m_force = nullptr;
+    m_count = 0;
+}
+
+void ChamberForceBatch::apply(atg_scs::SystemState *state) {
+    const int n = m_count;
+    const int *__restrict bodyIndex = m_bodyIndex;
+    const double *__restrict dx = m_dx;
+    const double *__restrict dy = m_dy;
+    double *__restrict speed = m_speed;
+    double *__restrict force = m_force;
+
+    for (int i = 0; i < n; ++i) {
+        const int body = bodyIndex[i];
+        speed[i] = state->v_x[body] * dx[i] + state->v_y[body] * dy[i];
+    }
+
+    for (int i = 0; i < n; ++i) {
+        force[i] = m_chambers[i]->calculatePistonForce(speed[i]);
+    }
+
+    // The force acts through each piston's origin, so it adds no torque and
+    // can be written straight into the force accumulators
+    for (int i = 0; i < n; ++i) {
+        const int body = bodyIndex[i];
+        state->f_x[body] += force[i] * dx[i];
+        state->f_y[body] += force[i] * dy[i];
+    }
+}
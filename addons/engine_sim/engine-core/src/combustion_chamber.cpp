@@ -9,6 +9,7 @@
 #include "../include/cylinder_bank.h"
 #include "../include/engine.h"
 
+#include <algorithm>
 #include <cmath>
 
 CombustionChamber::CombustionChamber() {
@@ -16,8 +17,7 @@ CombustionChamber::CombustionChamber() {
     m_piston = nullptr;
     m_head = nullptr;
     m_engine = nullptr;
-    m_pistonSpeed = nullptr;
-    m_pressure = nullptr;
+    m_geometry = nullptr;
     m_lit = false;
     m_litLastFrame = false;
     m_peakTemperature = 0;
@@ -25,23 +25,25 @@ CombustionChamber::CombustionChamber() {
     m_meanPistonSpeedToTurbulence = nullptr;
     m_nBurntFuel = 0;
 
-    m_manifoldToRunnerFlowRate = 0;
-    m_primaryToCollectorFlowRate = 0;
-    m_cylinderWidthApproximation = 0;
-    m_cylinderCrossSectionSurfaceArea = 0;
-
     m_lastTimestepTotalExhaustFlow = 0;
     m_lastTimestepTotalIntakeFlow = 0;
     m_exhaustFlow = 0;
     m_exhaustFlowRate = 0;
     m_intakeFlowRate = 0;
 
+    m_volume = 0;
+    m_interpolatedPistonSpeed = 0;
+    m_mechanicalVolume = 0;
+    m_mechanicalPistonSpeed = 0;
+    m_pressureForce = 0;
+    m_pressureForceSum = 0;
+    m_pressureForceSamples = 0;
+
     m_fuel = nullptr;
 }
 
 CombustionChamber::~CombustionChamber() {
-    assert(m_pistonSpeed == nullptr);
-    assert(m_pressure == nullptr);
+    /* void */
 }
 
 void CombustionChamber::initialize(const Parameters &params) {
@@ -51,26 +53,42 @@ void CombustionChamber::initialize(const Parameters &params) {
     m_crankcasePressure = params.CrankcasePressure;
     m_meanPistonSpeedToTurbulence = params.MeanPistonSpeedToTurbulence;
 
-    m_pistonSpeed = new double[StateSamples];
-    m_pressure = new double[StateSamples];
-    for (int i = 0; i < StateSamples; ++i) {
-        m_pistonSpeed[i] = 0;
-        m_pressure[i] = 0;
-    }
+    m_cyclePistonSpeed.initialize(StateSamples);
+    m_cyclePressure.initialize(StateSamples);
 
     Intake *intake = m_head->getIntake(m_piston->getCylinderIndex());
     ExhaustSystem *exhaust = m_head->getExhaustSystem(m_piston->getCylinderIndex());
+    const CylinderBank *bank = m_head->getCylinderBank();
 
-    m_manifoldToRunnerFlowRate = intake->getRunnerFlowRate();
-    m_primaryToCollectorFlowRate = exhaust->getPrimaryFlowRate();
-
-    const double bore_r = m_head->getCylinderBank()->getBore() / 2.0;
-    m_cylinderCrossSectionSurfaceArea = constants::pi * bore_r * bore_r;
-    m_cylinderWidthApproximation = std::sqrt(m_cylinderCrossSectionSurfaceArea);
-
-    const double height = getVolume() / m_cylinderCrossSectionSurfaceArea;
+    FlowRecord &r = m_flowRecord;
+    r.plenum = &intake->m_system;
+    r.collector = exhaust->getSystem();
+    r.manifoldToRunnerFlowRate = intake->getRunnerFlowRate();
+    r.primaryToCollectorFlowRate = exhaust->getPrimaryFlowRate();
+    r.plenumCrossSection = intake->getPlenumCrossSectionArea();
+    r.intakeRunnerCrossSection = m_head->getIntakeRunnerCrossSectionArea();
+    r.exhaustRunnerCrossSection = m_head->getExhaustRunnerCrossSectionArea();
+    r.collectorCrossSection = exhaust->getCollectorCrossSectionArea();
+    r.intakeVelocityDecay = intake->getVelocityDecay();
+    r.exhaustVelocityDecay = exhaust->getVelocityDecay();
+    r.boreRadius = bank->getBore() / 2.0;
+    r.boreCircumference = constants::pi * bank->getBore();
+    r.blowbyK = m_piston->getBlowbyK();
+
+    assert(m_geometry != nullptr);
+    Geometry &g = *m_geometry;
+    g.crossSection = constants::pi * r.boreRadius * r.boreRadius;
+    g.dx = bank->getDx();
+    g.dy = bank->getDy();
+    g.bankX = bank->getX();
+    g.bankY = bank->getY();
+    g.deckHeight = bank->getDeckHeight();
+    g.compressionHeight = m_piston->getCompressionHeight();
+    g.clearanceVolume = m_head->getCombustionChamberVolume() - m_piston->getDisplacement();
+
+    const double height = getVolume() / g.crossSection;
     m_system.setGeometry(
-        m_cylinderWidthApproximation,
+        std::sqrt(g.crossSection),
         height,
         1.0,
         0.0);
@@ -110,53 +128,35 @@ void CombustionChamber::initialize(const Parameters &params) {
 }
 
 void CombustionChamber::destroy() {
-    if (m_pistonSpeed != nullptr) delete[] m_pistonSpeed;
-    if (m_pressure != nullptr) delete[] m_pressure;
-
-    m_pistonSpeed = nullptr;
-    m_pressure = nullptr;
+    m_cyclePistonSpeed.destroy();
+    m_cyclePressure.destroy();
 }
 
 double CombustionChamber::getVolume() const {
-    const double combustionPortVolume = m_head->getCombustionChamberVolume();
-    const CylinderBank *bank = m_head->getCylinderBank();
+    const Geometry &g = *m_geometry;
+    const atg_scs::RigidBody &body = m_piston->m_body;
 
-    const double area = bank->boreSurfaceArea();
     const double s =
-        m_piston->relativeX() * bank->getDx()
-        + m_piston->relativeY() * bank->getDy();
+        (body.p_x - g.bankX) * g.dx
+        + (body.p_y - g.bankY) * g.dy;
     const double sweep =
-        area * (bank->getDeckHeight() - s - m_piston->getCompressionHeight());
+        g.crossSection * (g.deckHeight - s - g.compressionHeight);
 
-    return sweep + combustionPortVolume - m_piston->getDisplacement();
+    return sweep + g.clearanceVolume;
 }
 
 double CombustionChamber::pistonSpeed() const {
-    const CylinderBank *bank = m_head->getCylinderBank();
     return
-        m_piston->m_body.v_x * bank->getDx()
-        + m_piston->m_body.v_y * bank->getDy();
+        m_piston->m_body.v_x * m_geometry->dx
+        + m_piston->m_body.v_y * m_geometry->dy;
 }
 
 double CombustionChamber::calculateMeanPistonSpeed() const {
-    double avg = 0;
-    for (int i = 0; i < StateSamples; ++i) {
-        avg += m_pistonSpeed[i];
-    }
-
-    avg /= StateSamples;
-    return avg;
+    return m_cyclePistonSpeed.getMean();
 }
 
 double CombustionChamber::calculateFiringPressure() const {
-    double firingPressure = 0;
-    for (int i = 0; i < StateSamples; ++i) {
-        if (m_pressure[i] > firingPressure) {
-            firingPressure = m_pressure[i];
-        }
-    }
-
-    return firingPressure;
+    return std::max(m_cyclePressure.getMax(), 0.0);
 }
 
 bool CombustionChamber::popLitLastFrame() {
@@ -223,10 +223,23 @@ void CombustionChamber::ignite() {
     }
 }
 
-void CombustionChamber::update(double dt) {
-    m_system.setVolume(getVolume());
+void CombustionChamber::update(double dt, const EngineStepState &state, double mechanicalFraction) {
+    const double volume = getVolume();
+    const double speed = pistonSpeed();
+
+    if (mechanicalFraction >= 1.0) {
+        m_volume = volume;
+        m_interpolatedPistonSpeed = speed;
+    }
+    else {
+        m_volume = m_mechanicalVolume + (volume - m_mechanicalVolume) * mechanicalFraction;
+        m_interpolatedPistonSpeed =
+            m_mechanicalPistonSpeed + (speed - m_mechanicalPistonSpeed) * mechanicalFraction;
+    }
+
+    m_system.setVolume(m_volume);
 
-    updateCycleStates();
+    updateCycleStates(state);
 
     m_intakeFlowRate = m_head->intakeFlowRate(m_piston->getCylinderIndex());
     m_exhaustFlowRate = m_head->exhaustFlowRate(m_piston->getCylinderIndex());
@@ -237,39 +250,38 @@ void CombustionChamber::flow(double dt) {
         m_peakTemperature = m_system.temperature();
     }
 
-    const double volume = getVolume();
-    const double cylinderHeight = volume / m_cylinderCrossSectionSurfaceArea;
+    const FlowRecord &r = m_flowRecord;
+    const double crossSection = m_geometry->crossSection;
+    const double volume = m_volume;
+    const double cylinderHeight = volume / crossSection;
     const double cylinderSurfaceArea =
-        cylinderHeight * constants::pi * m_head->getCylinderBank()->getBore()
-        + m_cylinderCrossSectionSurfaceArea * 2;
+        cylinderHeight * r.boreCircumference
+        + crossSection * 2;
 
     const double dT = units::celcius(90.0) - m_system.temperature();
 
     m_system.changeEnergy(dT * cylinderSurfaceArea * 100 * dt);
-    m_system.flow(m_piston->getBlowbyK(), dt, m_crankcasePressure, units::celcius(25.0));
-
-    Intake *intake = m_head->getIntake(m_piston->getCylinderIndex());
-    ExhaustSystem *exhaust = m_head->getExhaustSystem(m_piston->getCylinderIndex());
+    m_system.flow(r.blowbyK, dt, m_crankcasePressure, units::celcius(25.0));
 
     const double start_n = m_system.n();
 
     GasSystem::FlowParameters flowParams;
     flowParams.dt = dt;
 
-    flowParams.k_flow = m_manifoldToRunnerFlowRate;
-    flowParams.crossSectionArea_0 = intake->getPlenumCrossSectionArea();
-    flowParams.crossSectionArea_1 = m_head->getIntakeRunnerCrossSectionArea();
+    flowParams.k_flow = r.manifoldToRunnerFlowRate;
+    flowParams.crossSectionArea_0 = r.plenumCrossSection;
+    flowParams.crossSectionArea_1 = r.intakeRunnerCrossSection;
     flowParams.direction_x = 1.0;
     flowParams.direction_y = 0.0;
-    flowParams.system_0 = &intake->m_system;
+    flowParams.system_0 = r.plenum;
     flowParams.system_1 = &m_intakeRunnerAndManifold;
     GasSystem::flow(flowParams);
 
     m_intakeRunnerAndManifold.dissipateExcessVelocity();
 
     flowParams.k_flow = m_intakeFlowRate;
-    flowParams.crossSectionArea_0 = m_head->getIntakeRunnerCrossSectionArea();
-    flowParams.crossSectionArea_1 = volume / cylinderHeight;
+    flowParams.crossSectionArea_0 = r.intakeRunnerCrossSection;
+    flowParams.crossSectionArea_1 = crossSection;
     flowParams.direction_x = 1.0;
     flowParams.direction_y = 0.0;
     flowParams.system_0 = &m_intakeRunnerAndManifold;
@@ -280,8 +292,8 @@ void CombustionChamber::flow(double dt) {
     m_system.dissipateExcessVelocity();
 
     flowParams.k_flow = m_exhaustFlowRate;
-    flowParams.crossSectionArea_0 = volume / cylinderHeight;
-    flowParams.crossSectionArea_1 = m_head->getExhaustRunnerCrossSectionArea();
+    flowParams.crossSectionArea_0 = crossSection;
+    flowParams.crossSectionArea_1 = r.exhaustRunnerCrossSection;
     flowParams.direction_x = 1.0;
     flowParams.direction_y = 0.0;
     flowParams.system_0 = &m_system;
@@ -291,18 +303,18 @@ void CombustionChamber::flow(double dt) {
     m_system.dissipateExcessVelocity();
     m_exhaustRunnerAndPrimary.dissipateExcessVelocity();
 
-    flowParams.k_flow = m_primaryToCollectorFlowRate;
-    flowParams.crossSectionArea_0 = m_head->getExhaustRunnerCrossSectionArea();
-    flowParams.crossSectionArea_1 = exhaust->getCollectorCrossSectionArea();
+    flowParams.k_flow = r.primaryToCollectorFlowRate;
+    flowParams.crossSectionArea_0 = r.exhaustRunnerCrossSection;
+    flowParams.crossSectionArea_1 = r.collectorCrossSection;
     flowParams.direction_x = 1.0;
     flowParams.direction_y = 0.0;
     flowParams.system_0 = &m_exhaustRunnerAndPrimary;
-    flowParams.system_1 = exhaust->getSystem();
+    flowParams.system_1 = r.collector;
     GasSystem::flow(flowParams);
 
-    m_intakeRunnerAndManifold.updateVelocity(dt, intake->getVelocityDecay());
+    m_intakeRunnerAndManifold.updateVelocity(dt, r.intakeVelocityDecay);
     m_system.updateVelocity(dt, 0.5);
-    m_exhaustRunnerAndPrimary.updateVelocity(dt, exhaust->getVelocityDecay());
+    m_exhaustRunnerAndPrimary.updateVelocity(dt, r.exhaustVelocityDecay);
 
     if (std::abs(intakeFlow) > 1E-9 && m_lit) {
         m_lit = false;
@@ -313,9 +325,8 @@ void CombustionChamber::flow(double dt) {
     m_lastTimestepTotalIntakeFlow += intakeFlow;
 
     if (m_lit) {
-        CylinderBank *bank = m_head->getCylinderBank();
-        const double totalTravel_x = bank->getBore() / 2;
-        const double totalTravel_y = volume / bank->boreSurfaceArea();
+        const double totalTravel_x = r.boreRadius;
+        const double totalTravel_y = volume / crossSection;
         const double expansion = volume / m_flameEvent.lastVolume;
         const double lastTravel_x = m_flameEvent.travel_x;
         const double lastTravel_y = m_flameEvent.travel_y * expansion;
@@ -389,29 +400,68 @@ double CombustionChamber::calculateFrictionForce(double v_s) const {
     return F_0 * F_2 + F_3 + F_4;
 }
 
-void CombustionChamber::updateCycleStates() {
-    double crankAngle = m_engine->getOutputCrankshaft()->getCycleAngle();
+void CombustionChamber::updateCycleStates(const EngineStepState &state) {
+    double crankAngle = state.cycleAngle;
     if (std::isnan(crankAngle) || std::isinf(crankAngle)) {
         crankAngle = 0.0;
     }
 
     const int i = (int)std::round((crankAngle / (4 * constants::pi)) * (StateSamples - 1.0));
 
-    m_pistonSpeed[i] = std::abs(pistonSpeed());
-    m_pressure[i] = m_system.pressure();
+    m_cyclePistonSpeed.set(i, std::abs(m_interpolatedPistonSpeed));
+    m_cyclePressure.set(i, m_system.pressure());
 }
 
 void CombustionChamber::apply(atg_scs::SystemState *system) {
-    CylinderBank *bank = m_head->getCylinderBank();
-    const double area = (bank->getBore() * bank->getBore() / 4.0) * constants::pi;
     const double v_x = system->v_x[m_piston->m_body.index];
     const double v_y = system->v_y[m_piston->m_body.index];
 
     const double v_s =
-        v_x * bank->getDx() + v_y * bank->getDy();
+        v_x * m_geometry->dx + v_y * m_geometry->dy;
+    const double force = calculatePistonForce(v_s);
 
+    system->applyForce(
+        0.0,
+        0.0,
+        force * m_geometry->dx,
+        force * m_geometry->dy,
+        m_piston->m_body.index);
+}
+
+void CombustionChamber::accumulatePressureForce() {
+    m_pressureForceSum += calculatePressureForce();
+    ++m_pressureForceSamples;
+}
+
+void CombustionChamber::endMechanicalStep() {
+    m_pressureForce = (m_pressureForceSamples > 0)
+        ? m_pressureForceSum / m_pressureForceSamples
+        : calculatePressureForce();
+    m_pressureForceSum = 0;
+    m_pressureForceSamples = 0;
+
+    m_mechanicalVolume = getVolume();
+    m_mechanicalPistonSpeed = pistonSpeed();
+}
+
+void CombustionChamber::resetMechanicalStep() {
+    m_pressureForceSum = 0;
+    m_pressureForceSamples = 0;
+    endMechanicalStep();
+
+    m_volume = m_mechanicalVolume;
+    m_interpolatedPistonSpeed = m_mechanicalPistonSpeed;
+}
+
+double CombustionChamber::calculatePressureForce() const {
+    const double area = m_geometry->crossSection;
     const double pressureDifferential = m_system.pressure() - m_crankcasePressure;
-    const double force = -area * pressureDifferential;
+
+    return -area * pressureDifferential;
+}
+
+double CombustionChamber::calculatePistonForce(double v_s) const {
+    const double force = m_pressureForce;
 
     if (std::isnan(force) || std::isinf(force)) {
         assert(false);
@@ -426,21 +476,53 @@ void CombustionChamber::apply(atg_scs::SystemState *system) {
         ? -F
         : F;
 
-    system->applyForce(
-        0.0,
-        0.0,
-        (force + F_fric) * bank->getDx(),
-        (force + F_fric) * bank->getDy(),
-        m_piston->m_body.index);
+    return force + F_fric;
 }
 
 double CombustionChamber::getFrictionForce() const {
-    CylinderBank *bank = m_head->getCylinderBank();
     const double v_x = m_piston->m_body.v_x;
     const double v_y = m_piston->m_body.v_y;
 
     const double v_s =
-        v_x * bank->getDx() + v_y * bank->getDy();
+        v_x * m_geometry->dx + v_y * m_geometry->dy;
 
     return calculateFrictionForce(v_s);
 }
+
+void CombustionChamber::writeState(StateWriter *writer) const {
+    m_system.writeState(writer);
+    m_intakeRunnerAndManifold.writeState(writer);
+    m_exhaustRunnerAndPrimary.writeState(writer);
+
+    writer->write(m_flameEvent);
+    writer->write(m_lit);
+    writer->write(m_litLastFrame);
+    writer->write(m_peakTemperature);
+    writer->write(m_nBurntFuel);
+    writer->write(m_intakeFlowRate);
+    writer->write(m_exhaustFlowRate);
+    writer->write(m_exhaustFlow);
+    writer->write(m_lastTimestepTotalExhaustFlow);
+    writer->write(m_lastTimestepTotalIntakeFlow);
+    m_cyclePressure.writeState(writer);
+    m_cyclePistonSpeed.writeState(writer);
+}
+
+void CombustionChamber::readState(StateReader *reader) {
+    m_system.readState(reader);
+    m_intakeRunnerAndManifold.readState(reader);
+    m_exhaustRunnerAndPrimary.readState(reader);
+
+    reader->read(&m_flameEvent);
+    reader->read(&m_lit);
+    reader->read(&m_litLastFrame);
+    reader->read(&m_peakTemperature);
+    reader->read(&m_nBurntFuel);
+    reader->read(&m_intakeFlowRate);
+    reader->read(&m_exhaustFlowRate);
+    reader->read(&m_exhaustFlow);
+    reader->read(&m_lastTimestepTotalExhaustFlow);
+    reader->read(&m_lastTimestepTotalIntakeFlow);
+    m_cyclePressure.readState(reader);
+    m_cyclePistonSpeed.readState(reader);
+}
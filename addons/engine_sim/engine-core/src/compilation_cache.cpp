@@ -0,0 +1,227 @@
+#include "../include/compilation_cache.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+    // FNV-1a
+    uint64_t hashContents(const std::string &contents) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (const char c : contents) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
+    bool readFile(const std::filesystem::path &path, std::string *contents) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+
+        std::ostringstream ss;
+        ss << file.rdbuf();
+        *contents = ss.str();
+
+        return true;
+    }
+
+    // `import "file"`, optionally public or private. Comments and anything
+    // else are skipped.
+    bool parseImport(const std::string &line, std::string *target) {
+        std::istringstream ss(line);
+        std::string word;
+        if (!(ss >> word)) return false;
+        if (word == "public" || word == "private") {
+            if (!(ss >> word)) return false;
+        }
+
+        if (word != "import") return false;
+
+        ss >> std::ws;
+        if (ss.get() != '"') return false;
+
+        return static_cast<bool>(std::getline(ss, *target, '"')) && !target->empty();
+    }
+
+    bool isFile(const std::filesystem::path &path) {
+        std::error_code ec;
+        return std::filesystem::is_regular_file(path, ec);
+    }
+
+    bool resolveImport(
+        const std::filesystem::path &importer,
+        const std::string &target,
+        const std::vector<std::string> &searchPaths,
+        std::filesystem::path *resolved)
+    {
+        std::vector<std::filesystem::path> candidates;
+        candidates.push_back(importer.parent_path() / target);
+        for (const std::string &searchPath : searchPaths) {
+            candidates.push_back(std::filesystem::path(searchPath) / target);
+        }
+
+        for (const std::filesystem::path &candidate : candidates) {
+            if (isFile(candidate)) {
+                *resolved = candidate;
+                return true;
+            }
+            else if (!candidate.has_extension() && isFile(candidate.string() + ".mr")) {
+                *resolved = candidate.string() + ".mr";
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+} // namespace
+
+CompilationCache::CompilationCache() {
+    m_capacity = DefaultCapacity;
+}
+
+CompilationCache::~CompilationCache() {
+    /* void */
+}
+
+void CompilationCache::setCapacity(int capacity) {
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    m_capacity = (capacity < 0) ? 0 : capacity;
+    while (static_cast<int>(m_entries.size()) > m_capacity) {
+        m_entries.pop_back();
+    }
+}
+
+bool CompilationCache::find(
+    const std::string &scriptPath,
+    const std::vector<std::string> &searchPaths,
+    std::vector<uint8_t> *data)
+{
+    const std::string key = normalize(scriptPath);
+
+    // Files are scanned outside the lock, so the entry is looked up twice
+    std::vector<Dependency> recorded;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (const Entry &entry : m_entries) {
+            if (entry.scriptPath == key) {
+                recorded = entry.dependencies;
+                break;
+            }
+        }
+    }
+
+    if (recorded.empty()) return false;
+
+    std::vector<Dependency> current;
+    const bool unchanged = collectDependencies(scriptPath, searchPaths, &current)
+        && current.size() == recorded.size()
+        && std::equal(
+            current.begin(),
+            current.end(),
+            recorded.begin(),
+            [](const Dependency &a, const Dependency &b) {
+                return a.path == b.path && a.hash == b.hash;
+            });
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->scriptPath != key) continue;
+
+        if (!unchanged) {
+            m_entries.erase(it);
+            return false;
+        }
+
+        m_entries.splice(m_entries.begin(), m_entries, it);
+        *data = it->data;
+        return true;
+    }
+
+    return false;
+}
+
+void CompilationCache::store(
+    const std::string &scriptPath,
+    const std::vector<std::string> &searchPaths,
+    const uint8_t *data,
+    size_t size)
+{
+    Entry entry;
+    entry.scriptPath = normalize(scriptPath);
+    if (!collectDependencies(scriptPath, searchPaths, &entry.dependencies)) return;
+    entry.data.assign(data, data + size);
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (m_capacity == 0) return;
+
+    m_entries.remove_if([&](const Entry &e) { return e.scriptPath == entry.scriptPath; });
+    m_entries.push_front(std::move(entry));
+
+    while (static_cast<int>(m_entries.size()) > m_capacity) {
+        m_entries.pop_back();
+    }
+}
+
+void CompilationCache::clear() {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_entries.clear();
+}
+
+int CompilationCache::getEntryCount() {
+    std::lock_guard<std::mutex> lock(m_lock);
+    return static_cast<int>(m_entries.size());
+}
+
+bool CompilationCache::collectDependencies(
+    const std::string &scriptPath,
+    const std::vector<std::string> &searchPaths,
+    std::vector<Dependency> *dependencies)
+{
+    dependencies->clear();
+
+    std::vector<std::filesystem::path> pending = { scriptPath };
+    while (!pending.empty()) {
+        const std::filesystem::path path = pending.back();
+        pending.pop_back();
+
+        const std::string key = normalize(path.string());
+        bool visited = false;
+        for (const Dependency &dependency : *dependencies) {
+            visited = visited || dependency.path == key;
+        }
+
+        if (visited) continue;
+
+        std::string contents;
+        if (!readFile(path, &contents)) return false;
+        dependencies->push_back({ key, hashContents(contents) });
+
+        std::vector<std::filesystem::path> imports;
+        std::istringstream lines(contents);
+        std::string line, target;
+        while (std::getline(lines, line)) {
+            if (!parseImport(line, &target)) continue;
+
+            std::filesystem::path resolved;
+            if (!resolveImport(path, target, searchPaths, &resolved)) return false;
+            imports.push_back(resolved);
+        }
+
+        // Visit imports in the order they're written
+        pending.insert(pending.end(), imports.rbegin(), imports.rend());
+    }
+
+    return true;
+}
+
+std::string CompilationCache::normalize(const std::string &path) {
+    std::error_code ec;
+    const std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+    return (ec ? std::filesystem::path(path) : absolute).lexically_normal().string();
+}
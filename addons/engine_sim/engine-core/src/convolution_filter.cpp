@@ -1,5 +1,7 @@
 #include "../include/convolution_filter.h"
 
+#include "../include/arena.h"
+
 #include <assert.h>
 #include <string.h>
 
@@ -25,16 +27,16 @@ ConvolutionFilter::~ConvolutionFilter() {
 void ConvolutionFilter::initialize(int samples) {
     m_sampleCount = samples;
     m_shiftOffset = 0;
-    m_shiftRegister = new float[samples];
-    m_impulseResponse = new float[samples];
+    m_shiftRegister = Arena::allocate<float>(samples);
+    m_impulseResponse = Arena::allocate<float>(samples);
 
     memset(m_shiftRegister, 0, sizeof(float) * samples);
     memset(m_impulseResponse, 0, sizeof(float) * samples);
 }
 
 void ConvolutionFilter::destroy() {
-    delete[] m_shiftRegister;
-    delete[] m_impulseResponse;
+    Arena::free(m_shiftRegister);
+    Arena::free(m_impulseResponse);
 
     m_shiftRegister = nullptr;
     m_impulseResponse = nullptr;
@@ -113,3 +115,21 @@ float ConvolutionFilter::f(float sample) {
 
     return result;
 }
+
+void ConvolutionFilter::writeState(StateWriter *writer) const {
+    writer->write(m_sampleCount);
+    writer->write(m_shiftRegister, m_sampleCount);
+    writer->write(m_shiftOffset);
+}
+
+void ConvolutionFilter::readState(StateReader *reader) {
+    int sampleCount = 0;
+    if (!reader->read(&sampleCount)) return;
+    if (sampleCount != m_sampleCount) {
+        reader->invalidate();
+        return;
+    }
+
+    reader->read(m_shiftRegister, m_sampleCount);
+    reader->read(&m_shiftOffset);
+}
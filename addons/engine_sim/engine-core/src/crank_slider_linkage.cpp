@@ -0,0 +1,323 @@
+#include "../include/crank_slider_linkage.h"
+
+#include "../include/arena.h"
+#include "../include/combustion_chamber.h"
+#include "../include/connecting_rod.h"
+#include "../include/constants.h"
+#include "../include/crankshaft.h"
+#include "../include/cylinder_bank.h"
+#include "../include/engine.h"
+#include "../include/piston.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+
+CrankSliderLinkage::CrankSliderLinkage() {
+    m_engine = nullptr;
+
+    m_cylinders = nullptr;
+    m_order = nullptr;
+    m_masterCylinder = nullptr;
+    m_crankshaftIndex = nullptr;
+    m_cylinderCount = 0;
+
+    m_baseInertia = nullptr;
+    m_inertia = nullptr;
+    m_crankAngle = nullptr;
+    m_torque = nullptr;
+    m_inertiaDerivative = nullptr;
+    m_crankshaftCount = 0;
+}
+
+CrankSliderLinkage::~CrankSliderLinkage() {
+    assert(m_cylinders == nullptr);
+    assert(m_baseInertia == nullptr);
+}
+
+void CrankSliderLinkage::initialize(Engine *engine) {
+    m_engine = engine;
+    m_cylinderCount = engine->getCylinderCount();
+    m_crankshaftCount = engine->getCrankshaftCount();
+
+    m_cylinders = Arena::allocate<Cylinder>(m_cylinderCount);
+    m_order = Arena::allocate<int>(m_cylinderCount);
+    m_masterCylinder = Arena::allocate<int>(m_cylinderCount);
+    m_crankshaftIndex = Arena::allocate<int>(m_cylinderCount);
+
+    m_baseInertia = Arena::allocate<double>(m_crankshaftCount);
+    m_inertia = Arena::allocate<double>(m_crankshaftCount);
+    m_crankAngle = Arena::allocate<double>(m_crankshaftCount);
+    m_torque = Arena::allocate<double>(m_crankshaftCount);
+    m_inertiaDerivative = Arena::allocate<double>(m_crankshaftCount);
+
+    // Crankshaft bodies are expected to already carry their own inertia
+    for (int i = 0; i < m_crankshaftCount; ++i) {
+        m_baseInertia[i] = engine->getCrankshaft(i)->m_body.I;
+    }
+
+    for (int i = 0; i < m_cylinderCount; ++i) {
+        ConnectingRod *rod = engine->getConnectingRod(i);
+        ConnectingRod *master = rod->getMasterRod();
+
+        m_masterCylinder[i] = -1;
+        for (int j = 0; j < m_cylinderCount && master != nullptr; ++j) {
+            if (engine->getConnectingRod(j) == master) m_masterCylinder[i] = j;
+        }
+
+        const Crankshaft *crankshaft = (master != nullptr)
+            ? master->getCrankshaft()
+            : rod->getCrankshaft();
+        m_crankshaftIndex[i] = 0;
+        for (int j = 0; j < m_crankshaftCount; ++j) {
+            if (engine->getCrankshaft(j) == crankshaft) m_crankshaftIndex[i] = j;
+        }
+    }
+
+    int n = 0;
+    for (int i = 0; i < m_cylinderCount; ++i) {
+        if (m_masterCylinder[i] == -1) m_order[n++] = i;
+    }
+
+    for (int i = 0; i < m_cylinderCount; ++i) {
+        if (m_masterCylinder[i] != -1) m_order[n++] = i;
+    }
+}
+
+void CrankSliderLinkage::destroy() {
+    Arena::free(m_cylinders);
+    Arena::free(m_order);
+    Arena::free(m_masterCylinder);
+    Arena::free(m_crankshaftIndex);
+
+    Arena::free(m_baseInertia);
+    Arena::free(m_inertia);
+    Arena::free(m_crankAngle);
+    Arena::free(m_torque);
+    Arena::free(m_inertiaDerivative);
+
+    m_cylinders = nullptr;
+    m_order = nullptr;
+    m_masterCylinder = nullptr;
+    m_crankshaftIndex = nullptr;
+
+    m_baseInertia = nullptr;
+    m_inertia = nullptr;
+    m_crankAngle = nullptr;
+    m_torque = nullptr;
+    m_inertiaDerivative = nullptr;
+
+    m_cylinderCount = 0;
+    m_crankshaftCount = 0;
+    m_engine = nullptr;
+}
+
+void CrankSliderLinkage::update() {
+    for (int i = 0; i < m_crankshaftCount; ++i) {
+        m_crankAngle[i] = m_engine->getCrankshaft(i)->m_body.theta;
+        m_inertia[i] = m_baseInertia[i];
+    }
+
+    solve(m_crankAngle);
+
+    for (int i = 0; i < m_cylinderCount; ++i) {
+        const Cylinder &cylinder = m_cylinders[i];
+        const int crank = m_crankshaftIndex[i];
+        const double omega = m_engine->getCrankshaft(crank)->m_body.v_theta;
+
+        Piston *piston = m_engine->getPiston(i);
+        const CylinderBank *bank = piston->getCylinderBank();
+
+        // The body origin sits past the wrist pin by its local offset
+        const double s = cylinder.s + piston->getWristPinLocation();
+        piston->m_body.p_x = bank->getX() + s * bank->getDx();
+        piston->m_body.p_y = bank->getY() + s * bank->getDy();
+        piston->m_body.v_x = cylinder.ds * omega * bank->getDx();
+        piston->m_body.v_y = cylinder.ds * omega * bank->getDy();
+        piston->m_body.theta = bank->getAngle() + constants::pi;
+        piston->m_body.v_theta = 0;
+
+        ConnectingRod *rod = piston->getRod();
+        rod->m_body.p_x = cylinder.rodCenter.x;
+        rod->m_body.p_y = cylinder.rodCenter.y;
+        rod->m_body.v_x = cylinder.rodCenter.dx * omega;
+        rod->m_body.v_y = cylinder.rodCenter.dy * omega;
+        rod->m_body.theta = cylinder.phi - constants::pi / 2;
+        rod->m_body.v_theta = cylinder.dphi * omega;
+
+        piston->setCylinderWallForce(
+            std::abs(m_engine->getChamber(i)->getPressureForce()) * cylinder.sideRatio);
+
+        m_inertia[crank] += reciprocatingInertia(i, nullptr);
+    }
+
+    for (int i = 0; i < m_crankshaftCount; ++i) {
+        m_engine->getCrankshaft(i)->m_body.I = m_inertia[i];
+    }
+}
+
+void CrankSliderLinkage::apply(atg_scs::SystemState *state) {
+    for (int i = 0; i < m_crankshaftCount; ++i) {
+        m_crankAngle[i] = state->theta[m_engine->getCrankshaft(i)->m_body.index];
+        m_torque[i] = 0;
+        m_inertiaDerivative[i] = 0;
+    }
+
+    solve(m_crankAngle);
+
+    for (int i = 0; i < m_cylinderCount; ++i) {
+        const Cylinder &cylinder = m_cylinders[i];
+        const int crank = m_crankshaftIndex[i];
+        const double omega = state->v_theta[m_engine->getCrankshaft(crank)->m_body.index];
+
+        CombustionChamber *chamber = m_engine->getChamber(i);
+        m_engine->getPiston(i)->setCylinderWallForce(
+            std::abs(chamber->getPressureForce()) * cylinder.sideRatio);
+
+        const double force = chamber->calculatePistonForce(cylinder.ds * omega);
+        m_torque[crank] += force * cylinder.ds;
+
+        double dJ = 0;
+        reciprocatingInertia(i, &dJ);
+        m_inertiaDerivative[crank] += dJ;
+    }
+
+    for (int i = 0; i < m_crankshaftCount; ++i) {
+        const int index = m_engine->getCrankshaft(i)->m_body.index;
+        const double omega = state->v_theta[index];
+        state->t[index] += m_torque[i] - 0.5 * m_inertiaDerivative[i] * omega * omega;
+    }
+}
+
+void CrankSliderLinkage::crankJournal(Crankshaft *crankshaft, int journal, double theta, Point *target) {
+    const double angle = theta + crankshaft->getRodJournalAngle(journal);
+    const double r = crankshaft->getThrow();
+    const double c = std::cos(angle), s = std::sin(angle);
+
+    target->x = crankshaft->getPosX() + r * c;
+    target->y = crankshaft->getPosY() + r * s;
+    target->dx = -r * s;
+    target->dy = r * c;
+    target->ddx = -r * c;
+    target->ddy = -r * s;
+}
+
+void CrankSliderLinkage::slaveJournal(
+    ConnectingRod *master,
+    const Cylinder &masterCylinder,
+    int journal,
+    Point *target)
+{
+    double l_x, l_y;
+    master->getRodJournalPositionLocal(journal, &l_x, &l_y);
+
+    const double theta = masterCylinder.phi - constants::pi / 2;
+    const double c = std::cos(theta), s = std::sin(theta);
+    const double q_x = c * l_x - s * l_y;
+    const double q_y = s * l_x + c * l_y;
+
+    const Point &p = masterCylinder.rodCenter;
+    const double dphi = masterCylinder.dphi;
+    const double ddphi = masterCylinder.ddphi;
+
+    target->x = p.x + q_x;
+    target->y = p.y + q_y;
+    target->dx = p.dx - dphi * q_y;
+    target->dy = p.dy + dphi * q_x;
+    target->ddx = p.ddx - ddphi * q_y - dphi * dphi * q_x;
+    target->ddy = p.ddy + ddphi * q_x - dphi * dphi * q_y;
+}
+
+void CrankSliderLinkage::solveCylinder(
+    const CylinderBank *bank,
+    const ConnectingRod *rod,
+    const Point &b,
+    Cylinder *target)
+{
+    // Pin-to-pin distance as the link constraints define it
+    const double length = rod->getLittleEndLocal() - rod->getBigEndLocal();
+    const double d_x = bank->getDx(), d_y = bank->getDy();
+    const double r_x = b.x - bank->getX(), r_y = b.y - bank->getY();
+
+    // Big end along (u) and across (c) the bank axis
+    const double u = d_x * r_x + d_y * r_y;
+    const double du = d_x * b.dx + d_y * b.dy;
+    const double ddu = d_x * b.ddx + d_y * b.ddy;
+    const double c = d_x * r_y - d_y * r_x;
+    const double dc = d_x * b.dy - d_y * b.dx;
+    const double ddc = d_x * b.ddy - d_y * b.ddx;
+
+    const double k = std::sqrt(std::max(length * length - c * c, 1E-12 * length * length));
+    const double k3 = k * k * k;
+
+    target->s = u + k;
+    target->ds = du - c * dc / k;
+    target->dds = ddu - (dc * dc + c * ddc) / k - c * c * dc * dc / k3;
+
+    target->phi = std::atan2(d_y, d_x) + std::atan2(-c, k);
+    target->dphi = -dc / k;
+    target->ddphi = -ddc / k - c * dc * dc / k3;
+    target->sideRatio = std::abs(c) / k;
+
+    target->bigEnd = b;
+
+    const double e_x = std::cos(target->phi), e_y = std::sin(target->phi);
+    const double bigEnd = rod->getBigEndLocal();
+    const double dphi = target->dphi, ddphi = target->ddphi;
+
+    Point &center = target->rodCenter;
+    center.x = b.x - bigEnd * e_x;
+    center.y = b.y - bigEnd * e_y;
+    center.dx = b.dx + bigEnd * dphi * e_y;
+    center.dy = b.dy - bigEnd * dphi * e_x;
+    center.ddx = b.ddx + bigEnd * (ddphi * e_y + dphi * dphi * e_x);
+    center.ddy = b.ddy - bigEnd * (ddphi * e_x - dphi * dphi * e_y);
+}
+
+void CrankSliderLinkage::solve(const double *theta) {
+    for (int n = 0; n < m_cylinderCount; ++n) {
+        const int i = m_order[n];
+        ConnectingRod *rod = m_engine->getConnectingRod(i);
+
+        Point bigEnd;
+        if (m_masterCylinder[i] == -1) {
+            crankJournal(
+                m_engine->getCrankshaft(m_crankshaftIndex[i]),
+                rod->getJournal(),
+                theta[m_crankshaftIndex[i]],
+                &bigEnd);
+        }
+        else {
+            slaveJournal(
+                rod->getMasterRod(),
+                m_cylinders[m_masterCylinder[i]],
+                rod->getJournal(),
+                &bigEnd);
+        }
+
+        solveCylinder(m_engine->getPiston(i)->getCylinderBank(), rod, bigEnd, &m_cylinders[i]);
+    }
+}
+
+double CrankSliderLinkage::reciprocatingInertia(int i, double *inertiaDerivative) const {
+    const Cylinder &cylinder = m_cylinders[i];
+    const Piston *piston = m_engine->getPiston(i);
+    const ConnectingRod *rod = piston->getRod();
+    const Point &center = cylinder.rodCenter;
+
+    const double m_p = piston->getMass();
+    const double m_r = rod->getMass();
+    const double I_r = rod->getMomentOfInertia();
+
+    if (inertiaDerivative != nullptr) {
+        *inertiaDerivative = 2 * (
+            m_p * cylinder.ds * cylinder.dds
+            + m_r * (center.dx * center.ddx + center.dy * center.ddy)
+            + I_r * cylinder.dphi * cylinder.ddphi);
+    }
+
+    return
+        m_p * cylinder.ds * cylinder.ds
+        + m_r * (center.dx * center.dx + center.dy * center.dy)
+        + I_r * cylinder.dphi * cylinder.dphi;
+}
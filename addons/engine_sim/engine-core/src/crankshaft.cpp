@@ -1,5 +1,6 @@
 #include "../include/crankshaft.h"
 
+#include "../include/arena.h"
 #include "../include/constants.h"
 
 #include <cmath>
@@ -27,7 +28,7 @@ void Crankshaft::initialize(const Parameters &params) {
     m_I = params.momentOfInertia;
     m_throw = params.crankThrow;
     m_rodJournalCount = params.rodJournals;
-    m_rodJournalAngles = new double[m_rodJournalCount];
+    m_rodJournalAngles = Arena::allocate<double>(m_rodJournalCount);
     m_p_x = params.pos_x;
     m_p_y = params.pos_y;
     m_tdc = params.tdc;
@@ -35,7 +36,7 @@ void Crankshaft::initialize(const Parameters &params) {
 }
 
 void Crankshaft::destroy() {
-    if (m_rodJournalAngles != nullptr) delete[] m_rodJournalAngles;
+    Arena::free(m_rodJournalAngles);
 
     m_rodJournalAngles = nullptr;
 }
@@ -1,9 +1,14 @@
 #include "../include/cylinder_head.h"
 
+#include "../include/arena.h"
+#include "../include/constants.h"
+#include "../include/crankshaft.h"
 #include "../include/cylinder_bank.h"
 #include "../include/valvetrain.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <cmath>
 
 CylinderHead::CylinderHead() {
     m_cylinders = nullptr;
@@ -21,14 +26,20 @@ CylinderHead::CylinderHead() {
     m_exhaustRunnerVolume = 0.0;
     m_exhaustRunnerCrossSectionArea = 0.0;
     m_combustionChamberVolume = 0.0;
+
+    m_flowTables = nullptr;
+    m_camModeCount = 0;
+    m_intakeVersions = nullptr;
+    m_exhaustVersions = nullptr;
+    m_activeCamMode = 0;
 }
 
 CylinderHead::~CylinderHead() {
-    /* void */
+    assert(m_flowTables == nullptr);
 }
 
 void CylinderHead::initialize(const Parameters &params) {
-    m_cylinders = new Cylinder[params.Bank->getCylinderCount()];
+    m_cylinders = Arena::allocate<Cylinder>(params.Bank->getCylinderCount());
 
     m_bank = params.Bank;
     m_valvetrain = params.Valvetrain;
@@ -44,16 +55,26 @@ void CylinderHead::initialize(const Parameters &params) {
 }
 
 void CylinderHead::destroy() {
-    if (m_cylinders != nullptr) delete[] m_cylinders;
+    Arena::free(m_cylinders);
     m_cylinders = nullptr;
+
+    destroyFlowTables();
 }
 
 double CylinderHead::intakeFlowRate(int cylinder) const {
+    if (m_flowTables != nullptr) {
+        return sampleFlowTable(IntakeFlow, cylinder, m_intakePosition);
+    }
+
     return m_intakePortFlow->sampleTriangle(
             intakeValveLift(cylinder));
 }
 
 double CylinderHead::exhaustFlowRate(int cylinder) const {
+    if (m_flowTables != nullptr) {
+        return sampleFlowTable(ExhaustFlow, cylinder, m_exhaustPosition);
+    }
+
     return m_exhaustPortFlow->sampleTriangle(
             exhaustValveLift(cylinder));
 }
@@ -63,9 +84,124 @@ double CylinderHead::intakeValveLift(int cylinder) const {
 }
 
 double CylinderHead::exhaustValveLift(int cylinder) const {
+    if (m_flowTables != nullptr) {
+        return sampleFlowTable(ExhaustLift, cylinder, m_exhaustPosition);
+    }
+
     return m_valvetrain->exhaustValveLift(cylinder);
 }
 
+void CylinderHead::buildFlowTables() {
+    destroyFlowTables();
+
+    const int cylinderCount = m_bank->getCylinderCount();
+    m_camModeCount = m_valvetrain->getCamModeCount();
+    m_flowTables =
+        Arena::allocate<double>((size_t)m_camModeCount * cylinderCount * FlowTableCount * (FlowTableResolution + 1));
+    m_intakeVersions = Arena::allocate<int>(m_camModeCount);
+    m_exhaustVersions = Arena::allocate<int>(m_camModeCount);
+
+    for (int mode = 0; mode < m_camModeCount; ++mode) {
+        buildFlowTables(mode, true);
+        buildFlowTables(mode, false);
+    }
+
+    updateFlowTables();
+}
+
+void CylinderHead::updateFlowTables() {
+    if (m_flowTables == nullptr) return;
+
+    updateFlowTables(m_valvetrain->getActiveCamMode());
+}
+
+void CylinderHead::updateFlowTables(const EngineStepState &state) {
+    if (m_flowTables == nullptr) return;
+
+    updateFlowTables(m_valvetrain->getActiveCamMode(state));
+}
+
+void CylinderHead::updateFlowTables(int camMode) {
+    m_activeCamMode = camMode;
+
+    Camshaft *intakeCamshaft = m_valvetrain->getIntakeCamshaft(m_activeCamMode);
+    Camshaft *exhaustCamshaft = m_valvetrain->getExhaustCamshaft(m_activeCamMode);
+    if (intakeCamshaft->getVersion() != m_intakeVersions[m_activeCamMode]) {
+        buildFlowTables(m_activeCamMode, true);
+    }
+
+    if (exhaustCamshaft->getVersion() != m_exhaustVersions[m_activeCamMode]) {
+        buildFlowTables(m_activeCamMode, false);
+    }
+
+    m_intakePosition = findTablePosition(intakeCamshaft);
+    m_exhaustPosition = (exhaustCamshaft->getCrankshaft() == intakeCamshaft->getCrankshaft())
+        ? m_intakePosition
+        : findTablePosition(exhaustCamshaft);
+}
+
+void CylinderHead::destroyFlowTables() {
+    Arena::free(m_flowTables);
+    Arena::free(m_intakeVersions);
+    Arena::free(m_exhaustVersions);
+
+    m_flowTables = nullptr;
+    m_intakeVersions = nullptr;
+    m_exhaustVersions = nullptr;
+    m_camModeCount = 0;
+    m_activeCamMode = 0;
+}
+
+double *CylinderHead::getFlowTable(int mode, int cylinder, FlowTable table) const {
+    const int cylinderCount = m_bank->getCylinderCount();
+    const size_t index = ((size_t)mode * cylinderCount + cylinder) * FlowTableCount + table;
+    return m_flowTables + index * (FlowTableResolution + 1);
+}
+
+void CylinderHead::buildFlowTables(int mode, bool intake) {
+    Camshaft *camshaft = intake
+        ? m_valvetrain->getIntakeCamshaft(mode)
+        : m_valvetrain->getExhaustCamshaft(mode);
+    const double step = 4 * constants::pi / FlowTableResolution;
+
+    for (int i = 0; i < m_bank->getCylinderCount(); ++i) {
+        double *flow = getFlowTable(mode, i, intake ? IntakeFlow : ExhaustFlow);
+        double *lift = getFlowTable(mode, i, ExhaustLift);
+
+        for (int j = 0; j <= FlowTableResolution; ++j) {
+            const double valveLift = camshaft->valveLiftAt(i, j * step);
+            if (intake) {
+                flow[j] = m_intakePortFlow->sampleTriangle(valveLift);
+            }
+            else {
+                flow[j] = m_exhaustPortFlow->sampleTriangle(valveLift);
+                lift[j] = valveLift;
+            }
+        }
+    }
+
+    if (intake) m_intakeVersions[mode] = camshaft->getVersion();
+    else m_exhaustVersions[mode] = camshaft->getVersion();
+}
+
+CylinderHead::TablePosition CylinderHead::findTablePosition(const Camshaft *camshaft) {
+    constexpr double cycle = 4 * constants::pi;
+    double angle = std::fmod(camshaft->getCrankshaft()->getAngle(), cycle);
+    if (std::isnan(angle)) angle = 0;
+    else if (angle < 0) angle += cycle;
+
+    TablePosition p;
+    const double u = angle * (FlowTableResolution / cycle);
+    p.cell = std::min(static_cast<int>(u), FlowTableResolution - 1);
+    p.s = u - p.cell;
+    return p;
+}
+
+double CylinderHead::sampleFlowTable(FlowTable table, int cylinder, const TablePosition &p) const {
+    const double *values = getFlowTable(m_activeCamMode, cylinder, table);
+    return values[p.cell] + (values[p.cell + 1] - values[p.cell]) * p.s;
+}
+
 void CylinderHead::setAllExhaustSystems(ExhaustSystem *system) {
     for (int i = 0; i < m_bank->getCylinderCount(); ++i) {
         m_cylinders[i].exhaustSystem = system;
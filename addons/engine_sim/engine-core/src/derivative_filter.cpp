@@ -15,3 +15,11 @@ float DerivativeFilter::f(float sample) {
 
     return (sample - temp) / m_dt;
 }
+
+void DerivativeFilter::writeState(StateWriter *writer) const {
+    writer->write(m_previous);
+}
+
+void DerivativeFilter::readState(StateReader *reader) {
+    reader->read(&m_previous);
+}
@@ -22,7 +22,19 @@ void DirectThrottleLinkage::setSpeedControl(double s) {
     m_throttlePosition = 1 - std::pow(s, m_gamma);
 }
 
-void DirectThrottleLinkage::update(double dt, Engine *engine) {
-    Throttle::update(dt, engine);
+void DirectThrottleLinkage::update(double dt, const EngineStepState &state, Engine *engine) {
+    Throttle::update(dt, state, engine);
     engine->setThrottle(m_throttlePosition);
 }
+
+void DirectThrottleLinkage::writeState(StateWriter *writer) const {
+    Throttle::writeState(writer);
+
+    writer->write(m_throttlePosition);
+}
+
+void DirectThrottleLinkage::readState(StateReader *reader) {
+    Throttle::readState(reader);
+
+    reader->read(&m_throttlePosition);
+}
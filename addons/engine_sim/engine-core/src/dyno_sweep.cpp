@@ -0,0 +1,136 @@
+#include "../include/dyno_sweep.h"
+
+#include "../include/piston_engine_simulator.h"
+#include "../include/state_snapshot.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+DynoSweep::DynoSweep() {
+    m_points = nullptr;
+    m_pointCount = 0;
+}
+
+DynoSweep::~DynoSweep() {
+    assert(m_points == nullptr);
+}
+
+bool DynoSweep::run(const Instance *instances, int instanceCount, const Parameters &params) {
+    destroy();
+
+    if (instances == nullptr || instanceCount <= 0) return false;
+    for (int i = 0; i < instanceCount; ++i) {
+        if (instances[i].engine == nullptr
+            || instances[i].vehicle == nullptr
+            || instances[i].transmission == nullptr) return false;
+        if (instances[i].engine->getCrankshaftCount() <= 0) return false;
+    }
+
+    const Engine *engine = instances[0].engine;
+    const double minSpeed = (params.minSpeed >= 0)
+        ? params.minSpeed
+        : engine->getDynoMinSpeed();
+    const double maxSpeed = (params.maxSpeed >= 0)
+        ? params.maxSpeed
+        : engine->getDynoMaxSpeed();
+    const double speedStep = (params.speedStep > 0)
+        ? params.speedStep
+        : engine->getDynoHoldStep();
+    if (speedStep <= 0 || maxSpeed < minSpeed) return false;
+
+    m_pointCount = static_cast<int>(std::floor((maxSpeed - minSpeed) / speedStep + 1E-6)) + 1;
+    m_points = new Point[m_pointCount];
+    for (int i = 0; i < m_pointCount; ++i) {
+        m_points[i].speed = std::min(minSpeed + i * speedStep, maxSpeed);
+    }
+
+    const int threadCount = std::min(instanceCount, m_pointCount);
+    const int chunkSize = (m_pointCount + threadCount - 1) / threadCount;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i) {
+        const int start = i * chunkSize;
+        const int count = std::min(chunkSize, m_pointCount - start);
+        if (count <= 0) break;
+
+        threads.emplace_back(
+            &DynoSweep::sweep,
+            std::cref(instances[i]),
+            std::cref(params),
+            m_points + start,
+            count);
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    return true;
+}
+
+void DynoSweep::destroy() {
+    delete[] m_points;
+    m_points = nullptr;
+    m_pointCount = 0;
+}
+
+void DynoSweep::sweep(const Instance &instance, const Parameters &params, Point *points, int pointCount) {
+    Engine *engine = instance.engine;
+
+    PistonEngineSimulator simulator;
+    simulator.initialize(Simulator::Parameters());
+    simulator.setSimulationFrequency(static_cast<int>(engine->getSimulationFrequency()));
+    simulator.setSynthesizerEnabled(false);
+    simulator.loadSimulation(engine, instance.vehicle, instance.transmission);
+    simulator.setFluidSimulationSteps(params.fluidSimulationSteps);
+
+    instance.transmission->changeGear(-1);
+    engine->getIgnitionModule()->m_enabled = true;
+    engine->setSpeedControl(params.speedControl);
+    simulator.m_starterMotor.m_enabled = false;
+    simulator.m_dyno.m_enabled = true;
+    simulator.m_dyno.m_hold = true;
+
+    StateWriter initialState;
+    simulator.writeState(&initialState);
+
+    const int windowFrames = std::max(1, static_cast<int>(std::round(params.settleWindow / params.frameTime)));
+    for (int i = 0; i < pointCount; ++i) {
+        Point &point = points[i];
+
+        StateReader reader(initialState.getData(), initialState.getSize());
+        simulator.readState(&reader);
+        simulator.m_dyno.m_rotationSpeed = point.speed;
+
+        // The filtered torque is already averaged over a full cycle, so it
+        // is considered settled once it stops drifting between windows
+        double t = 0;
+        double lastTorque = 0;
+        bool settled = false;
+        while (t < params.maxSettleTime) {
+            for (int j = 0; j < windowFrames; ++j, t += params.frameTime) {
+                simulator.startFrame(params.frameTime);
+                while (simulator.simulateStep()) {}
+                simulator.endFrame();
+            }
+
+            const double torque = simulator.getFilteredDynoTorque();
+            const double tolerance = std::max(
+                std::abs(torque) * params.settleTolerance,
+                params.settleTorqueTolerance);
+            settled = t >= params.minSettleTime && std::abs(torque - lastTorque) <= tolerance;
+            lastTorque = torque;
+
+            if (settled) break;
+        }
+
+        point.torque = lastTorque;
+        point.power = lastTorque * point.speed;
+        point.settled = settled;
+    }
+
+    simulator.destroy();
+}
@@ -1,5 +1,6 @@
 #include "../include/engine.h"
 
+#include "../include/arena.h"
 #include "../include/constants.h"
 #include "../include/units.h"
 #include "../include/fuel.h"
@@ -19,6 +20,7 @@ Engine::Engine() {
     m_exhaustSystems = nullptr;
     m_intakes = nullptr;
     m_combustionChambers = nullptr;
+    m_chamberGeometry = nullptr;
 
     m_crankshaftCount = 0;
     m_cylinderBankCount = 0;
@@ -50,6 +52,7 @@ Engine::~Engine() {
     assert(m_exhaustSystems == nullptr);
     assert(m_intakes == nullptr);
     assert(m_combustionChambers == nullptr);
+    assert(m_chamberGeometry == nullptr);
 }
 
 void Engine::initialize(const Parameters &params) {
@@ -79,6 +82,7 @@ void Engine::initialize(const Parameters &params) {
     m_exhaustSystems = new ExhaustSystem[m_exhaustSystemCount];
     m_intakes = new Intake[m_intakeCount];
     m_combustionChambers = new CombustionChamber[m_cylinderCount];
+    m_chamberGeometry = Arena::allocate<CombustionChamber::Geometry>(m_cylinderCount);
 
     for (int i = 0; i < m_exhaustSystemCount; ++i) {
         m_exhaustSystems[i].m_index = i;
@@ -86,6 +90,7 @@ void Engine::initialize(const Parameters &params) {
 
     for (int i = 0; i < m_cylinderCount; ++i) {
         m_combustionChambers[i].setEngine(this);
+        m_combustionChambers[i].setGeometry(&m_chamberGeometry[i]);
     }
 }
 
@@ -100,6 +105,10 @@ void Engine::destroy() {
         m_combustionChambers[i].destroy();
     }
 
+    for (int i = 0; i < m_cylinderBankCount; ++i) {
+        m_heads[i].destroy();
+    }
+
     for (int i = 0; i < m_exhaustSystemCount; ++i) {
         m_exhaustSystems[i].destroy();
     }
@@ -119,6 +128,7 @@ void Engine::destroy() {
     if (m_exhaustSystems != nullptr) delete[] m_exhaustSystems;
     if (m_intakes != nullptr) delete[] m_intakes;
     if (m_combustionChambers != nullptr) delete[] m_combustionChambers;
+    Arena::free(m_chamberGeometry);
 
     m_crankshafts = nullptr;
     m_cylinderBanks = nullptr;
@@ -128,6 +138,7 @@ void Engine::destroy() {
     m_exhaustSystems = nullptr;
     m_intakes = nullptr;
     m_combustionChambers = nullptr;
+    m_chamberGeometry = nullptr;
     m_throttle = nullptr;
 }
 
@@ -297,8 +308,8 @@ double Engine::getIntakeFlowRate() const {
     return airIntake;
 }
 
-void Engine::update(double dt) {
-    m_throttle->update(dt, this);
+void Engine::update(double dt, const EngineStepState &state) {
+    m_throttle->update(dt, state, this);
 }
 
 double Engine::getManifoldPressure() const {
@@ -409,3 +420,41 @@ double Engine::getSpeed() const {
 bool Engine::isSpinningCw() const {
     return getOutputCrankshaft()->m_body.v_theta <= 0;
 }
+
+void Engine::writeState(StateWriter *writer) const {
+    writer->write(m_throttleValue);
+    if (m_throttle != nullptr) m_throttle->writeState(writer);
+
+    m_ignitionModule.writeState(writer);
+
+    for (int i = 0; i < m_intakeCount; ++i) {
+        m_intakes[i].writeState(writer);
+    }
+
+    for (int i = 0; i < m_exhaustSystemCount; ++i) {
+        m_exhaustSystems[i].writeState(writer);
+    }
+
+    for (int i = 0; i < m_cylinderCount; ++i) {
+        m_combustionChambers[i].writeState(writer);
+    }
+}
+
+void Engine::readState(StateReader *reader) {
+    reader->read(&m_throttleValue);
+    if (m_throttle != nullptr) m_throttle->readState(reader);
+
+    m_ignitionModule.readState(reader);
+
+    for (int i = 0; i < m_intakeCount; ++i) {
+        m_intakes[i].readState(reader);
+    }
+
+    for (int i = 0; i < m_exhaustSystemCount; ++i) {
+        m_exhaustSystems[i].readState(reader);
+    }
+
+    for (int i = 0; i < m_cylinderCount; ++i) {
+        m_combustionChambers[i].readState(reader);
+    }
+}
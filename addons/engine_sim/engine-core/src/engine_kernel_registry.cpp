@@ -0,0 +1,43 @@
+#include "../include/engine_kernel_registry.h"
+
+#include "../include/engine.h"
+#include "../include/piston_engine_simulator.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+std::vector<EngineKernelRegistry::Kernel> &kernels() {
+    static std::vector<EngineKernelRegistry::Kernel> registered;
+    return registered;
+}
+
+} // namespace
+
+void EngineKernelRegistry::add(const Kernel &kernel) {
+    if (find(kernel.engineName) != nullptr) return;
+    kernels().push_back(kernel);
+}
+
+const EngineKernelRegistry::Kernel *EngineKernelRegistry::find(const std::string &engineName) {
+    for (const Kernel &kernel : kernels()) {
+        if (engineName == kernel.engineName) return &kernel;
+    }
+
+    return nullptr;
+}
+
+PistonEngineSimulator *EngineKernelRegistry::createSimulator(Engine *engine) {
+    const Kernel *kernel = find(engine->getName());
+    if (kernel == nullptr) return nullptr;
+
+    if (!kernel->matches(engine)) {
+        std::fprintf(stderr,
+            "engine-sim: kernel for '%s' is out of date with the script, using the generic simulator\n",
+            kernel->engineName);
+        return nullptr;
+    }
+
+    return kernel->create();
+}
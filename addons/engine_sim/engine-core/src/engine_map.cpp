@@ -0,0 +1,192 @@
+#include "../include/engine_map.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    constexpr char FileMagic[4] = { 'E', 'S', 'M', 'V' };
+}
+
+EngineMap::EngineMap() {
+    m_samples = nullptr;
+    m_motoringTorque = nullptr;
+
+    m_speedSamples = 0;
+    m_speedControlSamples = 0;
+    m_minSpeed = 0.0;
+    m_maxSpeed = 0.0;
+}
+
+EngineMap::~EngineMap() {
+    assert(m_samples == nullptr);
+    assert(m_motoringTorque == nullptr);
+}
+
+void EngineMap::initialize(const Parameters &params) {
+    destroy();
+
+    m_speedSamples = std::max(2, params.speedSamples);
+    m_speedControlSamples = std::max(2, params.speedControlSamples);
+    m_minSpeed = params.minSpeed;
+    m_maxSpeed = std::max(params.maxSpeed, params.minSpeed + 1E-6);
+
+    m_samples = new Sample[m_speedSamples * m_speedControlSamples];
+    m_motoringTorque = new double[m_speedSamples];
+    for (int i = 0; i < m_speedSamples; ++i) {
+        m_motoringTorque[i] = 0.0;
+    }
+}
+
+void EngineMap::destroy() {
+    if (m_samples != nullptr) delete[] m_samples;
+    if (m_motoringTorque != nullptr) delete[] m_motoringTorque;
+
+    m_samples = nullptr;
+    m_motoringTorque = nullptr;
+
+    m_speedSamples = 0;
+    m_speedControlSamples = 0;
+}
+
+bool EngineMap::write(const std::string &path) const {
+    if (isEmpty()) return false;
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    const uint32_t version = FileVersion;
+    const int32_t speedSamples = m_speedSamples;
+    const int32_t speedControlSamples = m_speedControlSamples;
+
+    file.write(FileMagic, sizeof(FileMagic));
+    file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char *>(&speedSamples), sizeof(speedSamples));
+    file.write(reinterpret_cast<const char *>(&speedControlSamples), sizeof(speedControlSamples));
+    file.write(reinterpret_cast<const char *>(&m_minSpeed), sizeof(m_minSpeed));
+    file.write(reinterpret_cast<const char *>(&m_maxSpeed), sizeof(m_maxSpeed));
+    file.write(
+        reinterpret_cast<const char *>(m_samples),
+        sizeof(Sample) * m_speedSamples * m_speedControlSamples);
+    file.write(
+        reinterpret_cast<const char *>(m_motoringTorque),
+        sizeof(double) * m_speedSamples);
+
+    return file.good();
+}
+
+bool EngineMap::read(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    char magic[4];
+    uint32_t version = 0;
+    int32_t speedSamples = 0, speedControlSamples = 0;
+    Parameters params;
+
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char *>(&version), sizeof(version));
+    file.read(reinterpret_cast<char *>(&speedSamples), sizeof(speedSamples));
+    file.read(reinterpret_cast<char *>(&speedControlSamples), sizeof(speedControlSamples));
+    file.read(reinterpret_cast<char *>(&params.minSpeed), sizeof(params.minSpeed));
+    file.read(reinterpret_cast<char *>(&params.maxSpeed), sizeof(params.maxSpeed));
+
+    if (!file
+        || std::memcmp(magic, FileMagic, sizeof(FileMagic)) != 0
+        || version != FileVersion
+        || speedSamples < 2 || speedControlSamples < 2)
+    {
+        return false;
+    }
+
+    params.speedSamples = speedSamples;
+    params.speedControlSamples = speedControlSamples;
+    initialize(params);
+
+    file.read(
+        reinterpret_cast<char *>(m_samples),
+        sizeof(Sample) * m_speedSamples * m_speedControlSamples);
+    file.read(
+        reinterpret_cast<char *>(m_motoringTorque),
+        sizeof(double) * m_speedSamples);
+
+    if (!file) {
+        destroy();
+        return false;
+    }
+
+    return true;
+}
+
+void EngineMap::setSample(int speedIndex, int speedControlIndex, const Sample &sample) {
+    m_samples[speedIndex * m_speedControlSamples + speedControlIndex] = sample;
+}
+
+const EngineMap::Sample &EngineMap::getSample(int speedIndex, int speedControlIndex) const {
+    return m_samples[speedIndex * m_speedControlSamples + speedControlIndex];
+}
+
+void EngineMap::setMotoringTorque(int speedIndex, double torque) {
+    m_motoringTorque[speedIndex] = torque;
+}
+
+EngineMap::Sample EngineMap::sample(double speed, double speedControl) const {
+    int i0;
+    double s;
+    locate(speed, &i0, &s);
+
+    const double c = std::min(std::max(speedControl, 0.0), 1.0) * (m_speedControlSamples - 1);
+    const int j0 = std::min(static_cast<int>(c), m_speedControlSamples - 2);
+    const double t = c - j0;
+
+    const Sample &s00 = getSample(i0, j0);
+    const Sample &s01 = getSample(i0, j0 + 1);
+    const Sample &s10 = getSample(i0 + 1, j0);
+    const Sample &s11 = getSample(i0 + 1, j0 + 1);
+
+    const double w00 = (1 - s) * (1 - t);
+    const double w01 = (1 - s) * t;
+    const double w10 = s * (1 - t);
+    const double w11 = s * t;
+
+    Sample result;
+    result.torque =
+        w00 * s00.torque + w01 * s01.torque + w10 * s10.torque + w11 * s11.torque;
+    result.airflow =
+        w00 * s00.airflow + w01 * s01.airflow + w10 * s10.airflow + w11 * s11.airflow;
+    result.manifoldPressure =
+        w00 * s00.manifoldPressure + w01 * s01.manifoldPressure
+        + w10 * s10.manifoldPressure + w11 * s11.manifoldPressure;
+    result.fuelFlow =
+        w00 * s00.fuelFlow + w01 * s01.fuelFlow + w10 * s10.fuelFlow + w11 * s11.fuelFlow;
+
+    return result;
+}
+
+double EngineMap::sampleMotoringTorque(double speed) const {
+    int i0;
+    double s;
+    locate(speed, &i0, &s);
+
+    return (1 - s) * m_motoringTorque[i0] + s * m_motoringTorque[i0 + 1];
+}
+
+double EngineMap::getSpeed(int speedIndex) const {
+    return m_minSpeed
+        + (m_maxSpeed - m_minSpeed) * speedIndex / (m_speedSamples - 1);
+}
+
+double EngineMap::getSpeedControl(int speedControlIndex) const {
+    return static_cast<double>(speedControlIndex) / (m_speedControlSamples - 1);
+}
+
+void EngineMap::locate(double speed, int *i0, double *s) const {
+    const double x = (speed - m_minSpeed) / (m_maxSpeed - m_minSpeed);
+    const double c = std::min(std::max(x, 0.0), 1.0) * (m_speedSamples - 1);
+
+    *i0 = std::min(static_cast<int>(c), m_speedSamples - 2);
+    *s = c - *i0;
+}
@@ -0,0 +1,117 @@
+#include "../include/engine_map_builder.h"
+
+#include "../include/piston_engine_simulator.h"
+
+#include <algorithm>
+
+EngineMapBuilder::EngineMapBuilder() {
+    /* void */
+}
+
+EngineMapBuilder::~EngineMapBuilder() {
+    /* void */
+}
+
+bool EngineMapBuilder::build(
+    Engine *engine,
+    Vehicle *vehicle,
+    Transmission *transmission,
+    const Parameters &params,
+    EngineMap *map)
+{
+    if (engine == nullptr || vehicle == nullptr || transmission == nullptr) return false;
+    if (engine->getCrankshaftCount() <= 0) return false;
+
+    EngineMap::Parameters mapParams;
+    mapParams.speedSamples = params.speedSamples;
+    mapParams.speedControlSamples = params.speedControlSamples;
+    mapParams.minSpeed = (params.minSpeed >= 0)
+        ? params.minSpeed
+        : engine->getStarterSpeed();
+    mapParams.maxSpeed = (params.maxSpeed >= 0)
+        ? params.maxSpeed
+        : engine->getRedline();
+    map->initialize(mapParams);
+
+    PistonEngineSimulator simulator;
+    simulator.initialize(Simulator::Parameters());
+    simulator.setSimulationFrequency(static_cast<int>(engine->getSimulationFrequency()));
+    simulator.setSynthesizerEnabled(false);
+    simulator.loadSimulation(engine, vehicle, transmission);
+    simulator.setFluidSimulationSteps(params.fluidSimulationSteps);
+
+    IgnitionModule *ignition = engine->getIgnitionModule();
+    const bool ignitionEnabled = ignition->m_enabled;
+    const double speedControl = engine->getSpeedControl();
+    const int gear = transmission->getGear();
+
+    transmission->changeGear(-1);
+    simulator.m_starterMotor.m_enabled = false;
+    simulator.m_dyno.m_enabled = true;
+    simulator.m_dyno.m_hold = true;
+
+    for (int i = 0; i < map->getSpeedSampleCount(); ++i) {
+        simulator.m_dyno.m_rotationSpeed = map->getSpeed(i);
+
+        ignition->m_enabled = true;
+        for (int j = 0; j < map->getSpeedControlSampleCount(); ++j) {
+            engine->setSpeedControl(map->getSpeedControl(j));
+            run(&simulator, params.settleTime, params.frameTime);
+            map->setSample(i, j, measure(&simulator, params.measureTime, params.frameTime));
+        }
+
+        ignition->m_enabled = false;
+        engine->setSpeedControl(0.0);
+        run(&simulator, params.settleTime, params.frameTime);
+        map->setMotoringTorque(
+            i,
+            measure(&simulator, params.measureTime, params.frameTime).torque);
+    }
+
+    ignition->m_enabled = ignitionEnabled;
+    engine->setSpeedControl(speedControl);
+    transmission->changeGear(gear);
+
+    simulator.destroy();
+
+    return true;
+}
+
+void EngineMapBuilder::run(PistonEngineSimulator *simulator, double t, double frameTime) {
+    for (double t_s = 0; t_s < t; t_s += frameTime) {
+        simulator->startFrame(frameTime);
+        while (simulator->simulateStep()) {}
+        simulator->endFrame();
+    }
+}
+
+EngineMap::Sample EngineMapBuilder::measure(
+    PistonEngineSimulator *simulator,
+    double t,
+    double frameTime)
+{
+    Engine *engine = simulator->getEngine();
+    engine->resetFuelConsumption();
+
+    EngineMap::Sample sample;
+    double totalTime = 0;
+    int frames = 0;
+    for (; totalTime < t; totalTime += frameTime, ++frames) {
+        simulator->startFrame(frameTime);
+        while (simulator->simulateStep()) {}
+        simulator->endFrame();
+
+        sample.torque += simulator->getFilteredDynoTorque();
+        sample.airflow += engine->getIntakeFlowRate();
+        sample.manifoldPressure += engine->getManifoldPressure();
+    }
+
+    if (frames > 0) {
+        sample.torque /= frames;
+        sample.airflow /= frames;
+        sample.manifoldPressure /= frames;
+        sample.fuelFlow = engine->getTotalFuelMassConsumed() / totalTime;
+    }
+
+    return sample;
+}
@@ -0,0 +1,1068 @@
+#include "../include/engine_pack.h"
+
+#include "../include/direct_throttle_linkage.h"
+#include "../include/governor.h"
+#include "../include/impulse_response.h"
+#include "../include/standard_valvetrain.h"
+#include "../include/units.h"
+#include "../include/vtec_valvetrain.h"
+
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <vector>
+
+namespace {
+    constexpr char FileMagic[4] = { 'E', 'S', 'E', 'P' };
+
+    // Sanity limit on any count in a pack, so a corrupt file fails instead
+    // of allocating
+    constexpr int MaxCount = 1 << 20;
+
+    enum class ThrottleType : int32_t {
+        DirectLinkage,
+        Governor
+    };
+
+    enum class ValvetrainType : int32_t {
+        Standard,
+        Vtec
+    };
+
+    struct FunctionRecord {
+        double filterRadius = 0;
+        double inputScale = 1;
+        double outputScale = 1;
+        std::vector<double> x, y;
+    };
+
+    struct CamshaftRecord {
+        double advance = 0;
+        double baseRadius = 0;
+        int32_t lobeProfile = -1;
+        std::vector<double> lobeCenterlines;
+    };
+
+    struct CrankshaftRecord {
+        Crankshaft::Parameters params;
+        std::vector<double> journalAngles;
+    };
+
+    struct CylinderRecord {
+        Piston::Parameters piston;
+        ConnectingRod::Parameters rod;
+        int32_t crankshaft = 0;
+        int32_t master = -1;
+        std::vector<double> rodJournalAngles;
+
+        int32_t intake = 0;
+        int32_t exhaust = 0;
+        double soundAttenuation = 0;
+        double primaryLength = 0;
+
+        bool plugEnabled = false;
+        double firingAngle = 0;
+    };
+
+    struct ExhaustRecord {
+        ExhaustSystem::Parameters params;
+        bool hasImpulseResponse = false;
+        std::string impulseFilename;
+        double impulseVolume = 0;
+    };
+
+    struct HeadRecord {
+        CylinderBank::Parameters bank;
+        CylinderHead::Parameters head;
+        int32_t intakePortFlow = -1;
+        int32_t exhaustPortFlow = -1;
+
+        ValvetrainType valvetrain = ValvetrainType::Standard;
+        VtecValvetrain::Parameters vtec;
+        std::vector<CamshaftRecord> intakeCams, exhaustCams;    // Per cam mode
+    };
+
+    struct PackRecord {
+        Simulator::Parameters simulatorParameters;
+        std::vector<FunctionRecord> functions;
+
+        Engine::Parameters engine;
+        ThrottleType throttle = ThrottleType::DirectLinkage;
+        Governor::Parameters governor;
+        DirectThrottleLinkage::Parameters directLinkage;
+
+        std::vector<CrankshaftRecord> crankshafts;
+        std::vector<HeadRecord> heads;
+        std::vector<CylinderRecord> cylinders;
+        std::vector<ExhaustRecord> exhaustSystems;
+        std::vector<Intake::Parameters> intakes;
+
+        int32_t timingCurve = -1;
+        double revLimit = 0;
+        double limiterDuration = 0;
+
+        Fuel::Parameters fuel;
+        int32_t turbulenceToFlameSpeedRatio = -1;
+        int32_t meanPistonSpeedToTurbulence = -1;
+
+        bool hasVehicle = false;
+        Vehicle::Parameters vehicle;
+
+        bool hasTransmission = false;
+        std::vector<double> gearRatios;
+        double maxClutchTorque = 0;
+    };
+
+    void writeString(StateWriter *writer, const std::string &s) {
+        writer->write(static_cast<uint32_t>(s.size()));
+        writer->writeBytes(s.data(), s.size());
+    }
+
+    bool readString(StateReader *reader, std::string *s) {
+        uint32_t size = 0;
+        if (!reader->read(&size) || size > reader->getRemaining()) {
+            reader->invalidate();
+            return false;
+        }
+
+        s->assign(reinterpret_cast<const char *>(reader->getCurrent()), size);
+        return reader->skip(size);
+    }
+
+    bool readCount(StateReader *reader, int32_t *count) {
+        if (!reader->read(count) || *count < 0 || *count > MaxCount) {
+            reader->invalidate();
+            return false;
+        }
+
+        return true;
+    }
+
+    bool readDoubles(StateReader *reader, std::vector<double> *v) {
+        int32_t count = 0;
+        if (!readCount(reader, &count)) return false;
+
+        v->resize(count);
+        return reader->read(v->data(), count);
+    }
+
+    // Functions are shared between parts, so they're stored once and
+    // referenced by index
+    class FunctionTable {
+        public:
+            int32_t index(const Function *f) {
+                if (f == nullptr) return -1;
+
+                auto it = m_indices.find(f);
+                if (it != m_indices.end()) return it->second;
+
+                const int32_t i = static_cast<int32_t>(m_functions.size());
+                m_indices[f] = i;
+                m_functions.push_back(f);
+                return i;
+            }
+
+            void write(StateWriter *writer) const {
+                writer->write(static_cast<int32_t>(m_functions.size()));
+                for (const Function *f : m_functions) {
+                    const int n = f->getSampleCount();
+                    writer->write(f->getFilterRadius());
+                    writer->write(f->getInputScale());
+                    writer->write(f->getOutputScale());
+                    writer->write(static_cast<int32_t>(n));
+                    for (int i = 0; i < n; ++i) writer->write(f->getSampleX(i));
+                    for (int i = 0; i < n; ++i) writer->write(f->getSampleY(i));
+                }
+            }
+
+            const std::vector<const Function *> &getFunctions() const {
+                return m_functions;
+            }
+
+        protected:
+            std::map<const Function *, int32_t> m_indices;
+            std::vector<const Function *> m_functions;
+    };
+
+    void writeCamshaft(StateWriter *writer, FunctionTable *functions, Camshaft *cam) {
+        writer->write(cam->getAdvance());
+        writer->write(cam->getBaseRadius());
+        writer->write(functions->index(cam->getLobeProfile()));
+        writer->write(static_cast<int32_t>(cam->getLobeCount()));
+        for (int i = 0; i < cam->getLobeCount(); ++i) {
+            // Stored as the crank angle setLobeCenterline() takes
+            writer->write(cam->getLobeCenterline(i) * 2);
+        }
+    }
+
+    bool readCamshaft(StateReader *reader, CamshaftRecord *cam) {
+        reader->read(&cam->advance);
+        reader->read(&cam->baseRadius);
+        reader->read(&cam->lobeProfile);
+        return readDoubles(reader, &cam->lobeCenterlines);
+    }
+
+    // Index of a part within the engine's array of them, or -1
+    template <typename T_Part>
+    int32_t indexOf(const T_Part *part, const T_Part *first, int count) {
+        if (part == nullptr || count == 0) return -1;
+
+        const std::ptrdiff_t i = part - first;
+        return (i >= 0 && i < count) ? static_cast<int32_t>(i) : -1;
+    }
+
+    bool readPack(StateReader *reader, PackRecord *pack) {
+        char magic[4];
+        uint32_t version = 0;
+        reader->read(magic, 4);
+        reader->read(&version);
+        if (!reader->isValid()
+            || std::memcmp(magic, FileMagic, sizeof(FileMagic)) != 0
+            || version != EnginePack::FileVersion)
+        {
+            reader->invalidate();
+            return false;
+        }
+
+        int32_t systemType = 0;
+        reader->read(&systemType);
+        pack->simulatorParameters.systemType = static_cast<Simulator::SystemType>(systemType);
+
+        int32_t functionCount = 0;
+        if (!readCount(reader, &functionCount)) return false;
+        pack->functions.resize(functionCount);
+        for (FunctionRecord &f : pack->functions) {
+            int32_t n = 0;
+            reader->read(&f.filterRadius);
+            reader->read(&f.inputScale);
+            reader->read(&f.outputScale);
+            if (!readCount(reader, &n)) return false;
+
+            f.x.resize(n);
+            f.y.resize(n);
+            reader->read(f.x.data(), n);
+            reader->read(f.y.data(), n);
+        }
+
+        Engine::Parameters &engine = pack->engine;
+        readString(reader, &engine.name);
+        reader->read(&engine.starterTorque);
+        reader->read(&engine.starterSpeed);
+        reader->read(&engine.redline);
+        reader->read(&engine.dynoMinSpeed);
+        reader->read(&engine.dynoMaxSpeed);
+        reader->read(&engine.dynoHoldStep);
+        reader->read(&engine.initialSimulationFrequency);
+        reader->read(&engine.initialHighFrequencyGain);
+        reader->read(&engine.initialNoise);
+        reader->read(&engine.initialJitter);
+        engine.throttle = nullptr;
+
+        int32_t crankshaftCount = 0, bankCount = 0, cylinderCount = 0;
+        int32_t exhaustCount = 0, intakeCount = 0;
+        readCount(reader, &crankshaftCount);
+        readCount(reader, &bankCount);
+        readCount(reader, &cylinderCount);
+        readCount(reader, &exhaustCount);
+        if (!readCount(reader, &intakeCount)) return false;
+
+        engine.crankshaftCount = crankshaftCount;
+        engine.cylinderBanks = bankCount;
+        engine.cylinderCount = cylinderCount;
+        engine.exhaustSystemCount = exhaustCount;
+        engine.intakeCount = intakeCount;
+
+        reader->read(&pack->throttle);
+        if (pack->throttle == ThrottleType::Governor) {
+            Governor::Parameters &g = pack->governor;
+            reader->read(&g.minSpeed);
+            reader->read(&g.maxSpeed);
+            reader->read(&g.minVelocity);
+            reader->read(&g.maxVelocity);
+            reader->read(&g.k_s);
+            reader->read(&g.k_d);
+            reader->read(&g.gamma);
+        }
+        else if (pack->throttle == ThrottleType::DirectLinkage) {
+            reader->read(&pack->directLinkage.gamma);
+        }
+        else {
+            reader->invalidate();
+            return false;
+        }
+
+        pack->crankshafts.resize(crankshaftCount);
+        for (CrankshaftRecord &crank : pack->crankshafts) {
+            Crankshaft::Parameters &p = crank.params;
+            reader->read(&p.mass);
+            reader->read(&p.flywheelMass);
+            reader->read(&p.momentOfInertia);
+            reader->read(&p.crankThrow);
+            reader->read(&p.pos_x);
+            reader->read(&p.pos_y);
+            reader->read(&p.tdc);
+            reader->read(&p.frictionTorque);
+            if (!readDoubles(reader, &crank.journalAngles)) return false;
+            p.rodJournals = static_cast<int>(crank.journalAngles.size());
+        }
+
+        pack->cylinders.resize(cylinderCount);
+        for (CylinderRecord &cylinder : pack->cylinders) {
+            Piston::Parameters &piston = cylinder.piston;
+            reader->read(&piston.BlowbyFlowCoefficient);
+            reader->read(&piston.CompressionHeight);
+            reader->read(&piston.WristPinPosition);
+            reader->read(&piston.Displacement);
+            reader->read(&piston.mass);
+
+            ConnectingRod::Parameters &rod = cylinder.rod;
+            reader->read(&rod.mass);
+            reader->read(&rod.momentOfInertia);
+            reader->read(&rod.centerOfMass);
+            reader->read(&rod.length);
+            reader->read(&rod.slaveThrow);
+            reader->read(&cylinder.crankshaft);
+            reader->read(&rod.journal);
+            reader->read(&cylinder.master);
+            if (!readDoubles(reader, &cylinder.rodJournalAngles)) return false;
+            rod.rodJournals = static_cast<int>(cylinder.rodJournalAngles.size());
+
+            if (cylinder.crankshaft < 0 || cylinder.crankshaft >= crankshaftCount
+                || cylinder.master < -1 || cylinder.master >= cylinderCount
+                || rod.journal < 0
+                || rod.journal >= pack->crankshafts[cylinder.crankshaft].params.rodJournals)
+            {
+                reader->invalidate();
+                return false;
+            }
+        }
+
+        pack->exhaustSystems.resize(exhaustCount);
+        for (ExhaustRecord &exhaust : pack->exhaustSystems) {
+            ExhaustSystem::Parameters &p = exhaust.params;
+            reader->read(&p.length);
+            reader->read(&p.collectorCrossSectionArea);
+            reader->read(&p.outletFlowRate);
+            reader->read(&p.primaryTubeLength);
+            reader->read(&p.primaryFlowRate);
+            reader->read(&p.velocityDecay);
+            reader->read(&p.audioVolume);
+            p.impulseResponse = nullptr;
+
+            reader->read(&exhaust.hasImpulseResponse);
+            readString(reader, &exhaust.impulseFilename);
+            reader->read(&exhaust.impulseVolume);
+        }
+
+        pack->intakes.resize(intakeCount);
+        for (Intake::Parameters &p : pack->intakes) {
+            reader->read(&p.volume);
+            reader->read(&p.CrossSectionArea);
+            reader->read(&p.InputFlowK);
+            reader->read(&p.IdleFlowK);
+            reader->read(&p.RunnerFlowRate);
+            reader->read(&p.MolecularAfr);
+            reader->read(&p.IdleThrottlePlatePosition);
+            reader->read(&p.RunnerLength);
+            reader->read(&p.VelocityDecay);
+        }
+
+        int cylinderBase = 0;
+        pack->heads.resize(bankCount);
+        for (int i = 0; i < bankCount; ++i) {
+            HeadRecord &head = pack->heads[i];
+
+            CylinderBank::Parameters &bank = head.bank;
+            reader->read(&bank.angle);
+            reader->read(&bank.bore);
+            reader->read(&bank.deckHeight);
+            reader->read(&bank.positionX);
+            reader->read(&bank.positionY);
+            reader->read(&bank.displayDepth);
+            readCount(reader, &bank.cylinderCount);
+            bank.index = i;
+
+            CylinderHead::Parameters &p = head.head;
+            reader->read(&p.CombustionChamberVolume);
+            reader->read(&p.IntakeRunnerVolume);
+            reader->read(&p.IntakeRunnerCrossSectionArea);
+            reader->read(&p.ExhaustRunnerVolume);
+            reader->read(&p.ExhaustRunnerCrossSectionArea);
+            reader->read(&p.FlipDisplay);
+            reader->read(&head.intakePortFlow);
+            reader->read(&head.exhaustPortFlow);
+
+            reader->read(&head.valvetrain);
+            int camModes = 1;
+            if (head.valvetrain == ValvetrainType::Vtec) {
+                reader->read(&head.vtec.minRpm);
+                reader->read(&head.vtec.minSpeed);
+                reader->read(&head.vtec.manifoldVacuum);
+                reader->read(&head.vtec.minThrottlePosition);
+                camModes = 2;
+            }
+            else if (head.valvetrain != ValvetrainType::Standard) {
+                reader->invalidate();
+                return false;
+            }
+
+            head.intakeCams.resize(camModes);
+            head.exhaustCams.resize(camModes);
+            for (int mode = 0; mode < camModes; ++mode) {
+                readCamshaft(reader, &head.intakeCams[mode]);
+                readCamshaft(reader, &head.exhaustCams[mode]);
+            }
+
+            if (!reader->isValid()
+                || bank.cylinderCount > cylinderCount - cylinderBase)
+            {
+                reader->invalidate();
+                return false;
+            }
+
+            for (int j = 0; j < bank.cylinderCount; ++j) {
+                CylinderRecord &cylinder = pack->cylinders[cylinderBase + j];
+                reader->read(&cylinder.intake);
+                reader->read(&cylinder.exhaust);
+                reader->read(&cylinder.soundAttenuation);
+                reader->read(&cylinder.primaryLength);
+
+                if (cylinder.intake < 0 || cylinder.intake >= intakeCount
+                    || cylinder.exhaust < 0 || cylinder.exhaust >= exhaustCount)
+                {
+                    reader->invalidate();
+                    return false;
+                }
+            }
+
+            cylinderBase += bank.cylinderCount;
+        }
+
+        if (cylinderBase != cylinderCount) {
+            reader->invalidate();
+            return false;
+        }
+
+        reader->read(&pack->timingCurve);
+        reader->read(&pack->revLimit);
+        reader->read(&pack->limiterDuration);
+        for (CylinderRecord &cylinder : pack->cylinders) {
+            reader->read(&cylinder.plugEnabled);
+            reader->read(&cylinder.firingAngle);
+        }
+
+        Fuel::Parameters &fuel = pack->fuel;
+        reader->read(&fuel.molecularMass);
+        reader->read(&fuel.energyDensity);
+        reader->read(&fuel.density);
+        reader->read(&fuel.molecularAfr);
+        reader->read(&fuel.burningEfficiencyRandomness);
+        reader->read(&fuel.lowEfficiencyAttenuation);
+        reader->read(&fuel.maxBurningEfficiency);
+        reader->read(&fuel.maxTurbulenceEffect);
+        reader->read(&fuel.maxDilutionEffect);
+        reader->read(&pack->turbulenceToFlameSpeedRatio);
+        reader->read(&pack->meanPistonSpeedToTurbulence);
+
+        reader->read(&pack->hasVehicle);
+        if (pack->hasVehicle) {
+            Vehicle::Parameters &v = pack->vehicle;
+            reader->read(&v.mass);
+            reader->read(&v.dragCoefficient);
+            reader->read(&v.crossSectionArea);
+            reader->read(&v.diffRatio);
+            reader->read(&v.tireRadius);
+            reader->read(&v.rollingResistance);
+        }
+
+        reader->read(&pack->hasTransmission);
+        if (pack->hasTransmission) {
+            readDoubles(reader, &pack->gearRatios);
+            reader->read(&pack->maxClutchTorque);
+        }
+
+        if (!reader->isValid()) return false;
+
+        // Function references have to resolve; only the optional ones may
+        // be missing
+        auto validFunction = [&](int32_t f, bool optional) {
+            return (optional && f == -1) || (f >= 0 && f < functionCount);
+        };
+
+        bool valid = validFunction(pack->timingCurve, false)
+            && validFunction(pack->turbulenceToFlameSpeedRatio, true)
+            && validFunction(pack->meanPistonSpeedToTurbulence, cylinderCount == 0);
+        for (const HeadRecord &head : pack->heads) {
+            valid = valid
+                && validFunction(head.intakePortFlow, false)
+                && validFunction(head.exhaustPortFlow, false);
+            for (size_t mode = 0; mode < head.intakeCams.size(); ++mode) {
+                valid = valid
+                    && validFunction(head.intakeCams[mode].lobeProfile, false)
+                    && validFunction(head.exhaustCams[mode].lobeProfile, false);
+            }
+        }
+
+        if (!valid) {
+            reader->invalidate();
+            return false;
+        }
+
+        return true;
+    }
+
+    Camshaft *buildCamshaft(
+        const CamshaftRecord &record,
+        Crankshaft *crankshaft,
+        const std::vector<Function *> &functions)
+    {
+        Camshaft::Parameters params;
+        params.lobes = static_cast<int>(record.lobeCenterlines.size());
+        params.advance = record.advance;
+        params.baseRadius = record.baseRadius;
+        params.crankshaft = crankshaft;
+        params.lobeProfile = functions[record.lobeProfile];
+
+        Camshaft *cam = new Camshaft;
+        cam->initialize(params);
+        for (int i = 0; i < params.lobes; ++i) {
+            cam->setLobeCenterline(i, record.lobeCenterlines[i]);
+        }
+
+        return cam;
+    }
+
+    // Same order of construction as EngineNode::buildEngine(). If given,
+    // `sharedFunctions` are used in place of the pack's function table.
+    void buildPack(
+        const PackRecord &pack,
+        EnginePack::Objects *out,
+        const std::vector<const Function *> *sharedFunctions = nullptr)
+    {
+        std::vector<Function *> functions;
+        if (sharedFunctions != nullptr) {
+            for (const Function *f : *sharedFunctions) {
+                // Parts only ever sample their functions
+                functions.push_back(const_cast<Function *>(f));
+            }
+        }
+        else {
+            out->functions = std::make_shared<EnginePack::FunctionSet>();
+            for (const FunctionRecord &record : pack.functions) {
+                const int n = static_cast<int>(record.x.size());
+                Function *f = new Function;
+                f->initialize(n, record.filterRadius);
+                f->addSamples(record.x.data(), record.y.data(), n);
+                f->setInputScale(record.inputScale);
+                f->setOutputScale(record.outputScale);
+                functions.push_back(f);
+            }
+
+            out->functions->functions = functions;
+        }
+
+        auto function = [&](int32_t i) {
+            return (i >= 0) ? functions[i] : nullptr;
+        };
+
+        Engine *engine = new Engine;
+        Engine::Parameters engineParams = pack.engine;
+        if (pack.throttle == ThrottleType::Governor) {
+            Governor *governor = new Governor;
+            governor->initialize(pack.governor);
+            engineParams.throttle = governor;
+        }
+        else {
+            DirectThrottleLinkage *linkage = new DirectThrottleLinkage;
+            linkage->initialize(pack.directLinkage);
+            engineParams.throttle = linkage;
+        }
+
+        engine->initialize(engineParams);
+
+        for (int i = 0; i < engine->getCrankshaftCount(); ++i) {
+            const CrankshaftRecord &record = pack.crankshafts[i];
+            Crankshaft *crankshaft = engine->getCrankshaft(i);
+            crankshaft->initialize(record.params);
+            for (int j = 0; j < record.params.rodJournals; ++j) {
+                crankshaft->setRodJournalAngle(j, record.journalAngles[j]);
+            }
+        }
+
+        int cylinderBase = 0;
+        for (int i = 0; i < engine->getCylinderBankCount(); ++i) {
+            const HeadRecord &head = pack.heads[i];
+            CylinderBank *bank = engine->getCylinderBank(i);
+            CylinderBank::Parameters bankParams = head.bank;
+            bankParams.crankshaft = engine->getCrankshaft(0);
+            bank->initialize(bankParams);
+
+            for (int j = 0; j < bankParams.cylinderCount; ++j) {
+                const int index = cylinderBase + j;
+                const CylinderRecord &record = pack.cylinders[index];
+                Piston *piston = engine->getPiston(index);
+                ConnectingRod *rod = engine->getConnectingRod(index);
+
+                Piston::Parameters pistonParams = record.piston;
+                pistonParams.Bank = bank;
+                pistonParams.CylinderIndex = j;
+                pistonParams.Rod = rod;
+                piston->initialize(pistonParams);
+
+                ConnectingRod::Parameters rodParams = record.rod;
+                rodParams.crankshaft = engine->getCrankshaft(record.crankshaft);
+                rodParams.piston = piston;
+                rodParams.master = nullptr;
+                rod->initialize(rodParams);
+                for (int k = 0; k < rodParams.rodJournals; ++k) {
+                    rod->setRodJournalAngle(k, record.rodJournalAngles[k]);
+                }
+            }
+
+            cylinderBase += bankParams.cylinderCount;
+        }
+
+        for (int i = 0; i < engine->getExhaustSystemCount(); ++i) {
+            const ExhaustRecord &record = pack.exhaustSystems[i];
+            ExhaustSystem::Parameters params = record.params;
+            if (record.hasImpulseResponse) {
+                params.impulseResponse = new ImpulseResponse;
+                params.impulseResponse->initialize(record.impulseFilename, record.impulseVolume);
+            }
+
+            engine->getExhaustSystem(i)->initialize(params);
+        }
+
+        for (int i = 0; i < engine->getIntakeCount(); ++i) {
+            Intake::Parameters params = pack.intakes[i];
+            engine->getIntake(i)->initialize(params);
+        }
+
+        cylinderBase = 0;
+        for (int i = 0; i < engine->getCylinderBankCount(); ++i) {
+            const HeadRecord &head = pack.heads[i];
+            Crankshaft *crankshaft = engine->getCrankshaft(0);
+
+            Valvetrain *valvetrain = nullptr;
+            if (head.valvetrain == ValvetrainType::Vtec) {
+                VtecValvetrain::Parameters params = head.vtec;
+                params.intakeCamshaft = buildCamshaft(head.intakeCams[0], crankshaft, functions);
+                params.exhaustCamshaft = buildCamshaft(head.exhaustCams[0], crankshaft, functions);
+                params.vtecIntakeCamshaft = buildCamshaft(head.intakeCams[1], crankshaft, functions);
+                params.vtexExhaustCamshaft = buildCamshaft(head.exhaustCams[1], crankshaft, functions);
+                params.engine = engine;
+
+                VtecValvetrain *vtec = new VtecValvetrain;
+                vtec->initialize(params);
+                valvetrain = vtec;
+            }
+            else {
+                StandardValvetrain::Parameters params;
+                params.intakeCamshaft = buildCamshaft(head.intakeCams[0], crankshaft, functions);
+                params.exhaustCamshaft = buildCamshaft(head.exhaustCams[0], crankshaft, functions);
+
+                StandardValvetrain *standard = new StandardValvetrain;
+                standard->initialize(params);
+                valvetrain = standard;
+            }
+
+            CylinderHead::Parameters params = head.head;
+            params.Bank = engine->getCylinderBank(i);
+            params.Valvetrain = valvetrain;
+            params.IntakePortFlow = functions[head.intakePortFlow];
+            params.ExhaustPortFlow = functions[head.exhaustPortFlow];
+
+            CylinderHead *cylinderHead = engine->getHead(i);
+            cylinderHead->initialize(params);
+
+            for (int j = 0; j < head.bank.cylinderCount; ++j) {
+                const CylinderRecord &record = pack.cylinders[cylinderBase + j];
+                cylinderHead->setIntake(j, engine->getIntake(record.intake));
+                cylinderHead->setExhaustSystem(j, engine->getExhaustSystem(record.exhaust));
+                cylinderHead->setSoundAttenuation(j, record.soundAttenuation);
+                cylinderHead->setHeaderPrimaryLength(j, record.primaryLength);
+            }
+
+            cylinderBase += head.bank.cylinderCount;
+        }
+
+        for (int i = 0; i < engine->getCylinderCount(); ++i) {
+            const CylinderRecord &record = pack.cylinders[i];
+            if (record.master >= 0) {
+                ConnectingRod *rod = engine->getConnectingRod(i);
+                rod->setMaster(engine->getConnectingRod(record.master));
+                rod->setCrankshaft(rod->getMasterRod()->getCrankshaft());
+            }
+        }
+
+        IgnitionModule::Parameters ignitionParams;
+        ignitionParams.cylinderCount = engine->getCylinderCount();
+        ignitionParams.crankshaft = engine->getCrankshaft(0);
+        ignitionParams.timingCurve = functions[pack.timingCurve];
+        ignitionParams.revLimit = pack.revLimit;
+        ignitionParams.limiterDuration = pack.limiterDuration;
+        engine->getIgnitionModule()->initialize(ignitionParams);
+        for (int i = 0; i < engine->getCylinderCount(); ++i) {
+            if (pack.cylinders[i].plugEnabled) {
+                engine->getIgnitionModule()->setFiringOrder(i, pack.cylinders[i].firingAngle);
+            }
+        }
+
+        Fuel::Parameters fuelParams = pack.fuel;
+        fuelParams.turbulenceToFlameSpeedRatio = function(pack.turbulenceToFlameSpeedRatio);
+        Fuel *fuel = engine->getFuel();
+        fuel->initialize(fuelParams);
+
+        CombustionChamber::Parameters ccParams;
+        ccParams.CrankcasePressure = units::pressure(1.0, units::atm);
+        ccParams.Fuel = fuel;
+        ccParams.StartingPressure = units::pressure(1.0, units::atm);
+        ccParams.StartingTemperature = units::celcius(25.0);
+        ccParams.MeanPistonSpeedToTurbulence = function(pack.meanPistonSpeedToTurbulence);
+
+        for (int i = 0; i < engine->getCylinderCount(); ++i) {
+            ccParams.Piston = engine->getPiston(i);
+            ccParams.Head = engine->getHead(ccParams.Piston->getCylinderBank()->getIndex());
+            engine->getChamber(i)->initialize(ccParams);
+        }
+
+        if (sharedFunctions == nullptr) {
+            for (Function *f : functions) {
+                f->compile();
+            }
+        }
+
+        out->engine = engine;
+        out->simulatorParameters = pack.simulatorParameters;
+
+        if (pack.hasVehicle) {
+            out->vehicle = new Vehicle;
+            out->vehicle->initialize(pack.vehicle);
+        }
+
+        if (pack.hasTransmission) {
+            Transmission::Parameters params;
+            params.GearCount = static_cast<int>(pack.gearRatios.size());
+            params.GearRatios = pack.gearRatios.data();
+            params.MaxClutchTorque = pack.maxClutchTorque;
+
+            out->transmission = new Transmission;
+            out->transmission->initialize(params);
+        }
+    }
+} /* namespace */
+
+EnginePack::FunctionSet::~FunctionSet() {
+    for (Function *f : functions) {
+        f->destroy();
+        delete f;
+    }
+}
+
+bool EnginePack::write(
+    const Objects &objects,
+    StateWriter *writer,
+    const std::string &referenceDirectory)
+{
+    return writePack(objects, writer, referenceDirectory, nullptr);
+}
+
+bool EnginePack::writePack(
+    const Objects &objects,
+    StateWriter *writer,
+    const std::string &referenceDirectory,
+    std::vector<const Function *> *functionOrder)
+{
+    Engine *engine = objects.engine;
+    FunctionTable functions;
+
+    // Function indices are assigned while writing the parts, so the parts
+    // go to a separate buffer and the table is written ahead of them
+    StateWriter parts;
+
+    writeString(&parts, engine->getName());
+    parts.write(engine->getStarterTorque());
+    parts.write(engine->getStarterSpeed());
+    parts.write(engine->getRedline());
+    parts.write(engine->getDynoMinSpeed());
+    parts.write(engine->getDynoMaxSpeed());
+    parts.write(engine->getDynoHoldStep());
+    parts.write(engine->getSimulationFrequency());
+    parts.write(engine->getInitialHighFrequencyGain());
+    parts.write(engine->getInitialNoise());
+    parts.write(engine->getInitialJitter());
+    parts.write(static_cast<int32_t>(engine->getCrankshaftCount()));
+    parts.write(static_cast<int32_t>(engine->getCylinderBankCount()));
+    parts.write(static_cast<int32_t>(engine->getCylinderCount()));
+    parts.write(static_cast<int32_t>(engine->getExhaustSystemCount()));
+    parts.write(static_cast<int32_t>(engine->getIntakeCount()));
+
+    Throttle *throttle = engine->getThrottleLinkage();
+    if (Governor *governor = dynamic_cast<Governor *>(throttle)) {
+        parts.write(ThrottleType::Governor);
+        parts.write(governor->getMinSpeed());
+        parts.write(governor->getMaxSpeed());
+        parts.write(governor->getMinVelocity());
+        parts.write(governor->getMaxVelocity());
+        parts.write(governor->getKs());
+        parts.write(governor->getKd());
+        parts.write(governor->getGamma());
+    }
+    else if (DirectThrottleLinkage *linkage = dynamic_cast<DirectThrottleLinkage *>(throttle)) {
+        parts.write(ThrottleType::DirectLinkage);
+        parts.write(linkage->getGamma());
+    }
+    else {
+        return false;
+    }
+
+    for (int i = 0; i < engine->getCrankshaftCount(); ++i) {
+        Crankshaft *crankshaft = engine->getCrankshaft(i);
+        parts.write(crankshaft->getMass());
+        parts.write(crankshaft->getFlywheelMass());
+        parts.write(crankshaft->getMomentOfInertia());
+        parts.write(crankshaft->getThrow());
+        parts.write(crankshaft->getPosX());
+        parts.write(crankshaft->getPosY());
+        parts.write(crankshaft->getTdc());
+        parts.write(crankshaft->getFrictionTorque());
+        parts.write(static_cast<int32_t>(crankshaft->getRodJournalCount()));
+        for (int j = 0; j < crankshaft->getRodJournalCount(); ++j) {
+            parts.write(crankshaft->getRodJournalAngle(j));
+        }
+    }
+
+    for (int i = 0; i < engine->getCylinderCount(); ++i) {
+        Piston *piston = engine->getPiston(i);
+        parts.write(piston->getBlowbyK());
+        parts.write(piston->getCompressionHeight());
+        parts.write(piston->getWristPinLocation());
+        parts.write(piston->getDisplacement());
+        parts.write(piston->getMass());
+
+        ConnectingRod *rod = engine->getConnectingRod(i);
+        parts.write(rod->getMass());
+        parts.write(rod->getMomentOfInertia());
+        parts.write(rod->getCenterOfMass());
+        parts.write(rod->getLength());
+        parts.write(rod->getSlaveThrow());
+        parts.write(indexOf(
+            rod->getCrankshaft(),
+            engine->getCrankshaft(0),
+            engine->getCrankshaftCount()));
+        parts.write(static_cast<int32_t>(rod->getJournal()));
+        parts.write(indexOf(
+            rod->getMasterRod(),
+            engine->getConnectingRod(0),
+            engine->getCylinderCount()));
+        parts.write(static_cast<int32_t>(rod->getRodJournalCount()));
+        for (int j = 0; j < rod->getRodJournalCount(); ++j) {
+            parts.write(rod->getRodJournalAngle(j));
+        }
+    }
+
+    for (int i = 0; i < engine->getExhaustSystemCount(); ++i) {
+        ExhaustSystem *exhaust = engine->getExhaustSystem(i);
+        parts.write(exhaust->getLength());
+        parts.write(exhaust->getCollectorCrossSectionArea());
+        parts.write(exhaust->getOutletFlowRate());
+        parts.write(exhaust->getPrimaryTubeLength());
+        parts.write(exhaust->getPrimaryFlowRate());
+        parts.write(exhaust->getVelocityDecay());
+        parts.write(exhaust->getAudioVolume());
+
+        ImpulseResponse *response = exhaust->getImpulseResponse();
+        std::string filename = (response != nullptr) ? response->getFilename() : "";
+        if (!referenceDirectory.empty() && std::filesystem::path(filename).is_absolute()) {
+            const std::filesystem::path relative =
+                std::filesystem::path(filename).lexically_relative(referenceDirectory);
+            if (!relative.empty() && *relative.begin() != "..") {
+                filename = relative.generic_string();
+            }
+        }
+
+        parts.write(response != nullptr);
+        writeString(&parts, filename);
+        parts.write((response != nullptr) ? response->getVolume() : 0.0);
+    }
+
+    for (int i = 0; i < engine->getIntakeCount(); ++i) {
+        Intake *intake = engine->getIntake(i);
+        parts.write(intake->getPlenumVolume());
+        parts.write(intake->getPlenumCrossSectionArea());
+        parts.write(intake->getInputFlowK());
+        parts.write(intake->getIdleFlowK());
+        parts.write(intake->getRunnerFlowRate());
+        parts.write(intake->getMolecularAfr());
+        parts.write(intake->getIdleThrottlePlatePosition());
+        parts.write(intake->getRunnerLength());
+        parts.write(intake->getVelocityDecay());
+    }
+
+    for (int i = 0; i < engine->getCylinderBankCount(); ++i) {
+        CylinderBank *bank = engine->getCylinderBank(i);
+        parts.write(bank->getAngle());
+        parts.write(bank->getBore());
+        parts.write(bank->getDeckHeight());
+        parts.write(bank->getX());
+        parts.write(bank->getY());
+        parts.write(bank->getDisplayDepth());
+        parts.write(static_cast<int32_t>(bank->getCylinderCount()));
+
+        CylinderHead *head = engine->getHead(i);
+        parts.write(head->getCombustionChamberVolume());
+        parts.write(head->getIntakeRunnerVolume());
+        parts.write(head->getIntakeRunnerCrossSectionArea());
+        parts.write(head->getExhaustRunnerVolume());
+        parts.write(head->getExhaustRunnerCrossSectionArea());
+        parts.write(head->getFlipDisplay());
+        parts.write(functions.index(head->getIntakePortFlow()));
+        parts.write(functions.index(head->getExhaustPortFlow()));
+
+        Valvetrain *valvetrain = head->getValvetrain();
+        if (VtecValvetrain *vtec = dynamic_cast<VtecValvetrain *>(valvetrain)) {
+            parts.write(ValvetrainType::Vtec);
+            parts.write(vtec->getMinRpm());
+            parts.write(vtec->getMinSpeed());
+            parts.write(vtec->getManifoldVacuum());
+            parts.write(vtec->getMinThrottlePosition());
+        }
+        else {
+            parts.write(ValvetrainType::Standard);
+        }
+
+        for (int mode = 0; mode < valvetrain->getCamModeCount(); ++mode) {
+            writeCamshaft(&parts, &functions, valvetrain->getIntakeCamshaft(mode));
+            writeCamshaft(&parts, &functions, valvetrain->getExhaustCamshaft(mode));
+        }
+
+        for (int j = 0; j < bank->getCylinderCount(); ++j) {
+            parts.write(indexOf(
+                head->getIntake(j),
+                engine->getIntake(0),
+                engine->getIntakeCount()));
+            parts.write(indexOf(
+                head->getExhaustSystem(j),
+                engine->getExhaustSystem(0),
+                engine->getExhaustSystemCount()));
+            parts.write(head->getSoundAttenuation(j));
+            parts.write(head->getHeaderPrimaryLength(j));
+        }
+    }
+
+    IgnitionModule *ignition = engine->getIgnitionModule();
+    parts.write(functions.index(ignition->getTimingCurve()));
+    parts.write(ignition->getRevLimit());
+    parts.write(ignition->getLimiterDuration());
+    for (int i = 0; i < engine->getCylinderCount(); ++i) {
+        parts.write(ignition->isPlugEnabled(i));
+        parts.write(ignition->getFiringAngle(i));
+    }
+
+    Fuel *fuel = engine->getFuel();
+    parts.write(fuel->getMolecularMass());
+    parts.write(fuel->getEnergyDensity());
+    parts.write(fuel->getDensity());
+    parts.write(fuel->getMolecularAfr());
+    parts.write(fuel->getBurningEfficiencyRandomness());
+    parts.write(fuel->getLowEfficiencyAttenuation());
+    parts.write(fuel->getMaxBurningEfficiency());
+    parts.write(fuel->getMaxTurbulenceEffect());
+    parts.write(fuel->getMaxDilutionEffect());
+    parts.write(functions.index(fuel->getTurbulenceToFlameSpeedRatio()));
+    parts.write(functions.index((engine->getCylinderCount() > 0)
+        ? engine->getChamber(0)->getMeanPistonSpeedToTurbulence()
+        : nullptr));
+
+    Vehicle *vehicle = objects.vehicle;
+    parts.write(vehicle != nullptr);
+    if (vehicle != nullptr) {
+        parts.write(vehicle->getMass());
+        parts.write(vehicle->getDragCoefficient());
+        parts.write(vehicle->getCrossSectionArea());
+        parts.write(vehicle->getDiffRatio());
+        parts.write(vehicle->getTireRadius());
+        parts.write(vehicle->getRollingResistance());
+    }
+
+    Transmission *transmission = objects.transmission;
+    parts.write(transmission != nullptr);
+    if (transmission != nullptr) {
+        parts.write(static_cast<int32_t>(transmission->getGearCount()));
+        for (int i = 0; i < transmission->getGearCount(); ++i) {
+            parts.write(transmission->getGearRatio(i));
+        }
+
+        parts.write(transmission->getMaxClutchTorque());
+    }
+
+    writer->write(FileMagic, 4);
+    writer->write(FileVersion);
+    writer->write(static_cast<int32_t>(objects.simulatorParameters.systemType));
+    functions.write(writer);
+    writer->writeBytes(parts.getData(), parts.getSize());
+
+    if (functionOrder != nullptr) {
+        *functionOrder = functions.getFunctions();
+    }
+
+    return true;
+}
+
+bool EnginePack::save(const Objects &objects, const std::string &path) {
+    if (objects.engine == nullptr) return false;
+
+    StateWriter writer;
+    return write(
+            objects,
+            &writer,
+            std::filesystem::absolute(path).parent_path().lexically_normal().string())
+        && writer.save(path);
+}
+
+bool EnginePack::read(StateReader *reader, Objects *out) {
+    *out = Objects();
+
+    PackRecord pack;
+    if (!readPack(reader, &pack)) return false;
+
+    buildPack(pack, out);
+    return true;
+}
+
+void EnginePack::instantiate(const Objects &prototype, Objects *out) {
+    *out = Objects();
+    if (prototype.engine == nullptr) return;
+
+    std::vector<const Function *> functions;
+    StateWriter writer;
+    if (!writePack(prototype, &writer, "", &functions)) return;
+
+    PackRecord pack;
+    StateReader reader(writer.getData(), writer.getSize());
+    if (!readPack(&reader, &pack)) return;
+
+    buildPack(pack, out, &functions);
+    out->functions = prototype.functions;
+}
+
+bool EnginePack::load(const std::string &path, Objects *out) {
+    StateReader reader;
+    return reader.load(path) && read(&reader, out);
+}
+
+void EnginePack::release(Objects *objects) {
+    if (objects->engine != nullptr) {
+        objects->engine->destroy();
+        delete objects->engine;
+    }
+
+    delete objects->vehicle;
+    delete objects->transmission;
+
+    // After the parts that sample them
+    objects->functions.reset();
+
+    *objects = Objects();
+}
@@ -1,16 +1,33 @@
 #include "../include/engine_sim_runtime_c.h"
 
+#include "../include/arena.h"
+#include "../include/compilation_cache.h"
+#include "../include/constants.h"
+#include "../include/dyno_sweep.h"
 #include "../include/engine.h"
+#include "../include/engine_kernel_registry.h"
+#include "../include/engine_map_builder.h"
+#include "../include/engine_pack.h"
 #include "../include/ignition_module.h"
+#include "../include/mean_value_simulator.h"
+#include "../include/offline_renderer.h"
 #include "../include/piston_engine_simulator.h"
+#include "../include/snapshot_buffer.h"
+#include "../include/spsc_queue.h"
 #include "../include/units.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstddef>
 #include <cstdio>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #ifdef ATG_ENGINE_SIM_PIRANHA_ENABLED
@@ -158,84 +175,118 @@ static std::filesystem::path resolve_maybe_relative(
     return base_dir / p;
 }
 
+// Crank and drivetrain dynamics are smooth without the crank-slider, so the
+// mean-value model doesn't need the script's audio-rate frequency
+constexpr int MeanValueSimulationFrequency = 2000;
+
+// Simulation thread pacing (s). Frames are a fraction of the synthesizer's
+// latency target, and a stall longer than the maximum isn't caught up on.
+constexpr double SimulationThreadMinPeriod = 0.002;
+constexpr double SimulationThreadMaxPeriod = 1.0 / 60;
+constexpr double SimulationThreadMaxFrame = 0.1;
+
 static double clamp01(double v) {
     if (v < 0.0) return 0.0;
     if (v > 1.0) return 1.0;
     return v;
 }
 
-} // namespace
-
-struct es_runtime_t {
+struct ScriptObjects {
     Engine *engine = nullptr;
     Vehicle *vehicle = nullptr;
     Transmission *transmission = nullptr;
-    Simulator *simulator = nullptr;
-
-    std::filesystem::path base_dir;
-
-    void clear() {
-        if (simulator != nullptr) {
-            simulator->destroy();
-            delete simulator;
-            simulator = nullptr;
-        }
-
-        if (engine != nullptr) {
-            engine->destroy();
-            delete engine;
-            engine = nullptr;
-        }
-
-        if (vehicle != nullptr) {
-            delete vehicle;
-            vehicle = nullptr;
-        }
-
-        if (transmission != nullptr) {
-            delete transmission;
-            transmission = nullptr;
-        }
+    Simulator::Parameters simulatorParameters;
+    std::shared_ptr<EnginePack::FunctionSet> functions;     // Null for script output
+};
 
-        base_dir.clear();
+static void release_script_objects(ScriptObjects *objects) {
+    if (objects->engine != nullptr) {
+        objects->engine->destroy();
+        delete objects->engine;
     }
-};
 
-extern "C" {
+    delete objects->vehicle;
+    delete objects->transmission;
 
-es_runtime_t *es_runtime_create(void) {
-    return new es_runtime_t;
+    *objects = ScriptObjects();
 }
 
-void es_runtime_destroy(es_runtime_t *rt) {
-    if (rt == nullptr) return;
-    rt->clear();
-    delete rt;
-}
+// Scripts and packs don't have to define a vehicle or transmission
+static void add_default_drivetrain(ScriptObjects *objects) {
+    if (objects->vehicle == nullptr) {
+        Vehicle::Parameters vehParams;
+        vehParams.mass = units::mass(1597, units::kg);
+        vehParams.diffRatio = 3.42;
+        vehParams.tireRadius = units::distance(10, units::inch);
+        vehParams.dragCoefficient = 0.25;
+        vehParams.crossSectionArea = units::distance(6.0, units::foot) * units::distance(6.0, units::foot);
+        vehParams.rollingResistance = 2000.0;
+        objects->vehicle = new Vehicle;
+        objects->vehicle->initialize(vehParams);
+    }
 
-bool es_runtime_has_simulation(const es_runtime_t *rt) {
-    return rt != nullptr && rt->simulator != nullptr && rt->engine != nullptr;
+    if (objects->transmission == nullptr) {
+        static const double gearRatios[] = { 2.97, 2.07, 1.43, 1.00, 0.84, 0.56 };
+        Transmission::Parameters tParams;
+        tParams.GearCount = 6;
+        tParams.GearRatios = gearRatios;
+        tParams.MaxClutchTorque = units::torque(1000.0, units::ft_lb);
+        objects->transmission = new Transmission;
+        objects->transmission->initialize(tParams);
+    }
 }
 
-bool es_runtime_load_script(es_runtime_t *rt, const char *script_path) {
-    if (rt == nullptr || script_path == nullptr) return false;
+static bool load_pack_objects(const char *pack_path, ScriptObjects *out) {
+    EnginePack::Objects pack;
+    if (!EnginePack::load(pack_path, &pack)) return false;
 
-    rt->clear();
+    out->engine = pack.engine;
+    out->vehicle = pack.vehicle;
+    out->transmission = pack.transmission;
+    out->simulatorParameters = pack.simulatorParameters;
+    out->functions = pack.functions;
+    add_default_drivetrain(out);
 
-    rt->base_dir = std::filesystem::path(script_path).parent_path();
+    return true;
+}
+
+// Compiled scripts are kept as engine packs, so loading an unchanged script
+// again (another instance, the next dyno sweep, a reload in the editor) skips
+// the interpreter
+CompilationCache s_compilation_cache;
 
 #ifdef ATG_ENGINE_SIM_PIRANHA_ENABLED
-    Engine *engine = nullptr;
-    Vehicle *vehicle = nullptr;
-    Transmission *transmission = nullptr;
-    Simulator::Parameters sim_params;
+// Compiles and executes a .mr script, supplying a default vehicle and
+// transmission when the script doesn't define them.
+static bool compile_script(
+    const char *script_path,
+    const std::filesystem::path &base_dir,
+    ScriptObjects *out)
+{
+    const std::vector<std::string> search_paths = es_script::Compiler::getSearchPaths(script_path);
+
+    std::vector<uint8_t> cached;
+    if (s_compilation_cache.find(script_path, search_paths, &cached)) {
+        EnginePack::Objects pack;
+        StateReader reader(cached.data(), cached.size());
+        if (EnginePack::read(&reader, &pack)) {
+            out->engine = pack.engine;
+            out->vehicle = pack.vehicle;
+            out->transmission = pack.transmission;
+            out->simulatorParameters = pack.simulatorParameters;
+            out->functions = pack.functions;
+            add_default_drivetrain(out);
+
+            return true;
+        }
+    }
 
     {
         es_script::Compiler compiler;
         compiler.initialize();
         
         // Add the script's directory as a search path so nested files can find engine_sim.mr
-        compiler.addSearchPath(rt->base_dir.string());
+        compiler.addSearchPath(base_dir.string());
 
         const bool compiled = compiler.compile(script_path);
         if (!compiled) {
@@ -246,43 +297,260 @@ bool es_runtime_load_script(es_runtime_t *rt, const char *script_path) {
         const es_script::Compiler::Output output = compiler.execute();
         compiler.destroy();
 
-        engine = output.engine;
-        vehicle = output.vehicle;
-        transmission = output.transmission;
-        sim_params = output.simulatorParameters;
+        out->engine = output.engine;
+        out->vehicle = output.vehicle;
+        out->transmission = output.transmission;
+        out->simulatorParameters = output.simulatorParameters;
     }
 
-    if (engine == nullptr) {
+    if (out->engine == nullptr) {
+        release_script_objects(out);
         return false;
     }
 
-    if (vehicle == nullptr) {
-        Vehicle::Parameters vehParams;
-        vehParams.mass = units::mass(1597, units::kg);
-        vehParams.diffRatio = 3.42;
-        vehParams.tireRadius = units::distance(10, units::inch);
-        vehParams.dragCoefficient = 0.25;
-        vehParams.crossSectionArea = units::distance(6.0, units::foot) * units::distance(6.0, units::foot);
-        vehParams.rollingResistance = 2000.0;
-        vehicle = new Vehicle;
-        vehicle->initialize(vehParams);
+    {
+        EnginePack::Objects pack;
+        pack.engine = out->engine;
+        pack.vehicle = out->vehicle;
+        pack.transmission = out->transmission;
+        pack.simulatorParameters = out->simulatorParameters;
+
+        StateWriter writer;
+        if (EnginePack::write(pack, &writer)) {
+            s_compilation_cache.store(script_path, search_paths, writer.getData(), writer.getSize());
+        }
     }
 
-    if (transmission == nullptr) {
-        static const double gearRatios[] = { 2.97, 2.07, 1.43, 1.00, 0.84, 0.56 };
-        Transmission::Parameters tParams;
-        tParams.GearCount = 6;
-        tParams.GearRatios = gearRatios;
-        tParams.MaxClutchTorque = units::torque(1000.0, units::ft_lb);
-        transmission = new Transmission;
-        transmission->initialize(tParams);
+    add_default_drivetrain(out);
+
+    return true;
+}
+#endif
+
+} // namespace
+
+static void release_simulation(
+    Simulator *&simulator,
+    EngineMap *&engine_map,
+    Engine *&engine,
+    Vehicle *&vehicle,
+    Transmission *&transmission,
+    Arena *&arena)
+{
+    if (simulator != nullptr) {
+        simulator->destroy();
+        delete simulator;
+        simulator = nullptr;
+    }
+
+    if (engine_map != nullptr) {
+        engine_map->destroy();
+        delete engine_map;
+        engine_map = nullptr;
+    }
+
+    if (engine != nullptr) {
+        engine->destroy();
+        delete engine;
+        engine = nullptr;
+    }
+
+    if (vehicle != nullptr) {
+        delete vehicle;
+        vehicle = nullptr;
+    }
+
+    if (transmission != nullptr) {
+        delete transmission;
+        transmission = nullptr;
+    }
+
+    // Last, since everything above may have buffers in it
+    if (arena != nullptr) {
+        arena->destroy();
+        delete arena;
+        arena = nullptr;
+    }
+}
+
+static Arena *create_arena(size_t chunk_size = Arena::DefaultChunkSize) {
+    Arena *arena = new Arena;
+    arena->initialize(chunk_size);
+
+    return arena;
+}
+
+// Simulation replaced by es_runtime_swap_load() that keeps running until its
+// audio has been crossfaded out. Only the audio reader advances `position`;
+// once it reaches `length` the reader no longer touches the simulation and
+// es_runtime_end_frame() releases it.
+struct FadingSimulation {
+    Engine *engine = nullptr;
+    Vehicle *vehicle = nullptr;
+    Transmission *transmission = nullptr;
+    Simulator *simulator = nullptr;
+    EngineMap *engine_map = nullptr;
+    Arena *arena = nullptr;
+    std::shared_ptr<EnginePack::FunctionSet> functions;
+
+    int length = 0;                     // Samples
+    std::atomic<int> position{ 0 };
+
+    bool isFading() const {
+        return simulator != nullptr;
+    }
+
+    void release() {
+        // Leaves `length` alone since the reader may still be checking it
+        position.store(length, std::memory_order_release);
+        release_simulation(simulator, engine_map, engine, vehicle, transmission, arena);
+        functions.reset();
+    }
+};
+
+// Control change made while the simulation thread is running, applied by the
+// thread between steps
+struct ControlCommand {
+    enum class Type {
+        SpeedControl,
+        Throttle,
+        StarterEnabled,
+        IgnitionEnabled,
+        Gear,
+        ClutchPressure,
+        SimulationSpeed,
+        SimulationFrequency,
+        MechanicalStepDivisor,
+        QualityTier
+    };
+
+    Type type = Type::Throttle;
+    double value = 0.0;
+};
+
+// Published at the end of every frame. es_runtime_get_telemetry() always
+// reads it; the other getters only while the simulation thread is running.
+struct RuntimeSnapshot {
+    es_telemetry_t telemetry;
+    double simulation_speed;
+    double simulation_frequency;
+    int mechanical_step_divisor;
+    es_quality_tier_t quality_tier;
+    bool has_solver_stats;
+    es_solver_stats_t solver_stats;
+};
+
+// Steps a runtime's simulation on a thread of its own. Controls reach it
+// through `commands` and state comes back through `snapshot`, published after
+// every frame, so the caller and the thread never wait on each other for
+// those. `frame_lock` is held for each frame and by the few calls that
+// replace or read the simulation as a whole.
+struct SimulationThread {
+    std::thread worker;
+    std::atomic<bool> running{ false };
+    bool enabled = false;
+
+    mutable std::mutex frame_lock;
+    SpscQueue<ControlCommand, 1024> commands;
+    SnapshotBuffer<RuntimeSnapshot> snapshot;
+
+    void stop() {
+        running.store(false, std::memory_order_release);
+        if (worker.joinable()) worker.join();
+    }
+};
+
+struct es_runtime_t {
+    Engine *engine = nullptr;
+    Vehicle *vehicle = nullptr;
+    Transmission *transmission = nullptr;
+    Simulator *simulator = nullptr;
+
+    // Functions of an engine loaded from a pack, released after it
+    std::shared_ptr<EnginePack::FunctionSet> functions;
+
+    std::filesystem::path base_dir;
+
+    EngineMap *engine_map = nullptr;
+
+    // Buffers of everything above; created by each load and released with it
+    Arena *arena = nullptr;
+
+    FadingSimulation fading;
+
+    SimulationThread sim_thread;
+
+    // Load options, kept across clear()
+    bool reduced_kinematics = false;
+
+    void clear() {
+        // Anything still queued was meant for the engine being released.
+        // Whether the thread is enabled is kept.
+        sim_thread.stop();
+        ControlCommand dropped;
+        while (sim_thread.commands.pop(&dropped)) {}
+
+        fading.release();
+        release_simulation(simulator, engine_map, engine, vehicle, transmission, arena);
+        functions.reset();
+
+        base_dir.clear();
+    }
+};
+
+// Background load started by es_runtime_load_script_async(). `status` is
+// written last by the worker, so everything else is safe to read once it
+// isn't ES_LOAD_PENDING.
+struct es_load_t {
+    std::thread worker;
+    std::atomic<int> status{ ES_LOAD_PENDING };
+
+    std::string script_path;
+    std::filesystem::path base_dir;
+    bool reduced_kinematics = false;
+
+    ScriptObjects objects;
+    Simulator *simulator = nullptr;     // Prepared, audio thread not started
+    Arena *arena = nullptr;
+
+    void release() {
+        if (worker.joinable()) worker.join();
+
+        EngineMap *engine_map = nullptr;
+        release_simulation(
+            simulator, engine_map, objects.engine, objects.vehicle, objects.transmission, arena);
+        objects.functions.reset();
     }
+};
 
-    // Create simulator (full engine simulation) + synthesizer
-    auto *sim = new PistonEngineSimulator;
+// Full engine simulation and synthesizer for loaded objects, with impulse
+// responses looked up under `base_dir` or copied from `impulse_source`.
+// Doesn't start the audio thread and touches no runtime state, so it can run
+// on a loader thread.
+static PistonEngineSimulator *prepare_piston_simulation(
+    const ScriptObjects &objects,
+    const std::filesystem::path &base_dir,
+    bool reduced_kinematics,
+    Synthesizer *impulse_source = nullptr)
+{
+    Engine *engine = objects.engine;
+    Vehicle *vehicle = objects.vehicle;
+    Transmission *transmission = objects.transmission;
+    const Simulator::Parameters sim_params = objects.simulatorParameters;
+
+    // Create simulator (full engine simulation) + synthesizer, specialized
+    // for this engine if a matching kernel was built in
+    static std::once_flag kernels_registered;
+    std::call_once(kernels_registered, registerEngineKernels);
+    PistonEngineSimulator *sim = EngineKernelRegistry::createSimulator(engine);
+    if (sim == nullptr) sim = new PistonEngineSimulator;
+    else std::fprintf(stderr, "engine-sim: using specialized kernel for '%s'\n", engine->getName().c_str());
     sim->initialize(sim_params);
     // Use engine's simulation_frequency from script (typically 8000-10000 for performance)
     sim->setSimulationFrequency(engine->getSimulationFrequency());
+    sim->setKinematics(reduced_kinematics
+        ? PistonEngineSimulator::Kinematics::ReducedCoordinates
+        : PistonEngineSimulator::Kinematics::Constraints);
     sim->loadSimulation(engine, vehicle, transmission);
     sim->setFluidSimulationSteps(2);  // Reduced from 8 for performance
 
@@ -303,6 +571,11 @@ bool es_runtime_load_script(es_runtime_t *rt, const char *script_path) {
             audioParams.volume, audioParams.dF_F_mix, audioParams.airNoise, audioParams.convolution, audioParams.levelerTarget, audioParams.levelerMaxGain);
     }
 
+    if (impulse_source != nullptr) {
+        sim->synthesizer().copyImpulseResponses(*impulse_source);
+        return sim;
+    }
+
     // Load impulse responses without delta-studio
     for (int i = 0; i < engine->getExhaustSystemCount(); ++i) {
         ImpulseResponse *response = engine->getExhaustSystem(i)->getImpulseResponse();
@@ -321,8 +594,8 @@ bool es_runtime_load_script(es_runtime_t *rt, const char *script_path) {
         // 2. In es/sound-library/ under script dir (for paths like "new/minimal_muffling_02.wav")
         // 3. Absolute path as-is
         std::vector<std::filesystem::path> candidates = {
-            resolve_maybe_relative(rt->base_dir, filename),
-            rt->base_dir / "es" / "sound-library" / filename,
+            resolve_maybe_relative(base_dir, filename),
+            base_dir / "es" / "sound-library" / filename,
             std::filesystem::path(filename)
         };
 
@@ -351,110 +624,997 @@ bool es_runtime_load_script(es_runtime_t *rt, const char *script_path) {
         }
     }
 
+    return sim;
+}
+
+static es_quality_tier_t get_quality_tier(const Simulator *sim) {
+    switch (sim->getQualityTier()) {
+    case Simulator::QualityTier::Reduced: return ES_QUALITY_TIER_REDUCED;
+    case Simulator::QualityTier::PhysicsOnly: return ES_QUALITY_TIER_PHYSICS_ONLY;
+    case Simulator::QualityTier::Frozen: return ES_QUALITY_TIER_FROZEN;
+    case Simulator::QualityTier::Full:
+    default: return ES_QUALITY_TIER_FULL;
+    }
+}
+
+static bool get_solver_stats(const Simulator *sim, es_solver_stats_t *out_stats) {
+    if (sim->getSleSolver() == nullptr) return false;
+
+    const Simulator::SolverStatistics &stats = sim->getSolverStatistics();
+    out_stats->last_iterations = stats.lastIterations;
+    out_stats->last_residual = stats.lastResidual;
+    out_stats->frame_steps = stats.frameSteps;
+    out_stats->frame_mean_iterations = (stats.frameSteps > 0)
+        ? static_cast<double>(stats.frameIterations) / stats.frameSteps
+        : 0.0;
+    out_stats->frame_max_iterations = stats.frameMaxIterations;
+    out_stats->frame_max_residual = stats.frameMaxResidual;
+    out_stats->frame_unconverged_steps = stats.frameUnconvergedSteps;
+
+    return true;
+}
+
+static void apply_control(es_runtime_t *rt, const ControlCommand &command) {
+    if (rt->simulator == nullptr) return;
+
+    switch (command.type) {
+    case ControlCommand::Type::SpeedControl:
+        rt->engine->setSpeedControl(command.value);
+        break;
+    case ControlCommand::Type::Throttle:
+        rt->engine->setThrottle(command.value);
+        break;
+    case ControlCommand::Type::StarterEnabled:
+        rt->simulator->m_starterMotor.m_enabled = command.value != 0;
+        break;
+    case ControlCommand::Type::IgnitionEnabled:
+        if (rt->engine->getIgnitionModule() != nullptr) {
+            rt->engine->getIgnitionModule()->m_enabled = command.value != 0;
+        }
+        break;
+    case ControlCommand::Type::Gear:
+        rt->transmission->changeGear(static_cast<int>(command.value));
+        break;
+    case ControlCommand::Type::ClutchPressure:
+        rt->transmission->setClutchPressure(command.value);
+        break;
+    case ControlCommand::Type::SimulationSpeed:
+        rt->simulator->setSimulationSpeed(command.value);
+        break;
+    case ControlCommand::Type::SimulationFrequency:
+        rt->simulator->setSimulationFrequency(static_cast<int>(command.value));
+        break;
+    case ControlCommand::Type::MechanicalStepDivisor:
+        rt->simulator->setMechanicalStepDivisor(static_cast<int>(command.value));
+        break;
+    case ControlCommand::Type::QualityTier:
+        rt->simulator->setQualityTier(static_cast<Simulator::QualityTier>(static_cast<int>(command.value)));
+        break;
+    }
+}
+
+static void apply_queued_controls(es_runtime_t *rt) {
+    ControlCommand command;
+    while (rt->sim_thread.commands.pop(&command)) {
+        apply_control(rt, command);
+    }
+}
+
+// Applies a control right away, or queues it if the simulation thread owns
+// the simulation. Controls are expected to come from one thread.
+static void submit_control(es_runtime_t *rt, ControlCommand::Type type, double value) {
+    ControlCommand command;
+    command.type = type;
+    command.value = value;
+
+    if (!rt->sim_thread.running.load(std::memory_order_acquire)) {
+        apply_control(rt, command);
+    }
+    else if (!rt->sim_thread.commands.push(command)) {
+        std::fprintf(stderr, "engine-sim: control queue full, dropping command\n");
+    }
+}
+
+static bool read_snapshot(const es_runtime_t *rt, RuntimeSnapshot *snapshot) {
+    return rt->sim_thread.running.load(std::memory_order_acquire)
+        && rt->sim_thread.snapshot.read(snapshot);
+}
+
+static void fill_telemetry(const es_runtime_t *rt, es_telemetry_t *telemetry) {
+    Engine *engine = rt->engine;
+
+    telemetry->version = ES_TELEMETRY_VERSION;
+    telemetry->size = sizeof(es_telemetry_t);
+    telemetry->engine_speed_rpm = rt->simulator->filteredEngineSpeed();
+    telemetry->engine_speed_raw_rpm = engine->getRpm();
+    telemetry->throttle = engine->getThrottle();
+    telemetry->clutch_pressure = rt->transmission->getClutchPressure();
+    telemetry->gear = rt->transmission->getGear();
+    telemetry->manifold_pressure_pa = engine->getManifoldPressure();
+    telemetry->intake_afr = engine->getIntakeAfr();
+    telemetry->dyno_torque_nm = rt->simulator->getFilteredDynoTorque();
+    telemetry->vehicle_speed_mps = (rt->vehicle != nullptr) ? rt->vehicle->getSpeed() : 0.0;
+
+    telemetry->cylinder_count = std::min(engine->getCylinderCount(), ES_TELEMETRY_MAX_CYLINDERS);
+    for (int i = 0; i < telemetry->cylinder_count; ++i) {
+        const GasSystem &chamber = engine->getChamber(i)->m_system;
+        telemetry->cylinder_pressure_pa[i] = chamber.pressure();
+        telemetry->cylinder_temperature_k[i] = chamber.temperature();
+    }
+}
+
+static void publish_snapshot(es_runtime_t *rt) {
+    Simulator *sim = rt->simulator;
+
+    RuntimeSnapshot snapshot = {};
+    fill_telemetry(rt, &snapshot.telemetry);
+    snapshot.telemetry.frame = rt->sim_thread.snapshot.getVersion() + 1;
+    snapshot.simulation_speed = sim->getSimulationSpeed();
+    snapshot.simulation_frequency = sim->getFullQualitySimulationFrequency();
+    snapshot.mechanical_step_divisor = sim->getMechanicalStepDivisor();
+    snapshot.quality_tier = get_quality_tier(sim);
+    snapshot.has_solver_stats = get_solver_stats(sim, &snapshot.solver_stats);
+
+    rt->sim_thread.snapshot.publish(snapshot);
+}
+
+static void start_runtime_frame(es_runtime_t *rt, double dt_seconds) {
+    rt->simulator->startFrame(dt_seconds);
+
+    if (rt->fading.isFading()) {
+        rt->fading.simulator->startFrame(dt_seconds);
+    }
+}
+
+static void end_runtime_frame(es_runtime_t *rt) {
+    rt->simulator->endFrame();
+
+    // The outgoing engine keeps pace with the frame until it has faded out
+    FadingSimulation &fading = rt->fading;
+    if (fading.isFading()) {
+        if (fading.position.load(std::memory_order_acquire) >= fading.length) {
+            fading.release();
+        }
+        else {
+            while (fading.simulator->simulateStep()) {}
+            fading.simulator->endFrame();
+        }
+    }
+}
+
+// Runs frames as long as the thread is running, paced so the synthesizer
+// stays near its latency target (the simulator's latency control adjusts
+// each frame's step count)
+static void simulation_thread_main(es_runtime_t *rt) {
+    SimulationThread &thread = rt->sim_thread;
+
+    auto last = std::chrono::steady_clock::now();
+    while (thread.running.load(std::memory_order_acquire)) {
+        const auto frame_start = std::chrono::steady_clock::now();
+        const double dt = std::min(
+            std::chrono::duration<double>(frame_start - last).count(),
+            SimulationThreadMaxFrame);
+        last = frame_start;
+
+        double period = SimulationThreadMaxPeriod;
+        {
+            std::lock_guard<std::mutex> lock(thread.frame_lock);
+
+            apply_queued_controls(rt);
+            start_runtime_frame(rt, dt);
+            while (rt->simulator->simulateStep()) {
+                apply_queued_controls(rt);
+            }
+            end_runtime_frame(rt);
+
+            publish_snapshot(rt);
+
+            period = std::max(
+                SimulationThreadMinPeriod,
+                std::min(SimulationThreadMaxPeriod, rt->simulator->getSynthesizerInputLatencyTarget() / 4));
+        }
+
+        std::this_thread::sleep_until(
+            frame_start
+            + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(period)));
+    }
+}
+
+// Publishes a newly installed simulation's first snapshot, and starts the
+// thread if it's enabled
+static void resume_simulation_thread(es_runtime_t *rt) {
+    SimulationThread &thread = rt->sim_thread;
+    if (rt->simulator == nullptr || rt->engine == nullptr) return;
+    if (thread.running.load(std::memory_order_acquire)) return;
+
+    // Telemetry shouldn't report the previous engine
+    publish_snapshot(rt);
+    if (!thread.enabled) return;
+
+    thread.running.store(true, std::memory_order_release);
+    thread.worker = std::thread(simulation_thread_main, rt);
+}
+
+// Starts a prepared simulation's audio and hands it and its objects to the
+// runtime, which takes ownership
+static void install_simulation(es_runtime_t *rt, const ScriptObjects &objects, Simulator *sim) {
     sim->startAudioRenderingThread();
 
-    rt->engine = engine;
-    rt->vehicle = vehicle;
-    rt->transmission = transmission;
+    rt->engine = objects.engine;
+    rt->vehicle = objects.vehicle;
+    rt->transmission = objects.transmission;
+    rt->functions = objects.functions;
     rt->simulator = sim;
 
+    resume_simulation_thread(rt);
+}
+
+// rt->base_dir is where impulse responses are looked up
+static bool start_piston_simulation(es_runtime_t *rt, const ScriptObjects &objects) {
+    install_simulation(
+        rt,
+        objects,
+        prepare_piston_simulation(objects, rt->base_dir, rt->reduced_kinematics));
+
     return true;
+}
+
+extern "C" {
+
+es_runtime_t *es_runtime_create(void) {
+    return new es_runtime_t;
+}
+
+void es_runtime_destroy(es_runtime_t *rt) {
+    if (rt == nullptr) return;
+    rt->clear();
+    delete rt;
+}
+
+void es_runtime_set_reduced_kinematics(es_runtime_t *rt, bool enabled) {
+    if (rt == nullptr) return;
+    rt->reduced_kinematics = enabled;
+}
+
+bool es_runtime_has_simulation(const es_runtime_t *rt) {
+    return rt != nullptr && rt->simulator != nullptr && rt->engine != nullptr;
+}
+
+bool es_runtime_load_script(es_runtime_t *rt, const char *script_path) {
+    if (rt == nullptr || script_path == nullptr) return false;
+
+    rt->clear();
+
+    rt->base_dir = std::filesystem::path(script_path).parent_path();
+
+#ifdef ATG_ENGINE_SIM_PIRANHA_ENABLED
+    // Whatever a failed load leaves in the arena goes with the next clear()
+    rt->arena = create_arena();
+    Arena::Scope scope(rt->arena);
+
+    ScriptObjects objects;
+    if (!compile_script(script_path, rt->base_dir, &objects)) {
+        return false;
+    }
+
+    return start_piston_simulation(rt, objects);
 #else
     (void)script_path;
     return false;
 #endif
 }
 
+bool es_runtime_load_pack(es_runtime_t *rt, const char *pack_path) {
+    if (rt == nullptr || pack_path == nullptr) return false;
+
+    rt->clear();
+
+    rt->base_dir = std::filesystem::path(pack_path).parent_path();
+
+    rt->arena = create_arena();
+    Arena::Scope scope(rt->arena);
+
+    ScriptObjects objects;
+    if (!load_pack_objects(pack_path, &objects)) {
+        std::fprintf(stderr, "engine-sim: failed to load engine pack: %s\n", pack_path);
+        return false;
+    }
+
+    return start_piston_simulation(rt, objects);
+}
+
+es_load_t *es_runtime_load_script_async(es_runtime_t *rt, const char *script_path) {
+    if (rt == nullptr || script_path == nullptr) return nullptr;
+
+#ifdef ATG_ENGINE_SIM_PIRANHA_ENABLED
+    es_load_t *load = new es_load_t;
+    load->script_path = script_path;
+    load->base_dir = std::filesystem::path(script_path).parent_path();
+    load->reduced_kinematics = rt->reduced_kinematics;
+    load->arena = create_arena();
+
+    load->worker = std::thread([load]() {
+        Arena::Scope scope(load->arena);
+
+        if (!compile_script(load->script_path.c_str(), load->base_dir, &load->objects)) {
+            std::fprintf(stderr, "engine-sim: background load failed: %s\n", load->script_path.c_str());
+            load->status.store(ES_LOAD_FAILED, std::memory_order_release);
+            return;
+        }
+
+        load->simulator =
+            prepare_piston_simulation(load->objects, load->base_dir, load->reduced_kinematics);
+        load->status.store(ES_LOAD_READY, std::memory_order_release);
+    });
+
+    return load;
+#else
+    return nullptr;
+#endif
+}
+
+es_load_status_t es_load_get_status(const es_load_t *load) {
+    if (load == nullptr) return ES_LOAD_FAILED;
+    return static_cast<es_load_status_t>(load->status.load(std::memory_order_acquire));
+}
+
+es_load_status_t es_load_wait(es_load_t *load) {
+    if (load == nullptr) return ES_LOAD_FAILED;
+    if (load->worker.joinable()) load->worker.join();
+    return es_load_get_status(load);
+}
+
+bool es_runtime_swap_load(es_runtime_t *rt, es_load_t *load, double crossfade_seconds) {
+    if (rt == nullptr || load == nullptr) return false;
+    if (es_load_wait(load) != ES_LOAD_READY || load->simulator == nullptr) return false;
+
+    // Between frames if the simulation thread is running
+    std::lock_guard<std::mutex> lock(rt->sim_thread.frame_lock);
+
+    // Only one engine fades out at a time
+    rt->fading.release();
+
+    int fade_samples = 0;
+    if (crossfade_seconds > 0 && rt->simulator != nullptr && rt->simulator->isSynthesizerEnabled()) {
+        fade_samples = static_cast<int>(crossfade_seconds * rt->simulator->synthesizer().getAudioSampleRate());
+    }
+
+    FadingSimulation &fading = rt->fading;
+    if (fade_samples > 0) {
+        std::swap(fading.engine, rt->engine);
+        std::swap(fading.vehicle, rt->vehicle);
+        std::swap(fading.transmission, rt->transmission);
+        std::swap(fading.simulator, rt->simulator);
+        std::swap(fading.engine_map, rt->engine_map);
+        std::swap(fading.arena, rt->arena);
+        std::swap(fading.functions, rt->functions);
+        fading.length = fade_samples;
+        fading.position.store(0, std::memory_order_release);
+    }
+
+    // Whatever isn't fading out is replaced right away
+    release_simulation(rt->simulator, rt->engine_map, rt->engine, rt->vehicle, rt->transmission, rt->arena);
+    rt->functions.reset();
+
+    rt->base_dir = load->base_dir;
+    rt->arena = load->arena;
+    install_simulation(rt, load->objects, load->simulator);
+
+    load->objects = ScriptObjects();
+    load->simulator = nullptr;
+    load->arena = nullptr;
+
+    return true;
+}
+
+void es_load_release(es_load_t *load) {
+    if (load == nullptr) return;
+    load->release();
+    delete load;
+}
+
+void es_runtime_clear_compilation_cache(void) {
+    s_compilation_cache.clear();
+}
+
+es_runtime_t *es_runtime_clone(const es_runtime_t *prototype) {
+    if (prototype == nullptr || prototype->engine == nullptr || prototype->simulator == nullptr) return nullptr;
+
+    // A running simulation thread on the prototype waits until the clone is done
+    std::lock_guard<std::mutex> prototype_lock(prototype->sim_thread.frame_lock);
+
+    Simulator *source = prototype->simulator;
+
+    EnginePack::Objects definition;
+    definition.engine = prototype->engine;
+    definition.vehicle = prototype->vehicle;
+    definition.transmission = prototype->transmission;
+    definition.simulatorParameters = source->getParameters();
+
+    // Keeps a pack's functions alive for as long as any clone uses them. A
+    // script's are never freed, so they have no reference to share.
+    definition.functions = prototype->functions;
+
+    // The clone's buffers are the same sizes as the prototype's, so its
+    // arena can be sized to fit them in one chunk
+    es_runtime_t *rt = new es_runtime_t;
+    rt->base_dir = prototype->base_dir;
+    rt->reduced_kinematics = prototype->reduced_kinematics;
+    const size_t prototype_used = (prototype->arena != nullptr) ? prototype->arena->getUsed() : 0;
+    rt->arena = create_arena((prototype_used > 0) ? prototype_used : Arena::DefaultChunkSize);
+
+    Arena::Scope scope(rt->arena);
+
+    EnginePack::Objects instance;
+    EnginePack::instantiate(definition, &instance);
+    if (instance.engine == nullptr) {
+        es_runtime_destroy(rt);
+        return nullptr;
+    }
+
+    ScriptObjects objects;
+    objects.engine = instance.engine;
+    objects.vehicle = instance.vehicle;
+    objects.transmission = instance.transmission;
+    objects.simulatorParameters = instance.simulatorParameters;
+    objects.functions = instance.functions;
+
+    Simulator *sim = nullptr;
+    if (prototype->engine_map != nullptr) {
+        const EngineMap *map = prototype->engine_map;
+
+        EngineMap::Parameters mapParams;
+        mapParams.speedSamples = map->getSpeedSampleCount();
+        mapParams.speedControlSamples = map->getSpeedControlSampleCount();
+        mapParams.minSpeed = map->getMinSpeed();
+        mapParams.maxSpeed = map->getMaxSpeed();
+
+        rt->engine_map = new EngineMap;
+        rt->engine_map->initialize(mapParams);
+        for (int i = 0; i < mapParams.speedSamples; ++i) {
+            rt->engine_map->setMotoringTorque(i, map->getMotoringTorque(i));
+            for (int j = 0; j < mapParams.speedControlSamples; ++j) {
+                rt->engine_map->setSample(i, j, map->getSample(i, j));
+            }
+        }
+
+        auto *meanValue = new MeanValueSimulator;
+        meanValue->initialize(objects.simulatorParameters);
+        meanValue->setSimulationFrequency(MeanValueSimulationFrequency);
+        meanValue->loadSimulation(objects.engine, objects.vehicle, objects.transmission, rt->engine_map);
+        objects.engine->calculateDisplacement();
+        sim = meanValue;
+
+        rt->engine = objects.engine;
+        rt->vehicle = objects.vehicle;
+        rt->transmission = objects.transmission;
+        rt->functions = objects.functions;
+        rt->simulator = sim;
+
+        resume_simulation_thread(rt);
+    }
+    else {
+        auto *piston = static_cast<PistonEngineSimulator *>(source);
+        PistonEngineSimulator *clone = prepare_piston_simulation(
+            objects,
+            rt->base_dir,
+            piston->getKinematics() == PistonEngineSimulator::Kinematics::ReducedCoordinates,
+            &source->synthesizer());
+        clone->setSimulationFrequency(source->getFullQualitySimulationFrequency());
+        clone->setFluidSimulationSteps(piston->getFluidSimulationSteps());
+        clone->synthesizer().setAudioParameters(source->synthesizer().getAudioParameters());
+        sim = clone;
+
+        install_simulation(rt, objects, clone);
+    }
+
+    sim->setMechanicalStepDivisor(source->getMechanicalStepDivisor());
+    sim->setSimulationSpeed(source->getSimulationSpeed());
+
+    return rt;
+}
+
+bool es_runtime_export_pack(const char *script_path, const char *out_pack_path) {
+    if (script_path == nullptr || out_pack_path == nullptr) return false;
+
+#ifdef ATG_ENGINE_SIM_PIRANHA_ENABLED
+    ScriptObjects objects;
+    if (!compile_script(script_path, std::filesystem::path(script_path).parent_path(), &objects)) {
+        return false;
+    }
+
+    EnginePack::Objects pack;
+    pack.engine = objects.engine;
+    pack.vehicle = objects.vehicle;
+    pack.transmission = objects.transmission;
+    pack.simulatorParameters = objects.simulatorParameters;
+    const bool written = EnginePack::save(pack, out_pack_path);
+
+    release_script_objects(&objects);
+
+    return written;
+#else
+    return false;
+#endif
+}
+
+bool es_runtime_build_engine_map(const char *script_path, const char *out_map_path) {
+    if (script_path == nullptr || out_map_path == nullptr) return false;
+
+#ifdef ATG_ENGINE_SIM_PIRANHA_ENABLED
+    ScriptObjects objects;
+    if (!compile_script(script_path, std::filesystem::path(script_path).parent_path(), &objects)) {
+        return false;
+    }
+
+    EngineMap map;
+    EngineMapBuilder builder;
+    const bool built = builder.build(
+        objects.engine,
+        objects.vehicle,
+        objects.transmission,
+        EngineMapBuilder::Parameters(),
+        &map);
+    const bool written = built && map.write(out_map_path);
+
+    map.destroy();
+    release_script_objects(&objects);
+
+    return written;
+#else
+    return false;
+#endif
+}
+
+bool es_runtime_load_script_mean_value(es_runtime_t *rt, const char *script_path, const char *map_path) {
+    if (rt == nullptr || script_path == nullptr) return false;
+
+    rt->clear();
+
+    rt->base_dir = std::filesystem::path(script_path).parent_path();
+
+#ifdef ATG_ENGINE_SIM_PIRANHA_ENABLED
+    rt->arena = create_arena();
+    Arena::Scope scope(rt->arena);
+
+    ScriptObjects objects;
+    if (!compile_script(script_path, rt->base_dir, &objects)) {
+        return false;
+    }
+
+    EngineMap *map = new EngineMap;
+    if (map_path == nullptr || !map->read(map_path)) {
+        // The builder's own simulations are temporary
+        Arena::Scope builderScope(nullptr);
+
+        EngineMapBuilder builder;
+        if (!builder.build(
+            objects.engine,
+            objects.vehicle,
+            objects.transmission,
+            EngineMapBuilder::Parameters(),
+            map))
+        {
+            map->destroy();
+            delete map;
+            release_script_objects(&objects);
+            return false;
+        }
+
+        if (map_path != nullptr && !map->write(map_path)) {
+            std::fprintf(stderr, "engine-sim: failed to write engine map: %s\n", map_path);
+        }
+    }
+
+    auto *sim = new MeanValueSimulator;
+    sim->initialize(objects.simulatorParameters);
+    sim->setSimulationFrequency(MeanValueSimulationFrequency);
+    sim->loadSimulation(objects.engine, objects.vehicle, objects.transmission, map);
+
+    objects.engine->calculateDisplacement();
+
+    rt->engine = objects.engine;
+    rt->vehicle = objects.vehicle;
+    rt->transmission = objects.transmission;
+    rt->functions = objects.functions;
+    rt->simulator = sim;
+    rt->engine_map = map;
+
+    resume_simulation_thread(rt);
+
+    return true;
+#else
+    (void)map_path;
+    return false;
+#endif
+}
+
+int es_runtime_dyno_sweep(
+    const char *script_path,
+    double min_rpm,
+    double max_rpm,
+    double step_rpm,
+    int instances,
+    es_dyno_point_t *out_points,
+    int max_points)
+{
+    if (script_path == nullptr) return -1;
+
+#ifdef ATG_ENGINE_SIM_PIRANHA_ENABLED
+    if (instances <= 0) {
+        instances = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    // Instances are all loaded before any sweep thread starts
+    const std::filesystem::path base_dir = std::filesystem::path(script_path).parent_path();
+    std::vector<ScriptObjects> objects(instances);
+    std::vector<DynoSweep::Instance> sweepInstances(instances);
+    bool loaded = true;
+    for (int i = 0; i < instances && loaded; ++i) {
+        loaded = compile_script(script_path, base_dir, &objects[i]);
+        sweepInstances[i].engine = objects[i].engine;
+        sweepInstances[i].vehicle = objects[i].vehicle;
+        sweepInstances[i].transmission = objects[i].transmission;
+    }
+
+    int pointCount = -1;
+    if (loaded) {
+        DynoSweep::Parameters params;
+        if (min_rpm > 0) params.minSpeed = units::rpm(min_rpm);
+        if (max_rpm > 0) params.maxSpeed = units::rpm(max_rpm);
+        if (step_rpm > 0) params.speedStep = units::rpm(step_rpm);
+
+        DynoSweep sweep;
+        if (sweep.run(sweepInstances.data(), instances, params)) {
+            pointCount = sweep.getPointCount();
+            for (int i = 0; i < pointCount && i < max_points && out_points != nullptr; ++i) {
+                const DynoSweep::Point &point = sweep.getPoint(i);
+                out_points[i].rpm = units::toRpm(point.speed);
+                out_points[i].torque_nm = point.torque;
+                out_points[i].power_w = point.power;
+                out_points[i].settled = point.settled;
+            }
+        }
+
+        sweep.destroy();
+    }
+
+    for (ScriptObjects &instance : objects) {
+        release_script_objects(&instance);
+    }
+
+    return pointCount;
+#else
+    (void)min_rpm;
+    (void)max_rpm;
+    (void)step_rpm;
+    (void)instances;
+    (void)out_points;
+    (void)max_points;
+    return -1;
+#endif
+}
+
 void es_runtime_set_speed_control(es_runtime_t *rt, double speed_control_0_to_1) {
     if (rt == nullptr || rt->engine == nullptr) return;
-    rt->engine->setSpeedControl(clamp01(speed_control_0_to_1));
+    submit_control(rt, ControlCommand::Type::SpeedControl, clamp01(speed_control_0_to_1));
 }
 
 void es_runtime_set_throttle(es_runtime_t *rt, double throttle_0_to_1) {
     if (rt == nullptr || rt->engine == nullptr) return;
-    rt->engine->setThrottle(clamp01(throttle_0_to_1));
+    submit_control(rt, ControlCommand::Type::Throttle, clamp01(throttle_0_to_1));
 }
 
 double es_runtime_get_throttle(const es_runtime_t *rt) {
     if (rt == nullptr || rt->engine == nullptr) return 0.0;
+
+    RuntimeSnapshot snapshot;
+    if (read_snapshot(rt, &snapshot)) return snapshot.telemetry.throttle;
+
     return rt->engine->getThrottle();
 }
 
 void es_runtime_set_starter_enabled(es_runtime_t *rt, bool enabled) {
     if (rt == nullptr || rt->simulator == nullptr) return;
-    rt->simulator->m_starterMotor.m_enabled = enabled;
+    submit_control(rt, ControlCommand::Type::StarterEnabled, enabled ? 1.0 : 0.0);
 }
 
 void es_runtime_set_ignition_enabled(es_runtime_t *rt, bool enabled) {
     if (rt == nullptr || rt->engine == nullptr) return;
-    IgnitionModule *ignition = rt->engine->getIgnitionModule();
-    if (ignition != nullptr) {
-        ignition->m_enabled = enabled;
-    }
+    submit_control(rt, ControlCommand::Type::IgnitionEnabled, enabled ? 1.0 : 0.0);
 }
 
 void es_runtime_start_frame(es_runtime_t *rt, double dt_seconds) {
     if (rt == nullptr || rt->simulator == nullptr) return;
-    rt->simulator->startFrame(dt_seconds);
+    if (rt->sim_thread.running.load(std::memory_order_acquire)) return;
+    start_runtime_frame(rt, dt_seconds);
 }
 
 bool es_runtime_simulate_step(es_runtime_t *rt) {
     if (rt == nullptr || rt->simulator == nullptr) return false;
+    if (rt->sim_thread.running.load(std::memory_order_acquire)) return false;
     return rt->simulator->simulateStep();
 }
 
 void es_runtime_end_frame(es_runtime_t *rt) {
     if (rt == nullptr || rt->simulator == nullptr) return;
-    rt->simulator->endFrame();
+    if (rt->sim_thread.running.load(std::memory_order_acquire)) return;
+    end_runtime_frame(rt);
+    publish_snapshot(rt);
+}
+
+void es_runtime_set_simulation_thread_enabled(es_runtime_t *rt, bool enabled) {
+    if (rt == nullptr) return;
+
+    SimulationThread &thread = rt->sim_thread;
+    thread.enabled = enabled;
+    if (enabled) {
+        resume_simulation_thread(rt);
+    }
+    else {
+        thread.stop();
+        apply_queued_controls(rt);
+    }
+}
+
+bool es_runtime_is_simulation_thread_enabled(const es_runtime_t *rt) {
+    return rt != nullptr && rt->sim_thread.enabled;
 }
 
 int es_runtime_read_audio(es_runtime_t *rt, int samples, int16_t *out_pcm16) {
     if (rt == nullptr || rt->simulator == nullptr || out_pcm16 == nullptr || samples <= 0) return 0;
-    return rt->simulator->readAudioOutput(samples, out_pcm16);
+
+    // Mean-value runtimes never initialize a synthesizer
+    if (!rt->simulator->isSynthesizerEnabled()) {
+        std::fill(out_pcm16, out_pcm16 + samples, static_cast<int16_t>(0));
+        return 0;
+    }
+
+    const int read = rt->simulator->readAudioOutput(samples, out_pcm16);
+
+    // Equal-power crossfade from an engine that was swapped out
+    FadingSimulation &fading = rt->fading;
+    const int position = fading.position.load(std::memory_order_acquire);
+    if (position < fading.length) {
+        const int count = std::min(samples, fading.length - position);
+
+        int16_t outgoing[256];
+        for (int offset = 0; offset < count; offset += 256) {
+            const int n = std::min(count - offset, 256);
+            fading.simulator->readAudioOutput(n, outgoing);
+
+            for (int i = 0; i < n; ++i) {
+                const double t = static_cast<double>(position + offset + i) / fading.length;
+                const double mixed =
+                    std::sin(t * constants::pi / 2) * out_pcm16[offset + i]
+                    + std::cos(t * constants::pi / 2) * outgoing[i];
+                out_pcm16[offset + i] =
+                    static_cast<int16_t>(std::lround(std::max(-32768.0, std::min(32767.0, mixed))));
+            }
+        }
+
+        fading.position.store(position + count, std::memory_order_release);
+    }
+
+    return read;
 }
 
 void es_runtime_wait_audio_processed(es_runtime_t *rt) {
     if (rt == nullptr || rt->simulator == nullptr) return;
+    if (!rt->simulator->isSynthesizerEnabled()) return;
     rt->simulator->synthesizer().waitProcessed();
 }
 
+bool es_runtime_render_offline(
+    es_runtime_t *rt,
+    const es_control_point_t *control_track,
+    int control_point_count,
+    double seconds,
+    const char *out_wav_path)
+{
+    if (rt == nullptr || rt->simulator == nullptr || out_wav_path == nullptr) return false;
+    if (seconds <= 0 || control_point_count < 0) return false;
+
+    std::vector<OfflineRenderer::ControlPoint> track;
+    if (control_track != nullptr) {
+        track.resize(control_point_count);
+        for (int i = 0; i < control_point_count; ++i) {
+            OfflineRenderer::ControlPoint &point = track[i];
+            point.time = control_track[i].time;
+            point.speedControl = control_track[i].speed_control;
+            point.starterEnabled = control_track[i].starter_enabled;
+            point.ignitionEnabled = control_track[i].ignition_enabled;
+            point.gear = control_track[i].gear;
+            point.clutchPressure = control_track[i].clutch_pressure;
+        }
+    }
+
+    OfflineRenderer::Parameters params;
+    params.duration = seconds;
+
+    std::lock_guard<std::mutex> lock(rt->sim_thread.frame_lock);
+
+    OfflineRenderer renderer;
+    if (!renderer.render(
+        rt->simulator,
+        track.data(),
+        static_cast<int>(track.size()),
+        params,
+        out_wav_path))
+    {
+        std::fprintf(stderr, "engine-sim: offline render to %s failed\n", out_wav_path);
+        return false;
+    }
+
+    return true;
+}
+
+bool es_runtime_save_state(es_runtime_t *rt, const char *path) {
+    if (rt == nullptr || rt->simulator == nullptr || path == nullptr) return false;
+
+    std::lock_guard<std::mutex> lock(rt->sim_thread.frame_lock);
+    return rt->simulator->saveState(path);
+}
+
+bool es_runtime_load_state(es_runtime_t *rt, const char *path) {
+    if (rt == nullptr || rt->simulator == nullptr || path == nullptr) return false;
+
+    std::lock_guard<std::mutex> lock(rt->sim_thread.frame_lock);
+    if (!rt->simulator->loadState(path)) {
+        std::fprintf(stderr, "engine-sim: failed to load state from %s\n", path);
+        return false;
+    }
+
+    return true;
+}
+
 double es_runtime_get_engine_speed(es_runtime_t *rt) {
     if (rt == nullptr || rt->simulator == nullptr) return 0.0;
+
+    RuntimeSnapshot snapshot;
+    if (read_snapshot(rt, &snapshot)) return snapshot.telemetry.engine_speed_rpm;
+
     return rt->simulator->filteredEngineSpeed();
 }
 
 double es_runtime_get_engine_speed_raw(es_runtime_t *rt) {
     if (rt == nullptr || rt->engine == nullptr) return 0.0;
+
+    RuntimeSnapshot snapshot;
+    if (read_snapshot(rt, &snapshot)) return snapshot.telemetry.engine_speed_raw_rpm;
+
     return rt->engine->getRpm();
 }
 
 void es_runtime_set_simulation_speed(es_runtime_t *rt, double speed) {
     if (rt == nullptr || rt->simulator == nullptr) return;
-    rt->simulator->setSimulationSpeed(speed);
+    submit_control(rt, ControlCommand::Type::SimulationSpeed, speed);
 }
 
 double es_runtime_get_simulation_speed(es_runtime_t *rt) {
     if (rt == nullptr || rt->simulator == nullptr) return 1.0;
+
+    RuntimeSnapshot snapshot;
+    if (read_snapshot(rt, &snapshot)) return snapshot.simulation_speed;
+
     return rt->simulator->getSimulationSpeed();
 }
 
 void es_runtime_set_simulation_frequency(es_runtime_t *rt, double freq) {
     if (rt == nullptr || rt->simulator == nullptr) return;
-    rt->simulator->setSimulationFrequency(freq);
+    submit_control(rt, ControlCommand::Type::SimulationFrequency, freq);
 }
 
 double es_runtime_get_simulation_frequency(es_runtime_t *rt) {
     if (rt == nullptr || rt->simulator == nullptr) return 10000.0;
-    return rt->simulator->getSimulationFrequency();
+
+    RuntimeSnapshot snapshot;
+    if (read_snapshot(rt, &snapshot)) return snapshot.simulation_frequency;
+
+    return rt->simulator->getFullQualitySimulationFrequency();
+}
+
+void es_runtime_set_mechanical_step_divisor(es_runtime_t *rt, int divisor) {
+    if (rt == nullptr || rt->simulator == nullptr) return;
+    submit_control(rt, ControlCommand::Type::MechanicalStepDivisor, divisor);
+}
+
+int es_runtime_get_mechanical_step_divisor(const es_runtime_t *rt) {
+    if (rt == nullptr || rt->simulator == nullptr) return 1;
+
+    RuntimeSnapshot snapshot;
+    if (read_snapshot(rt, &snapshot)) return snapshot.mechanical_step_divisor;
+
+    return rt->simulator->getMechanicalStepDivisor();
+}
+
+void es_runtime_set_quality_tier(es_runtime_t *rt, es_quality_tier_t tier) {
+    if (rt == nullptr || rt->simulator == nullptr) return;
+
+    switch (tier) {
+    case ES_QUALITY_TIER_FULL:
+        submit_control(rt, ControlCommand::Type::QualityTier, static_cast<int>(Simulator::QualityTier::Full));
+        break;
+    case ES_QUALITY_TIER_REDUCED:
+        submit_control(rt, ControlCommand::Type::QualityTier, static_cast<int>(Simulator::QualityTier::Reduced));
+        break;
+    case ES_QUALITY_TIER_PHYSICS_ONLY:
+        submit_control(rt, ControlCommand::Type::QualityTier, static_cast<int>(Simulator::QualityTier::PhysicsOnly));
+        break;
+    case ES_QUALITY_TIER_FROZEN:
+        submit_control(rt, ControlCommand::Type::QualityTier, static_cast<int>(Simulator::QualityTier::Frozen));
+        break;
+    }
+}
+
+es_quality_tier_t es_runtime_get_quality_tier(const es_runtime_t *rt) {
+    if (rt == nullptr || rt->simulator == nullptr) return ES_QUALITY_TIER_FULL;
+
+    RuntimeSnapshot snapshot;
+    if (read_snapshot(rt, &snapshot)) return snapshot.quality_tier;
+
+    return get_quality_tier(rt->simulator);
+}
+
+bool es_runtime_get_memory_usage(const es_runtime_t *rt, es_memory_usage_t *out_usage) {
+    if (rt == nullptr || rt->simulator == nullptr || rt->arena == nullptr || out_usage == nullptr) return false;
+
+    const Arena *arena = rt->arena;
+    out_usage->engine_bytes = arena->getUsed(Arena::Category::Engine);
+    out_usage->simulation_bytes = arena->getUsed(Arena::Category::Simulation);
+    out_usage->synthesizer_bytes = arena->getUsed(Arena::Category::Synthesizer);
+    out_usage->arena_used_bytes = arena->getUsed();
+    out_usage->arena_reserved_bytes = arena->getReserved();
+
+    return true;
+}
+
+bool es_runtime_get_telemetry(const es_runtime_t *rt, es_telemetry_t *out_telemetry, uint32_t flags) {
+    if (rt == nullptr || rt->simulator == nullptr || out_telemetry == nullptr) return false;
+
+    const uint32_t size = out_telemetry->size;
+    if (size < offsetof(es_telemetry_t, cylinder_count)) return false;
+
+    RuntimeSnapshot snapshot;
+    if (!rt->sim_thread.snapshot.read(&snapshot)) return false;
+
+    es_telemetry_t &telemetry = snapshot.telemetry;
+    size_t copied = std::min<size_t>(size, sizeof(es_telemetry_t));
+    if ((flags & ES_TELEMETRY_CYLINDERS) == 0) {
+        telemetry.cylinder_count = 0;
+        copied = std::min(copied, offsetof(es_telemetry_t, cylinder_pressure_pa));
+    }
+
+    std::memcpy(out_telemetry, &telemetry, copied);
+    out_telemetry->size = size;
+
+    return true;
+}
+
+bool es_runtime_get_solver_stats(const es_runtime_t *rt, es_solver_stats_t *out_stats) {
+    if (rt == nullptr || rt->simulator == nullptr || out_stats == nullptr) return false;
+
+    RuntimeSnapshot snapshot;
+    if (read_snapshot(rt, &snapshot)) {
+        if (snapshot.has_solver_stats) *out_stats = snapshot.solver_stats;
+        return snapshot.has_solver_stats;
+    }
+
+    return get_solver_stats(rt->simulator, out_stats);
 }
 
 void es_runtime_set_gear(es_runtime_t *rt, int gear) {
     if (rt == nullptr || rt->transmission == nullptr) return;
-    rt->transmission->changeGear(gear);
+    submit_control(rt, ControlCommand::Type::Gear, gear);
 }
 
 int es_runtime_get_gear(es_runtime_t *rt) {
     if (rt == nullptr || rt->transmission == nullptr) return 0;
+
+    RuntimeSnapshot snapshot;
+    if (read_snapshot(rt, &snapshot)) return snapshot.telemetry.gear;
+
     return rt->transmission->getGear();
 }
 
@@ -465,11 +1625,15 @@ int es_runtime_get_gear_count(es_runtime_t *rt) {
 
 void es_runtime_set_clutch_pressure(es_runtime_t *rt, double pressure_0_to_1) {
     if (rt == nullptr || rt->transmission == nullptr) return;
-    rt->transmission->setClutchPressure(clamp01(pressure_0_to_1));
+    submit_control(rt, ControlCommand::Type::ClutchPressure, clamp01(pressure_0_to_1));
 }
 
 double es_runtime_get_clutch_pressure(es_runtime_t *rt) {
     if (rt == nullptr || rt->transmission == nullptr) return 0.0;
+
+    RuntimeSnapshot snapshot;
+    if (read_snapshot(rt, &snapshot)) return snapshot.telemetry.clutch_pressure;
+
     return rt->transmission->getClutchPressure();
 }
 
@@ -79,3 +79,17 @@ void ExhaustSystem::process(double dt) {
     m_system.dissipateExcessVelocity();
     m_system.updateVelocity(dt, m_velocityDecay);
 }
+
+void ExhaustSystem::writeState(StateWriter *writer) const {
+    m_system.writeState(writer);
+    m_atmosphere.writeState(writer);
+
+    writer->write(m_flow);
+}
+
+void ExhaustSystem::readState(StateReader *reader) {
+    m_system.readState(reader);
+    m_atmosphere.readState(reader);
+
+    reader->read(&m_flow);
+}
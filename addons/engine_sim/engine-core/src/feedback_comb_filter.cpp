@@ -1,5 +1,7 @@
 #include "../include/feedback_comb_filter.h"
 
+#include "../include/arena.h"
+
 #include <assert.h>
 
 FeedbackCombFilter::FeedbackCombFilter() {
@@ -15,7 +17,7 @@ FeedbackCombFilter::~FeedbackCombFilter() {
 
 void FeedbackCombFilter::initialize(int M) {
     this->M = M;
-    m_y = new float[M];
+    m_y = Arena::allocate<float>(M);
     m_offset = 0;
 }
 
@@ -31,7 +33,7 @@ float FeedbackCombFilter::f(float sample) {
 }
 
 void FeedbackCombFilter::destroy() {
-    delete[] m_y;
+    Arena::free(m_y);
 
     m_y = nullptr;
 }
@@ -15,3 +15,11 @@ float Filter::f(float sample) {
 void Filter::destroy() {
     /* void */
 }
+
+void Filter::writeState(StateWriter *writer) const {
+    /* void */
+}
+
+void Filter::readState(StateReader *reader) {
+    /* void */
+}
@@ -4,8 +4,7 @@
 #include <string.h>
 #include <assert.h>
 #include <cmath>
-
-GaussianFilter *Function::DefaultGaussianFilter = nullptr;
+#include <vector>
 
 Function::Function() {
     m_x = m_y = nullptr;
@@ -16,17 +15,30 @@ Function::Function() {
     m_inputScale = 1.0;
     m_outputScale = 1.0;
 
-    if (DefaultGaussianFilter == nullptr) {
-        DefaultGaussianFilter = new GaussianFilter;
-        DefaultGaussianFilter->initialize(1.0, 3.0, 1024);
-    }
-
     m_gaussianFilter = nullptr;
+
+    m_compiled = nullptr;
+    m_compiledSize = 0;
+    m_compiledX0 = 0;
+    m_compiledInvStep = 0;
+}
+
+GaussianFilter *Function::getDefaultGaussianFilter() {
+    // Scripts are compiled on loader threads, so this can't be a lazily set
+    // pointer
+    static GaussianFilter *filter = [] {
+        GaussianFilter *f = new GaussianFilter;
+        f->initialize(1.0, 3.0, 1024);
+        return f;
+    }();
+
+    return filter;
 }
 
 Function::~Function() {
     assert(m_x == nullptr);
     assert(m_y == nullptr);
+    assert(m_compiled == nullptr);
 }
 
 void Function::initialize(int size, double filterRadius, GaussianFilter *filter) {
@@ -36,7 +48,7 @@ void Function::initialize(int size, double filterRadius, GaussianFilter *filter)
 
     m_gaussianFilter = (filter != nullptr)
         ? filter
-        : DefaultGaussianFilter;
+        : getDefaultGaussianFilter();
 }
 
 void Function::resize(int newCapacity) {
@@ -66,9 +78,21 @@ void Function::destroy() {
 
     m_capacity = 0;
     m_size = 0;
+
+    clearCompiled();
+}
+
+void Function::setInputScale(double s) {
+    if (s != m_inputScale) {
+        clearCompiled();
+    }
+
+    m_inputScale = s;
 }
 
 void Function::addSample(double x, double y) {
+    clearCompiled();
+
     if (m_size + 1 > m_capacity) {
         resize(m_capacity * 2 + 1);
     }
@@ -101,13 +125,125 @@ void Function::addSample(double x, double y) {
     m_y[index] = y;
 }
 
+void Function::addSamples(const double *x, const double *y, int count) {
+    if (count <= 0) return;
+
+    clearCompiled();
+
+    if (m_size + count > m_capacity) {
+        resize(m_size + count);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        m_x[m_size + i] = x[i];
+        m_y[m_size + i] = y[i];
+        m_yMin = std::fmin(m_yMin, y[i]);
+        m_yMax = std::fmax(m_yMax, y[i]);
+    }
+
+    m_size += count;
+    if (isOrdered()) return;
+
+    // Equal inputs keep the order they were added in
+    std::vector<int> order(m_size);
+    for (int i = 0; i < m_size; ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return m_x[a] < m_x[b];
+    });
+
+    std::vector<double> sorted_x(m_size), sorted_y(m_size);
+    for (int i = 0; i < m_size; ++i) {
+        sorted_x[i] = m_x[order[i]];
+        sorted_y[i] = m_y[order[i]];
+    }
+
+    memcpy(m_x, sorted_x.data(), sizeof(double) * m_size);
+    memcpy(m_y, sorted_y.data(), sizeof(double) * m_size);
+}
+
+bool Function::compile(int resolution, double maxError) {
+    clearCompiled();
+    if (m_size < 2 || m_x[0] >= m_x[m_size - 1]) return false;
+
+    const double x0 = m_x[0];
+    const double x1 = m_x[m_size - 1];
+    const double tolerance = maxError * (m_yMax - m_yMin);
+
+    for (int n = std::max(resolution, 1); n <= MaxCompiledResolution; n *= 2) {
+        const double step = (x1 - x0) / n;
+        double *table = new double[n + 1];
+        for (int i = 0; i <= n; ++i) {
+            table[i] = evaluateTriangle((i == n) ? x1 : x0 + i * step);
+        }
+
+        // The filtered function has kinks where samples enter or leave the
+        // filter, so check inside every cell as well as at the samples
+        double error = 0;
+        for (int i = 0; i < n && error <= tolerance; ++i) {
+            for (int j = 1; j < 4; ++j) {
+                const double t = j / 4.0;
+                const double exact = evaluateTriangle(x0 + (i + t) * step);
+                const double lerp = table[i] + (table[i + 1] - table[i]) * t;
+                error = std::fmax(error, std::abs(exact - lerp));
+            }
+        }
+
+        for (int i = 1; i < m_size - 1 && error <= tolerance; ++i) {
+            const double u = (m_x[i] - x0) / step;
+            const int cell = std::min(static_cast<int>(u), n - 1);
+            const double t = u - cell;
+            const double lerp = table[cell] + (table[cell + 1] - table[cell]) * t;
+            error = std::fmax(error, std::abs(evaluateTriangle(m_x[i]) - lerp));
+        }
+
+        if (error <= tolerance) {
+            m_compiled = table;
+            m_compiledSize = n + 1;
+            m_compiledX0 = x0;
+            m_compiledInvStep = n / (x1 - x0);
+            return true;
+        }
+
+        delete[] table;
+    }
+
+    return false;
+}
+
+void Function::clearCompiled() {
+    delete[] m_compiled;
+
+    m_compiled = nullptr;
+    m_compiledSize = 0;
+    m_compiledX0 = 0;
+    m_compiledInvStep = 0;
+}
+
 double Function::sampleTriangle(double x) const {
-    x *= m_inputScale;
+    if (m_compiled == nullptr) {
+        return sampleTriangleExact(x);
+    }
+
+    const double u = (x * m_inputScale - m_compiledX0) * m_compiledInvStep;
+    const int last = m_compiledSize - 1;
+    if (!(u > 0)) return m_compiled[0] * m_outputScale;
+    else if (u >= last) return m_compiled[last] * m_outputScale;
+
+    const int i = static_cast<int>(u);
+    const double t = u - i;
+    return (m_compiled[i] + (m_compiled[i + 1] - m_compiled[i]) * t) * m_outputScale;
+}
+
+double Function::sampleTriangleExact(double x) const {
+    return evaluateTriangle(x * m_inputScale) * m_outputScale;
+}
+
+double Function::evaluateTriangle(double x) const {
     const int closest = closestSample(x);
 
     if (m_size == 0) return 0;
-    else if (x >= m_x[m_size - 1]) return m_y[m_size - 1] * m_outputScale;
-    else if (x <= m_x[0]) return m_y[0] * m_outputScale;
+    else if (x >= m_x[m_size - 1]) return m_y[m_size - 1];
+    else if (x <= m_x[0]) return m_y[0];
 
     double sum = 0;
     double totalWeight = 0;
@@ -130,7 +266,7 @@ double Function::sampleTriangle(double x) const {
     }
 
     return (totalWeight != 0)
-        ? sum * m_outputScale / totalWeight
+        ? sum / totalWeight
         : 0;
 }
 
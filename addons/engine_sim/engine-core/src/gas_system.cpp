@@ -590,3 +590,11 @@ double GasSystem::pressureEquilibriumMaxFlow(double P_env, double T_env) const {
         return -(P_env * (0.5 * m_degreesOfFreedom * volume()) - kineticEnergy()) / E_k_per_mol_env;
     }
 }
+
+void GasSystem::writeState(StateWriter *writer) const {
+    writer->write(m_state);
+}
+
+void GasSystem::readState(StateReader *reader) {
+    reader->read(&m_state);
+}
@@ -33,8 +33,8 @@ void Governor::setSpeedControl(double s) {
     m_targetSpeed = (1 - s) * m_minSpeed + s * m_maxSpeed;
 }
 
-void Governor::update(double dt, Engine *engine) {
-    const double currentSpeed = engine->getSpeed();
+void Governor::update(double dt, const EngineStepState &state, Engine *engine) {
+    const double currentSpeed = state.speed;
     const double ds = m_targetSpeed * m_targetSpeed - currentSpeed * currentSpeed;
 
     m_velocity += (dt * -ds * m_k_s - m_velocity * dt * m_k_d);
@@ -50,3 +50,19 @@ void Governor::update(double dt, Engine *engine) {
 
     engine->setThrottle(1 - std::pow(1 - m_currentThrottle, m_gamma));
 }
+
+void Governor::writeState(StateWriter *writer) const {
+    Throttle::writeState(writer);
+
+    writer->write(m_targetSpeed);
+    writer->write(m_currentThrottle);
+    writer->write(m_velocity);
+}
+
+void Governor::readState(StateReader *reader) {
+    Throttle::readState(reader);
+
+    reader->read(&m_targetSpeed);
+    reader->read(&m_currentThrottle);
+    reader->read(&m_velocity);
+}
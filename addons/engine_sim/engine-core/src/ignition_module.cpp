@@ -1,13 +1,19 @@
 #include "../include/ignition_module.h"
 
+#include "../include/arena.h"
 #include "../include/utilities.h"
 #include "../include/constants.h"
 #include "../include/units.h"
 
+#include <algorithm>
 #include <cmath>
 
 IgnitionModule::IgnitionModule() {
     m_plugs = nullptr;
+    m_schedule = nullptr;
+    m_scheduleSize = 0;
+    m_cursor = 0;
+    m_scheduleValid = false;
     m_crankshaft = nullptr;
     m_timingCurve = nullptr;
     m_cylinderCount = 0;
@@ -23,15 +29,23 @@ IgnitionModule::~IgnitionModule() {
 }
 
 void IgnitionModule::destroy() {
-    delete[] m_plugs;
+    Arena::free(m_plugs);
+    Arena::free(m_schedule);
 
     m_plugs = nullptr;
+    m_schedule = nullptr;
+    m_scheduleSize = 0;
+    m_scheduleValid = false;
     m_cylinderCount = 0;
 }
 
 void IgnitionModule::initialize(const Parameters &params) {
     m_cylinderCount = params.cylinderCount;
-    m_plugs = new SparkPlug[m_cylinderCount];
+    m_plugs = Arena::allocate<SparkPlug>(m_cylinderCount);
+    m_schedule = Arena::allocate<ScheduledEvent>(m_cylinderCount);
+    m_scheduleSize = 0;
+    m_cursor = 0;
+    m_scheduleValid = false;
     m_crankshaft = params.crankshaft;
     m_timingCurve = params.timingCurve;
     m_revLimit = params.revLimit;
@@ -43,6 +57,7 @@ void IgnitionModule::setFiringOrder(int cylinderIndex, double angle) {
 
     m_plugs[cylinderIndex].angle = angle;
     m_plugs[cylinderIndex].enabled = true;
+    m_scheduleValid = false;
 }
 
 void IgnitionModule::reset() {
@@ -50,43 +65,39 @@ void IgnitionModule::reset() {
     resetIgnitionEvents();
 }
 
-void IgnitionModule::update(double dt) {
-    const double cycleAngle = m_crankshaft->getCycleAngle();
+void IgnitionModule::update(double dt, const EngineStepState &state) {
+    // The step state describes the output crankshaft, which is the one the
+    // module is driven by in every engine that has only one
+    const bool outputShaft = (m_crankshaft == state.outputCrankshaft);
+    const double cycleAngle = outputShaft
+        ? state.cycleAngle
+        : m_crankshaft->getCycleAngle();
+    const double angularVelocity = outputShaft
+        ? state.angularVelocity
+        : m_crankshaft->m_body.v_theta;
 
     if (m_enabled && m_revLimitTimer == 0) {
         const double fourPi = 4 * constants::pi;
-        const double advance = getTimingAdvance();
-
-        for (int i = 0; i < m_cylinderCount; ++i) {
-            double adjustedAngle = positiveMod(m_plugs[i].angle - advance, fourPi);
-            const double r0 = m_lastCrankshaftAngle;
-            double r1 = cycleAngle;
-
-            if (m_crankshaft->m_body.v_theta < 0) {
-                if (r1 < r0) {
-                    r1 += fourPi;
-                    adjustedAngle += fourPi;
-                }
-
-                if (adjustedAngle >= r0 && adjustedAngle < r1) {
-                    m_plugs[i].ignitionEvent = m_plugs[i].enabled;
-                }
-            }
-            else {
-                if (r1 > r0) {
-                    r1 -= fourPi;
-                    adjustedAngle -= fourPi;
-                }
-
-                if (adjustedAngle >= r1 && adjustedAngle < r0) {
-                    m_plugs[i].ignitionEvent = m_plugs[i].enabled;
-                }
-            }
+        const double advance = getTimingAdvance(angularVelocity);
+
+        // Plugs fire when their firing angle, less the advance, lies in the
+        // cycle angle swept since the last step
+        if (angularVelocity < 0) {
+            fireEvents(
+                m_lastCrankshaftAngle + advance,
+                positiveMod(cycleAngle - m_lastCrankshaftAngle, fourPi),
+                true);
+        }
+        else {
+            fireEvents(
+                cycleAngle + advance,
+                positiveMod(m_lastCrankshaftAngle - cycleAngle, fourPi),
+                false);
         }
     }
 
     m_revLimitTimer -= dt;
-    if (std::fabs(m_crankshaft->m_body.v_theta) > m_revLimit) {
+    if (std::fabs(angularVelocity) > m_revLimit) {
         m_revLimitTimer = m_limiterDuration;
     }
 
@@ -108,9 +119,126 @@ void IgnitionModule::resetIgnitionEvents() {
 }
 
 double IgnitionModule::getTimingAdvance() {
-    return m_timingCurve->sampleTriangle(-m_crankshaft->m_body.v_theta);
+    return getTimingAdvance(m_crankshaft->m_body.v_theta);
+}
+
+double IgnitionModule::getTimingAdvance(double angularVelocity) const {
+    return m_timingCurve->sampleTriangle(-angularVelocity);
+}
+
+void IgnitionModule::buildSchedule() {
+    m_scheduleSize = 0;
+    for (int i = 0; i < m_cylinderCount; ++i) {
+        if (!m_plugs[i].enabled) continue;
+
+        m_schedule[m_scheduleSize++] = {
+            positiveMod(m_plugs[i].angle, 4 * constants::pi),
+            i
+        };
+    }
+
+    std::stable_sort(
+        m_schedule,
+        m_schedule + m_scheduleSize,
+        [](const ScheduledEvent &a, const ScheduledEvent &b) { return a.angle < b.angle; });
+
+    m_cursor = 0;
+    m_scheduleValid = true;
+}
+
+int IgnitionModule::findNextEvent(double angle) const {
+    const ScheduledEvent *next = std::lower_bound(
+        m_schedule,
+        m_schedule + m_scheduleSize,
+        angle,
+        [](const ScheduledEvent &e, double angle) { return e.angle < angle; });
+    const int event = static_cast<int>(next - m_schedule);
+
+    return (event == m_scheduleSize) ? 0 : event;
+}
+
+bool IgnitionModule::isNextEvent(int event, double angle) const {
+    if (m_scheduleSize == 1) return true;
+
+    const double fourPi = 4 * constants::pi;
+    const int previous = (event == 0) ? m_scheduleSize - 1 : event - 1;
+
+    double d = m_schedule[event].angle - angle;
+    double d_prev = m_schedule[previous].angle - angle;
+    if (d < 0) d += fourPi;
+    if (d_prev < 0) d_prev += fourPi;
+
+    return d < d_prev;
+}
+
+void IgnitionModule::fireEvents(double start, double window, bool forward) {
+    if (!m_scheduleValid) buildSchedule();
+    if (m_scheduleSize == 0) return;
+
+    const double fourPi = 4 * constants::pi;
+    start = positiveMod(start, fourPi);
+
+    // The cursor is kept at the event the next window most likely starts
+    // at, so finding it only takes a search after a large jump
+    int event = m_cursor;
+    if (!isNextEvent(event, start)) {
+        const int next = (event + 1) % m_scheduleSize;
+        const int previous = (event + m_scheduleSize - 1) % m_scheduleSize;
+        if (isNextEvent(next, start)) event = next;
+        else if (isNextEvent(previous, start)) event = previous;
+        else event = findNextEvent(start);
+    }
+
+    m_cursor = event;
+    for (int i = 0; i < m_scheduleSize; ++i) {
+        double d = m_schedule[event].angle - start;
+        if (d < 0) d += fourPi;
+        if (d >= window) break;
+
+        m_plugs[m_schedule[event].plug].ignitionEvent = true;
+        event = (event + 1) % m_scheduleSize;
+    }
+
+    // Turning forward, the next window starts where this one ended
+    if (forward) m_cursor = event;
 }
 
 IgnitionModule::SparkPlug *IgnitionModule::getPlug(int i) {
     return &m_plugs[((i % m_cylinderCount) + m_cylinderCount) % m_cylinderCount];
 }
+
+void IgnitionModule::writeState(StateWriter *writer) const {
+    writer->write(m_enabled);
+    writer->write(m_cylinderCount);
+
+    // Field by field, so the snapshot doesn't pick up padding
+    for (int i = 0; i < m_cylinderCount; ++i) {
+        writer->write(m_plugs[i].angle);
+        writer->write(m_plugs[i].ignitionEvent);
+        writer->write(m_plugs[i].enabled);
+    }
+
+    writer->write(m_lastCrankshaftAngle);
+    writer->write(m_revLimitTimer);
+}
+
+void IgnitionModule::readState(StateReader *reader) {
+    reader->read(&m_enabled);
+
+    int cylinderCount = 0;
+    if (!reader->read(&cylinderCount)) return;
+    if (cylinderCount != m_cylinderCount) {
+        reader->invalidate();
+        return;
+    }
+
+    for (int i = 0; i < m_cylinderCount; ++i) {
+        reader->read(&m_plugs[i].angle);
+        reader->read(&m_plugs[i].ignitionEvent);
+        reader->read(&m_plugs[i].enabled);
+    }
+
+    m_scheduleValid = false;
+    reader->read(&m_lastCrankshaftAngle);
+    reader->read(&m_revLimitTimer);
+}
@@ -10,6 +10,7 @@ Intake::Intake() {
     m_flow = 0;
     m_throttle = 1.0;
     m_idleThrottlePlatePosition = 0.0;
+    m_plenumVolume = 0.0;
     m_crossSectionArea = 0.0;
     m_flowRate = 0;
     m_totalFuelInjected = 0;
@@ -48,6 +49,7 @@ void Intake::initialize(Parameters &params) {
     m_idleFlowK = params.IdleFlowK;
     m_idleThrottlePlatePosition = params.IdleThrottlePlatePosition;
     m_runnerLength = params.RunnerLength;
+    m_plenumVolume = params.volume;
     m_crossSectionArea = params.CrossSectionArea;
     m_velocityDecay = params.VelocityDecay;
     m_runnerFlowRate = params.RunnerFlowRate;
@@ -107,3 +109,23 @@ void Intake::process(double dt) {
         m_totalFuelInjected += fuelMix.p_fuel * idleCircuitFlow;
     }
 }
+
+void Intake::writeState(StateWriter *writer) const {
+    m_system.writeState(writer);
+    m_atmosphere.writeState(writer);
+
+    writer->write(m_throttle);
+    writer->write(m_flow);
+    writer->write(m_flowRate);
+    writer->write(m_totalFuelInjected);
+}
+
+void Intake::readState(StateReader *reader) {
+    m_system.readState(reader);
+    m_atmosphere.readState(reader);
+
+    reader->read(&m_throttle);
+    reader->read(&m_flow);
+    reader->read(&m_flowRate);
+    reader->read(&m_totalFuelInjected);
+}
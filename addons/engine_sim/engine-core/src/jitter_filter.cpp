@@ -1,5 +1,7 @@
 #include "../include/jitter_filter.h"
 
+#include "../include/arena.h"
+
 JitterFilter::JitterFilter() {
     m_history = nullptr;
     m_maxJitter = 0;
@@ -9,7 +11,7 @@ JitterFilter::JitterFilter() {
 }
 
 JitterFilter::~JitterFilter() {
-    /* void */
+    Arena::free(m_history);
 }
 
 void JitterFilter::initialize(
@@ -19,7 +21,7 @@ void JitterFilter::initialize(
 {
     m_maxJitter = maxJitter;
 
-    m_history = new float[maxJitter];
+    m_history = Arena::allocate<float>(maxJitter);
     m_offset = 0;
     memset(m_history, 0, sizeof(float) * maxJitter);
 
@@ -33,3 +35,25 @@ void JitterFilter::initialize(
 float JitterFilter::f(float sample) {
     return fast_f(sample);
 }
+
+void JitterFilter::writeState(StateWriter *writer) const {
+    writer->write(m_maxJitter);
+    writer->write(m_history, m_maxJitter);
+    writer->write(m_offset);
+    writer->write(m_rngState);
+    m_noiseFilter.writeState(writer);
+}
+
+void JitterFilter::readState(StateReader *reader) {
+    int maxJitter = 0;
+    if (!reader->read(&maxJitter)) return;
+    if (maxJitter != m_maxJitter) {
+        reader->invalidate();
+        return;
+    }
+
+    reader->read(m_history, m_maxJitter);
+    reader->read(&m_offset);
+    reader->read(&m_rngState);
+    m_noiseFilter.readState(reader);
+}
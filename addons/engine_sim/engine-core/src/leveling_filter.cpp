@@ -32,3 +32,13 @@ float LevelingFilter::f(float sample) {
 
     return sample * m_attenuation;
 }
+
+void LevelingFilter::writeState(StateWriter *writer) const {
+    writer->write(m_peak);
+    writer->write(m_attenuation);
+}
+
+void LevelingFilter::readState(StateReader *reader) {
+    reader->read(&m_peak);
+    reader->read(&m_attenuation);
+}
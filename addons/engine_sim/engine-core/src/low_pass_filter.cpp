@@ -13,3 +13,11 @@ LowPassFilter::~LowPassFilter() {
 float LowPassFilter::f(float sample) {
     return fast_f(sample);
 }
+
+void LowPassFilter::writeState(StateWriter *writer) const {
+    writer->write(m_y);
+}
+
+void LowPassFilter::readState(StateReader *reader) {
+    reader->read(&m_y);
+}
@@ -0,0 +1,180 @@
+#include "../include/mean_value_simulator.h"
+
+#include "../include/units.h"
+
+#include <assert.h>
+#include <cmath>
+
+CrankTorqueGenerator::CrankTorqueGenerator() {
+    m_body = nullptr;
+    m_torque = 0.0;
+}
+
+CrankTorqueGenerator::~CrankTorqueGenerator() {
+    /* void */
+}
+
+void CrankTorqueGenerator::apply(atg_scs::SystemState *system) {
+    system->t[m_body->index] += m_torque;
+}
+
+MeanValueSimulator::MeanValueSimulator() {
+    m_map = nullptr;
+
+    m_engine = nullptr;
+    m_transmission = nullptr;
+    m_vehicle = nullptr;
+}
+
+MeanValueSimulator::~MeanValueSimulator() {
+    assert(m_map == nullptr);
+}
+
+void MeanValueSimulator::loadSimulation(
+    Engine *engine,
+    Vehicle *vehicle,
+    Transmission *transmission,
+    const EngineMap *map)
+{
+    Simulator::loadSimulation(engine, vehicle, transmission);
+    setSynthesizerEnabled(false);
+
+    m_engine = engine;
+    m_vehicle = vehicle;
+    m_transmission = transmission;
+    m_map = map;
+
+    if (m_engine->getCrankshaftCount() <= 0) return;
+
+    Crankshaft *outputShaft = m_engine->getOutputCrankshaft();
+
+    // Lump every crankshaft plus the rotating share of the reciprocating
+    // mass into the output shaft's inertia
+    double m = 0, I = 0;
+    for (int i = 0; i < m_engine->getCrankshaftCount(); ++i) {
+        Crankshaft *crankshaft = m_engine->getCrankshaft(i);
+        m += crankshaft->getMass() + crankshaft->getFlywheelMass();
+        I += crankshaft->getMomentOfInertia();
+    }
+
+    for (int i = 0; i < m_engine->getCylinderCount(); ++i) {
+        Piston *piston = m_engine->getPiston(i);
+        ConnectingRod *rod = piston->getRod();
+        const Crankshaft *crankshaft = (rod->getCrankshaft() != nullptr)
+            ? rod->getCrankshaft()
+            : outputShaft;
+        const double r = crankshaft->getThrow();
+        I += 0.5 * (piston->getMass() + rod->getMass()) * r * r;
+    }
+
+    outputShaft->m_body.p_x = outputShaft->getPosX();
+    outputShaft->m_body.p_y = outputShaft->getPosY();
+    outputShaft->m_body.theta = 0;
+    outputShaft->m_body.v_theta = 0;
+    outputShaft->m_body.m = m;
+    outputShaft->m_body.I = I;
+
+    m_crankConstraint.setBody(&outputShaft->m_body);
+    m_crankConstraint.setWorldPosition(outputShaft->getPosX(), outputShaft->getPosY());
+    m_crankConstraint.setLocalPosition(0.0, 0.0);
+    m_crankConstraint.m_ks = 5000;
+    m_crankConstraint.m_kd = 10;
+
+    m_system->addRigidBody(&outputShaft->m_body);
+    m_system->addConstraint(&m_crankConstraint);
+
+    m_crankTorque.m_body = &outputShaft->m_body;
+    m_crankTorque.m_torque = 0.0;
+    m_system->addForceGenerator(&m_crankTorque);
+
+    m_transmission->addToSystem(m_system, &m_vehicleMass, m_vehicle, m_engine);
+    m_vehicle->addToSystem(m_system, &m_vehicleMass);
+
+    m_vehicleDrag.initialize(&m_vehicleMass, m_vehicle);
+    m_system->addConstraint(&m_vehicleDrag);
+
+    m_vehicleMass.reset();
+    m_vehicleMass.m = 1.0;
+    m_vehicleMass.I = 1.0;
+    m_system->addRigidBody(&m_vehicleMass);
+
+    m_dyno.connectCrankshaft(outputShaft);
+    m_system->addConstraint(&m_dyno);
+
+    m_starterMotor.connectCrankshaft(outputShaft);
+    m_starterMotor.m_maxTorque = m_engine->getStarterTorque();
+    m_starterMotor.m_rotationSpeed = -m_engine->getStarterSpeed();
+    m_system->addConstraint(&m_starterMotor);
+}
+
+double MeanValueSimulator::getTotalExhaustFlow() const {
+    return m_current.airflow + m_current.fuelFlow;
+}
+
+void MeanValueSimulator::destroy() {
+    if (m_system != nullptr) m_system->reset();
+
+    m_map = nullptr;
+    m_vehicle = nullptr;
+    m_transmission = nullptr;
+    m_engine = nullptr;
+
+    Simulator::destroy();
+}
+
+void MeanValueSimulator::simulateStep_() {
+    const EngineStepState &state = getStepState();
+    const double speed = state.speed;
+    const bool ignition = m_engine->getIgnitionModule()->m_enabled;
+
+    m_current = m_map->sample(speed, m_engine->getSpeedControl());
+    if (!ignition) {
+        m_current.torque = m_map->sampleMotoringTorque(speed);
+        m_current.airflow = m_map->sample(speed, 0.0).airflow;
+        m_current.fuelFlow = 0.0;
+    }
+
+    // Fade out below the mapped range so a stopped engine produces no
+    // torque, and don't drive the engine past the top of the map
+    if (speed < m_map->getMinSpeed()) {
+        const double s = speed / m_map->getMinSpeed();
+        m_current.torque *= s;
+        m_current.airflow *= s;
+        m_current.fuelFlow *= s;
+    }
+    else if (speed > m_map->getMaxSpeed() && m_current.torque > 0) {
+        m_current.torque = 0.0;
+    }
+
+    m_crankTorque.m_torque = state.spinningCw
+        ? -m_current.torque
+        : m_current.torque;
+
+    const int intakeCount = m_engine->getIntakeCount();
+    for (int i = 0; i < intakeCount; ++i) {
+        m_engine->getIntake(i)->m_flowRate = m_current.airflow / intakeCount;
+    }
+}
+
+void MeanValueSimulator::writeToSynthesizer() {
+    /* void */
+}
+
+void MeanValueSimulator::writeState_(StateWriter *writer) const {
+    writer->write('M');
+    writeBodyState(m_engine->getOutputCrankshaft()->m_body, writer);
+    writeBodyState(m_vehicleMass, writer);
+    writer->write(m_current);
+}
+
+void MeanValueSimulator::readState_(StateReader *reader) {
+    char tag = 0;
+    if (!reader->read(&tag) || tag != 'M') {
+        reader->invalidate();
+        return;
+    }
+
+    readBodyState(&m_engine->getOutputCrankshaft()->m_body, reader);
+    readBodyState(&m_vehicleMass, reader);
+    reader->read(&m_current);
+}
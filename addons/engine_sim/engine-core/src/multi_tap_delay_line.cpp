@@ -0,0 +1,162 @@
+#include "../include/multi_tap_delay_line.h"
+
+#include "../include/arena.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <vector>
+
+MultiTapDelayLine::MultiTapDelayLine() {
+    m_buffer = nullptr;
+    m_capacity = 0;
+    m_mask = 0;
+    m_position = 0;
+
+    m_tapDelay = nullptr;
+    m_tapLatency = nullptr;
+    m_tapCount = 0;
+    m_maxLatency = 0;
+
+    m_sampleRate = 0.0;
+}
+
+MultiTapDelayLine::~MultiTapDelayLine() {
+    assert(m_buffer == nullptr);
+    assert(m_tapDelay == nullptr);
+}
+
+void MultiTapDelayLine::initialize(int tapCount, double sampleRate) {
+    destroy();
+
+    m_tapCount = tapCount;
+    m_tapDelay = Arena::allocate<double>(tapCount);
+    m_tapLatency = Arena::allocate<int>(tapCount);
+    for (int i = 0; i < tapCount; ++i) {
+        m_tapDelay[i] = 0.0;
+        m_tapLatency[i] = 0;
+    }
+
+    m_sampleRate = sampleRate;
+    reserve(32);
+}
+
+void MultiTapDelayLine::destroy() {
+    Arena::free(m_buffer);
+    Arena::free(m_tapDelay);
+    Arena::free(m_tapLatency);
+
+    m_buffer = nullptr;
+    m_tapDelay = nullptr;
+    m_tapLatency = nullptr;
+
+    m_capacity = 0;
+    m_mask = 0;
+    m_position = 0;
+    m_tapCount = 0;
+    m_maxLatency = 0;
+}
+
+void MultiTapDelayLine::setTapDelay(int tap, double delay) {
+    assert(tap >= 0 && tap < m_tapCount);
+
+    m_tapDelay[tap] = delay;
+    updateLatencies();
+}
+
+void MultiTapDelayLine::setSampleRate(double sampleRate) {
+    if (sampleRate == m_sampleRate || sampleRate <= 0) return;
+    else if (m_sampleRate <= 0) {
+        m_sampleRate = sampleRate;
+        updateLatencies();
+        return;
+    }
+
+    const int count = m_maxLatency;
+    std::vector<double> pending(count);
+    for (int i = 0; i < count; ++i) {
+        pending[i] = m_buffer[(m_position + i) & m_mask];
+    }
+
+    const double ratio = m_sampleRate / sampleRate;
+    m_sampleRate = sampleRate;
+    updateLatencies();
+    setPending(pending.data(), count, ratio);
+}
+
+void MultiTapDelayLine::writeState(StateWriter *writer) const {
+    writer->write(m_sampleRate);
+    writer->write(m_maxLatency);
+    for (int i = 0; i < m_maxLatency; ++i) {
+        writer->write(m_buffer[(m_position + i) & m_mask]);
+    }
+}
+
+void MultiTapDelayLine::readState(StateReader *reader) {
+    double sampleRate = 0;
+    int count = 0;
+    reader->read(&sampleRate);
+    reader->read(&count);
+    if (!reader->isValid() || sampleRate <= 0 || count < 0 || count > (1 << 24)) {
+        reader->invalidate();
+        return;
+    }
+
+    std::vector<double> pending(count);
+    reader->read(pending.data(), count);
+    if (!reader->isValid()) return;
+
+    setPending(pending.data(), count, sampleRate / m_sampleRate);
+}
+
+void MultiTapDelayLine::updateLatencies() {
+    m_maxLatency = 0;
+    for (int i = 0; i < m_tapCount; ++i) {
+        m_tapLatency[i] = static_cast<int>(std::round(m_tapDelay[i] * m_sampleRate));
+        m_maxLatency = std::max(m_maxLatency, m_tapLatency[i]);
+    }
+
+    reserve(m_maxLatency + 1);
+}
+
+void MultiTapDelayLine::reserve(int size) {
+    if (size <= m_capacity) return;
+
+    int capacity = 1;
+    while (capacity < size) capacity *= 2;
+
+    double *buffer = Arena::allocate<double>(capacity);
+    for (int i = 0; i < capacity; ++i) {
+        buffer[i] = (i < m_capacity)
+            ? m_buffer[(m_position + i) & m_mask]
+            : 0.0;
+    }
+
+    Arena::free(m_buffer);
+
+    m_buffer = buffer;
+    m_capacity = capacity;
+    m_mask = capacity - 1;
+    m_position = 0;
+}
+
+void MultiTapDelayLine::setPending(const double *pending, int count, double ratio) {
+    for (int i = 0; i < m_capacity; ++i) {
+        m_buffer[i] = 0.0;
+    }
+
+    m_position = 0;
+    if (count == 0) return;
+
+    const int resampled = std::min(
+        m_maxLatency,
+        static_cast<int>(std::round(count / ratio)));
+    for (int i = 0; i < resampled; ++i) {
+        const double x = i * ratio;
+        const int i0 = std::min(static_cast<int>(x), count - 1);
+        const int i1 = std::min(i0 + 1, count - 1);
+        const double s = x - i0;
+
+        m_buffer[i] = pending[i0] * (1 - s) + pending[i1] * s;
+    }
+}
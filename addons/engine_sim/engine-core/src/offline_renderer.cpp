@@ -0,0 +1,142 @@
+#include "../include/offline_renderer.h"
+
+#include "../include/simulator.h"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+constexpr int RenderChunkSamples = 4096;
+
+void writeU16(std::ofstream &file, uint16_t v) {
+    const char bytes[] = { static_cast<char>(v & 0xFF), static_cast<char>((v >> 8) & 0xFF) };
+    file.write(bytes, 2);
+}
+
+void writeU32(std::ofstream &file, uint32_t v) {
+    writeU16(file, static_cast<uint16_t>(v & 0xFFFF));
+    writeU16(file, static_cast<uint16_t>(v >> 16));
+}
+
+// Sizes are patched once the sample count is known
+void writeWavHeader(std::ofstream &file, uint32_t sampleRate, uint32_t dataSize) {
+    file.write("RIFF", 4);
+    writeU32(file, 36 + dataSize);
+    file.write("WAVE", 4);
+
+    file.write("fmt ", 4);
+    writeU32(file, 16);
+    writeU16(file, 1);                  // PCM
+    writeU16(file, 1);                  // Mono
+    writeU32(file, sampleRate);
+    writeU32(file, sampleRate * 2);     // Byte rate
+    writeU16(file, 2);                  // Block align
+    writeU16(file, 16);                 // Bits per sample
+
+    file.write("data", 4);
+    writeU32(file, dataSize);
+}
+
+} // namespace
+
+OfflineRenderer::OfflineRenderer() {
+    m_samplesWritten = 0;
+}
+
+OfflineRenderer::~OfflineRenderer() {
+    /* void */
+}
+
+bool OfflineRenderer::render(
+    Simulator *simulator,
+    const ControlPoint *track,
+    int pointCount,
+    const Parameters &params,
+    const std::string &path)
+{
+    m_samplesWritten = 0;
+
+    if (simulator == nullptr || simulator->getEngine() == nullptr) return false;
+    if (!simulator->isSynthesizerEnabled()) return false;
+    if (params.duration <= 0 || params.blockTime <= 0) return false;
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    Synthesizer &synthesizer = simulator->synthesizer();
+    const uint32_t sampleRate = static_cast<uint32_t>(synthesizer.getAudioSampleRate());
+    writeWavHeader(file, sampleRate, 0);
+
+    const bool restartThread = synthesizer.isRenderingThreadRunning();
+    const bool latencyControl = simulator->isLatencyControlEnabled();
+    const double simulationSpeed = simulator->getSimulationSpeed();
+    const Simulator::QualityTier qualityTier = simulator->getQualityTier();
+
+    synthesizer.endAudioRenderingThread();
+    simulator->setLatencyControlEnabled(false);
+    simulator->setSimulationSpeed(1.0);
+    simulator->setQualityTier(Simulator::QualityTier::Full);
+
+    std::vector<int16_t> samples(RenderChunkSamples);
+    for (double t = 0; t < params.duration; t += params.blockTime) {
+        applyControls(simulator, track, pointCount, t);
+
+        simulator->startFrame(std::min(params.blockTime, params.duration - t));
+        while (simulator->simulateStep()) {}
+        simulator->endFrame();
+
+        int n;
+        while ((n = synthesizer.renderPending(samples.data(), RenderChunkSamples)) > 0) {
+            // WAV is little endian, as are all supported targets
+            file.write(reinterpret_cast<const char *>(samples.data()), sizeof(int16_t) * n);
+            m_samplesWritten += n;
+        }
+    }
+
+    simulator->setQualityTier(qualityTier);
+    simulator->setSimulationSpeed(simulationSpeed);
+    simulator->setLatencyControlEnabled(latencyControl);
+    if (restartThread) {
+        synthesizer.startAudioRenderingThread();
+    }
+
+    file.seekp(0);
+    writeWavHeader(file, sampleRate, static_cast<uint32_t>(m_samplesWritten * 2));
+
+    return file.good();
+}
+
+void OfflineRenderer::applyControls(Simulator *simulator, const ControlPoint *track, int pointCount, double t) {
+    if (track == nullptr || pointCount <= 0) return;
+
+    int i = 0;
+    while (i + 1 < pointCount && track[i + 1].time <= t) ++i;
+
+    const ControlPoint &current = track[i];
+    double speedControl = current.speedControl;
+    if (i + 1 < pointCount && t >= current.time) {
+        const ControlPoint &next = track[i + 1];
+        const double s = (t - current.time) / (next.time - current.time);
+        speedControl = current.speedControl * (1 - s) + next.speedControl * s;
+    }
+
+    Engine *engine = simulator->getEngine();
+    Transmission *transmission = simulator->getTransmission();
+
+    engine->setSpeedControl(std::max(0.0, std::min(1.0, speedControl)));
+    if (engine->getIgnitionModule() != nullptr) {
+        engine->getIgnitionModule()->m_enabled = current.ignitionEnabled;
+    }
+
+    simulator->m_starterMotor.m_enabled = current.starterEnabled;
+
+    if (transmission != nullptr) {
+        if (transmission->getGear() != current.gear) {
+            transmission->changeGear(current.gear);
+        }
+
+        transmission->setClutchPressure(std::max(0.0, std::min(1.0, current.clutchPressure)));
+    }
+}
@@ -16,6 +16,7 @@ Piston::Piston() {
     m_wristPinLocation = 0.0;
     m_mass = 0.0;
     m_blowby_k = 0.0;
+    m_cylinderWallForce = 0.0;
 }
 
 Piston::~Piston() {
@@ -46,6 +47,8 @@ double Piston::relativeY() const {
 }
 
 double Piston::calculateCylinderWallForce() const {
+    if (m_cylinderConstraint == nullptr) return m_cylinderWallForce;
+
     return std::sqrt(
         m_cylinderConstraint->F_x[0][0] * m_cylinderConstraint->F_x[0][0]
         + m_cylinderConstraint->F_y[0][0] * m_cylinderConstraint->F_y[0][0]);
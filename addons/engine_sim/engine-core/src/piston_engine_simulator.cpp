@@ -1,17 +1,20 @@
 #include "../include/piston_engine_simulator.h"
 
+#include "../include/arena.h"
 #include "../include/constants.h"
 #include "../include/units.h"
 
 #include <cmath>
 #include <assert.h>
 #include <set>
+#include <vector>
 
 PistonEngineSimulator::PistonEngineSimulator() {
     m_engine = nullptr;
     m_transmission = nullptr;
     m_vehicle = nullptr;
-    m_delayFilters = nullptr;
+    m_exhaustRoutes = nullptr;
+    m_exhaustDelayLines = nullptr;
 
     m_crankConstraints = nullptr;
     m_cylinderWallConstraints = nullptr;
@@ -23,6 +26,7 @@ PistonEngineSimulator::PistonEngineSimulator() {
 
     m_derivativeFilter.m_dt = 1.0;
     m_fluidSimulationSteps = 8;
+    m_kinematics = Kinematics::Constraints;
 }
 
 PistonEngineSimulator::~PistonEngineSimulator() {
@@ -31,10 +35,13 @@ PistonEngineSimulator::~PistonEngineSimulator() {
     assert(m_linkConstraints == nullptr);
     assert(m_crankshaftFrictionConstraints == nullptr);
     assert(m_exhaustFlowStagingBuffer == nullptr);
-    assert(m_delayFilters == nullptr);
+    assert(m_exhaustRoutes == nullptr);
+    assert(m_exhaustDelayLines == nullptr);
 }
 
 void PistonEngineSimulator::loadSimulation(Engine *engine, Vehicle *vehicle, Transmission *transmission) {
+    Arena::CategoryScope scope(Arena::Category::Simulation);
+
     Simulator::loadSimulation(engine, vehicle, transmission);
 
     m_engine = engine;
@@ -52,7 +59,8 @@ void PistonEngineSimulator::loadSimulation(Engine *engine, Vehicle *vehicle, Tra
     m_linkConstraints = new atg_scs::LinkConstraint[linkCount];
     m_crankshaftFrictionConstraints = new atg_scs::RotationFrictionConstraint[crankCount];
     m_crankshaftLinks = new atg_scs::ClutchConstraint[crankCount - 1];
-    m_delayFilters = new DelayFilter[cylinderCount];
+    m_exhaustRoutes = Arena::allocate<ExhaustRoute>(cylinderCount);
+    m_exhaustDelayLines = new MultiTapDelayLine[m_engine->getExhaustSystemCount()];
 
     const double ks = 5000;
     const double kd = 10;
@@ -108,6 +116,16 @@ void PistonEngineSimulator::loadSimulation(Engine *engine, Vehicle *vehicle, Tra
         Piston *piston = m_engine->getPiston(i);
         ConnectingRod *connectingRod = piston->getRod();
 
+        piston->m_body.m = piston->getMass();
+        piston->m_body.I = 1.0;
+
+        connectingRod->m_body.m = connectingRod->getMass();
+        connectingRod->m_body.I = connectingRod->getMomentOfInertia();
+
+        if (m_kinematics == Kinematics::ReducedCoordinates) {
+            continue;
+        }
+
         CylinderBank *bank = piston->getCylinderBank();
         const double dx = std::cos(bank->getAngle() + constants::pi / 2);
         const double dy = std::sin(bank->getAngle() + constants::pi / 2);
@@ -157,18 +175,20 @@ void PistonEngineSimulator::loadSimulation(Engine *engine, Vehicle *vehicle, Tra
         m_linkConstraints[i * 2 + 1].m_ks = ks;
         m_linkConstraints[i * 2 + 0].m_kd = kd;
 
-        piston->m_body.m = piston->getMass();
-        piston->m_body.I = 1.0;
-
-        connectingRod->m_body.m = connectingRod->getMass();
-        connectingRod->m_body.I = connectingRod->getMomentOfInertia();
-
         m_system->addRigidBody(&piston->m_body);
         m_system->addRigidBody(&connectingRod->m_body);
         m_system->addConstraint(&m_linkConstraints[i * 2 + 0]);
         m_system->addConstraint(&m_linkConstraints[i * 2 + 1]);
         m_system->addConstraint(&m_cylinderWallConstraints[i]);
-        m_system->addForceGenerator(m_engine->getChamber(i));
+    }
+
+    if (m_kinematics == Kinematics::ReducedCoordinates) {
+        m_crankSlider.initialize(m_engine);
+        m_system->addForceGenerator(&m_crankSlider);
+    }
+    else {
+        m_chamberForces.initialize(m_engine);
+        m_system->addForceGenerator(&m_chamberForces);
     }
 
     m_dyno.connectCrankshaft(m_engine->getOutputCrankshaft());
@@ -179,6 +199,10 @@ void PistonEngineSimulator::loadSimulation(Engine *engine, Vehicle *vehicle, Tra
     m_starterMotor.m_rotationSpeed = -m_engine->getStarterSpeed();
     m_system->addConstraint(&m_starterMotor);
 
+    for (int i = 0; i < m_engine->getCylinderBankCount(); ++i) {
+        m_engine->getHead(i)->buildFlowTables();
+    }
+
     placeAndInitialize();
     initializeSynthesizer();
 }
@@ -194,16 +218,21 @@ double PistonEngineSimulator::getAverageOutputSignal() const {
 
 void PistonEngineSimulator::placeAndInitialize() {
     const int cylinderCount = m_engine->getCylinderCount();
-    for (int i = 0; i < cylinderCount; ++i) {
-        ConnectingRod *rod = m_engine->getConnectingRod(i);
+    if (m_kinematics == Kinematics::ReducedCoordinates) {
+        m_crankSlider.update();
+    }
+    else {
+        for (int i = 0; i < cylinderCount; ++i) {
+            ConnectingRod *rod = m_engine->getConnectingRod(i);
 
-        if (rod->getRodJournalCount() != 0) {
-            placeCylinder(i);
+            if (rod->getRodJournalCount() != 0) {
+                placeCylinder(i);
+            }
         }
-    }
 
-    for (int i = 0; i < cylinderCount; ++i) {
-        placeCylinder(i);
+        for (int i = 0; i < cylinderCount; ++i) {
+            placeCylinder(i);
+        }
     }
 
     for (int i = 0; i < cylinderCount; ++i) {
@@ -212,21 +241,59 @@ void PistonEngineSimulator::placeAndInitialize() {
             m_engine->getChamber(i)->getVolume(),
             units::celcius(25.0)
         );
+        m_engine->getChamber(i)->resetMechanicalStep();
+    }
+
+    m_engine->getIgnitionModule()->reset();
+
+    m_exhaustFlowStagingBuffer = Arena::allocate<double>(m_engine->getExhaustSystemCount());
+    initializeExhaustRouting();
+}
 
-        Piston *piston = m_engine->getChamber(i)->getPiston();
-        CylinderHead *head = m_engine->getChamber(i)->getCylinderHead();
+void PistonEngineSimulator::resolveExhaustRoutes(Engine *engine, ExhaustRoute *routes) {
+    const int cylinderCount = engine->getCylinderCount();
+    const double speedOfSound = 343.0 * units::m / units::sec;
+
+    std::vector<int> taps(engine->getExhaustSystemCount(), 0);
+    for (int i = 0; i < cylinderCount; ++i) {
+        Piston *piston = engine->getPiston(i);
+        CylinderHead *head = engine->getHead(piston->getCylinderBank()->getIndex());
         ExhaustSystem *exhaust = head->getExhaustSystem(piston->getCylinderIndex());
+
         const double exhaustLength =
             head->getHeaderPrimaryLength(piston->getCylinderIndex())
             + exhaust->getLength();
-        const double speedOfSound = 343.0 * units::m / units::sec;
-        const double delay = exhaustLength / speedOfSound;
-        m_delayFilters[i].initialize(delay, static_cast<double>(getSimulationFrequency()));
+
+        ExhaustRoute &route = routes[i];
+        route.channel = exhaust->getIndex();
+        route.tap = taps[route.channel]++;
+        route.gain =
+            head->getSoundAttenuation(piston->getCylinderIndex())
+            * (exhaust->getAudioVolume() / cylinderCount)
+            * (1 / (exhaustLength * exhaustLength));
+        route.delay = exhaustLength / speedOfSound;
     }
+}
 
-    m_engine->getIgnitionModule()->reset();
+void PistonEngineSimulator::initializeExhaustRouting() {
+    const int cylinderCount = m_engine->getCylinderCount();
+    const int exhaustSystemCount = m_engine->getExhaustSystemCount();
 
-    m_exhaustFlowStagingBuffer = new double[m_engine->getExhaustSystemCount()];
+    resolveExhaustRoutes(m_engine, m_exhaustRoutes);
+
+    std::vector<int> taps(exhaustSystemCount, 0);
+    for (int i = 0; i < cylinderCount; ++i) {
+        ++taps[m_exhaustRoutes[i].channel];
+    }
+
+    for (int i = 0; i < exhaustSystemCount; ++i) {
+        m_exhaustDelayLines[i].initialize(taps[i], static_cast<double>(getSimulationFrequency()));
+    }
+
+    for (int i = 0; i < cylinderCount; ++i) {
+        const ExhaustRoute &route = m_exhaustRoutes[i];
+        m_exhaustDelayLines[route.channel].setTapDelay(route.tap, route.delay);
+    }
 }
 
 void PistonEngineSimulator::placeCylinder(int i) {
@@ -279,43 +346,27 @@ void PistonEngineSimulator::placeCylinder(int i) {
 }
 
 void PistonEngineSimulator::simulateStep_() {
-    const double timestep = getTimestep();
-    IgnitionModule *im = m_engine->getIgnitionModule();
-    im->update(timestep);
-
-    const int cylinderCount = m_engine->getCylinderCount();
-    for (int i = 0; i < cylinderCount; ++i) {
-        if (im->getIgnitionEvent(i)) {
-            m_engine->getChamber(i)->ignite();
-        }
-        m_engine->getChamber(i)->update(timestep);
-    }
+    stepEngine(
+        m_engine->getCylinderCount(),
+        m_engine->getCylinderBankCount(),
+        m_engine->getExhaustSystemCount(),
+        m_engine->getIntakeCount());
+}
 
-    for (int i = 0; i < cylinderCount; ++i) {
-        m_engine->getChamber(i)->resetLastTimestepExhaustFlow();
-        m_engine->getChamber(i)->resetLastTimestepIntakeFlow();
-    }
+void PistonEngineSimulator::onSimulationFrequencyChanged(int previousFrequency) {
+    Simulator::onSimulationFrequencyChanged(previousFrequency);
 
     const int exhaustSystemCount = m_engine->getExhaustSystemCount();
-    const int intakeCount = m_engine->getIntakeCount();
-    const double fluidTimestep = timestep / m_fluidSimulationSteps;
-    
-    for (int i = 0; i < m_fluidSimulationSteps; ++i) {
-        for (int j = 0; j < exhaustSystemCount; ++j) {
-            m_engine->getExhaustSystem(j)->process(fluidTimestep);
-        }
-
-        for (int j = 0; j < intakeCount; ++j) {
-            m_engine->getIntake(j)->process(fluidTimestep);
-            m_engine->getIntake(j)->m_flowRate += m_engine->getIntake(j)->m_flow;
-        }
-
-        for (int j = 0; j < cylinderCount; ++j) {
-            m_engine->getChamber(j)->flow(fluidTimestep);
-        }
+    for (int i = 0; i < exhaustSystemCount; ++i) {
+        m_exhaustDelayLines[i].setSampleRate(static_cast<double>(getSimulationFrequency()));
     }
+}
 
-    im->resetIgnitionEvents();
+int PistonEngineSimulator::getActiveFluidSimulationSteps() const {
+    // Pressure pulse detail only matters when the synthesizer is listening
+    return (getQualityTier() == QualityTier::PhysicsOnly)
+        ? 1
+        : m_fluidSimulationSteps;
 }
 
 double PistonEngineSimulator::getTotalExhaustFlow() const {
@@ -335,7 +386,10 @@ void PistonEngineSimulator::endFrame() {
     }
 
     const double frameTimestep = simulationSteps() * getTimestep();
-    const int cylinderCount = m_engine->getCylinderCount();
+    if (frameTimestep <= 0) {
+        return;
+    }
+
     for (int i = 0; i < m_engine->getIntakeCount(); ++i) {
         m_engine->getIntake(i)->m_flowRate /= frameTimestep;
     }
@@ -348,8 +402,17 @@ void PistonEngineSimulator::destroy() {
     if (m_cylinderWallConstraints != nullptr) delete[] m_cylinderWallConstraints;
     if (m_linkConstraints != nullptr) delete[] m_linkConstraints;
     if (m_crankshaftFrictionConstraints != nullptr) delete[] m_crankshaftFrictionConstraints;
-    if (m_exhaustFlowStagingBuffer != nullptr) delete[] m_exhaustFlowStagingBuffer;
-    if (m_delayFilters != nullptr) delete[] m_delayFilters;
+    Arena::free(m_exhaustFlowStagingBuffer);
+    Arena::free(m_exhaustRoutes);
+    if (m_exhaustDelayLines != nullptr) {
+        for (int i = 0; i < m_engine->getExhaustSystemCount(); ++i) {
+            m_exhaustDelayLines[i].destroy();
+        }
+
+        delete[] m_exhaustDelayLines;
+    }
+    m_crankSlider.destroy();
+    m_chamberForces.destroy();
 
     m_crankConstraints = nullptr;
     m_cylinderWallConstraints = nullptr;
@@ -360,52 +423,69 @@ void PistonEngineSimulator::destroy() {
     m_vehicle = nullptr;
     m_transmission = nullptr;
     m_engine = nullptr;
-    m_delayFilters = nullptr;
+    m_exhaustRoutes = nullptr;
+    m_exhaustDelayLines = nullptr;
 
     Simulator::destroy();
 }
 
 void PistonEngineSimulator::writeToSynthesizer() {
-    const int exhaustSystemCount = m_engine->getExhaustSystemCount();
-    for (int i = 0; i < exhaustSystemCount; ++i) {
-        m_exhaustFlowStagingBuffer[i] = 0;
+    writeExhaustPulses(
+        m_engine->getCylinderCount(),
+        m_engine->getExhaustSystemCount(),
+        m_exhaustRoutes);
+}
+
+void PistonEngineSimulator::writeState_(StateWriter *writer) const {
+    writer->write('P');
+
+    for (int i = 0; i < m_engine->getCrankshaftCount(); ++i) {
+        writeBodyState(m_engine->getCrankshaft(i)->m_body, writer);
     }
 
-    const double attenuation = std::min(std::abs(filteredEngineSpeed()), 40.0) / 40.0;
-    const double attenuation_3 = attenuation * attenuation * attenuation;
+    for (int i = 0; i < m_engine->getCylinderCount(); ++i) {
+        const Piston *piston = m_engine->getPiston(i);
+        writeBodyState(piston->m_body, writer);
+        writeBodyState(piston->getRod()->m_body, writer);
+    }
 
-    static double lastValveLift[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    for (int i = 0; i < m_engine->getExhaustSystemCount(); ++i) {
+        m_exhaustDelayLines[i].writeState(writer);
+    }
 
-    const double timestep = getTimestep();
-    const int cylinderCount = m_engine->getCylinderCount();
-    for (int i = 0; i < cylinderCount; ++i) {
-        Piston *piston = m_engine->getPiston(i);
-        CylinderBank *bank = piston->getCylinderBank();
-        CylinderHead *head = m_engine->getHead(bank->getIndex());
-        ExhaustSystem *exhaust = head->getExhaustSystem(piston->getCylinderIndex());
-        CombustionChamber *chamber = m_engine->getChamber(i);
+    writeBodyState(m_vehicleMass, writer);
+    m_derivativeFilter.writeState(writer);
+}
 
-        const double exhaustLength =
-            head->getHeaderPrimaryLength(piston->getCylinderIndex())
-            + exhaust->getLength();
+void PistonEngineSimulator::readState_(StateReader *reader) {
+    char tag = 0;
+    if (!reader->read(&tag) || tag != 'P') {
+        reader->invalidate();
+        return;
+    }
 
-        double exhaustFlow =
-            attenuation_3 * 1600 * (
-                1.0 * (chamber->m_exhaustRunnerAndPrimary.pressure() - units::pressure(1.0, units::atm))
-                + 0.1 * chamber->m_exhaustRunnerAndPrimary.dynamicPressure(1.0, 0.0)
-                + 0.1 * chamber->m_exhaustRunnerAndPrimary.dynamicPressure(-1.0, 0.0));
+    for (int i = 0; i < m_engine->getCrankshaftCount(); ++i) {
+        readBodyState(&m_engine->getCrankshaft(i)->m_body, reader);
+    }
 
-        lastValveLift[i] = head->exhaustValveLift(piston->getCylinderIndex());
+    for (int i = 0; i < m_engine->getCylinderCount(); ++i) {
+        Piston *piston = m_engine->getPiston(i);
+        readBodyState(&piston->m_body, reader);
+        readBodyState(&piston->getRod()->m_body, reader);
+    }
 
-        const double delayedExhaustPulse =
-            m_delayFilters[i].fast_f(exhaustFlow);
+    for (int i = 0; i < m_engine->getExhaustSystemCount(); ++i) {
+        m_exhaustDelayLines[i].readState(reader);
+    }
 
-        ExhaustSystem *exhaustSystem = head->getExhaustSystem(piston->getCylinderIndex());
-        m_exhaustFlowStagingBuffer[exhaustSystem->getIndex()] +=
-            head->getSoundAttenuation(piston->getCylinderIndex())
-            * (exhaustSystem->getAudioVolume() * delayedExhaustPulse / cylinderCount)
-            * (1 / (exhaustLength * exhaustLength));
+    readBodyState(&m_vehicleMass, reader);
+    m_derivativeFilter.readState(reader);
+
+    if (m_kinematics == Kinematics::ReducedCoordinates) {
+        m_crankSlider.update();
     }
 
-    synthesizer().writeInput(m_exhaustFlowStagingBuffer);
+    for (int i = 0; i < m_engine->getCylinderCount(); ++i) {
+        m_engine->getChamber(i)->resetMechanicalStep();
+    }
 }
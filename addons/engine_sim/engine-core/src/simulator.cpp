@@ -1,7 +1,8 @@
 #include "../include/simulator.h"
-#include "../dependencies/submodules/simple-2d-constraint-solver/include/gauss_seidel_sle_solver.h"
 #include "../dependencies/submodules/simple-2d-constraint-solver/include/cholesky_sle_solver.h"
 
+#include <cstring>
+
 #ifndef ENGINE_SIM_ENABLE_SIGNPOST
 #define ENGINE_SIM_ENABLE_SIGNPOST 0
 #endif
@@ -16,34 +17,49 @@ Simulator::Simulator() {
     m_vehicle = nullptr;
     m_transmission = nullptr;
     m_system = nullptr;
+    m_sleSolver = nullptr;
 
     m_physicsProcessingTime = 0;
 
     m_simulationSpeed = 1.0;
     m_targetSynthesizerLatency = 0.1;
+    m_latencyControlEnabled = true;
     m_simulationFrequency = 10000;
+    m_fullQualitySimulationFrequency = 10000;
     m_steps = 0;
 
+    m_mechanicalStepDivisor = 1;
+    m_pendingMechanicalStepDivisor = 1;
+    m_mechanicalStepPhase = 0;
+    m_mechanicalStartAngle = 0.0;
+    m_mechanicalEndAngle = 0.0;
+
+    m_qualityTier = QualityTier::Full;
+    m_pendingQualityTier = QualityTier::Full;
+    m_synthesizerGain = 1.0;
+    m_synthesizerGainTarget = 1.0;
+    m_synthesizerEnabled = true;
+
     m_currentIteration = 0;
 
     m_filteredEngineSpeed = 0.0;
-    m_dynoTorqueSamples = nullptr;
     m_lastDynoTorqueSample = 0;
 }
 
 Simulator::~Simulator() {
     assert(m_system == nullptr);
-    assert(m_dynoTorqueSamples == nullptr);
 }
 
 void Simulator::initialize(const Parameters &params) {
+    m_parameters = params;
+
     if (params.systemType == SystemType::NsvOptimized) {
         atg_scs::OptimizedNsvRigidBodySystem *system =
             new atg_scs::OptimizedNsvRigidBodySystem;
-        atg_scs::GaussSeidelSleSolver *solver = new atg_scs::GaussSeidelSleSolver;
-        solver->m_maxIterations = 32;
-        solver->m_minDelta = 0.1;
-        system->initialize(solver);
+        m_sleSolver = new BlockSleSolver;
+        m_sleSolver->m_maxIterations = 32;
+        m_sleSolver->m_relativeTolerance = 1E-3;
+        system->initialize(m_sleSolver);
         m_system = system;
     }
     else {
@@ -55,22 +71,37 @@ void Simulator::initialize(const Parameters &params) {
         m_system = system;
     }
 
-    m_dynoTorqueSamples = new double[DynoTorqueSamples];
-    for (int i = 0; i < DynoTorqueSamples; ++i) {
-        m_dynoTorqueSamples[i] = 0.0;
-    }
+    m_dynoTorque.initialize(DynoTorqueSamples);
 }
 
 void Simulator::loadSimulation(Engine *engine, Vehicle *vehicle, Transmission *transmission) {
     m_engine = engine;
     m_vehicle = vehicle;
     m_transmission = transmission;
+    m_mechanicalStepPhase = 0;
 }
 
 void Simulator::releaseSimulation() {
     destroy();
 }
 
+void Simulator::setSimulationFrequency(int frequency) {
+    m_fullQualitySimulationFrequency = frequency;
+
+    if (m_engine == nullptr) {
+        m_simulationFrequency = frequency;
+    }
+}
+
+void Simulator::setMechanicalStepDivisor(int divisor) {
+    m_pendingMechanicalStepDivisor = std::max(1, divisor);
+
+    // Between mechanical steps there's nothing in progress to disturb
+    if (m_mechanicalStepPhase == 0) {
+        m_mechanicalStepDivisor = m_pendingMechanicalStepDivisor;
+    }
+}
+
 void Simulator::startFrame(double dt) {
     if (m_engine == nullptr) {
         m_steps = 0;
@@ -79,19 +110,34 @@ void Simulator::startFrame(double dt) {
 
     m_simulationStart = std::chrono::steady_clock::now();
     m_currentIteration = 0;
+
+    m_solverStatistics.frameSteps = 0;
+    m_solverStatistics.frameIterations = 0;
+    m_solverStatistics.frameMaxIterations = 0;
+    m_solverStatistics.frameMaxResidual = 0.0;
+    m_solverStatistics.frameUnconvergedSteps = 0;
+
+    updateQualityTier();
+    if (m_qualityTier == QualityTier::Frozen) {
+        m_steps = 0;
+        return;
+    }
+
     m_synthesizer.setInputSampleRate(m_simulationFrequency * m_simulationSpeed);
 
     const double timestep = getTimestep();
     m_steps = (int)std::round((dt * m_simulationSpeed) / timestep);
 
-    const double targetLatency = getSynthesizerInputLatencyTarget();
-    if (m_synthesizer.getLatency() < targetLatency) {
-        m_steps = static_cast<int>((m_steps + 1) * 1.1);
-    }
-    else if (m_synthesizer.getLatency() > targetLatency) {
-        m_steps = static_cast<int>((m_steps - 1) * 0.9);
-        if (m_steps < 0) {
-            m_steps = 0;
+    if (isSynthesizerActive() && m_latencyControlEnabled) {
+        const double targetLatency = getSynthesizerInputLatencyTarget();
+        if (m_synthesizer.getLatency() < targetLatency) {
+            m_steps = static_cast<int>((m_steps + 1) * 1.1);
+        }
+        else if (m_synthesizer.getLatency() > targetLatency) {
+            m_steps = static_cast<int>((m_steps - 1) * 0.9);
+            if (m_steps < 0) {
+                m_steps = 0;
+            }
         }
     }
 
@@ -108,12 +154,13 @@ void Simulator::startFrame(double dt) {
 #endif
 
 #if ENGINE_SIM_ENABLE_STEP_TIMING
-static long long s_totalStepTimeNs = 0;
-static long long s_physicsTimeNs = 0;
-static long long s_updateTimeNs = 0;
-static long long s_simStepTimeNs = 0;
-static long long s_synthTimeNs = 0;
-static int s_profileSteps = 0;
+// Per thread so that simulators running in parallel don't race
+static thread_local long long s_totalStepTimeNs = 0;
+static thread_local long long s_physicsTimeNs = 0;
+static thread_local long long s_updateTimeNs = 0;
+static thread_local long long s_simStepTimeNs = 0;
+static thread_local long long s_synthTimeNs = 0;
+static thread_local int s_profileSteps = 0;
 #endif
 
 bool Simulator::simulateStep() {
@@ -166,11 +213,34 @@ bool Simulator::simulateStep() {
     #if ENGINE_SIM_ENABLE_SIGNPOST && defined(__APPLE__)
     os_signpost_interval_begin(s_engineSimPerfLog, sp_process, "physics::process");
     #endif
-    m_system->process(timestep, 1);
+    Crankshaft *outputShaft = m_engine->getOutputCrankshaft();
+    if (m_mechanicalStepPhase == 0) {
+        m_mechanicalStepDivisor = m_pendingMechanicalStepDivisor;
+        m_mechanicalStartAngle = outputShaft->m_body.theta;
+
+        m_system->process(timestep * m_mechanicalStepDivisor, 1);
+        updateSolverStatistics();
+
+        m_mechanicalEndAngle = outputShaft->m_body.theta;
+    }
     #if ENGINE_SIM_ENABLE_SIGNPOST && defined(__APPLE__)
     os_signpost_interval_end(s_engineSimPerfLog, sp_process, "physics::process");
     #endif
 
+    // The crank is moved through the mechanical step a simulation step at a
+    // time so that ignition and valve timing keep the full resolution. The
+    // last step lands exactly on the solved angle, which the next mechanical
+    // step then starts from.
+    ++m_mechanicalStepPhase;
+    if (m_mechanicalStepDivisor > 1) {
+        outputShaft->m_body.theta = isMechanicalStepComplete()
+            ? m_mechanicalEndAngle
+            : m_mechanicalStartAngle
+                + (m_mechanicalEndAngle - m_mechanicalStartAngle) * getMechanicalStepFraction();
+    }
+
+    updateStepState();
+
     #if ENGINE_SIM_ENABLE_STEP_TIMING
     const auto t1_physics = std::chrono::steady_clock::now();
     s_physicsTimeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(t1_physics - t0).count();
@@ -179,7 +249,8 @@ bool Simulator::simulateStep() {
     #if ENGINE_SIM_ENABLE_SIGNPOST && defined(__APPLE__)
     os_signpost_interval_begin(s_engineSimPerfLog, sp_update, "entities::update");
     #endif
-    m_engine->update(timestep);
+    m_engine->update(timestep, m_stepState);
+    m_stepState.throttle = m_engine->getThrottle();     // The governor may have moved it
     m_vehicle->update(timestep);
     m_transmission->update(timestep);
 
@@ -195,36 +266,16 @@ bool Simulator::simulateStep() {
     s_updateTimeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(t2_update - t1_physics).count();
     #endif
 
-    Crankshaft *outputShaft = m_engine->getOutputCrankshaft();
-    outputShaft->resetAngle();
-
-    for (int i = 0; i < m_engine->getCrankshaftCount(); ++i) {
-        Crankshaft *shaft = m_engine->getCrankshaft(i);
-        shaft->m_body.theta = outputShaft->m_body.theta;
-    }
-
-    const double cycleAngle = outputShaft->getCycleAngle();
     const int index = static_cast<int>(std::floor(
-        DynoTorqueSamples * cycleAngle / (4 * constants::pi)
+        DynoTorqueSamples * m_stepState.cycleAngle / (4 * constants::pi)
     ));
-    const int step = m_engine->isSpinningCw() ? 1 : -1;
+    const int step = m_stepState.spinningCw ? 1 : -1;
     const double torque = m_dyno.getTorque();
-    m_dynoTorqueSamples[index] = torque;
+    m_dynoTorque.set(index, torque);
 
+    // Bins the crank skipped over since the last sample get the same torque
     if (m_lastDynoTorqueSample != index) {
-        for (int i = m_lastDynoTorqueSample + step; i != index; i += step) {
-            if (i >= DynoTorqueSamples) {
-                i = -1;
-                continue;
-            }
-            else if (i < 0) {
-                i = DynoTorqueSamples;
-                continue;
-            }
-
-            m_dynoTorqueSamples[i] = torque;
-        }
-
+        m_dynoTorque.fill(m_lastDynoTorqueSample, index, step, torque);
         m_lastDynoTorqueSample = index;
     }
 
@@ -244,7 +295,17 @@ bool Simulator::simulateStep() {
     s_simStepTimeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(t4_simstep - t3_dyno).count();
     #endif
 
-    writeToSynthesizer();
+    if (isSynthesizerActive()) {
+        const double fadeStep = timestep / SynthesizerFadeTime;
+        if (m_synthesizerGain < m_synthesizerGainTarget) {
+            m_synthesizerGain = std::min(m_synthesizerGainTarget, m_synthesizerGain + fadeStep);
+        }
+        else if (m_synthesizerGain > m_synthesizerGainTarget) {
+            m_synthesizerGain = std::max(m_synthesizerGainTarget, m_synthesizerGain - fadeStep);
+        }
+
+        writeToSynthesizer();
+    }
 
     #if ENGINE_SIM_ENABLE_STEP_TIMING
     const auto t5_synth = std::chrono::steady_clock::now();
@@ -262,6 +323,10 @@ bool Simulator::simulateStep() {
     ++s_profileSteps;
     #endif
 
+    if (isMechanicalStepComplete()) {
+        m_mechanicalStepPhase = 0;
+    }
+
     ++m_currentIteration;
     return true;
 }
@@ -275,6 +340,7 @@ int Simulator::readAudioOutput(int samples, int16_t *target) {
 }
 
 void Simulator::endFrame() {
+    if (!m_synthesizerEnabled) return;
     m_synthesizer.endInputBlock();
 }
 
@@ -288,10 +354,51 @@ void Simulator::destroy() {
         m_system = nullptr;
     }
 
-    if (m_dynoTorqueSamples != nullptr) {
-        delete[] m_dynoTorqueSamples;
-        m_dynoTorqueSamples = nullptr;
+    if (m_sleSolver != nullptr) {
+        delete m_sleSolver;
+        m_sleSolver = nullptr;
+    }
+
+    m_dynoTorque.destroy();
+}
+
+void Simulator::updateSolverStatistics() {
+    if (m_sleSolver == nullptr) return;
+
+    SolverStatistics &stats = m_solverStatistics;
+    stats.lastIterations = m_sleSolver->getLastIterations();
+    stats.lastResidual = m_sleSolver->getLastResidual();
+
+    ++stats.frameSteps;
+    stats.frameIterations += stats.lastIterations;
+    stats.frameMaxIterations = std::max(stats.frameMaxIterations, stats.lastIterations);
+    stats.frameMaxResidual = std::max(stats.frameMaxResidual, stats.lastResidual);
+    if (!m_sleSolver->didLastSolveConverge()) {
+        ++stats.frameUnconvergedSteps;
+    }
+}
+
+void Simulator::updateStepState() {
+    Crankshaft *outputShaft = m_engine->getOutputCrankshaft();
+    outputShaft->resetAngle();
+
+    // Every crankshaft shares the output shaft's angle
+    for (int i = 0; i < m_engine->getCrankshaftCount(); ++i) {
+        m_engine->getCrankshaft(i)->m_body.theta = outputShaft->m_body.theta;
     }
+
+    EngineStepState &state = m_stepState;
+    state.outputCrankshaft = outputShaft;
+    state.crankAngle = outputShaft->getAngle();
+    state.cycleAngle = outputShaft->getCycleAngle();
+    state.angularVelocity = outputShaft->m_body.v_theta;
+    state.speed = m_engine->getSpeed();
+    state.rpm = m_engine->getRpm();
+    state.manifoldPressure = (m_engine->getIntakeCount() > 0)
+        ? m_engine->getManifoldPressure()
+        : 0.0;
+    state.throttle = m_engine->getThrottle();
+    state.spinningCw = m_engine->isSpinningCw();
 }
 
 void Simulator::startAudioRenderingThread() {
@@ -307,14 +414,7 @@ double Simulator::getSynthesizerInputLatencyTarget() const {
 }
 
 double Simulator::getFilteredDynoTorque() const {
-    if (m_dynoTorqueSamples == nullptr) return 0;
-
-    double averageTorque = 0;
-    for (int i = 0; i < DynoTorqueSamples; ++i) {
-        averageTorque += m_dynoTorqueSamples[i];
-    }
-
-    return averageTorque / DynoTorqueSamples;
+    return m_dynoTorque.getMean();
 }
 
 double Simulator::getDynoPower() const {
@@ -345,6 +445,202 @@ void Simulator::initializeSynthesizer() {
 void Simulator::simulateStep_() {
 }
 
+void Simulator::writeState_(StateWriter *writer) const {
+    (void)writer;
+}
+
+void Simulator::readState_(StateReader *reader) {
+    (void)reader;
+}
+
+void Simulator::writeBodyState(const atg_scs::RigidBody &body, StateWriter *writer) {
+    writer->write(body.p_x);
+    writer->write(body.p_y);
+    writer->write(body.v_x);
+    writer->write(body.v_y);
+    writer->write(body.theta);
+    writer->write(body.v_theta);
+}
+
+void Simulator::readBodyState(atg_scs::RigidBody *body, StateReader *reader) {
+    reader->read(&body->p_x);
+    reader->read(&body->p_y);
+    reader->read(&body->v_x);
+    reader->read(&body->v_y);
+    reader->read(&body->theta);
+    reader->read(&body->v_theta);
+}
+
+void Simulator::writeState(StateWriter *writer) {
+    writer->write("ESSS", 4);
+    writer->write(StateVersion);
+    writer->write(m_engine->getCylinderCount());
+    writer->write(m_engine->getCrankshaftCount());
+    writer->write(m_engine->getExhaustSystemCount());
+    writer->write(m_engine->getIntakeCount());
+    writer->write(m_transmission->getGearCount());
+
+    writer->write(m_filteredEngineSpeed);
+    m_dynoTorque.writeState(writer);
+    writer->write(m_lastDynoTorqueSample);
+    writer->write(m_synthesizerGain);
+    writer->write(m_synthesizerGainTarget);
+
+    writer->write(m_dyno.m_enabled);
+    writer->write(m_dyno.m_hold);
+    writer->write(m_dyno.m_rotationSpeed);
+    writer->write(m_starterMotor.m_enabled);
+
+    m_engine->writeState(writer);
+    m_transmission->writeState(writer);
+    m_vehicle->writeState(writer);
+
+    writeState_(writer);
+
+    // Length-prefixed so that headless simulations can skip it
+    StateWriter synthesizerState;
+    if (m_synthesizerEnabled) {
+        m_synthesizer.writeState(&synthesizerState);
+    }
+
+    writer->write(static_cast<uint64_t>(synthesizerState.getSize()));
+    writer->writeBytes(synthesizerState.getData(), synthesizerState.getSize());
+}
+
+bool Simulator::readState(StateReader *reader) {
+    if (m_engine == nullptr) return false;
+
+    // Restoring part of a snapshot would leave the simulation inconsistent,
+    // so keep a copy of the current state to fall back to
+    StateWriter backup;
+    writeState(&backup);
+
+    if (readSnapshot(reader) && reader->isAtEnd()) {
+        // Multipliers from before the jump are a poor starting point
+        if (m_sleSolver != nullptr) m_sleSolver->reset();
+
+        // Snapshots don't record progress through a mechanical step; the
+        // restored crank angle becomes the start of a new one
+        m_mechanicalStepPhase = 0;
+        return true;
+    }
+
+    StateReader restore(backup.getData(), backup.getSize());
+    readSnapshot(&restore);
+
+    return false;
+}
+
+bool Simulator::readSnapshot(StateReader *reader) {
+    char magic[4];
+    uint32_t version = 0;
+    int cylinderCount = 0, crankshaftCount = 0, exhaustSystemCount = 0;
+    int intakeCount = 0, gearCount = 0;
+    reader->read(magic, 4);
+    reader->read(&version);
+    reader->read(&cylinderCount);
+    reader->read(&crankshaftCount);
+    reader->read(&exhaustSystemCount);
+    reader->read(&intakeCount);
+    reader->read(&gearCount);
+
+    if (!reader->isValid()
+        || std::memcmp(magic, "ESSS", 4) != 0
+        || version != StateVersion
+        || cylinderCount != m_engine->getCylinderCount()
+        || crankshaftCount != m_engine->getCrankshaftCount()
+        || exhaustSystemCount != m_engine->getExhaustSystemCount()
+        || intakeCount != m_engine->getIntakeCount()
+        || gearCount != m_transmission->getGearCount())
+    {
+        reader->invalidate();
+        return false;
+    }
+
+    reader->read(&m_filteredEngineSpeed);
+    m_dynoTorque.readState(reader);
+    reader->read(&m_lastDynoTorqueSample);
+    reader->read(&m_synthesizerGain);
+    reader->read(&m_synthesizerGainTarget);
+
+    reader->read(&m_dyno.m_enabled);
+    reader->read(&m_dyno.m_hold);
+    reader->read(&m_dyno.m_rotationSpeed);
+    reader->read(&m_starterMotor.m_enabled);
+
+    m_engine->readState(reader);
+    m_transmission->readState(reader);
+    m_vehicle->readState(reader);
+
+    readState_(reader);
+
+    // Audio state is only restored into a simulation that renders audio, so a
+    // headless snapshot still warms up the physics of an audible one
+    uint64_t synthesizerStateSize = 0;
+    reader->read(&synthesizerStateSize);
+    if (!reader->isValid() || synthesizerStateSize > reader->getRemaining()) {
+        reader->invalidate();
+        return false;
+    }
+
+    if (synthesizerStateSize > 0 && m_synthesizerEnabled) {
+        StateReader synthesizerState(reader->getCurrent(), synthesizerStateSize);
+        if (!m_synthesizer.readState(&synthesizerState) || !synthesizerState.isAtEnd()) {
+            reader->invalidate();
+            return false;
+        }
+    }
+
+    reader->skip(synthesizerStateSize);
+
+    return reader->isValid();
+}
+
+bool Simulator::saveState(const std::string &path) {
+    if (m_engine == nullptr) return false;
+
+    StateWriter writer;
+    writeState(&writer);
+    return writer.save(path);
+}
+
+bool Simulator::loadState(const std::string &path) {
+    if (m_engine == nullptr) return false;
+
+    StateReader reader;
+    return reader.load(path) && readState(&reader);
+}
+
+void Simulator::onSimulationFrequencyChanged(int previousFrequency) {
+    (void)previousFrequency;
+}
+
+void Simulator::updateQualityTier() {
+    const QualityTier target = m_pendingQualityTier;
+    m_synthesizerGainTarget =
+        (target == QualityTier::Full || target == QualityTier::Reduced)
+        ? 1.0
+        : 0.0;
+
+    // Keep stepping until the synthesizer input has faded out, otherwise the
+    // audio stream would stop on a discontinuity
+    QualityTier tier = target;
+    if (tier == QualityTier::Frozen && m_synthesizerGain > 0) {
+        tier = QualityTier::PhysicsOnly;
+    }
+
+    m_qualityTier = tier;
+
+    const int frequency = (tier == QualityTier::Full)
+        ? m_fullQualitySimulationFrequency
+        : std::max(1, m_fullQualitySimulationFrequency / ReducedQualityFrequencyDivisor);
+    if (frequency != m_simulationFrequency) {
+        const int previousFrequency = m_simulationFrequency;
+        m_simulationFrequency = frequency;
+        onSimulationFrequencyChanged(previousFrequency);
+    }
+}
+
 void Simulator::updateFilteredEngineSpeed(double dt) {
     const double alpha = dt / (100 + dt);
     m_filteredEngineSpeed = alpha * m_filteredEngineSpeed + (1 - alpha) * m_engine->getRpm();
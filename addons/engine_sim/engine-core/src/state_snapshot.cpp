@@ -0,0 +1,86 @@
+#include "../include/state_snapshot.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+StateWriter::StateWriter() {
+    /* void */
+}
+
+StateWriter::~StateWriter() {
+    /* void */
+}
+
+void StateWriter::writeBytes(const void *data, size_t size) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    m_data.insert(m_data.end(), bytes, bytes + size);
+}
+
+bool StateWriter::save(const std::string &path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    file.write(reinterpret_cast<const char *>(m_data.data()), m_data.size());
+    return file.good();
+}
+
+StateReader::StateReader() {
+    m_data = nullptr;
+    m_size = 0;
+    m_offset = 0;
+    m_valid = true;
+}
+
+StateReader::StateReader(const uint8_t *data, size_t size) {
+    m_data = data;
+    m_size = size;
+    m_offset = 0;
+    m_valid = true;
+}
+
+StateReader::~StateReader() {
+    /* void */
+}
+
+bool StateReader::readBytes(void *data, size_t size) {
+    if (!m_valid || size > m_size - m_offset) {
+        m_valid = false;
+        return false;
+    }
+
+    std::memcpy(data, m_data + m_offset, size);
+    m_offset += size;
+
+    return true;
+}
+
+bool StateReader::skip(size_t size) {
+    if (!m_valid || size > m_size - m_offset) {
+        m_valid = false;
+        return false;
+    }
+
+    m_offset += size;
+
+    return true;
+}
+
+bool StateReader::load(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        m_valid = false;
+        return false;
+    }
+
+    m_storage.assign(
+        std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>());
+
+    m_data = m_storage.data();
+    m_size = m_storage.size();
+    m_offset = 0;
+    m_valid = true;
+
+    return true;
+}
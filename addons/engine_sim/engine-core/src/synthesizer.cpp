@@ -1,5 +1,7 @@
 #include "../include/synthesizer.h"
 
+#include "../include/arena.h"
+
 #include <cassert>
 #include <cmath>
 #include <chrono>
@@ -34,6 +36,8 @@ Synthesizer::~Synthesizer() {
 }
 
 void Synthesizer::initialize(const Parameters &p) {
+    Arena::CategoryScope scope(Arena::Category::Synthesizer);
+
     m_inputChannelCount = p.inputChannelCount;
     m_inputBufferSize = p.inputBufferSize;
     m_inputWriteOffset = p.inputBufferSize;
@@ -50,7 +54,7 @@ void Synthesizer::initialize(const Parameters &p) {
     m_audioBuffer.initialize(p.audioBufferSize);
     m_inputChannels = new InputChannel[p.inputChannelCount];
     for (int i = 0; i < p.inputChannelCount; ++i) {
-        m_inputChannels[i].transferBuffer = new float[p.inputBufferSize];
+        m_inputChannels[i].transferBuffer = Arena::allocate<float>(p.inputBufferSize);
         m_inputChannels[i].data.initialize(p.inputBufferSize);
     }
 
@@ -88,6 +92,8 @@ void Synthesizer::initializeImpulseResponse(
     float volume,
     int index)
 {
+    Arena::CategoryScope scope(Arena::Category::Synthesizer);
+
     unsigned int clippedLength = 0;
     for (unsigned int i = 0; i < samples; ++i) {
         if (std::abs(impulseResponse[i]) > 100) {
@@ -119,6 +125,32 @@ void Synthesizer::initializeImpulseResponse(
     }
 }
 
+void Synthesizer::copyImpulseResponses(Synthesizer &source) {
+    Arena::CategoryScope scope(Arena::Category::Synthesizer);
+
+    for (int i = 0; i < m_inputChannelCount; ++i) {
+        ConvolutionFilter &from = source.m_filters[i].convolution;
+        if (from.getImpulseResponse() == nullptr) continue;
+
+        ConvolutionFilter &to = m_filters[i].convolution;
+        to.destroy();
+        to.initialize(from.getSampleCount());
+        std::memcpy(
+            to.getImpulseResponse(),
+            from.getImpulseResponse(),
+            sizeof(float) * from.getSampleCount());
+    }
+
+    if (source.m_masterConvolution.getImpulseResponse() != nullptr) {
+        m_masterConvolution.destroy();
+        m_masterConvolution.initialize(source.m_masterConvolution.getSampleCount());
+        std::memcpy(
+            m_masterConvolution.getImpulseResponse(),
+            source.m_masterConvolution.getImpulseResponse(),
+            sizeof(float) * source.m_masterConvolution.getSampleCount());
+    }
+}
+
 void Synthesizer::startAudioRenderingThread() {
     m_run = true;
     m_thread = new std::thread(&Synthesizer::audioRenderingThread, this);
@@ -144,6 +176,7 @@ void Synthesizer::destroy() {
 
     for (int i = 0; i < m_inputChannelCount; ++i) {
         m_inputChannels[i].data.destroy();
+        Arena::free(m_inputChannels[i].transferBuffer);
         m_filters[i].convolution.destroy();
     }
 
@@ -300,6 +333,8 @@ void Synthesizer::renderAudio() {
         m_inputChannels[i].data.readAndRemove(n, m_inputChannels[i].transferBuffer);
     }
 
+    // Held while the filters run so that snapshots never see a half-rendered block
+    std::lock_guard<std::mutex> inputLock(m_inputLock);
     lk0.unlock();
 
     for (int i = 0; i < m_inputChannelCount; ++i) {
@@ -315,6 +350,26 @@ void Synthesizer::renderAudio() {
     m_cv0.notify_one();
 }
 
+int Synthesizer::renderPending(int16_t *target, int maxSamples) {
+    if (m_inputChannelCount == 0) return 0;
+
+    const int n = std::min(maxSamples, (int)m_inputChannels[0].data.size());
+    if (n <= 0) return 0;
+
+    for (int i = 0; i < m_inputChannelCount; ++i) {
+        m_inputChannels[i].data.readAndRemove(n, m_inputChannels[i].transferBuffer);
+        m_filters[i].airNoiseLowPass.setCutoffFrequency(
+            static_cast<float>(m_audioParameters.airNoiseFrequencyCutoff), m_audioSampleRate);
+        m_filters[i].jitterFilter.setJitterScale(m_audioParameters.inputSampleNoise);
+    }
+
+    for (int i = 0; i < n; ++i) {
+        target[i] = renderAudio(i);
+    }
+
+    return n;
+}
+
 double Synthesizer::getLatency() const {
     return (double)m_latency / m_audioSampleRate;
 }
@@ -430,3 +485,67 @@ void Synthesizer::setAudioParameters(const AudioParameters &params) {
     std::lock_guard<std::mutex> lock(m_lock0);
     m_audioParameters = params;
 }
+
+void Synthesizer::writeState(StateWriter *writer) {
+    std::lock_guard<std::mutex> lk0(m_lock0);
+    std::lock_guard<std::mutex> inputLock(m_inputLock);
+
+    writer->write(m_inputChannelCount);
+    for (int i = 0; i < m_inputChannelCount; ++i) {
+        m_inputChannels[i].data.writeState(writer);
+        writer->write(m_inputChannels[i].lastInputSample);
+
+        ProcessingFilters &filters = m_filters[i];
+        filters.convolution.writeState(writer);
+        filters.derivative.writeState(writer);
+        filters.jitterFilter.writeState(writer);
+        filters.airNoiseLowPass.writeState(writer);
+        filters.inputDcFilter.writeState(writer);
+        filters.antialiasing.writeState(writer);
+    }
+
+    m_antialiasing.writeState(writer);
+    m_levelingFilter.writeState(writer);
+    m_masterConvolution.writeState(writer);
+    m_audioBuffer.writeState(writer);
+
+    writer->write(m_latency);
+    writer->write(m_inputWriteOffset);
+    writer->write(m_lastInputSampleOffset);
+}
+
+bool Synthesizer::readState(StateReader *reader) {
+    std::lock_guard<std::mutex> lk0(m_lock0);
+    std::lock_guard<std::mutex> inputLock(m_inputLock);
+
+    int inputChannelCount = 0;
+    if (!reader->read(&inputChannelCount)) return false;
+    if (inputChannelCount != m_inputChannelCount) {
+        reader->invalidate();
+        return false;
+    }
+
+    for (int i = 0; i < m_inputChannelCount; ++i) {
+        m_inputChannels[i].data.readState(reader);
+        reader->read(&m_inputChannels[i].lastInputSample);
+
+        ProcessingFilters &filters = m_filters[i];
+        filters.convolution.readState(reader);
+        filters.derivative.readState(reader);
+        filters.jitterFilter.readState(reader);
+        filters.airNoiseLowPass.readState(reader);
+        filters.inputDcFilter.readState(reader);
+        filters.antialiasing.readState(reader);
+    }
+
+    m_antialiasing.readState(reader);
+    m_levelingFilter.readState(reader);
+    m_masterConvolution.readState(reader);
+    m_audioBuffer.readState(reader);
+
+    reader->read(&m_latency);
+    reader->read(&m_inputWriteOffset);
+    reader->read(&m_lastInputSampleOffset);
+
+    return reader->isValid();
+}
@@ -12,6 +12,14 @@ void Throttle::setSpeedControl(double s) {
     m_speedControl = s;
 }
 
-void Throttle::update(double dt, Engine *engine) {
+void Throttle::update(double dt, const EngineStepState &state, Engine *engine) {
     /* void */
 }
+
+void Throttle::writeState(StateWriter *writer) const {
+    writer->write(m_speedControl);
+}
+
+void Throttle::readState(StateReader *reader) {
+    reader->read(&m_speedControl);
+}
@@ -1,5 +1,6 @@
 #include "../include/transmission.h"
 
+#include "../include/arena.h"
 #include "../include/units.h"
 
 #include <cmath>
@@ -16,9 +17,7 @@ Transmission::Transmission() {
 }
 
 Transmission::~Transmission() {
-    if (m_gearRatios != nullptr) {
-        delete[] m_gearRatios;
-    }
+    Arena::free(m_gearRatios);
 
     m_gearRatios = nullptr;
 }
@@ -26,7 +25,7 @@ Transmission::~Transmission() {
 void Transmission::initialize(const Parameters &params) {
     m_gearCount = params.GearCount;
     m_maxClutchTorque = params.MaxClutchTorque;
-    m_gearRatios = new double[params.GearCount];
+    m_gearRatios = Arena::allocate<double>(params.GearCount);
     memcpy(m_gearRatios, params.GearRatios, sizeof(double) * m_gearCount);
 }
 
@@ -80,3 +79,22 @@ void Transmission::changeGear(int newGear) {
 
     m_gear = newGear;
 }
+
+void Transmission::writeState(StateWriter *writer) const {
+    writer->write(m_gear);
+    writer->write(m_newGear);
+    writer->write(m_clutchPressure);
+}
+
+void Transmission::readState(StateReader *reader) {
+    int gear = -1;
+    if (!reader->read(&gear)) return;
+    if (gear < -1 || gear >= m_gearCount) {
+        reader->invalidate();
+        return;
+    }
+
+    m_gear = gear;
+    reader->read(&m_newGear);
+    reader->read(&m_clutchPressure);
+}
@@ -49,3 +49,11 @@ double Vehicle::linearForceToVirtualTorque(double force) const {
         std::sqrt(m_rotatingMass->I / m_mass);
     return rotationToKineticRatio * force;
 }
+
+void Vehicle::writeState(StateWriter *writer) const {
+    writer->write(m_travelledDistance);
+}
+
+void Vehicle::readState(StateReader *reader) {
+    reader->read(&m_travelledDistance);
+}
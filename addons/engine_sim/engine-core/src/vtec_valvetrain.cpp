@@ -58,9 +58,32 @@ Camshaft *VtecValvetrain::getActiveExhaustCamshaft() {
         : m_exhaustCamshaft;
 }
 
+Camshaft *VtecValvetrain::getIntakeCamshaft(int mode) {
+    return (mode == 1)
+        ? m_vtecIntakeCamshaft
+        : m_intakeCamshaft;
+}
+
+Camshaft *VtecValvetrain::getExhaustCamshaft(int mode) {
+    return (mode == 1)
+        ? m_vtecExhaustCamshaft
+        : m_exhaustCamshaft;
+}
+
 bool VtecValvetrain::isVtecEnabled() const {
+    return isVtecEnabled(
+        m_engine->getManifoldPressure(),
+        m_engine->getSpeed(),
+        m_engine->getThrottle());
+}
+
+bool VtecValvetrain::isVtecEnabled(const EngineStepState &state) const {
+    return isVtecEnabled(state.manifoldPressure, state.speed, state.throttle);
+}
+
+bool VtecValvetrain::isVtecEnabled(double manifoldPressure, double speed, double throttle) const {
     return
-        m_engine->getManifoldPressure() > m_manifoldVacuum
-        && m_engine->getSpeed() > m_minRpm
-        && (1 - m_engine->getThrottle()) > m_minThrottlePosition;
+        manifoldPressure > m_manifoldVacuum
+        && speed > m_minRpm
+        && (1 - throttle) > m_minThrottlePosition;
 }
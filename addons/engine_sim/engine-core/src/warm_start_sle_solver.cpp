@@ -0,0 +1,168 @@
+#include "../include/warm_start_sle_solver.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int BodiesPerRow = 2;
+constexpr int BlockSize = 3;
+constexpr uint8_t NoBlock = 0xFF;
+
+} // namespace
+
+WarmStartSleSolver::WarmStartSleSolver() : atg_scs::SleSolver(true) {
+    m_maxIterations = 32;
+    m_relativeTolerance = 1E-3;
+    m_absoluteTolerance = 1E-9;
+    m_warmStart = true;
+
+    m_lastIterations = 0;
+    m_lastResidual = 0.0;
+    m_lastConverged = true;
+}
+
+WarmStartSleSolver::~WarmStartSleSolver() {
+    m_lambda.destroy();
+    m_impulse.destroy();
+    m_diagonal.destroy();
+}
+
+bool WarmStartSleSolver::solve(
+    atg_scs::SparseMatrix<3> &J,
+    atg_scs::Matrix &W,
+    atg_scs::Matrix &right,
+    atg_scs::Matrix *result,
+    atg_scs::Matrix *previous)
+{
+    (void)previous;
+    return solve_(J, W, right, nullptr, result);
+}
+
+bool WarmStartSleSolver::solveWithLimits(
+    atg_scs::SparseMatrix<3> &J,
+    atg_scs::Matrix &W,
+    atg_scs::Matrix &right,
+    atg_scs::Matrix &limits,
+    atg_scs::Matrix *result,
+    atg_scs::Matrix *previous)
+{
+    (void)previous;
+    return solve_(J, W, right, &limits, result);
+}
+
+void WarmStartSleSolver::reset() {
+    m_lambda.destroy();
+}
+
+bool WarmStartSleSolver::solve_(
+    atg_scs::SparseMatrix<3> &J,
+    atg_scs::Matrix &W,
+    atg_scs::Matrix &right,
+    atg_scs::Matrix *limits,
+    atg_scs::Matrix *result)
+{
+    const int n = J.getHeight();
+    const int n_w = W.getHeight();
+
+    // The stored multipliers are only meaningful if the system has the same
+    // shape as last time; the constraint order is fixed once loaded
+    if (!m_warmStart || m_lambda.getHeight() != n) {
+        m_lambda.initialize(1, n, 0.0);
+    }
+
+    if (m_diagonal.getHeight() != n) m_diagonal.initialize(1, n, 0.0);
+    m_impulse.initialize(1, n_w, 0.0);
+
+    double rightNorm = 0.0;
+    for (int i = 0; i < n; ++i) {
+        double A_ii = 0.0;
+        double lambda = m_lambda.get(0, i);
+
+        if (limits != nullptr) {
+            lambda = std::max(limits->get(0, i), std::min(limits->get(1, i), lambda));
+            m_lambda.set(0, i, lambda);
+        }
+
+        for (int k = 0; k < BodiesPerRow; ++k) {
+            const uint8_t block = J.getBlockIndex(i, k);
+            if (block == NoBlock) continue;
+
+            for (int s = 0; s < BlockSize; ++s) {
+                const int index = block * BlockSize + s;
+                const double j = J.get(i, k, s);
+                const double w = W.get(0, index);
+
+                A_ii += j * j * w;
+                m_impulse.add(0, index, w * j * lambda);
+            }
+        }
+
+        m_diagonal.set(0, i, (A_ii > 0) ? 1.0 / A_ii : 0.0);
+        rightNorm = std::max(rightNorm, std::abs(right.get(0, i)));
+    }
+
+    const double tolerance =
+        std::max(m_relativeTolerance * rightNorm, m_absoluteTolerance);
+
+    m_lastIterations = 0;
+    m_lastResidual = 0.0;
+    m_lastConverged = (n == 0);
+
+    for (int iteration = 0; iteration < m_maxIterations && n > 0; ++iteration) {
+        double maxResidual = 0.0;
+
+        for (int i = 0; i < n; ++i) {
+            const double inv_A_ii = m_diagonal.get(0, i);
+            if (inv_A_ii == 0) continue;
+
+            double Ax = 0.0;
+            for (int k = 0; k < BodiesPerRow; ++k) {
+                const uint8_t block = J.getBlockIndex(i, k);
+                if (block == NoBlock) continue;
+
+                for (int s = 0; s < BlockSize; ++s) {
+                    Ax += J.get(i, k, s) * m_impulse.get(0, block * BlockSize + s);
+                }
+            }
+
+            const double lambda = m_lambda.get(0, i);
+            double next = lambda + (right.get(0, i) - Ax) * inv_A_ii;
+            if (limits != nullptr) {
+                next = std::max(limits->get(0, i), std::min(limits->get(1, i), next));
+            }
+
+            const double delta = next - lambda;
+            if (delta == 0) continue;
+
+            m_lambda.set(0, i, next);
+            for (int k = 0; k < BodiesPerRow; ++k) {
+                const uint8_t block = J.getBlockIndex(i, k);
+                if (block == NoBlock) continue;
+
+                for (int s = 0; s < BlockSize; ++s) {
+                    const int index = block * BlockSize + s;
+                    m_impulse.add(0, index, W.get(0, index) * J.get(i, k, s) * delta);
+                }
+            }
+
+            // Projected residual of this row, in the units of the right-hand side
+            maxResidual = std::max(maxResidual, std::abs(delta) / inv_A_ii);
+        }
+
+        m_lastIterations = iteration + 1;
+        m_lastResidual = (rightNorm > 0) ? maxResidual / rightNorm : maxResidual;
+
+        if (maxResidual <= tolerance) {
+            m_lastConverged = true;
+            break;
+        }
+    }
+
+    result->initialize(1, n, 0.0);
+    for (int i = 0; i < n; ++i) {
+        result->set(0, i, m_lambda.get(0, i));
+    }
+
+    return m_lastConverged;
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include "../include/angle_binned_aggregate.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int Bins = 512;
+
+// The gap fill the simulator used to do for dyno torque samples
+void referenceFill(std::vector<double> &samples, int last, int index, int step, double value) {
+    const int n = static_cast<int>(samples.size());
+    for (int i = last + step; i != index; i += step) {
+        if (i >= n) {
+            i = -1;
+            continue;
+        }
+        else if (i < 0) {
+            i = n;
+            continue;
+        }
+
+        samples[i] = value;
+    }
+}
+
+double referenceMean(const std::vector<double> &samples) {
+    double sum = 0;
+    for (double v : samples) sum += v;
+    return sum / samples.size();
+}
+
+double referenceMax(const std::vector<double> &samples) {
+    double max = 0;
+    for (double v : samples) {
+        if (v > max) max = v;
+    }
+
+    return max;
+}
+
+} // namespace
+
+TEST(AngleBinnedAggregateTests, MatchesDynoTorqueSampling) {
+    AngleBinnedAggregate aggregate;
+    aggregate.initialize(Bins);
+    std::vector<double> reference(Bins, 0.0);
+
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> advance(0, 40);
+    std::uniform_int_distribution<int> reverse(0, 50);
+    std::uniform_real_distribution<double> torque(-50.0, 400.0);
+
+    int step = 1;
+    int last = 0;
+    for (int i = 0; i < 20000; ++i) {
+        if (reverse(rng) == 0) step = -step;
+
+        const int index = ((last + step * advance(rng)) % Bins + Bins) % Bins;
+        const double value = torque(rng);
+
+        aggregate.set(index, value);
+        reference[index] = value;
+        if (last != index) {
+            aggregate.fill(last, index, step, value);
+            referenceFill(reference, last, index, step, value);
+            last = index;
+        }
+
+        ASSERT_NEAR(aggregate.getMean(), referenceMean(reference), 1E-9);
+    }
+
+    for (int i = 0; i < Bins; ++i) {
+        EXPECT_EQ(aggregate.get(i), reference[i]);
+    }
+
+    aggregate.destroy();
+}
+
+TEST(AngleBinnedAggregateTests, MatchesCycleScans) {
+    constexpr int StateSamples = 256;
+
+    AngleBinnedAggregate pressure, speed;
+    pressure.initialize(StateSamples);
+    speed.initialize(StateSamples);
+    std::vector<double> pressureReference(StateSamples, 0.0);
+    std::vector<double> speedReference(StateSamples, 0.0);
+
+    // A pressure peak once per cycle that grows and then falls off, so the
+    // bin holding the maximum gets overwritten with smaller values
+    for (int cycle = 0; cycle < 20; ++cycle) {
+        const double peak = (cycle < 10) ? 1E6 * (cycle + 1) : 1E6 * (20 - cycle);
+        for (int i = 0; i < StateSamples; ++i) {
+            const double p = 1E5 + ((i == 37 + cycle) ? peak : 0.5 * peak * i / StateSamples);
+            const double v = 10.0 * std::abs(std::sin(i * 0.05 + cycle));
+
+            pressure.set(i, p);
+            speed.set(i, v);
+            pressureReference[i] = p;
+            speedReference[i] = v;
+
+            if (i % 32 == 0) {
+                ASSERT_EQ(pressure.getMax(), referenceMax(pressureReference));
+                ASSERT_NEAR(speed.getMean(), referenceMean(speedReference), 1E-12);
+            }
+        }
+    }
+
+    pressure.destroy();
+    speed.destroy();
+}
+
+TEST(AngleBinnedAggregateTests, RestoresFromState) {
+    AngleBinnedAggregate aggregate;
+    aggregate.initialize(16);
+    for (int i = 0; i < 16; ++i) {
+        aggregate.set(i, i * 1.5);
+    }
+
+    StateWriter writer;
+    aggregate.writeState(&writer);
+
+    AngleBinnedAggregate restored;
+    restored.initialize(16);
+    StateReader reader(writer.getData(), writer.getSize());
+    restored.readState(&reader);
+
+    EXPECT_TRUE(reader.isAtEnd());
+    EXPECT_DOUBLE_EQ(restored.getSum(), aggregate.getSum());
+    EXPECT_DOUBLE_EQ(restored.getMax(), 15 * 1.5);
+
+    aggregate.destroy();
+    restored.destroy();
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include "../include/arena.h"
+#include "../include/ring_buffer.h"
+
+#include <cstdint>
+
+namespace {
+
+bool isAligned(const void *p) {
+    return reinterpret_cast<uintptr_t>(p) % Arena::Alignment == 0;
+}
+
+} // namespace
+
+TEST(ArenaTests, FallsBackToHeapWithoutScope) {
+    double *buffer = Arena::allocate<double>(17);
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_TRUE(isAligned(buffer));
+
+    for (int i = 0; i < 17; ++i) buffer[i] = i;
+    Arena::free(buffer);
+    Arena::free<double>(nullptr);
+}
+
+TEST(ArenaTests, AllocatesAlignedFromCurrentArena) {
+    Arena arena;
+    arena.initialize(1024);
+
+    {
+        Arena::Scope scope(&arena);
+
+        char *a = Arena::allocate<char>(1);
+        double *b = Arena::allocate<double>(3);
+        EXPECT_TRUE(isAligned(a));
+        EXPECT_TRUE(isAligned(b));
+        EXPECT_NE(static_cast<void *>(a), static_cast<void *>(b));
+
+        // Larger than a chunk
+        float *c = Arena::allocate<float>(4096);
+        EXPECT_TRUE(isAligned(c));
+        c[4095] = 1.0f;
+
+        // Arena buffers are only reclaimed with the arena
+        const size_t used = arena.getUsed();
+        Arena::free(b);
+        EXPECT_EQ(arena.getUsed(), used);
+    }
+
+    EXPECT_GT(arena.getUsed(), 4096 * sizeof(float));
+    EXPECT_GE(arena.getReserved(), arena.getUsed());
+
+    // Outside the scope allocations go back to the heap
+    int *heap = Arena::allocate<int>(4);
+    EXPECT_EQ(arena.getUsed(), arena.getUsed(Arena::Category::Engine));
+    Arena::free(heap);
+
+    arena.destroy();
+    EXPECT_EQ(arena.getUsed(), 0);
+    EXPECT_EQ(arena.getReserved(), 0);
+}
+
+TEST(ArenaTests, AttributesAllocationsToCategory) {
+    Arena arena;
+    arena.initialize();
+
+    Arena::Scope scope(&arena);
+    Arena::allocate<double>(8);
+    {
+        Arena::CategoryScope synthesizer(Arena::Category::Synthesizer);
+
+        RingBuffer<float> buffer;
+        buffer.initialize(1000);
+        buffer.destroy();
+
+        {
+            Arena::CategoryScope simulation(Arena::Category::Simulation);
+            Arena::allocate<int>(2);
+        }
+
+        Arena::allocate<int>(2);
+    }
+
+    const size_t engine = arena.getUsed(Arena::Category::Engine);
+    const size_t simulation = arena.getUsed(Arena::Category::Simulation);
+    const size_t synthesizer = arena.getUsed(Arena::Category::Synthesizer);
+    EXPECT_GE(engine, 8 * sizeof(double));
+    EXPECT_GT(simulation, 0);
+    EXPECT_GE(synthesizer, 1000 * sizeof(float));
+    EXPECT_EQ(engine + simulation + synthesizer, arena.getUsed());
+
+    arena.destroy();
+}
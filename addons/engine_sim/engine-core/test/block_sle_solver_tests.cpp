@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include "../include/block_sle_solver.h"
+
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int Cylinders = 6;
+
+// Crankshaft (body 0), vehicle (body 1) and a piston and rod per cylinder,
+// with rows laid out the way PistonEngineSimulator adds its constraints
+struct EngineSystem {
+    atg_scs::SparseMatrix<3> J;
+    atg_scs::Matrix W, right, limits;
+    int rows = 0;
+    int bodies = 0;
+
+    // Without torque limits the friction and starter rows are left out, as
+    // they would act on the same degree of freedom with no bound
+    void build(unsigned int seed, double torqueLimit) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> value(-1.0, 1.0);
+
+        struct Row { int b0, b1; double lo, hi; };
+        std::vector<Row> layout;
+        const double inf = DBL_MAX;
+
+        layout.push_back({ 0, 0xFF, -inf, inf });                       // Crank position
+        layout.push_back({ 0, 0xFF, -inf, inf });
+        layout.push_back({ 0, 1, -2 * torqueLimit, 2 * torqueLimit });  // Clutch
+        layout.push_back({ 1, 0xFF, -inf, inf });                       // Vehicle
+        if (torqueLimit < inf) {
+            layout.push_back({ 0, 0xFF, -torqueLimit, torqueLimit });   // Crank friction
+            layout.push_back({ 0, 0xFF, -torqueLimit, torqueLimit });   // Starter
+        }
+
+        for (int i = 0; i < Cylinders; ++i) {
+            const int piston = 2 + 2 * i, rod = piston + 1;
+            layout.push_back({ rod, piston, -inf, inf });
+            layout.push_back({ rod, piston, -inf, inf });
+            layout.push_back({ rod, 0, -inf, inf });
+            layout.push_back({ rod, 0, -inf, inf });
+            layout.push_back({ piston, 0xFF, -inf, inf });
+        }
+
+        rows = static_cast<int>(layout.size());
+        bodies = 2 + 2 * Cylinders;
+
+        J.initialize(bodies * 3, rows);
+        W.initialize(1, bodies * 3);
+        right.initialize(1, rows);
+        limits.initialize(2, rows);
+
+        for (int b = 0; b < bodies; ++b) {
+            const double m = (b == 0) ? 20.0 : 1.0 + 0.5 * b;
+            W.set(0, b * 3 + 0, 1 / m);
+            W.set(0, b * 3 + 1, 1 / m);
+            W.set(0, b * 3 + 2, 1 / (0.05 * m));
+        }
+
+        for (int i = 0; i < rows; ++i) {
+            J.setBlock(i, 0, static_cast<uint8_t>(layout[i].b0));
+            J.setBlock(i, 1, static_cast<uint8_t>(layout[i].b1));
+            for (int k = 0; k < 2; ++k) {
+                for (int s = 0; s < 3; ++s) {
+                    J.set(i, k, s, (k == 1 && layout[i].b1 == 0xFF) ? 0.0 : value(rng));
+                }
+            }
+
+            right.set(0, i, 10 * value(rng));
+            limits.set(0, i, layout[i].lo);
+            limits.set(1, i, layout[i].hi);
+        }
+    }
+
+    double maxRelativeError(const atg_scs::Matrix &a, const atg_scs::Matrix &b) const {
+        double error = 0.0, scale = 0.0;
+        for (int i = 0; i < rows; ++i) {
+            error = std::max(error, std::abs(a.get(0, i) - b.get(0, i)));
+            scale = std::max(scale, std::abs(a.get(0, i)));
+        }
+
+        return error / scale;
+    }
+
+    // Redundant rows can split their load any way they like, so compare the
+    // resulting body impulses instead of the multipliers
+    double maxImpulseError(const atg_scs::Matrix &a, const atg_scs::Matrix &b) {
+        std::vector<double> impulse(bodies * 3, 0.0);
+        for (int i = 0; i < rows; ++i) {
+            for (int k = 0; k < 2; ++k) {
+                const uint8_t block = J.getBlockIndex(i, k);
+                if (block == 0xFF) continue;
+                for (int s = 0; s < 3; ++s) {
+                    const int index = block * 3 + s;
+                    impulse[index] += W.get(0, index) * J.get(i, k, s) * (a.get(0, i) - b.get(0, i));
+                }
+            }
+        }
+
+        double error = 0.0;
+        for (double v : impulse) error = std::max(error, std::abs(v));
+        return error;
+    }
+};
+
+} // namespace
+
+TEST(BlockSleSolverTests, MatchesIterativeSolution) {
+    EngineSystem system;
+    system.build(1, DBL_MAX);
+
+    WarmStartSleSolver reference;
+    reference.m_maxIterations = 100000;
+    reference.m_relativeTolerance = 1E-13;
+
+    atg_scs::Matrix expected, result;
+    reference.solve(system.J, system.W, system.right, &expected, nullptr);
+
+    BlockSleSolver solver;
+    EXPECT_TRUE(solver.solve(system.J, system.W, system.right, &result, nullptr));
+    EXPECT_EQ(solver.getFallbackCount(), 0);
+    EXPECT_EQ(solver.getLastIterations(), 0);
+    EXPECT_EQ(solver.getLastActiveSetPasses(), 1);
+    EXPECT_LT(system.maxRelativeError(expected, result), 1E-7);
+}
+
+TEST(BlockSleSolverTests, ClampsLimitedRows) {
+    EngineSystem system;
+    system.build(2, 0.5);
+
+    WarmStartSleSolver reference;
+    reference.m_maxIterations = 100000;
+    reference.m_relativeTolerance = 1E-13;
+
+    atg_scs::Matrix expected, result;
+    reference.solveWithLimits(system.J, system.W, system.right, system.limits, &expected, nullptr);
+
+    BlockSleSolver solver;
+    EXPECT_TRUE(solver.solveWithLimits(system.J, system.W, system.right, system.limits, &result, nullptr));
+    EXPECT_EQ(solver.getFallbackCount(), 0);
+    EXPECT_EQ(solver.getLastIterations(), 0);
+    EXPECT_GT(solver.getLastActiveSetPasses(), 1);
+    EXPECT_LT(system.maxImpulseError(expected, result), 1E-5);
+
+    for (int i = 0; i < system.rows; ++i) {
+        EXPECT_GE(result.get(0, i), system.limits.get(0, i));
+        EXPECT_LE(result.get(0, i), system.limits.get(1, i));
+    }
+}
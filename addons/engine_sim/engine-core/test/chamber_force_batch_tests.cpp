@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include "test_engine.h"
+
+#include "../include/chamber_force_batch.h"
+#include "../include/piston_engine_simulator.h"
+#include "../include/units.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// Zeroed system state with room for every body up to the given index
+struct TestSystemState {
+    explicit TestSystemState(int n)
+        : a_theta(n), v_theta(n), theta(n), a_x(n), a_y(n), v_x(n), v_y(n),
+          p_x(n), p_y(n), f_x(n), f_y(n), t(n), m(n, 1.0)
+    {
+        state.n = n;
+        state.a_theta = a_theta.data();
+        state.v_theta = v_theta.data();
+        state.theta = theta.data();
+        state.a_x = a_x.data();
+        state.a_y = a_y.data();
+        state.v_x = v_x.data();
+        state.v_y = v_y.data();
+        state.p_x = p_x.data();
+        state.p_y = p_y.data();
+        state.f_x = f_x.data();
+        state.f_y = f_y.data();
+        state.t = t.data();
+        state.m = m.data();
+    }
+
+    std::vector<double> a_theta, v_theta, theta, a_x, a_y, v_x, v_y, p_x, p_y, f_x, f_y, t, m;
+    atg_scs::SystemState state;
+};
+
+} // namespace
+
+TEST(ChamberForceBatchTests, MatchesPerChamberForces) {
+    constexpr int CylinderCount = 4;
+    EnginePack::Objects objects = createTestEngine(CylinderCount);
+    Engine *engine = objects.engine;
+
+    PistonEngineSimulator simulator;
+    simulator.initialize(objects.simulatorParameters);
+    simulator.setSimulationFrequency(10000);
+    simulator.loadSimulation(engine, objects.vehicle, objects.transmission);
+    engine->getIgnitionModule()->m_enabled = true;
+    engine->getCrankshaft(0)->m_body.v_theta = -units::rpm(2000);
+
+    // Get the chambers away from their identical starting pressures
+    simulator.startFrame(1 / 60.0);
+    for (int i = 0; i < 100 && simulator.simulateStep(); ++i);
+    simulator.endFrame();
+
+    int bodyCount = 0;
+    for (int i = 0; i < CylinderCount; ++i) {
+        ASSERT_GE(engine->getPiston(i)->m_body.index, 0);
+        bodyCount = std::max(bodyCount, engine->getPiston(i)->m_body.index + 1);
+    }
+
+    TestSystemState batched(bodyCount), perChamber(bodyCount);
+    for (int i = 0; i < CylinderCount; ++i) {
+        // Speeds on both sides of the friction attenuation limit
+        const int body = engine->getPiston(i)->m_body.index;
+        batched.v_x[body] = perChamber.v_x[body] = (i - 1.5) * 4E-4;
+        batched.v_y[body] = perChamber.v_y[body] = (2.5 - i) * 1E-3;
+        batched.p_x[body] = perChamber.p_x[body] = 0.1 * i;
+        batched.p_y[body] = perChamber.p_y[body] = 0.2;
+    }
+
+    ChamberForceBatch batch;
+    batch.initialize(engine);
+    EXPECT_EQ(batch.getCount(), CylinderCount);
+    batch.apply(&batched.state);
+    batch.destroy();
+
+    for (int i = 0; i < CylinderCount; ++i) {
+        engine->getChamber(i)->apply(&perChamber.state);
+    }
+
+    for (int i = 0; i < bodyCount; ++i) {
+        EXPECT_EQ(batched.f_x[i], perChamber.f_x[i]);
+        EXPECT_EQ(batched.f_y[i], perChamber.f_y[i]);
+
+        // Forces act through the piston origin, so there's no torque to skip
+        EXPECT_EQ(perChamber.t[i], 0.0);
+        EXPECT_EQ(batched.t[i], 0.0);
+    }
+
+    simulator.destroy();
+    EnginePack::release(&objects);
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include "../include/compilation_cache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+void writeFile(const std::filesystem::path &path, const std::string &contents) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream file(path, std::ios::out);
+    file << contents;
+}
+
+// engine.mr imports a part relative to itself and a library found through
+// the search path
+struct ScriptTree {
+    std::filesystem::path root;
+    std::filesystem::path script;
+    std::filesystem::path part;
+    std::filesystem::path library;
+    std::vector<std::string> searchPaths;
+
+    ScriptTree() {
+        root = std::filesystem::temp_directory_path() / "engine_sim_compilation_cache_test";
+        std::filesystem::remove_all(root);
+
+        script = root / "engines" / "engine.mr";
+        part = root / "engines" / "parts" / "heads.mr";
+        library = root / "es" / "engine_sim.mr";
+        searchPaths = { (root / "es").string() };
+
+        writeFile(library, "public node engine {}\n");
+        writeFile(part, "private import \"engine_sim\"\n\npublic node head {}\n");
+        writeFile(
+            script,
+            "import \"engine_sim.mr\"\n"
+            "import \"parts/heads.mr\"\n"
+            "// import \"commented_out.mr\"\n\n"
+            "public node main {}\n");
+    }
+
+    ~ScriptTree() {
+        std::filesystem::remove_all(root);
+    }
+};
+
+} // namespace
+
+TEST(CompilationCacheTests, CollectsImportsTransitively) {
+    ScriptTree tree;
+
+    std::vector<CompilationCache::Dependency> dependencies;
+    ASSERT_TRUE(CompilationCache::collectDependencies(tree.script.string(), tree.searchPaths, &dependencies));
+    ASSERT_EQ(dependencies.size(), 3);
+    EXPECT_EQ(std::filesystem::path(dependencies[0].path), tree.script);
+    EXPECT_EQ(std::filesystem::path(dependencies[1].path), tree.library);
+    EXPECT_EQ(std::filesystem::path(dependencies[2].path), tree.part);
+
+    writeFile(tree.part, "private import \"missing.mr\"\n");
+    EXPECT_FALSE(CompilationCache::collectDependencies(tree.script.string(), tree.searchPaths, &dependencies));
+}
+
+TEST(CompilationCacheTests, InvalidatesWhenAnImportChanges) {
+    ScriptTree tree;
+
+    const uint8_t data[] = { 1, 2, 3 };
+    CompilationCache cache;
+    cache.store(tree.script.string(), tree.searchPaths, data, sizeof(data));
+
+    std::vector<uint8_t> cached;
+    ASSERT_TRUE(cache.find(tree.script.string(), tree.searchPaths, &cached));
+    EXPECT_EQ(cached, std::vector<uint8_t>(data, data + sizeof(data)));
+
+    // Only the contents count, so rewriting a file unchanged keeps the entry
+    writeFile(tree.library, "public node engine {}\n");
+    EXPECT_TRUE(cache.find(tree.script.string(), tree.searchPaths, &cached));
+
+    writeFile(tree.library, "public node engine { input x: 1.0; }\n");
+    EXPECT_FALSE(cache.find(tree.script.string(), tree.searchPaths, &cached));
+    EXPECT_EQ(cache.getEntryCount(), 0);
+}
+
+TEST(CompilationCacheTests, EvictsLeastRecentlyUsed) {
+    ScriptTree tree;
+    const std::filesystem::path other = tree.root / "engines" / "other.mr";
+    writeFile(other, "import \"engine_sim.mr\"\n");
+
+    const uint8_t data[] = { 0 };
+    CompilationCache cache;
+    cache.setCapacity(1);
+    cache.store(tree.script.string(), tree.searchPaths, data, sizeof(data));
+    cache.store(other.string(), tree.searchPaths, data, sizeof(data));
+
+    std::vector<uint8_t> cached;
+    EXPECT_EQ(cache.getEntryCount(), 1);
+    EXPECT_FALSE(cache.find(tree.script.string(), tree.searchPaths, &cached));
+    EXPECT_TRUE(cache.find(other.string(), tree.searchPaths, &cached));
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include "test_engine.h"
+
+#include "../include/crank_slider_linkage.h"
+#include "../include/constants.h"
+#include "../include/units.h"
+
+#include <cmath>
+
+namespace {
+
+// Radial-style layout: a master rod on the crank and a slave rod riding on
+// the master, in banks 60 degrees apart
+class CrankSliderTests : public testing::Test {
+    protected:
+        virtual void SetUp() override {
+            TestEngineParameters params;
+            params.cylinderCount = 2;
+            params.bankCount = 2;
+            params.bankAngle = 60 * units::deg;
+            params.articulatedRods = true;
+            m_objects = createTestEngine(params);
+
+            Engine *engine = m_objects.engine;
+            m_crankshaft = engine->getCrankshaft(0);
+            m_masterBank = engine->getCylinderBank(0);
+            m_slaveBank = engine->getCylinderBank(1);
+            m_master = engine->getConnectingRod(0);
+            m_slave = engine->getConnectingRod(1);
+        }
+
+        virtual void TearDown() override {
+            EnginePack::release(&m_objects);
+        }
+
+        void solve(
+            double theta,
+            CrankSliderLinkage::Cylinder *master,
+            CrankSliderLinkage::Cylinder *slave)
+        {
+            CrankSliderLinkage::Point journal;
+            CrankSliderLinkage::crankJournal(m_crankshaft, 0, theta, &journal);
+            CrankSliderLinkage::solveCylinder(m_masterBank, m_master, journal, master);
+            CrankSliderLinkage::slaveJournal(m_master, *master, 0, &journal);
+            CrankSliderLinkage::solveCylinder(m_slaveBank, m_slave, journal, slave);
+        }
+
+        EnginePack::Objects m_objects;
+        Crankshaft *m_crankshaft = nullptr;
+        CylinderBank *m_masterBank = nullptr;
+        CylinderBank *m_slaveBank = nullptr;
+        ConnectingRod *m_master = nullptr;
+        ConnectingRod *m_slave = nullptr;
+};
+
+void checkDerivatives(
+    const CrankSliderLinkage::Cylinder &prev,
+    const CrankSliderLinkage::Cylinder &current,
+    const CrankSliderLinkage::Cylinder &next,
+    double h)
+{
+    const double tolerance = 1E-6;
+
+    EXPECT_NEAR(current.ds, (next.s - prev.s) / (2 * h), tolerance);
+    EXPECT_NEAR(current.dds, (next.ds - prev.ds) / (2 * h), tolerance);
+    EXPECT_NEAR(current.dphi, (next.phi - prev.phi) / (2 * h), tolerance);
+    EXPECT_NEAR(current.ddphi, (next.dphi - prev.dphi) / (2 * h), tolerance);
+    EXPECT_NEAR(current.rodCenter.dx, (next.rodCenter.x - prev.rodCenter.x) / (2 * h), tolerance);
+    EXPECT_NEAR(current.rodCenter.dy, (next.rodCenter.y - prev.rodCenter.y) / (2 * h), tolerance);
+    EXPECT_NEAR(current.rodCenter.ddx, (next.rodCenter.dx - prev.rodCenter.dx) / (2 * h), tolerance);
+    EXPECT_NEAR(current.rodCenter.ddy, (next.rodCenter.dy - prev.rodCenter.dy) / (2 * h), tolerance);
+}
+
+} // namespace
+
+TEST_F(CrankSliderTests, DerivativesMatchFiniteDifferences) {
+    const double h = 1E-5;
+
+    for (double theta = 0; theta < 4 * constants::pi; theta += 0.37) {
+        CrankSliderLinkage::Cylinder master[3], slave[3];
+        solve(theta - h, &master[0], &slave[0]);
+        solve(theta, &master[1], &slave[1]);
+        solve(theta + h, &master[2], &slave[2]);
+
+        checkDerivatives(master[0], master[1], master[2], h);
+        checkDerivatives(slave[0], slave[1], slave[2], h);
+    }
+}
+
+TEST_F(CrankSliderTests, PinsStayOnRodAndBore) {
+    for (double theta = 0; theta < 2 * constants::pi; theta += 0.1) {
+        CrankSliderLinkage::Cylinder master, slave;
+        solve(theta, &master, &slave);
+
+        const CrankSliderLinkage::Cylinder *cylinders[] = { &master, &slave };
+        const CylinderBank *banks[] = { m_masterBank, m_slaveBank };
+        const ConnectingRod *rods[] = { m_master, m_slave };
+
+        for (int i = 0; i < 2; ++i) {
+            const CrankSliderLinkage::Cylinder &cylinder = *cylinders[i];
+            const double p_x = banks[i]->getX() + cylinder.s * banks[i]->getDx();
+            const double p_y = banks[i]->getY() + cylinder.s * banks[i]->getDy();
+            const double length =
+                rods[i]->getLittleEndLocal() - rods[i]->getBigEndLocal();
+
+            EXPECT_NEAR(
+                std::hypot(p_x - cylinder.bigEnd.x, p_y - cylinder.bigEnd.y),
+                length,
+                1E-9);
+
+            // The little end, as seen from the rod body, lands on the wrist pin
+            const double theta_r = cylinder.phi - constants::pi / 2;
+            const double l = rods[i]->getLittleEndLocal();
+            EXPECT_NEAR(cylinder.rodCenter.x - std::sin(theta_r) * l, p_x, 1E-9);
+            EXPECT_NEAR(cylinder.rodCenter.y + std::cos(theta_r) * l, p_y, 1E-9);
+        }
+    }
+}
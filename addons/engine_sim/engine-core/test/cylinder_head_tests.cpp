@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "test_engine.h"
+
+#include "../include/cylinder_head.h"
+#include "../include/units.h"
+
+namespace {
+
+class CylinderHeadTests : public testing::Test {
+    protected:
+        virtual void SetUp() override {
+            m_objects = createTestEngine(2);
+
+            Engine *engine = m_objects.engine;
+            m_crankshaft = engine->getCrankshaft(0);
+            m_head = engine->getHead(0);
+            m_intakeCam = m_head->getIntakeCamshaft();
+            m_exhaustCam = m_head->getExhaustCamshaft();
+        }
+
+        virtual void TearDown() override {
+            EnginePack::release(&m_objects);
+        }
+
+        // Compares the tables against the full lift and flow chain
+        void checkTables(double tolerance) {
+            Function *intakeFlow = m_head->getIntakePortFlow();
+            Function *exhaustFlow = m_head->getExhaustPortFlow();
+
+            const double maxLift = units::distance(200, units::thou);
+            const double maxIntakeFlow = intakeFlow->sampleTriangle(maxLift);
+            const double maxExhaustFlow = exhaustFlow->sampleTriangle(maxLift);
+
+            for (double theta = -9.0; theta < 9.0; theta += 0.0137) {
+                m_crankshaft->m_body.theta = theta;
+                m_head->updateFlowTables();
+
+                for (int i = 0; i < 2; ++i) {
+                    const double intakeLift = m_intakeCam->valveLift(i);
+                    const double exhaustLift = m_exhaustCam->valveLift(i);
+
+                    EXPECT_NEAR(m_head->intakeFlowRate(i), intakeFlow->sampleTriangle(intakeLift), tolerance * maxIntakeFlow);
+                    EXPECT_NEAR(m_head->exhaustFlowRate(i), exhaustFlow->sampleTriangle(exhaustLift), tolerance * maxExhaustFlow);
+                    EXPECT_NEAR(m_head->exhaustValveLift(i), exhaustLift, tolerance * maxLift);
+                }
+            }
+        }
+
+        EnginePack::Objects m_objects;
+        Crankshaft *m_crankshaft = nullptr;
+        CylinderHead *m_head = nullptr;
+        Camshaft *m_intakeCam = nullptr;
+        Camshaft *m_exhaustCam = nullptr;
+};
+
+} // namespace
+
+TEST_F(CylinderHeadTests, FlowTablesMatchCamChain) {
+    m_head->buildFlowTables();
+    EXPECT_TRUE(m_head->hasFlowTables());
+
+    checkTables(0.02);
+}
+
+TEST_F(CylinderHeadTests, FlowTablesFollowCamAdvance) {
+    m_head->buildFlowTables();
+
+    m_exhaustCam->setAdvance(20 * units::deg);
+    checkTables(0.02);
+
+    // The test engine has it at 834 degrees
+    m_intakeCam->setLobeCenterline(1, 844 * units::deg);
+    checkTables(0.02);
+}
@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+
+#include "../include/delay_filter.h"
+
+TEST(DelayFilterTests, DelaysByLatency) {
+    DelayFilter filter;
+    filter.initialize(0.01, 1000.0);
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(filter.fast_f(i + 1.0), 0.0);
+    }
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(filter.fast_f(0.0), i + 1.0);
+    }
+}
+
+TEST(DelayFilterTests, RejectsStateFromAnotherSampleRate) {
+    DelayFilter filter;
+    filter.initialize(0.01, 1000.0);
+    for (int i = 0; i < 5; ++i) {
+        filter.fast_f(i + 1.0);
+    }
+
+    StateWriter writer;
+    filter.writeState(&writer);
+
+    DelayFilter other;
+    other.initialize(0.01, 500.0);
+
+    StateReader reader(writer.getData(), writer.getSize());
+    other.readState(&reader);
+    EXPECT_FALSE(reader.isValid());
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include "test_engine.h"
+
+#include "../include/dyno_sweep.h"
+#include "../include/units.h"
+
+#include <vector>
+
+namespace {
+
+class DynoSweepTests : public testing::Test {
+    protected:
+        virtual void TearDown() override {
+            m_sweep.destroy();
+            for (EnginePack::Objects &objects : m_objects) {
+                EnginePack::release(&objects);
+            }
+        }
+
+        // One separately built engine per instance, without combustion
+        // randomness so that runs can be compared exactly
+        void sweep(int instanceCount, const DynoSweep::Parameters &params, bool *result) {
+            TestEngineParameters engineParams;
+            engineParams.cylinderCount = 2;
+            engineParams.burningEfficiencyRandomness = 0.0;
+
+            std::vector<DynoSweep::Instance> instances(instanceCount);
+            for (DynoSweep::Instance &instance : instances) {
+                m_objects.push_back(createTestEngine(engineParams));
+                instance.engine = m_objects.back().engine;
+                instance.vehicle = m_objects.back().vehicle;
+                instance.transmission = m_objects.back().transmission;
+            }
+
+            *result = m_sweep.run(instances.data(), instanceCount, params);
+        }
+
+        static DynoSweep::Parameters shortSweep() {
+            DynoSweep::Parameters params;
+            params.minSpeed = units::rpm(1000);
+            params.maxSpeed = units::rpm(1800);
+            params.speedStep = units::rpm(200);
+            params.minSettleTime = 0.05 * units::sec;
+            params.maxSettleTime = 0.2 * units::sec;
+            params.settleWindow = 0.05 * units::sec;
+            params.fluidSimulationSteps = 2;
+
+            return params;
+        }
+
+        std::vector<EnginePack::Objects> m_objects;
+        DynoSweep m_sweep;
+};
+
+} // namespace
+
+TEST_F(DynoSweepTests, SplittingAcrossInstancesGivesSameCurve) {
+    const DynoSweep::Parameters params = shortSweep();
+
+    bool swept = false;
+    sweep(1, params, &swept);
+    ASSERT_TRUE(swept);
+    ASSERT_EQ(m_sweep.getPointCount(), 5);
+
+    std::vector<DynoSweep::Point> single;
+    for (int i = 0; i < m_sweep.getPointCount(); ++i) {
+        single.push_back(m_sweep.getPoint(i));
+    }
+
+    // Three instances split five points into uneven chunks
+    sweep(3, params, &swept);
+    ASSERT_TRUE(swept);
+    ASSERT_EQ(m_sweep.getPointCount(), 5);
+
+    for (int i = 0; i < m_sweep.getPointCount(); ++i) {
+        const DynoSweep::Point &point = m_sweep.getPoint(i);
+        EXPECT_DOUBLE_EQ(point.speed, units::rpm(1000 + 200 * i));
+        if (i > 0) EXPECT_GT(point.speed, m_sweep.getPoint(i - 1).speed);
+
+        EXPECT_EQ(point.speed, single[i].speed);
+        EXPECT_EQ(point.torque, single[i].torque) << "Point " << i;
+        EXPECT_EQ(point.power, single[i].power);
+        EXPECT_EQ(point.settled, single[i].settled);
+        EXPECT_DOUBLE_EQ(point.power, point.torque * point.speed);
+    }
+}
+
+TEST_F(DynoSweepTests, LastPointIsClampedToMaxSpeed) {
+    DynoSweep::Parameters params = shortSweep();
+    params.maxSpeed = units::rpm(1500);
+
+    bool swept = false;
+    sweep(2, params, &swept);
+    ASSERT_TRUE(swept);
+    ASSERT_EQ(m_sweep.getPointCount(), 3);
+    EXPECT_DOUBLE_EQ(m_sweep.getPoint(2).speed, units::rpm(1400));
+}
+
+TEST_F(DynoSweepTests, SettlesOnlyWithinTolerance) {
+    // Any change is within tolerance, so every point settles at the first
+    // window past the minimum settle time
+    DynoSweep::Parameters params = shortSweep();
+    params.settleTorqueTolerance = 1E12;
+
+    bool swept = false;
+    sweep(2, params, &swept);
+    ASSERT_TRUE(swept);
+    for (int i = 0; i < m_sweep.getPointCount(); ++i) {
+        EXPECT_TRUE(m_sweep.getPoint(i).settled);
+    }
+
+    // Out of time before the minimum settle time is reached
+    params.minSettleTime = 1.0 * units::sec;
+    sweep(2, params, &swept);
+    ASSERT_TRUE(swept);
+    for (int i = 0; i < m_sweep.getPointCount(); ++i) {
+        EXPECT_FALSE(m_sweep.getPoint(i).settled);
+    }
+}
+
+TEST_F(DynoSweepTests, RejectsInvalidRange) {
+    DynoSweep::Parameters params = shortSweep();
+    params.maxSpeed = units::rpm(500);
+
+    bool swept = true;
+    sweep(1, params, &swept);
+    EXPECT_FALSE(swept);
+    EXPECT_EQ(m_sweep.getPointCount(), 0);
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include "test_engine.h"
+
+#include "../include/engine_kernel_registry.h"
+#include "../include/constants.h"
+#include "../include/engine.h"
+#include "../include/piston_engine_simulator.h"
+#include "../include/specialized_piston_engine_simulator.h"
+#include "../include/units.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+int createCount = 0;
+
+bool alwaysMatches(Engine *) { return true; }
+bool neverMatches(Engine *) { return false; }
+
+PistonEngineSimulator *createSimulator() {
+    ++createCount;
+    return new PistonEngineSimulator;
+}
+
+void initializeEngine(Engine *engine, const std::string &name) {
+    Engine::Parameters params;
+    params.cylinderBanks = 0;
+    params.cylinderCount = 0;
+    params.crankshaftCount = 0;
+    params.exhaustSystemCount = 0;
+    params.intakeCount = 0;
+    params.name = name;
+    params.throttle = nullptr;
+    params.initialSimulationFrequency = 10000;
+    params.initialHighFrequencyGain = 0;
+    params.initialNoise = 0;
+    params.initialJitter = 0;
+    engine->initialize(params);
+}
+
+// What engine-sim-aot would generate for createTestEngine(2)
+constexpr double TwinCollectorLength =
+    units::volume(20.0, units::L)
+    / (constants::pi * units::distance(1.0, units::inch) * units::distance(1.0, units::inch));
+
+constexpr double twinExhaustLength(int i) {
+    return units::distance(10.0 + i, units::inch) + TwinCollectorLength;
+}
+
+constexpr PistonEngineSimulator::ExhaustRoute twinRoute(int i) {
+    return {
+        0,
+        i,
+        (1.0 / 2) * (1 / (twinExhaustLength(i) * twinExhaustLength(i))),
+        twinExhaustLength(i) / (343.0 * units::m / units::sec) };
+}
+
+struct TwinLayout {
+    static constexpr int CylinderCount = 2;
+    static constexpr int CylinderBankCount = 1;
+    static constexpr int ExhaustSystemCount = 1;
+    static constexpr int IntakeCount = 1;
+    static constexpr PistonEngineSimulator::ExhaustRoute ExhaustRoutes[CylinderCount] =
+        { twinRoute(0), twinRoute(1) };
+};
+
+// Exposes what the simulator last fed the synthesizer
+template <typename T_Simulator>
+class ProbedSimulator : public T_Simulator {
+    public:
+        double getExhaustInput(int i) const { return this->m_exhaustFlowStagingBuffer[i]; }
+
+        // Everything but the synthesizer's own state, which has filters
+        // seeded per instance
+        void writeSimulationState(StateWriter *writer) {
+            StateWriter state, synthesizerState;
+            this->writeState(&state);
+            this->synthesizer().writeState(&synthesizerState);
+
+            writer->writeBytes(
+                state.getData(),
+                state.getSize() - sizeof(uint64_t) - synthesizerState.getSize());
+        }
+};
+
+void loadTwin(PistonEngineSimulator *simulator, EnginePack::Objects *objects) {
+    *objects = createTestEngine(2);
+
+    simulator->initialize(objects->simulatorParameters);
+    simulator->setSimulationFrequency(10000);
+
+    // Otherwise the steps per frame depend on how fast the audio thread
+    // drains each synthesizer
+    simulator->setLatencyControlEnabled(false);
+    simulator->loadSimulation(objects->engine, objects->vehicle, objects->transmission);
+
+    objects->engine->getIgnitionModule()->m_enabled = true;
+    objects->engine->getCrankshaft(0)->m_body.v_theta = -units::rpm(2000);
+}
+
+} // namespace
+
+TEST(EngineKernelRegistryTests, SpecializedKernelMatchesGenericSimulator) {
+    using Specialized = SpecializedPistonEngineSimulator<TwinLayout>;
+
+    EnginePack::Objects genericObjects, specializedObjects;
+    ProbedSimulator<PistonEngineSimulator> generic;
+    ProbedSimulator<Specialized> specialized;
+    loadTwin(&generic, &genericObjects);
+    loadTwin(&specialized, &specializedObjects);
+
+    EXPECT_TRUE(Specialized::matches(specializedObjects.engine));
+
+    bool identical = true;
+    for (int frame = 0; frame < 10 && identical; ++frame) {
+        generic.startFrame(1 / 60.0);
+        specialized.startFrame(1 / 60.0);
+
+        for (int step = 0; identical; ++step) {
+            // Combustion draws from rand(), so both have to see the same sequence
+            std::srand(step);
+            const bool genericStepped = generic.simulateStep();
+            std::srand(step);
+            const bool specializedStepped = specialized.simulateStep();
+
+            EXPECT_EQ(genericStepped, specializedStepped);
+            if (!genericStepped || !specializedStepped) break;
+
+            StateWriter genericState, specializedState;
+            generic.writeSimulationState(&genericState);
+            specialized.writeSimulationState(&specializedState);
+
+            identical =
+                genericState.getSize() == specializedState.getSize()
+                && std::memcmp(genericState.getData(), specializedState.getData(), genericState.getSize()) == 0
+                && generic.getExhaustInput(0) == specialized.getExhaustInput(0);
+            EXPECT_TRUE(identical) << "Frame " << frame << ", step " << step;
+        }
+
+        generic.endFrame();
+        specialized.endFrame();
+    }
+
+    generic.destroy();
+    specialized.destroy();
+    EnginePack::release(&genericObjects);
+    EnginePack::release(&specializedObjects);
+}
+
+TEST(EngineKernelRegistryTests, CreatesKernelByEngineName) {
+    EngineKernelRegistry::add({ "Registry Test V8", &alwaysMatches, &createSimulator });
+
+    Engine engine, other;
+    initializeEngine(&engine, "Registry Test V8");
+    initializeEngine(&other, "Registry Test I4");
+
+    createCount = 0;
+    PistonEngineSimulator *simulator = EngineKernelRegistry::createSimulator(&engine);
+    EXPECT_NE(simulator, nullptr);
+    EXPECT_EQ(createCount, 1);
+    delete simulator;
+
+    EXPECT_EQ(EngineKernelRegistry::createSimulator(&other), nullptr);
+    EXPECT_EQ(createCount, 1);
+
+    engine.destroy();
+    other.destroy();
+}
+
+TEST(EngineKernelRegistryTests, IgnoresStaleKernel) {
+    EngineKernelRegistry::add({ "Registry Test Stale", &neverMatches, &createSimulator });
+    ASSERT_NE(EngineKernelRegistry::find("Registry Test Stale"), nullptr);
+
+    Engine engine;
+    initializeEngine(&engine, "Registry Test Stale");
+
+    createCount = 0;
+    EXPECT_EQ(EngineKernelRegistry::createSimulator(&engine), nullptr);
+    EXPECT_EQ(createCount, 0);
+
+    engine.destroy();
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include "../include/engine_map.h"
+
+#include <cstdio>
+
+namespace {
+
+void fillLinearMap(EngineMap *map) {
+    EngineMap::Parameters params;
+    params.speedSamples = 5;
+    params.speedControlSamples = 3;
+    params.minSpeed = 100.0;
+    params.maxSpeed = 500.0;
+    map->initialize(params);
+
+    for (int i = 0; i < params.speedSamples; ++i) {
+        for (int j = 0; j < params.speedControlSamples; ++j) {
+            EngineMap::Sample sample;
+            sample.torque = map->getSpeed(i) + 1000.0 * map->getSpeedControl(j);
+            sample.airflow = map->getSpeedControl(j);
+            sample.manifoldPressure = map->getSpeed(i);
+            sample.fuelFlow = 2.0 * map->getSpeedControl(j);
+            map->setSample(i, j, sample);
+        }
+
+        map->setMotoringTorque(i, -0.1 * map->getSpeed(i));
+    }
+}
+
+} // namespace
+
+TEST(EngineMapTests, GridCoordinates) {
+    EngineMap map;
+    fillLinearMap(&map);
+
+    EXPECT_DOUBLE_EQ(map.getSpeed(0), 100.0);
+    EXPECT_DOUBLE_EQ(map.getSpeed(4), 500.0);
+    EXPECT_DOUBLE_EQ(map.getSpeedControl(0), 0.0);
+    EXPECT_DOUBLE_EQ(map.getSpeedControl(2), 1.0);
+
+    map.destroy();
+    EXPECT_TRUE(map.isEmpty());
+}
+
+TEST(EngineMapTests, BilinearSampling) {
+    EngineMap map;
+    fillLinearMap(&map);
+
+    // The table is linear in both axes, so interpolation is exact
+    const EngineMap::Sample s = map.sample(275.0, 0.3);
+    EXPECT_NEAR(s.torque, 275.0 + 300.0, 1E-9);
+    EXPECT_NEAR(s.airflow, 0.3, 1E-9);
+    EXPECT_NEAR(s.manifoldPressure, 275.0, 1E-9);
+    EXPECT_NEAR(s.fuelFlow, 0.6, 1E-9);
+
+    EXPECT_NEAR(map.sampleMotoringTorque(250.0), -25.0, 1E-9);
+
+    map.destroy();
+}
+
+TEST(EngineMapTests, SamplingClampsToGrid) {
+    EngineMap map;
+    fillLinearMap(&map);
+
+    const EngineMap::Sample low = map.sample(0.0, -1.0);
+    EXPECT_NEAR(low.torque, 100.0, 1E-9);
+
+    const EngineMap::Sample high = map.sample(1000.0, 2.0);
+    EXPECT_NEAR(high.torque, 1500.0, 1E-9);
+
+    EXPECT_NEAR(map.sampleMotoringTorque(1000.0), -50.0, 1E-9);
+
+    map.destroy();
+}
+
+TEST(EngineMapTests, WriteReadRoundTrip) {
+    EngineMap map;
+    fillLinearMap(&map);
+
+    const std::string path = ::testing::TempDir() + "engine_map_test.esmv";
+    ASSERT_TRUE(map.write(path));
+
+    EngineMap loaded;
+    ASSERT_TRUE(loaded.read(path));
+    std::remove(path.c_str());
+
+    EXPECT_EQ(loaded.getSpeedSampleCount(), map.getSpeedSampleCount());
+    EXPECT_EQ(loaded.getSpeedControlSampleCount(), map.getSpeedControlSampleCount());
+    EXPECT_DOUBLE_EQ(loaded.getMinSpeed(), map.getMinSpeed());
+    EXPECT_DOUBLE_EQ(loaded.getMaxSpeed(), map.getMaxSpeed());
+
+    for (int i = 0; i < map.getSpeedSampleCount(); ++i) {
+        for (int j = 0; j < map.getSpeedControlSampleCount(); ++j) {
+            EXPECT_DOUBLE_EQ(loaded.getSample(i, j).torque, map.getSample(i, j).torque);
+            EXPECT_DOUBLE_EQ(loaded.getSample(i, j).fuelFlow, map.getSample(i, j).fuelFlow);
+        }
+
+        EXPECT_DOUBLE_EQ(loaded.getMotoringTorque(i), map.getMotoringTorque(i));
+    }
+
+    loaded.destroy();
+    map.destroy();
+}
+
+TEST(EngineMapTests, ReadRejectsMissingFile) {
+    EngineMap map;
+    EXPECT_FALSE(map.read(::testing::TempDir() + "does_not_exist.esmv"));
+    EXPECT_TRUE(map.isEmpty());
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include "test_engine.h"
+
+#include "../include/constants.h"
+#include "../include/governor.h"
+#include "../include/impulse_response.h"
+#include "../include/units.h"
+
+#include <cstring>
+
+namespace {
+
+// Radial twin, so that master rods and more than one bank go through the
+// pack, with a governor unless given another throttle
+EnginePack::Objects createTwin(Throttle *throttle = nullptr) {
+    if (throttle == nullptr) {
+        Governor::Parameters governorParams;
+        governorParams.minSpeed = units::rpm(800);
+        governorParams.maxSpeed = units::rpm(7000);
+        governorParams.minVelocity = -5.0;
+        governorParams.maxVelocity = 5.0;
+        governorParams.k_s = 0.5;
+        governorParams.k_d = 10.0;
+        governorParams.gamma = 2.0;
+        Governor *governor = new Governor;
+        governor->initialize(governorParams);
+        throttle = governor;
+    }
+
+    TestEngineParameters params;
+    params.cylinderCount = 2;
+    params.bankCount = 2;
+    params.bankAngle = 60 * units::deg;
+    params.articulatedRods = true;
+    params.throttle = throttle;
+
+    return createTestEngine(params);
+}
+
+} // namespace
+
+TEST(EnginePackTests, RoundTripsEngine) {
+    EnginePack::Objects objects = createTwin();
+    objects.simulatorParameters.systemType = Simulator::SystemType::Generic;
+    objects.engine->getHead(1)->getExhaustCamshaft()->setAdvance(2 * units::deg);
+
+    StateWriter writer;
+    ASSERT_TRUE(EnginePack::write(objects, &writer));
+
+    EnginePack::Objects loaded;
+    StateReader reader(writer.getData(), writer.getSize());
+    ASSERT_TRUE(EnginePack::read(&reader, &loaded));
+    EXPECT_TRUE(reader.isAtEnd());
+
+    // Functions built from the pack are freed with it
+    ASSERT_NE(loaded.functions, nullptr);
+    EXPECT_FALSE(loaded.functions->functions.empty());
+    EXPECT_NE(loaded.functions, objects.functions);
+
+    Engine *engine = loaded.engine;
+    ASSERT_NE(engine, nullptr);
+    ASSERT_NE(loaded.vehicle, nullptr);
+    ASSERT_NE(loaded.transmission, nullptr);
+    EXPECT_EQ(loaded.transmission->getGearCount(), 4);
+    EXPECT_EQ(loaded.simulatorParameters.systemType, Simulator::SystemType::Generic);
+
+    EXPECT_EQ(engine->getName(), "Test Inline");
+    EXPECT_EQ(engine->getCylinderCount(), 2);
+    EXPECT_EQ(engine->getCylinderBankCount(), 2);
+    EXPECT_NE(dynamic_cast<Governor *>(engine->getThrottleLinkage()), nullptr);
+
+    EXPECT_EQ(engine->getConnectingRod(0)->getMasterRod(), nullptr);
+    EXPECT_EQ(engine->getConnectingRod(1)->getMasterRod(), engine->getConnectingRod(0));
+    EXPECT_DOUBLE_EQ(engine->getConnectingRod(0)->getSlaveThrow(), units::distance(1.0, units::inch));
+    EXPECT_DOUBLE_EQ(engine->getCylinderBank(1)->getAngle(), 30 * units::deg);
+    EXPECT_DOUBLE_EQ(engine->getIgnitionModule()->getFiringAngle(1), 2 * constants::pi);
+    EXPECT_DOUBLE_EQ(engine->getHead(1)->getIntakeCamshaft()->getLobeCenterline(0), (474 + 360) * units::deg / 2);
+    EXPECT_DOUBLE_EQ(engine->getHead(1)->getExhaustCamshaft()->getAdvance(), 2 * units::deg);
+    EXPECT_DOUBLE_EQ(engine->getHead(1)->getHeaderPrimaryLength(0), units::distance(11, units::inch));
+    EXPECT_EQ(engine->getExhaustSystem(0)->getImpulseResponse()->getFilename(), "sound-library/smooth.wav");
+
+    // Shared functions stay shared and are compiled like a script's
+    CylinderHead *head = engine->getHead(0);
+    EXPECT_EQ(head->getIntakePortFlow(), engine->getHead(1)->getIntakePortFlow());
+    EXPECT_EQ(head->getIntakeCamshaft()->getLobeProfile(), head->getExhaustCamshaft()->getLobeProfile());
+    EXPECT_TRUE(head->getIntakePortFlow()->isCompiled());
+    EXPECT_EQ(
+        engine->getChamber(0)->getMeanPistonSpeedToTurbulence(),
+        engine->getChamber(1)->getMeanPistonSpeedToTurbulence());
+
+    // Nothing is lost or reordered on the way through
+    StateWriter rewritten;
+    EnginePack::write(loaded, &rewritten);
+    ASSERT_EQ(rewritten.getSize(), writer.getSize());
+    EXPECT_EQ(std::memcmp(rewritten.getData(), writer.getData(), writer.getSize()), 0);
+
+    EnginePack::release(&objects);
+    EnginePack::release(&loaded);
+}
+
+TEST(EnginePackTests, RejectsTruncatedPack) {
+    EnginePack::Objects objects = createTwin();
+
+    StateWriter writer;
+    EnginePack::write(objects, &writer);
+
+    for (size_t size : { size_t(0), size_t(6), writer.getSize() / 2, writer.getSize() - 1 }) {
+        EnginePack::Objects loaded;
+        StateReader reader(writer.getData(), size);
+        EXPECT_FALSE(EnginePack::read(&reader, &loaded));
+        EXPECT_EQ(loaded.engine, nullptr);
+    }
+
+    EnginePack::release(&objects);
+}
+
+TEST(EnginePackTests, RejectsUnknownThrottle) {
+    EnginePack::Objects objects = createTwin(new Throttle);
+
+    StateWriter writer;
+    EXPECT_FALSE(EnginePack::write(objects, &writer));
+    EXPECT_EQ(writer.getSize(), size_t(0));
+
+    EnginePack::Objects instance;
+    EnginePack::instantiate(objects, &instance);
+    EXPECT_EQ(instance.engine, nullptr);
+
+    EnginePack::release(&objects);
+}
+
+TEST(EnginePackTests, InstantiateSharesFunctions) {
+    EnginePack::Objects prototype = createTwin();
+    prototype.simulatorParameters.systemType = Simulator::SystemType::Generic;
+
+    EnginePack::Objects instance;
+    EnginePack::instantiate(prototype, &instance);
+
+    Engine *engine = instance.engine;
+    ASSERT_NE(engine, nullptr);
+    EXPECT_NE(engine, prototype.engine);
+    EXPECT_EQ(instance.simulatorParameters.systemType, Simulator::SystemType::Generic);
+
+    // Definition data is shared, parts with state are not
+    CylinderHead *head = engine->getHead(0);
+    CylinderHead *prototypeHead = prototype.engine->getHead(0);
+    EXPECT_EQ(head->getIntakePortFlow(), prototypeHead->getIntakePortFlow());
+    EXPECT_EQ(head->getIntakeCamshaft()->getLobeProfile(), prototypeHead->getIntakeCamshaft()->getLobeProfile());
+    EXPECT_EQ(
+        engine->getChamber(0)->getMeanPistonSpeedToTurbulence(),
+        prototype.engine->getChamber(0)->getMeanPistonSpeedToTurbulence());
+    EXPECT_NE(head->getIntakeCamshaft(), prototypeHead->getIntakeCamshaft());
+    EXPECT_EQ(head->getIntakeCamshaft()->getCrankshaft(), engine->getCrankshaft(0));
+
+    StateWriter prototypePack, instancePack;
+    EnginePack::write(prototype, &prototypePack);
+    EnginePack::write(instance, &instancePack);
+    ASSERT_EQ(instancePack.getSize(), prototypePack.getSize());
+    EXPECT_EQ(std::memcmp(instancePack.getData(), prototypePack.getData(), prototypePack.getSize()), 0);
+
+    EnginePack::release(&instance);
+    EnginePack::release(&prototype);
+}
+
+TEST(EnginePackTests, InstanceOutlivesPrototype) {
+    EnginePack::Objects objects = createTwin();
+
+    StateWriter writer;
+    ASSERT_TRUE(EnginePack::write(objects, &writer));
+    EnginePack::release(&objects);
+
+    EnginePack::Objects prototype;
+    StateReader reader(writer.getData(), writer.getSize());
+    ASSERT_TRUE(EnginePack::read(&reader, &prototype));
+
+    EnginePack::Objects instance;
+    EnginePack::instantiate(prototype, &instance);
+    ASSERT_NE(instance.engine, nullptr);
+    EXPECT_EQ(instance.functions, prototype.functions);
+    EXPECT_EQ(instance.functions.use_count(), 2);
+
+    EnginePack::release(&prototype);
+    EXPECT_EQ(instance.functions.use_count(), 1);
+
+    // Still samples the functions it was built with
+    StateWriter instancePack;
+    ASSERT_TRUE(EnginePack::write(instance, &instancePack));
+    ASSERT_EQ(instancePack.getSize(), writer.getSize());
+    EXPECT_EQ(std::memcmp(instancePack.getData(), writer.getData(), writer.getSize()), 0);
+
+    EnginePack::release(&instance);
+}
@@ -2,7 +2,10 @@
 
 #include "../include/function.h"
 
+#include <cmath>
 #include <stdlib.h>
+#include <thread>
+#include <vector>
 
 TEST(FunctionTests, FunctionSanityCheck) {
     Function f;
@@ -79,3 +82,79 @@ TEST(FunctionTests, FunctionGaussianTest) {
 
     f.destroy();
 }
+
+TEST(FunctionTests, DefaultFilterIsSharedAcrossThreads) {
+    // The first functions in the process may be made on several threads at
+    // once, e.g. by scripts compiling in the background
+    constexpr int ThreadCount = 8;
+    std::vector<double> results(ThreadCount, 0.0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < ThreadCount; ++i) {
+        threads.emplace_back([&results, i]() {
+            Function f;
+            f.initialize(0, 1.0);
+            f.addSample(0.0, 1.0);
+            f.addSample(1.0, 3.0);
+            f.addSample(2.0, 2.0);
+            results[i] = f.sampleGaussian(1.0);
+            f.destroy();
+        });
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    for (int i = 1; i < ThreadCount; ++i) {
+        EXPECT_EQ(results[i], results[0]);
+    }
+}
+
+TEST(FunctionTests, FunctionBulkAddTest) {
+    Function bulk, single;
+    bulk.initialize(0, 1.0);
+    single.initialize(0, 1.0);
+
+    double x[1000], y[1000];
+    for (int i = 0; i < 1000; ++i) {
+        x[i] = rand() % 1000;
+        y[i] = i;
+        single.addSample(x[i], y[i]);
+    }
+
+    bulk.addSamples(x, y, 1000);
+    EXPECT_TRUE(bulk.isOrdered());
+
+    for (double s = -10.0; s <= 1010.0; s += 0.37) {
+        EXPECT_NEAR(bulk.sampleTriangle(s), single.sampleTriangle(s), 1E-9 * 1000);
+    }
+
+    bulk.destroy();
+    single.destroy();
+}
+
+TEST(FunctionTests, FunctionCompiledErrorBoundTest) {
+    Function f;
+    f.initialize(0, 0.05);
+
+    // Shaped like a cam lobe: a raised cosine with a flat base
+    for (int i = -100; i <= 100; ++i) {
+        const double x = i * 0.02;
+        const double y = (std::abs(x) < 1.0) ? 0.5 + 0.5 * std::cos(x * 3.14159265358979) : 0.0;
+        f.addSample(x, y);
+    }
+
+    constexpr double MaxError = 1E-4;
+    ASSERT_TRUE(f.compile(16, MaxError));
+    EXPECT_TRUE(f.isCompiled());
+    EXPECT_GT(f.getCompiledResolution(), 16);
+
+    for (double s = -2.5; s <= 2.5; s += 0.0013) {
+        EXPECT_NEAR(f.sampleTriangle(s), f.sampleTriangleExact(s), MaxError * 1.5);
+    }
+
+    f.addSample(3.0, 0.0);
+    EXPECT_FALSE(f.isCompiled());
+
+    f.destroy();
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include "test_engine.h"
+
+#include "../include/ignition_module.h"
+#include "../include/constants.h"
+#include "../include/utilities.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr double FourPi = 4 * constants::pi;
+
+class IgnitionModuleTests : public testing::Test {
+    protected:
+        virtual void SetUp() override {
+            // Only the crankshaft is used, driving a module with its own
+            // firing order and timing curve
+            m_objects = createTestEngine();
+            m_crankshaft = m_objects.engine->getCrankshaft(0);
+
+            // Advance grows with speed, up to 0.6 rad at 600 rad/s
+            m_timingCurve.initialize(0, 600.0);
+            m_timingCurve.addSample(0.0, 0.0);
+            m_timingCurve.addSample(600.0, 0.6);
+        }
+
+        virtual void TearDown() override {
+            m_module.destroy();
+            m_timingCurve.destroy();
+            EnginePack::release(&m_objects);
+        }
+
+        void initialize(const std::vector<double> &firingAngles) {
+            IgnitionModule::Parameters params;
+            params.cylinderCount = static_cast<int>(firingAngles.size());
+            params.crankshaft = m_crankshaft;
+            params.timingCurve = &m_timingCurve;
+            params.revLimit = 1000.0;
+            m_module.initialize(params);
+            m_module.m_enabled = true;
+
+            for (int i = 0; i < params.cylinderCount; ++i) {
+                m_module.setFiringOrder(i, firingAngles[i]);
+            }
+
+            m_firingAngles = firingAngles;
+        }
+
+        void start(double cycleAngle) {
+            m_crankshaft->m_body.theta = -cycleAngle;
+            m_module.reset();
+            m_cycleAngle = cycleAngle;
+        }
+
+        // Moves the crank to the given cycle angle and returns which plugs fired
+        std::vector<bool> step(double cycleAngle, double angularVelocity) {
+            m_crankshaft->m_body.theta = -cycleAngle;
+            m_crankshaft->m_body.v_theta = angularVelocity;
+
+            EngineStepState state;
+            state.outputCrankshaft = m_crankshaft;
+            state.cycleAngle = m_crankshaft->getCycleAngle();
+            state.angularVelocity = angularVelocity;
+            m_module.update(1E-4, state);
+
+            std::vector<bool> fired(m_firingAngles.size());
+            for (size_t i = 0; i < fired.size(); ++i) {
+                fired[i] = m_module.getIgnitionEvent(static_cast<int>(i));
+            }
+
+            m_module.resetIgnitionEvents();
+            m_cycleAngle = state.cycleAngle;
+            return fired;
+        }
+
+        // Plain per-plug window test the scheduler has to agree with
+        std::vector<bool> expected(double r0, double r1, double angularVelocity) {
+            const double advance = m_timingCurve.sampleTriangle(-angularVelocity);
+            const double start = (angularVelocity < 0) ? r0 : r1;
+            const double window = (angularVelocity < 0)
+                ? positiveMod(r1 - r0, FourPi)
+                : positiveMod(r0 - r1, FourPi);
+
+            std::vector<bool> fired(m_firingAngles.size());
+            for (size_t i = 0; i < fired.size(); ++i) {
+                fired[i] = positiveMod(m_firingAngles[i] - advance - start, FourPi) < window;
+            }
+
+            return fired;
+        }
+
+        EnginePack::Objects m_objects;
+        Crankshaft *m_crankshaft = nullptr;
+        Function m_timingCurve;
+        IgnitionModule m_module;
+        std::vector<double> m_firingAngles;
+        double m_cycleAngle = 0;
+};
+
+} // namespace
+
+TEST_F(IgnitionModuleTests, FiresAcrossWrapTurningForward) {
+    initialize({ 0.1, FourPi - 0.1, 2 * constants::pi });
+    start(FourPi - 0.2);
+
+    // Stopped, so there's no advance
+    const std::vector<bool> fired = step(0.2, -1E-6);
+    EXPECT_TRUE(fired[0]);
+    EXPECT_TRUE(fired[1]);
+    EXPECT_FALSE(fired[2]);
+
+    const std::vector<bool> next = step(0.3, -1E-6);
+    EXPECT_FALSE(next[0]);
+    EXPECT_FALSE(next[1]);
+    EXPECT_FALSE(next[2]);
+}
+
+TEST_F(IgnitionModuleTests, FiresAcrossWrapTurningBackward) {
+    initialize({ 0.1, FourPi - 0.1, 2 * constants::pi });
+    start(0.2);
+
+    const std::vector<bool> fired = step(FourPi - 0.2, 1E-6);
+    EXPECT_TRUE(fired[0]);
+    EXPECT_TRUE(fired[1]);
+    EXPECT_FALSE(fired[2]);
+}
+
+TEST_F(IgnitionModuleTests, FiresEveryPlugOncePerCycle) {
+    std::vector<double> angles;
+    for (int i = 0; i < 12; ++i) {
+        angles.push_back(i * FourPi / 12 + 0.01);
+    }
+
+    initialize(angles);
+    start(0.0);
+
+    // Three cycles with the speed, and so the advance, ramping up
+    std::vector<int> count(angles.size(), 0);
+    const int steps = 3000;
+    for (int i = 1; i <= steps; ++i) {
+        const double speed = 100.0 + 400.0 * i / steps;
+        const std::vector<bool> fired = step(3 * FourPi * i / steps, -speed);
+        for (size_t j = 0; j < fired.size(); ++j) {
+            if (fired[j]) ++count[j];
+        }
+    }
+
+    for (size_t j = 0; j < angles.size(); ++j) {
+        EXPECT_GE(count[j], 3);
+        EXPECT_LE(count[j], 4);
+    }
+}
+
+TEST_F(IgnitionModuleTests, MatchesWindowTest) {
+    std::vector<double> angles;
+    for (int i = 0; i < 9; ++i) {
+        angles.push_back(i * FourPi / 9 - 1.0);
+    }
+    angles.push_back(angles[3]);    // Two plugs firing together
+
+    initialize(angles);
+    start(FourPi - 0.05);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> stepSize(0.0, 0.4);
+    std::uniform_real_distribution<double> speed(0.0, 600.0);
+    std::uniform_int_distribution<int> reverse(0, 20);
+
+    double direction = -1.0;
+    double angle = m_cycleAngle;
+    for (int i = 0; i < 5000; ++i) {
+        if (reverse(rng) == 0) direction = -direction;
+
+        // Cycle angle increases when turning with negative velocity
+        angle = positiveMod(angle - direction * stepSize(rng), FourPi);
+        const double angularVelocity = direction * speed(rng);
+
+        const double r0 = m_cycleAngle;
+        const std::vector<bool> fired = step(angle, angularVelocity);
+        const std::vector<bool> reference = expected(r0, m_cycleAngle, angularVelocity);
+
+        for (size_t j = 0; j < fired.size(); ++j) {
+            ASSERT_EQ(fired[j], reference[j]) << "step " << i << ", plug " << j;
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include "test_engine.h"
+
+#include "../include/constants.h"
+#include "../include/piston_engine_simulator.h"
+#include "../include/units.h"
+
+#include <vector>
+
+namespace {
+
+class MechanicalStepTests : public testing::Test {
+    protected:
+        virtual void SetUp() override {
+            m_objects = createTestEngine();
+
+            m_simulator.initialize(m_objects.simulatorParameters);
+            m_simulator.setSimulationFrequency(10000);
+            m_simulator.loadSimulation(m_objects.engine, m_objects.vehicle, m_objects.transmission);
+
+            m_objects.engine->getIgnitionModule()->m_enabled = true;
+            m_objects.engine->getCrankshaft(0)->m_body.v_theta = -units::rpm(2000);
+
+            m_chamber = m_objects.engine->getChamber(0);
+            const double boreRadius = m_objects.engine->getCylinderBank(0)->getBore() / 2.0;
+            m_area = constants::pi * boreRadius * boreRadius;
+
+            // Enough steps for every block a test runs
+            m_simulator.startFrame(1 / 60.0);
+        }
+
+        virtual void TearDown() override {
+            m_simulator.endFrame();
+            m_simulator.destroy();
+            EnginePack::release(&m_objects);
+        }
+
+        // What the undivided path applies: the force from the pressure the
+        // chamber was left at by this step
+        double instantaneousPressureForce() const {
+            return -m_area * (m_chamber->m_system.pressure() - units::pressure(1.0, units::atm));
+        }
+
+        double crankAngle() const {
+            return m_objects.engine->getOutputCrankshaft()->m_body.theta;
+        }
+
+        EnginePack::Objects m_objects;
+        PistonEngineSimulator m_simulator;
+        CombustionChamber *m_chamber = nullptr;
+        double m_area = 0.0;
+};
+
+TEST_F(MechanicalStepTests, DivisorOneMatchesPerStepPath) {
+    m_simulator.setMechanicalStepDivisor(1);
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(m_simulator.simulateStep());
+
+        // Exact equality: a single sample average has to be the sample itself
+        EXPECT_EQ(m_chamber->getPressureForce(), instantaneousPressureForce());
+        EXPECT_EQ(m_chamber->m_system.volume(), m_chamber->getVolume());
+    }
+}
+
+TEST_F(MechanicalStepTests, DivisorAveragesForceAndInterpolatesAngle) {
+    constexpr int Divisor = 4;
+    m_simulator.setMechanicalStepDivisor(Divisor);
+
+    for (int block = 0; block < 20; ++block) {
+        const double startAngle = crankAngle();
+        const double startVolume = m_chamber->getVolume();
+        const double previousForce = m_chamber->getPressureForce();
+
+        std::vector<double> angles, volumes, forces;
+        for (int k = 1; k <= Divisor; ++k) {
+            ASSERT_TRUE(m_simulator.simulateStep());
+
+            angles.push_back(crankAngle());
+            volumes.push_back(m_chamber->m_system.volume());
+            forces.push_back(instantaneousPressureForce());
+
+            // The applied force only changes once the block is complete
+            if (k < Divisor) {
+                EXPECT_EQ(m_chamber->getPressureForce(), previousForce);
+            }
+        }
+
+        // The last step lands on the solved angle and volume
+        const double endAngle = angles.back();
+        const double endVolume = m_chamber->getVolume();
+        EXPECT_EQ(volumes.back(), endVolume);
+
+        double forceSum = 0;
+        for (int k = 1; k <= Divisor; ++k) {
+            const double s = k / static_cast<double>(Divisor);
+            EXPECT_DOUBLE_EQ(angles[k - 1], startAngle + (endAngle - startAngle) * s);
+            EXPECT_DOUBLE_EQ(volumes[k - 1], startVolume + (endVolume - startVolume) * s);
+
+            forceSum += forces[k - 1];
+        }
+
+        EXPECT_DOUBLE_EQ(m_chamber->getPressureForce(), forceSum / Divisor);
+    }
+}
+
+} // namespace
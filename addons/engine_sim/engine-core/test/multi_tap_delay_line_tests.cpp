@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include "../include/multi_tap_delay_line.h"
+#include "../include/delay_filter.h"
+
+#include <random>
+
+TEST(MultiTapDelayLineTests, MatchesSummedDelayFilters) {
+    constexpr int Taps = 4;
+    const double delays[Taps] = { 0.0, 0.003, 0.0125, 0.02 };
+
+    MultiTapDelayLine line;
+    line.initialize(Taps, 1000.0);
+
+    DelayFilter filters[Taps];
+    for (int i = 0; i < Taps; ++i) {
+        line.setTapDelay(i, delays[i]);
+        filters[i].initialize(delays[i], 1000.0);
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> sample(-1.0, 1.0);
+    for (int step = 0; step < 1000; ++step) {
+        double expected = 0;
+        for (int i = 0; i < Taps; ++i) {
+            const double x = sample(rng);
+            line.add(i, x);
+            expected += filters[i].fast_f(x);
+        }
+
+        ASSERT_NEAR(line.next(), expected, 1E-12);
+    }
+
+    line.destroy();
+}
+
+TEST(MultiTapDelayLineTests, SampleRateChangeKeepsSignalContinuous) {
+    MultiTapDelayLine line;
+    line.initialize(1, 1000.0);
+    line.setTapDelay(0, 0.01);
+
+    // Linear ramp so that resampled output is exact
+    double t = 0.0;
+    for (int i = 0; i < 50; ++i, t += 0.001) {
+        line.add(0, t);
+        line.next();
+    }
+
+    line.setSampleRate(500.0);
+    EXPECT_EQ(line.getSampleRate(), 500.0);
+    EXPECT_EQ(line.getTapLatency(0), 5);
+
+    line.add(0, t);
+    double last = line.next();
+    EXPECT_NEAR(last, t - 0.01, 1E-9);
+    for (int i = 0; i < 20; ++i) {
+        t += 0.002;
+        line.add(0, t);
+        const double v = line.next();
+        EXPECT_NEAR(v - last, 0.002, 1E-9);
+        last = v;
+    }
+
+    line.destroy();
+}
+
+TEST(MultiTapDelayLineTests, RestoresFromState) {
+    MultiTapDelayLine line;
+    line.initialize(2, 1000.0);
+    line.setTapDelay(0, 0.002);
+    line.setTapDelay(1, 0.008);
+
+    for (int i = 0; i < 20; ++i) {
+        line.add(0, i);
+        line.add(1, 2.0 * i);
+        line.next();
+    }
+
+    StateWriter writer;
+    line.writeState(&writer);
+
+    MultiTapDelayLine restored;
+    restored.initialize(2, 1000.0);
+    restored.setTapDelay(0, 0.002);
+    restored.setTapDelay(1, 0.008);
+
+    StateReader reader(writer.getData(), writer.getSize());
+    restored.readState(&reader);
+    EXPECT_TRUE(reader.isAtEnd());
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(restored.next(), line.next());
+    }
+
+    line.destroy();
+    restored.destroy();
+}
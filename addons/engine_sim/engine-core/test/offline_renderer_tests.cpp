@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include "test_engine.h"
+
+#include "../include/offline_renderer.h"
+#include "../include/piston_engine_simulator.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+uint32_t readU32(const std::vector<char> &data, size_t offset) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) {
+        v = (v << 8) | static_cast<uint8_t>(data[offset + i]);
+    }
+
+    return v;
+}
+
+uint16_t readU16(const std::vector<char> &data, size_t offset) {
+    return static_cast<uint16_t>(
+        static_cast<uint8_t>(data[offset]) | (static_cast<uint8_t>(data[offset + 1]) << 8));
+}
+
+} // namespace
+
+TEST(OfflineRendererTests, RendersClipAndRestoresSettings) {
+    namespace fs = std::filesystem;
+
+    EnginePack::Objects objects = createTestEngine(2);
+
+    PistonEngineSimulator simulator;
+    simulator.initialize(objects.simulatorParameters);
+    simulator.setSimulationFrequency(10000);
+    simulator.loadSimulation(objects.engine, objects.vehicle, objects.transmission);
+    simulator.setLatencyControlEnabled(true);
+    simulator.setSimulationSpeed(1.5);
+    simulator.startAudioRenderingThread();
+
+    OfflineRenderer::ControlPoint track[2];
+    track[0].starterEnabled = true;
+    track[1].time = 0.1;
+    track[1].speedControl = 1.0;
+
+    OfflineRenderer::Parameters params;
+    params.duration = 0.25;
+
+    const fs::path path = fs::temp_directory_path() / "engine_sim_offline_renderer_test.wav";
+    OfflineRenderer renderer;
+    const bool rendered = renderer.render(&simulator, track, 2, params, path.string());
+    const uint32_t sampleRate = static_cast<uint32_t>(simulator.synthesizer().getAudioSampleRate());
+
+    // The last control point is still applied
+    EXPECT_FALSE(simulator.m_starterMotor.m_enabled);
+
+    // Whatever the render bypassed is back the way it was
+    EXPECT_TRUE(simulator.synthesizer().isRenderingThreadRunning());
+    EXPECT_TRUE(simulator.isLatencyControlEnabled());
+    EXPECT_EQ(simulator.getSimulationSpeed(), 1.5);
+
+    simulator.endAudioRenderingThread();
+    simulator.destroy();
+    EnginePack::release(&objects);
+    ASSERT_TRUE(rendered);
+
+    // Resampling can leave a few samples in flight
+    const int64_t samples = renderer.getSamplesWritten();
+    EXPECT_NEAR(static_cast<double>(samples), params.duration * sampleRate, 100.0);
+
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<char> wav((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ASSERT_EQ(wav.size(), 44 + 2 * static_cast<size_t>(samples));
+    EXPECT_EQ(std::memcmp(wav.data(), "RIFF", 4), 0);
+    EXPECT_EQ(readU32(wav, 4), wav.size() - 8);
+    EXPECT_EQ(std::memcmp(wav.data() + 8, "WAVE", 4), 0);
+    EXPECT_EQ(std::memcmp(wav.data() + 12, "fmt ", 4), 0);
+    EXPECT_EQ(readU16(wav, 20), 1);         // PCM
+    EXPECT_EQ(readU16(wav, 22), 1);         // Mono
+    EXPECT_EQ(readU32(wav, 24), sampleRate);
+    EXPECT_EQ(readU16(wav, 34), 16);
+    EXPECT_EQ(std::memcmp(wav.data() + 36, "data", 4), 0);
+    EXPECT_EQ(readU32(wav, 40), 2 * static_cast<uint32_t>(samples));
+
+    file.close();
+    fs::remove(path);
+}
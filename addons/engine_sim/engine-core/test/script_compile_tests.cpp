@@ -2,10 +2,16 @@
 
 #include "../include/engine_sim_runtime_c.h"
 
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <thread>
 
 namespace {
 
@@ -68,6 +74,40 @@ TEST(ScriptCompileTests, CreatesFreshErrorLogOnCompile) {
 #endif
 }
 
+TEST(ScriptCompileTests, CompilesTwoScriptsConcurrently) {
+#if !defined(ATG_ENGINE_SIM_PIRANHA_ENABLED)
+    GTEST_SKIP() << "Scripting disabled (ATG_ENGINE_SIM_PIRANHA_ENABLED not set).";
+#else
+    namespace fs = std::filesystem;
+
+    const fs::path project_root = find_project_root_from_this_file();
+    const fs::path script_path = project_root / "assets" / "main.mr";
+    ASSERT_TRUE(fs::exists(script_path)) << "Expected script not found: " << script_path.string();
+
+    // Both have to go through the interpreter rather than the cache
+    es_runtime_clear_compilation_cache();
+
+    es_runtime_t *runtimes[2] = { es_runtime_create(), es_runtime_create() };
+    bool loaded[2] = { false, false };
+    std::thread threads[2];
+    for (int i = 0; i < 2; ++i) {
+        threads[i] = std::thread([&, i]() {
+            loaded[i] = es_runtime_load_script(runtimes[i], script_path.string().c_str());
+        });
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        EXPECT_TRUE(loaded[i]);
+        EXPECT_TRUE(es_runtime_has_simulation(runtimes[i]));
+        es_runtime_destroy(runtimes[i]);
+    }
+#endif
+}
+
 TEST(ScriptRuntimeTests, BusEngineCranksAndKeepsRunningBriefly) {
 #if !defined(ATG_ENGINE_SIM_PIRANHA_ENABLED)
     GTEST_SKIP() << "Scripting disabled (ATG_ENGINE_SIM_PIRANHA_ENABLED not set).";
@@ -123,3 +163,299 @@ TEST(ScriptRuntimeTests, BusEngineCranksAndKeepsRunningBriefly) {
         << ", RPM after starter off=" << rpm_after_starter_off;
 #endif
 }
+
+TEST(ScriptRuntimeTests, DynoSweepSplitsRangeAcrossInstances) {
+#if !defined(ATG_ENGINE_SIM_PIRANHA_ENABLED)
+    GTEST_SKIP() << "Scripting disabled (ATG_ENGINE_SIM_PIRANHA_ENABLED not set).";
+#else
+    namespace fs = std::filesystem;
+
+    const fs::path project_root = find_project_root_from_this_file();
+    const fs::path script_path = project_root / "assets" / "main.mr";
+    ASSERT_TRUE(fs::exists(script_path)) << "Expected script not found: " << script_path.string();
+
+    EXPECT_EQ(es_runtime_dyno_sweep(nullptr, 0, 0, 0, 1, nullptr, 0), -1);
+
+    es_dyno_point_t points[8];
+    const int count = es_runtime_dyno_sweep(
+        script_path.string().c_str(), 1000.0, 1600.0, 200.0, 2, points, 8);
+    ASSERT_EQ(count, 4);
+
+    bool producesTorque = false;
+    for (int i = 0; i < count; ++i) {
+        EXPECT_NEAR(points[i].rpm, 1000.0 + 200.0 * i, 1E-6);
+        EXPECT_TRUE(std::isfinite(points[i].torque_nm));
+        EXPECT_NEAR(points[i].power_w, points[i].torque_nm * points[i].rpm * 0.104719755, 1E-3);
+        producesTorque = producesTorque || points[i].torque_nm > 0;
+    }
+
+    EXPECT_TRUE(producesTorque);
+#endif
+}
+
+TEST(ScriptRuntimeTests, OfflineRenderWritesWholeDuration) {
+#if !defined(ATG_ENGINE_SIM_PIRANHA_ENABLED)
+    GTEST_SKIP() << "Scripting disabled (ATG_ENGINE_SIM_PIRANHA_ENABLED not set).";
+#else
+    namespace fs = std::filesystem;
+
+    const fs::path project_root = find_project_root_from_this_file();
+    const fs::path script_path = project_root / "assets" / "main.mr";
+    ASSERT_TRUE(fs::exists(script_path)) << "Expected script not found: " << script_path.string();
+
+    es_runtime_t *rt = es_runtime_create();
+    ASSERT_TRUE(es_runtime_load_script(rt, script_path.string().c_str()));
+
+    es_control_point_t track[2] = {};
+    track[0] = { 0.0, 0.0, true, true, -1, 1.0 };
+    track[1] = { 0.5, 0.0, false, true, -1, 1.0 };
+
+    const fs::path wav_path = fs::temp_directory_path() / "engine_sim_offline_render_test.wav";
+    ASSERT_TRUE(es_runtime_render_offline(rt, track, 2, 1.0, wav_path.string().c_str()));
+    es_runtime_destroy(rt);
+
+    // One second of mono PCM16 after the 44 byte header, within resampling slack
+    const double samples = (static_cast<double>(fs::file_size(wav_path)) - 44) / 2;
+    EXPECT_NEAR(samples, 44100.0, 100.0);
+
+    fs::remove(wav_path);
+#endif
+}
+
+TEST(ScriptRuntimeTests, AsyncLoadsCompileConcurrentlyAndSwap) {
+#if !defined(ATG_ENGINE_SIM_PIRANHA_ENABLED)
+    GTEST_SKIP() << "Scripting disabled (ATG_ENGINE_SIM_PIRANHA_ENABLED not set).";
+#else
+    namespace fs = std::filesystem;
+
+    const fs::path project_root = find_project_root_from_this_file();
+    const fs::path script_path = project_root / "assets" / "main.mr";
+    ASSERT_TRUE(fs::exists(script_path)) << "Expected script not found: " << script_path.string();
+
+    es_runtime_t *rt = es_runtime_create();
+    ASSERT_TRUE(es_runtime_load_script(rt, script_path.string().c_str()));
+
+    es_load_t *first = es_runtime_load_script_async(rt, script_path.string().c_str());
+    es_load_t *second = es_runtime_load_script_async(rt, script_path.string().c_str());
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(es_load_wait(first), ES_LOAD_READY);
+    EXPECT_EQ(es_load_wait(second), ES_LOAD_READY);
+
+    auto run_frames = [&](int frames) {
+        int16_t samples[1024];
+        for (int i = 0; i < frames; ++i) {
+            es_runtime_start_frame(rt, 1.0 / 60);
+            while (es_runtime_simulate_step(rt)) {}
+            es_runtime_end_frame(rt);
+            es_runtime_read_audio(rt, 735, samples);
+        }
+    };
+
+    // Crossfading swap, then a second swap while the first fade is still going
+    ASSERT_TRUE(es_runtime_swap_load(rt, first, 0.1));
+    EXPECT_TRUE(es_runtime_has_simulation(rt));
+    run_frames(3);
+    ASSERT_TRUE(es_runtime_swap_load(rt, second, 0.0));
+    run_frames(10);
+
+    // A load can only be swapped in once
+    EXPECT_FALSE(es_runtime_swap_load(rt, first, 0.0));
+
+    es_load_release(first);
+    es_load_release(second);
+    es_runtime_destroy(rt);
+#endif
+}
+
+TEST(ScriptRuntimeTests, SimulationThreadAppliesControlsAndPublishesState) {
+#if !defined(ATG_ENGINE_SIM_PIRANHA_ENABLED)
+    GTEST_SKIP() << "Scripting disabled (ATG_ENGINE_SIM_PIRANHA_ENABLED not set).";
+#else
+    namespace fs = std::filesystem;
+
+    const fs::path project_root = find_project_root_from_this_file();
+    const fs::path script_path = project_root / "assets" / "main.mr";
+    ASSERT_TRUE(fs::exists(script_path)) << "Expected script not found: " << script_path.string();
+
+    es_runtime_t *rt = es_runtime_create();
+    es_runtime_set_simulation_thread_enabled(rt, true);
+    ASSERT_TRUE(es_runtime_load_script(rt, script_path.string().c_str()));
+    EXPECT_TRUE(es_runtime_is_simulation_thread_enabled(rt));
+
+    es_runtime_set_gear(rt, -1);
+    es_runtime_set_speed_control(rt, 1.0);
+    es_runtime_set_ignition_enabled(rt, true);
+    es_runtime_set_starter_enabled(rt, true);
+    es_runtime_set_clutch_pressure(rt, 0.25);
+
+    // The frame calls belong to the thread now
+    es_runtime_start_frame(rt, 1.0 / 60);
+    EXPECT_FALSE(es_runtime_simulate_step(rt));
+
+    // Nothing drives the simulation here; the thread has to
+    int16_t samples[4410];
+    bool cranking = false;
+    for (int i = 0; i < 100 && !cranking; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        es_runtime_read_audio(rt, 882, samples);
+        cranking = std::abs(es_runtime_get_engine_speed_raw(rt)) > 1.0;
+    }
+
+    EXPECT_TRUE(cranking);
+    EXPECT_EQ(es_runtime_get_gear(rt), -1);
+    EXPECT_NEAR(es_runtime_get_clutch_pressure(rt), 0.25, 1e-9);
+
+    // Controls queued before stopping still arrive
+    es_runtime_set_clutch_pressure(rt, 0.5);
+    es_runtime_set_simulation_thread_enabled(rt, false);
+    EXPECT_NEAR(es_runtime_get_clutch_pressure(rt), 0.5, 1e-9);
+
+    es_runtime_start_frame(rt, 1.0 / 60);
+    EXPECT_TRUE(es_runtime_simulate_step(rt));
+    while (es_runtime_simulate_step(rt)) {}
+    es_runtime_end_frame(rt);
+
+    es_runtime_destroy(rt);
+#endif
+}
+
+TEST(ScriptRuntimeTests, TelemetryMatchesGettersAfterEachFrame) {
+#if !defined(ATG_ENGINE_SIM_PIRANHA_ENABLED)
+    GTEST_SKIP() << "Scripting disabled (ATG_ENGINE_SIM_PIRANHA_ENABLED not set).";
+#else
+    namespace fs = std::filesystem;
+
+    const fs::path project_root = find_project_root_from_this_file();
+    const fs::path script_path = project_root / "assets" / "main.mr";
+    ASSERT_TRUE(fs::exists(script_path)) << "Expected script not found: " << script_path.string();
+
+    es_runtime_t *rt = es_runtime_create();
+
+    es_telemetry_t telemetry = {};
+    telemetry.size = sizeof(es_telemetry_t);
+    EXPECT_FALSE(es_runtime_get_telemetry(rt, &telemetry, 0));
+
+    ASSERT_TRUE(es_runtime_load_script(rt, script_path.string().c_str()));
+    es_runtime_set_gear(rt, -1);
+    es_runtime_set_ignition_enabled(rt, true);
+    es_runtime_set_starter_enabled(rt, true);
+    es_runtime_set_clutch_pressure(rt, 0.25);
+
+    ASSERT_TRUE(es_runtime_get_telemetry(rt, &telemetry, ES_TELEMETRY_CYLINDERS));
+    const uint64_t loaded_frame = telemetry.frame;
+
+    for (int i = 0; i < 10; ++i) {
+        es_runtime_start_frame(rt, 1.0 / 60);
+        while (es_runtime_simulate_step(rt)) {}
+        es_runtime_end_frame(rt);
+    }
+
+    ASSERT_TRUE(es_runtime_get_telemetry(rt, &telemetry, ES_TELEMETRY_CYLINDERS));
+    EXPECT_EQ(telemetry.version, ES_TELEMETRY_VERSION);
+    EXPECT_EQ(telemetry.size, sizeof(es_telemetry_t));
+    EXPECT_EQ(telemetry.frame, loaded_frame + 10);
+    EXPECT_DOUBLE_EQ(telemetry.engine_speed_rpm, es_runtime_get_engine_speed(rt));
+    EXPECT_DOUBLE_EQ(telemetry.engine_speed_raw_rpm, es_runtime_get_engine_speed_raw(rt));
+    EXPECT_EQ(telemetry.gear, -1);
+    EXPECT_NEAR(telemetry.clutch_pressure, 0.25, 1e-9);
+    EXPECT_GT(telemetry.manifold_pressure_pa, 0.0);
+    EXPECT_GT(telemetry.cylinder_count, 0);
+    for (int i = 0; i < telemetry.cylinder_count; ++i) {
+        EXPECT_GT(telemetry.cylinder_pressure_pa[i], 0.0);
+        EXPECT_GT(telemetry.cylinder_temperature_k[i], 0.0);
+    }
+
+    // Without the flag the per-cylinder arrays are left alone
+    telemetry.cylinder_pressure_pa[0] = -1.0;
+    ASSERT_TRUE(es_runtime_get_telemetry(rt, &telemetry, 0));
+    EXPECT_EQ(telemetry.cylinder_count, 0);
+    EXPECT_EQ(telemetry.cylinder_pressure_pa[0], -1.0);
+
+    // A struct too old to hold the common fields is refused
+    telemetry.size = offsetof(es_telemetry_t, engine_speed_rpm);
+    EXPECT_FALSE(es_runtime_get_telemetry(rt, &telemetry, 0));
+
+    es_runtime_destroy(rt);
+#endif
+}
+
+TEST(ScriptRuntimeTests, TelemetryFillsOnlyCallerSize) {
+#if !defined(ATG_ENGINE_SIM_PIRANHA_ENABLED)
+    GTEST_SKIP() << "Scripting disabled (ATG_ENGINE_SIM_PIRANHA_ENABLED not set).";
+#else
+    namespace fs = std::filesystem;
+
+    const fs::path project_root = find_project_root_from_this_file();
+    const fs::path script_path = project_root / "assets" / "main.mr";
+    ASSERT_TRUE(fs::exists(script_path)) << "Expected script not found: " << script_path.string();
+
+    es_runtime_t *rt = es_runtime_create();
+    ASSERT_TRUE(es_runtime_load_script(rt, script_path.string().c_str()));
+    es_runtime_set_starter_enabled(rt, true);
+    for (int i = 0; i < 5; ++i) {
+        es_runtime_start_frame(rt, 1.0 / 60);
+        while (es_runtime_simulate_step(rt)) {}
+        es_runtime_end_frame(rt);
+    }
+
+    // Room for a struct from a newer header, with a guard pattern past
+    // whatever the caller claims to own
+    constexpr uint8_t Guard = 0xAB;
+    struct {
+        es_telemetry_t telemetry;
+        uint8_t newer[64];
+    } buffer;
+
+    auto fill_guard = [&]() {
+        std::memset(&buffer, Guard, sizeof(buffer));
+    };
+
+    auto untouched_from = [&](size_t offset) {
+        const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&buffer);
+        for (size_t i = offset; i < sizeof(buffer); ++i) {
+            if (bytes[i] != Guard) return false;
+        }
+
+        return true;
+    };
+
+    // Header from before the per-cylinder fields: only its own fields
+    const uint32_t old_size = offsetof(es_telemetry_t, cylinder_count);
+    fill_guard();
+    buffer.telemetry.size = old_size;
+    ASSERT_TRUE(es_runtime_get_telemetry(rt, &buffer.telemetry, ES_TELEMETRY_CYLINDERS));
+    EXPECT_EQ(buffer.telemetry.size, old_size);
+    EXPECT_EQ(buffer.telemetry.version, ES_TELEMETRY_VERSION);
+    EXPECT_DOUBLE_EQ(buffer.telemetry.engine_speed_rpm, es_runtime_get_engine_speed(rt));
+    EXPECT_TRUE(untouched_from(old_size));
+
+    // A size ending inside the arrays cuts them off there
+    const uint32_t partial_size = offsetof(es_telemetry_t, cylinder_pressure_pa) + sizeof(double);
+    fill_guard();
+    buffer.telemetry.size = partial_size;
+    ASSERT_TRUE(es_runtime_get_telemetry(rt, &buffer.telemetry, ES_TELEMETRY_CYLINDERS));
+    EXPECT_GT(buffer.telemetry.cylinder_count, 0);
+    EXPECT_GT(buffer.telemetry.cylinder_pressure_pa[0], 0.0);
+    EXPECT_TRUE(untouched_from(partial_size));
+
+    // A newer, larger struct gets this library's fields and keeps the rest.
+    // `version` tells the caller which fields those were.
+    const uint32_t newer_size = sizeof(buffer);
+    fill_guard();
+    buffer.telemetry.size = newer_size;
+    ASSERT_TRUE(es_runtime_get_telemetry(rt, &buffer.telemetry, ES_TELEMETRY_CYLINDERS));
+    EXPECT_EQ(buffer.telemetry.size, newer_size);
+    EXPECT_EQ(buffer.telemetry.version, ES_TELEMETRY_VERSION);
+    EXPECT_TRUE(untouched_from(sizeof(es_telemetry_t)));
+
+    // One byte short of the common fields is refused without writing
+    fill_guard();
+    buffer.telemetry.size = old_size - 1;
+    EXPECT_FALSE(es_runtime_get_telemetry(rt, &buffer.telemetry, 0));
+    EXPECT_EQ(buffer.telemetry.size, old_size - 1);
+    EXPECT_TRUE(untouched_from(offsetof(es_telemetry_t, frame)));
+
+    es_runtime_destroy(rt);
+#endif
+}
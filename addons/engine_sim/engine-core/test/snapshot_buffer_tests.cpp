@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include "../include/snapshot_buffer.h"
+
+#include <atomic>
+#include <thread>
+
+namespace {
+
+// Every field holds the same value, so a torn read shows up as a mismatch
+struct Sample {
+    uint64_t values[32];
+};
+
+Sample makeSample(uint64_t value) {
+    Sample sample;
+    for (uint64_t &v : sample.values) v = value;
+    return sample;
+}
+
+} // namespace
+
+TEST(SnapshotBufferTests, ReadsLatestPublished) {
+    SnapshotBuffer<Sample> buffer;
+
+    Sample sample;
+    EXPECT_FALSE(buffer.read(&sample));
+    EXPECT_EQ(buffer.getVersion(), 0);
+
+    buffer.publish(makeSample(1));
+    buffer.publish(makeSample(2));
+    buffer.publish(makeSample(3));
+
+    ASSERT_TRUE(buffer.read(&sample));
+    EXPECT_EQ(sample.values[0], 3);
+    EXPECT_EQ(sample.values[31], 3);
+    EXPECT_EQ(buffer.getVersion(), 3);
+}
+
+TEST(SnapshotBufferTests, ReadsAreNeverTorn) {
+    SnapshotBuffer<Sample> buffer;
+    buffer.publish(makeSample(0));
+
+    std::atomic<bool> done{ false };
+    std::thread writer([&]() {
+        for (uint64_t i = 1; i <= 200000; ++i) {
+            buffer.publish(makeSample(i));
+        }
+
+        done.store(true);
+    });
+
+    uint64_t previous = 0;
+    while (!done.load()) {
+        Sample sample;
+        ASSERT_TRUE(buffer.read(&sample));
+
+        for (const uint64_t v : sample.values) {
+            ASSERT_EQ(v, sample.values[0]);
+        }
+
+        // Snapshots never go backwards
+        ASSERT_GE(sample.values[0], previous);
+        previous = sample.values[0];
+    }
+
+    writer.join();
+}
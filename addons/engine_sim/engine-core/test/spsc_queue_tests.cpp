@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include "../include/spsc_queue.h"
+
+#include <thread>
+
+TEST(SpscQueueTests, FailsWhenFullAndWrapsAround) {
+    SpscQueue<int, 4> queue;
+
+    int value = 0;
+    EXPECT_FALSE(queue.pop(&value));
+
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 4; ++i) {
+            EXPECT_TRUE(queue.push(round * 10 + i));
+        }
+
+        EXPECT_FALSE(queue.push(-1));
+        EXPECT_EQ(queue.size(), 4);
+
+        for (int i = 0; i < 4; ++i) {
+            ASSERT_TRUE(queue.pop(&value));
+            EXPECT_EQ(value, round * 10 + i);
+        }
+
+        EXPECT_FALSE(queue.pop(&value));
+    }
+}
+
+TEST(SpscQueueTests, KeepsOrderAcrossThreads) {
+    constexpr int Count = 10000;
+    SpscQueue<int, 64> queue;
+
+    std::thread producer([&]() {
+        for (int i = 0; i < Count; ++i) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    while (expected < Count) {
+        int value = 0;
+        if (queue.pop(&value)) {
+            ASSERT_EQ(value, expected);
+            ++expected;
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    EXPECT_EQ(queue.size(), 0);
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include "../include/state_snapshot.h"
+#include "../include/delay_filter.h"
+#include "../include/jitter_filter.h"
+#include "../include/ring_buffer.h"
+
+TEST(StateSnapshotTests, ReadsBackInOrder) {
+    StateWriter writer;
+    writer.write(42);
+    writer.write(1.5);
+
+    const float samples[] = { 1.0f, 2.0f, 3.0f };
+    writer.write(samples, 3);
+
+    StateReader reader(writer.getData(), writer.getSize());
+    int i = 0;
+    double d = 0;
+    float f[3] = {};
+    EXPECT_TRUE(reader.read(&i));
+    EXPECT_TRUE(reader.read(&d));
+    EXPECT_TRUE(reader.read(f, 3));
+
+    EXPECT_EQ(i, 42);
+    EXPECT_EQ(d, 1.5);
+    EXPECT_EQ(f[2], 3.0f);
+    EXPECT_TRUE(reader.isAtEnd());
+}
+
+TEST(StateSnapshotTests, FailureIsSticky) {
+    StateWriter writer;
+    writer.write(static_cast<uint16_t>(7));
+    writer.write(static_cast<uint16_t>(8));
+
+    StateReader reader(writer.getData(), writer.getSize());
+    uint64_t tooLarge = 0;
+    uint16_t value = 0;
+    EXPECT_FALSE(reader.read(&tooLarge));
+    EXPECT_FALSE(reader.read(&value));
+    EXPECT_FALSE(reader.isValid());
+}
+
+TEST(StateSnapshotTests, RingBufferRoundTrip) {
+    RingBuffer<float> source;
+    source.initialize(8);
+    for (int i = 0; i < 12; ++i) {
+        source.write(static_cast<float>(i));
+        if (source.size() > 5) source.removeBeginning(1);
+    }
+
+    StateWriter writer;
+    source.writeState(&writer);
+
+    RingBuffer<float> target;
+    target.initialize(8);
+    StateReader reader(writer.getData(), writer.getSize());
+    target.readState(&reader);
+
+    ASSERT_TRUE(reader.isValid());
+    ASSERT_EQ(target.size(), source.size());
+    for (size_t i = 0; i < source.size(); ++i) {
+        EXPECT_EQ(target.read(i), source.read(i));
+    }
+
+    source.destroy();
+    target.destroy();
+}
+
+TEST(StateSnapshotTests, RestoredFiltersContinueIdentically) {
+    DelayFilter delay;
+    delay.initialize(0.01, 1000.0);
+
+    JitterFilter jitter;
+    jitter.initialize(10, 1000.0f, 44100.0f);
+    jitter.setJitterScale(0.5f);
+
+    for (int i = 0; i < 25; ++i) {
+        delay.fast_f(i);
+        jitter.fast_f(static_cast<float>(i));
+    }
+
+    StateWriter writer;
+    delay.writeState(&writer);
+    jitter.writeState(&writer);
+
+    DelayFilter restoredDelay;
+    restoredDelay.initialize(0.01, 1000.0);
+
+    JitterFilter restoredJitter;
+    restoredJitter.initialize(10, 1000.0f, 44100.0f);
+    restoredJitter.setJitterScale(0.5f);
+
+    StateReader reader(writer.getData(), writer.getSize());
+    restoredDelay.readState(&reader);
+    restoredJitter.readState(&reader);
+    ASSERT_TRUE(reader.isValid());
+    EXPECT_TRUE(reader.isAtEnd());
+
+    for (int i = 0; i < 25; ++i) {
+        EXPECT_EQ(restoredDelay.fast_f(i), delay.fast_f(i));
+        EXPECT_EQ(restoredJitter.fast_f(1.0f), jitter.fast_f(1.0f));
+    }
+}
@@ -203,3 +203,38 @@ TEST(SynthesizerTests, DISABLED_SynthesizerSystemTest) {
 
     delete[] output;
 }
+
+TEST(SynthesizerTests, RenderPendingMatchesRenderingPath) {
+    constexpr int inputSamples = 64;
+
+    Synthesizer threaded, offline;
+    setupSynchronizedSynthesizer(threaded);
+    setupSynchronizedSynthesizer(offline);
+
+    int16_t threadedOutput[inputSamples] = {};
+    int16_t offlineOutput[inputSamples] = {};
+    int threadedSamples = 0, offlineSamples = 0;
+
+    for (int i = 0; i < inputSamples;) {
+        for (int j = 0; j < 16; ++j, ++i) {
+            const double v = (double)i;
+            const double data[] = { v, v, v, v, v, v, v, v };
+            threaded.writeInput(data);
+            offline.writeInput(data);
+        }
+
+        threaded.endInputBlock();
+        threaded.renderAudio();
+        threadedSamples += threaded.readAudioOutput(16, threadedOutput + threadedSamples);
+
+        offlineSamples += offline.renderPending(offlineOutput + offlineSamples, inputSamples - offlineSamples);
+    }
+
+    ASSERT_EQ(offlineSamples, threadedSamples);
+    for (int i = 0; i < offlineSamples; ++i) {
+        EXPECT_EQ(offlineOutput[i], threadedOutput[i]);
+    }
+
+    threaded.destroy();
+    offline.destroy();
+}
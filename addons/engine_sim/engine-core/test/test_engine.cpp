@@ -0,0 +1,330 @@
+#include "test_engine.h"
+
+#include "../include/constants.h"
+#include "../include/direct_throttle_linkage.h"
+#include "../include/impulse_response.h"
+#include "../include/standard_valvetrain.h"
+#include "../include/units.h"
+
+#include <cmath>
+#include <memory>
+
+namespace {
+
+// Same shape as the harmonic_cam_lobe script node
+Function *createLobe(double durationAt50Thou, double gamma, double lift, int steps) {
+    const double angle = durationAt50Thou / 4;
+    const double s = std::pow(2 * units::distance(50, units::thou) / lift, 1 / gamma) - 1;
+    const double k = std::acos(s) / angle;
+    const double extents = constants::pi / k;
+    const double step = extents / (steps - 5.0);
+
+    Function *lobe = new Function;
+    lobe->initialize(2 * steps - 1, step);
+    lobe->addSample(0.0, lift);
+    for (int i = 1; i < steps; ++i) {
+        const double x = i * step;
+        const double y = (x >= extents)
+            ? 0.0
+            : lift * std::pow(0.5 + 0.5 * std::cos(k * x), gamma);
+        lobe->addSample(x, y);
+        lobe->addSample(-x, y);
+    }
+
+    return lobe;
+}
+
+// Samples are given in thou of lift and scfm at 28 inH2O
+Function *createFlow(const double *flow, int count) {
+    const double step = units::distance(50, units::thou);
+
+    Function *f = new Function;
+    f->initialize(count, step);
+    for (int i = 0; i < count; ++i) {
+        f->addSample(i * step, GasSystem::k_28inH2O(flow[i]));
+    }
+
+    return f;
+}
+
+// One lobe per cylinder in the bank, all of the engine's cylinders firing
+// evenly through the cycle
+Camshaft *createCamshaft(
+    Crankshaft *crankshaft,
+    Function *lobe,
+    double centerline,
+    int bankCylinders,
+    int cylinderCount)
+{
+    Camshaft::Parameters params;
+    params.lobes = bankCylinders;
+    params.crankshaft = crankshaft;
+    params.lobeProfile = lobe;
+    params.baseRadius = units::distance(500, units::thou);
+
+    Camshaft *cam = new Camshaft;
+    cam->initialize(params);
+    for (int i = 0; i < bankCylinders; ++i) {
+        cam->setLobeCenterline(i, centerline + i * 4 * constants::pi / cylinderCount);
+    }
+
+    return cam;
+}
+
+} // namespace
+
+EnginePack::Objects createTestEngine(int cylinderCount) {
+    TestEngineParameters params;
+    params.cylinderCount = cylinderCount;
+    return createTestEngine(params);
+}
+
+EnginePack::Objects createTestEngine(const TestEngineParameters &testParams) {
+    const int cylinderCount = testParams.cylinderCount;
+    const int bankCount = testParams.bankCount;
+    const int bankCylinders = cylinderCount / bankCount;
+
+    static const double IntakeFlow[] =
+        { 0, 25, 75, 100, 130, 180, 190, 220, 240, 250, 260 };
+    static const double ExhaustFlow[] =
+        { 0, 25, 50, 75, 100, 125, 160, 175, 180, 190, 200 };
+    static const double GearRatios[] = { 2.97, 2.07, 1.43, 1.00 };
+
+    Throttle *throttle = testParams.throttle;
+    if (throttle == nullptr) {
+        DirectThrottleLinkage::Parameters throttleParams;
+        throttleParams.gamma = 1.0;
+        DirectThrottleLinkage *linkage = new DirectThrottleLinkage;
+        linkage->initialize(throttleParams);
+        throttle = linkage;
+    }
+
+    Engine::Parameters params;
+    params.name = "Test Inline";
+    params.cylinderBanks = bankCount;
+    params.cylinderCount = cylinderCount;
+    params.crankshaftCount = 1;
+    params.exhaustSystemCount = 1;
+    params.intakeCount = 1;
+    params.starterTorque = units::torque(50, units::ft_lb);
+    params.starterSpeed = units::rpm(500);
+    params.redline = units::rpm(3600);
+    params.throttle = throttle;
+    params.initialSimulationFrequency = 10000;
+    params.initialHighFrequencyGain = 0.01;
+    params.initialNoise = 1.0;
+    params.initialJitter = 0.5;
+
+    Engine *engine = new Engine;
+    engine->initialize(params);
+
+    Crankshaft::Parameters crankParams;
+    crankParams.mass = units::mass(5, units::lb);
+    crankParams.flywheelMass = units::mass(5, units::lb);
+    crankParams.momentOfInertia = 0.115;
+    crankParams.crankThrow = units::distance(69, units::mm) / 2;
+    crankParams.frictionTorque = units::torque(10, units::ft_lb);
+    crankParams.rodJournals = bankCylinders;
+    Crankshaft *crankshaft = engine->getCrankshaft(0);
+    crankshaft->initialize(crankParams);
+    for (int i = 0; i < bankCylinders; ++i) {
+        crankshaft->setRodJournalAngle(i, std::fmod(i * 4 * constants::pi / bankCylinders, 2 * constants::pi));
+    }
+
+    CylinderBank::Parameters bankParams;
+    bankParams.crankshaft = crankshaft;
+    bankParams.positionX = 0.0;
+    bankParams.positionY = 0.0;
+    bankParams.bore = units::distance(83, units::mm);
+    bankParams.deckHeight =
+        units::distance(5.0, units::inch) + units::distance(69, units::mm) / 2;
+    bankParams.displayDepth = 0.5;
+    bankParams.cylinderCount = bankCylinders;
+    for (int b = 0; b < bankCount; ++b) {
+        bankParams.angle = (b - (bankCount - 1) / 2.0) * testParams.bankAngle;
+        bankParams.index = b;
+        engine->getCylinderBank(b)->initialize(bankParams);
+    }
+
+    const double slaveThrow = units::distance(1.0, units::inch);
+    for (int i = 0; i < cylinderCount; ++i) {
+        const int bankIndex = i / bankCylinders;
+        const int position = i % bankCylinders;
+        Piston *piston = engine->getPiston(i);
+        ConnectingRod *rod = engine->getConnectingRod(i);
+
+        Piston::Parameters pistonParams;
+        pistonParams.Rod = rod;
+        pistonParams.Bank = engine->getCylinderBank(bankIndex);
+        pistonParams.CylinderIndex = position;
+        pistonParams.BlowbyFlowCoefficient = GasSystem::k_28inH2O(0.1);
+        pistonParams.CompressionHeight = units::distance(1.0, units::inch);
+        pistonParams.WristPinPosition = 0.0;
+        pistonParams.Displacement = 0.0;
+        pistonParams.mass = units::mass(400, units::g);
+        piston->initialize(pistonParams);
+
+        ConnectingRod::Parameters rodParams;
+        rodParams.mass = units::mass(300, units::g);
+        rodParams.momentOfInertia = 0.0015884918028487504;
+        rodParams.centerOfMass = 0.0;
+        rodParams.length = units::distance(4.0, units::inch);
+        rodParams.piston = piston;
+        rodParams.crankshaft = crankshaft;
+        rodParams.journal = position;
+        if (testParams.articulatedRods && bankIndex == 0) {
+            // Heavier toward the big end, which carries the slave journals
+            rodParams.centerOfMass = -slaveThrow;
+            rodParams.rodJournals = bankCount - 1;
+            rodParams.slaveThrow = slaveThrow;
+        }
+        else if (testParams.articulatedRods) {
+            // Shorter by the slave throw so the piston travels like the master's
+            rodParams.length -= slaveThrow;
+            rodParams.master = engine->getConnectingRod(position);
+            rodParams.journal = bankIndex - 1;
+        }
+        rod->initialize(rodParams);
+
+        // Slave journals point down their bank
+        for (int j = 0; j < rod->getRodJournalCount(); ++j) {
+            rod->setRodJournalAngle(
+                j,
+                constants::pi / 2
+                    + engine->getCylinderBank(j + 1)->getAngle()
+                    - engine->getCylinderBank(0)->getAngle());
+        }
+    }
+
+    ImpulseResponse *response = new ImpulseResponse;
+    response->initialize("sound-library/smooth.wav", 1.0);
+
+    ExhaustSystem::Parameters exhaustParams;
+    exhaustParams.collectorCrossSectionArea = constants::pi * std::pow(units::distance(1.0, units::inch), 2);
+    exhaustParams.length = units::volume(20.0, units::L) / exhaustParams.collectorCrossSectionArea;
+    exhaustParams.outletFlowRate = GasSystem::k_carb(300.0);
+    exhaustParams.primaryTubeLength = units::distance(10.0, units::inch);
+    exhaustParams.primaryFlowRate = GasSystem::k_carb(200.0);
+    exhaustParams.velocityDecay = 1.0;
+    exhaustParams.audioVolume = 1.0;
+    exhaustParams.impulseResponse = response;
+    engine->getExhaustSystem(0)->initialize(exhaustParams);
+
+    Intake::Parameters intakeParams;
+    intakeParams.volume = units::volume(1.0, units::L);
+    intakeParams.CrossSectionArea = units::area(10.0, units::cm2);
+    intakeParams.InputFlowK = GasSystem::k_carb(50.0);
+    intakeParams.IdleFlowK = GasSystem::k_carb(0.0);
+    intakeParams.RunnerFlowRate = GasSystem::k_carb(200.0);
+    intakeParams.IdleThrottlePlatePosition = 0.96;
+    engine->getIntake(0)->initialize(intakeParams);
+
+    Function *lobe = createLobe(160 * units::deg, 1.1, units::distance(200, units::thou), 100);
+
+    CylinderHead::Parameters headParams;
+    headParams.IntakePortFlow = createFlow(IntakeFlow, 11);
+    headParams.ExhaustPortFlow = createFlow(ExhaustFlow, 11);
+    headParams.CombustionChamberVolume = units::volume(50, units::cc);
+    headParams.IntakeRunnerVolume = units::volume(100, units::cc);
+    headParams.IntakeRunnerCrossSectionArea = units::area(30.0, units::cm2);
+    headParams.ExhaustRunnerVolume = units::volume(100, units::cc);
+    headParams.ExhaustRunnerCrossSectionArea = units::area(30.0, units::cm2);
+    for (int b = 0; b < bankCount; ++b) {
+        const double firstFiringAngle = b * bankCylinders * 4 * constants::pi / cylinderCount;
+
+        StandardValvetrain::Parameters valvetrainParams;
+        valvetrainParams.intakeCamshaft =
+            createCamshaft(crankshaft, lobe, (360 + 114) * units::deg + firstFiringAngle, bankCylinders, cylinderCount);
+        valvetrainParams.exhaustCamshaft =
+            createCamshaft(crankshaft, lobe, (360 - 114) * units::deg + firstFiringAngle, bankCylinders, cylinderCount);
+        StandardValvetrain *valvetrain = new StandardValvetrain;
+        valvetrain->initialize(valvetrainParams);
+
+        headParams.Bank = engine->getCylinderBank(b);
+        headParams.Valvetrain = valvetrain;
+        CylinderHead *head = engine->getHead(b);
+        head->initialize(headParams);
+        for (int i = 0; i < bankCylinders; ++i) {
+            head->setIntake(i, engine->getIntake(0));
+            head->setExhaustSystem(i, engine->getExhaustSystem(0));
+            head->setSoundAttenuation(i, 1.0);
+            head->setHeaderPrimaryLength(i, units::distance(10.0 + b * bankCylinders + i, units::inch));
+        }
+    }
+
+    Function *timing = new Function;
+    timing->initialize(5, units::rpm(1000));
+    for (int i = 0; i < 5; ++i) {
+        timing->addSample(units::rpm(1000 * i), 50 * units::deg);
+    }
+
+    IgnitionModule::Parameters ignitionParams;
+    ignitionParams.cylinderCount = cylinderCount;
+    ignitionParams.crankshaft = crankshaft;
+    ignitionParams.timingCurve = timing;
+    ignitionParams.revLimit = units::rpm(5000);
+    engine->getIgnitionModule()->initialize(ignitionParams);
+    for (int i = 0; i < cylinderCount; ++i) {
+        engine->getIgnitionModule()->setFiringOrder(i, i * 4 * constants::pi / cylinderCount);
+    }
+
+    Function *flameSpeed = new Function;
+    flameSpeed->initialize(9, 5.0);
+    flameSpeed->addSample(0.0, 3.0);
+    for (int i = 1; i < 9; ++i) {
+        flameSpeed->addSample(5.0 * i, 1.5 * 5.0 * i);
+    }
+
+    Fuel::Parameters fuelParams;
+    fuelParams.turbulenceToFlameSpeedRatio = flameSpeed;
+    fuelParams.burningEfficiencyRandomness = testParams.burningEfficiencyRandomness;
+    engine->getFuel()->initialize(fuelParams);
+
+    Function *turbulence = new Function;
+    turbulence->initialize(30, 1);
+    for (int i = 0; i < 30; ++i) {
+        turbulence->addSample(i, i * 0.5);
+    }
+
+    CombustionChamber::Parameters ccParams;
+    ccParams.Fuel = engine->getFuel();
+    ccParams.MeanPistonSpeedToTurbulence = turbulence;
+    ccParams.StartingPressure = units::pressure(1.0, units::atm);
+    ccParams.StartingTemperature = units::celcius(25.0);
+    ccParams.CrankcasePressure = units::pressure(1.0, units::atm);
+    for (int i = 0; i < cylinderCount; ++i) {
+        ccParams.Head = engine->getHead(i / bankCylinders);
+        ccParams.Piston = engine->getPiston(i);
+        engine->getChamber(i)->initialize(ccParams);
+    }
+
+    std::shared_ptr<EnginePack::FunctionSet> functions = std::make_shared<EnginePack::FunctionSet>();
+    functions->functions = { lobe, headParams.IntakePortFlow, headParams.ExhaustPortFlow, timing, flameSpeed, turbulence };
+    for (Function *f : functions->functions) {
+        f->compile();
+    }
+
+    Vehicle::Parameters vehicleParams;
+    vehicleParams.mass = units::mass(1000, units::kg);
+    vehicleParams.dragCoefficient = 0.25;
+    vehicleParams.crossSectionArea = units::area(2.0, units::m2);
+    vehicleParams.diffRatio = 3.42;
+    vehicleParams.tireRadius = units::distance(10, units::inch);
+    vehicleParams.rollingResistance = 2000.0;
+
+    Transmission::Parameters transmissionParams;
+    transmissionParams.GearCount = 4;
+    transmissionParams.GearRatios = GearRatios;
+    transmissionParams.MaxClutchTorque = units::torque(1000.0, units::ft_lb);
+
+    EnginePack::Objects objects;
+    objects.engine = engine;
+    objects.vehicle = new Vehicle;
+    objects.vehicle->initialize(vehicleParams);
+    objects.transmission = new Transmission;
+    objects.transmission->initialize(transmissionParams);
+    objects.simulatorParameters.systemType = Simulator::SystemType::NsvOptimized;
+    objects.functions = functions;
+
+    return objects;
+}
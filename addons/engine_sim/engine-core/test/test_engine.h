@@ -0,0 +1,34 @@
+#ifndef ATG_ENGINE_SIM_TEST_ENGINE_H
+#define ATG_ENGINE_SIM_TEST_ENGINE_H
+
+#include "../include/engine_pack.h"
+
+// Engine, vehicle and transmission built the way a script would build them.
+// Cylinders fire evenly, each bank has its own head and all of them share one
+// intake and exhaust system. Geometry and flow rates follow the Kohler CH750
+// so the result can actually be simulated. Free with EnginePack::release().
+struct TestEngineParameters {
+    int cylinderCount = 1;
+
+    // Cylinders are split evenly across banks, which fan out `bankAngle`
+    // apart around vertical. Cylinder i sits in bank i / (cylinders per bank).
+    int bankCount = 1;
+    double bankAngle = 0.0;
+
+    // Radial style: rods in the first bank are master rods on the crank, and
+    // the rods in the other banks ride on a slave journal of the master in
+    // the same position. Otherwise every bank shares the crank journals.
+    bool articulatedRods = false;
+
+    // Direct linkage when null. Owned by the engine.
+    Throttle *throttle = nullptr;
+
+    // Combustion draws from the global rand(), so runs only repeat exactly
+    // with this at 0
+    double burningEfficiencyRandomness = 0.5;
+};
+
+EnginePack::Objects createTestEngine(const TestEngineParameters &params);
+EnginePack::Objects createTestEngine(int cylinderCount = 1);
+
+#endif /* ATG_ENGINE_SIM_TEST_ENGINE_H */
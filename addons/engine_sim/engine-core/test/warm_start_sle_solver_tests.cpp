@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include "../include/warm_start_sle_solver.h"
+
+#include <cmath>
+
+namespace {
+
+constexpr int Bodies = 3;
+constexpr int Rows = 3;
+
+// Three bodies joined in a chain, plus one constraint on the first body alone
+void buildSystem(atg_scs::SparseMatrix<3> *J, atg_scs::Matrix *W, atg_scs::Matrix *right) {
+    J->initialize(Bodies * 3, Rows);
+    W->initialize(1, Bodies * 3);
+    right->initialize(1, Rows);
+
+    const double masses[] = { 1.0, 2.0, 5.0 };
+    for (int i = 0; i < Bodies; ++i) {
+        W->set(0, i * 3 + 0, 1 / masses[i]);
+        W->set(0, i * 3 + 1, 1 / masses[i]);
+        W->set(0, i * 3 + 2, 1 / (0.1 * masses[i]));
+    }
+
+    const int blocks[Rows][2] = { { 0, 1 }, { 1, 2 }, { 0, 0xFF } };
+    const double values[Rows][2][3] = {
+        { { 1.0, 0.2, 0.1 }, { -1.0, -0.2, 0.3 } },
+        { { 0.5, 1.0, -0.2 }, { -0.5, -1.0, 0.1 } },
+        { { 0.0, 1.0, 0.4 }, { 0.0, 0.0, 0.0 } }
+    };
+
+    for (int i = 0; i < Rows; ++i) {
+        for (int k = 0; k < 2; ++k) {
+            J->setBlock(i, k, static_cast<uint8_t>(blocks[i][k]));
+            for (int s = 0; s < 3; ++s) {
+                J->set(i, k, s, values[i][k][s]);
+            }
+        }
+    }
+
+    right->set(0, 0, 3.0);
+    right->set(0, 1, -1.0);
+    right->set(0, 2, 2.0);
+}
+
+// J * W * J^T times x, computed densely
+void multiply(atg_scs::SparseMatrix<3> &J, atg_scs::Matrix &W, const double *x, double *target) {
+    double impulse[Bodies * 3] = {};
+    for (int i = 0; i < Rows; ++i) {
+        for (int k = 0; k < 2; ++k) {
+            const uint8_t block = J.getBlockIndex(i, k);
+            if (block == 0xFF) continue;
+            for (int s = 0; s < 3; ++s) {
+                impulse[block * 3 + s] += W.get(0, block * 3 + s) * J.get(i, k, s) * x[i];
+            }
+        }
+    }
+
+    for (int i = 0; i < Rows; ++i) {
+        target[i] = 0;
+        for (int k = 0; k < 2; ++k) {
+            const uint8_t block = J.getBlockIndex(i, k);
+            if (block == 0xFF) continue;
+            for (int s = 0; s < 3; ++s) {
+                target[i] += J.get(i, k, s) * impulse[block * 3 + s];
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST(WarmStartSleSolverTests, ConvergesToSolution) {
+    atg_scs::SparseMatrix<3> J;
+    atg_scs::Matrix W, right, result;
+    buildSystem(&J, &W, &right);
+
+    WarmStartSleSolver solver;
+    solver.m_maxIterations = 200;
+    solver.m_relativeTolerance = 1E-9;
+    EXPECT_TRUE(solver.solve(J, W, right, &result, nullptr));
+    EXPECT_TRUE(solver.didLastSolveConverge());
+    EXPECT_LE(solver.getLastResidual(), 1E-9);
+
+    double x[Rows], Ax[Rows];
+    for (int i = 0; i < Rows; ++i) x[i] = result.get(0, i);
+    multiply(J, W, x, Ax);
+
+    for (int i = 0; i < Rows; ++i) {
+        EXPECT_NEAR(Ax[i], right.get(0, i), 1E-6);
+    }
+}
+
+TEST(WarmStartSleSolverTests, WarmStartSkipsWork) {
+    atg_scs::SparseMatrix<3> J;
+    atg_scs::Matrix W, right, result;
+    buildSystem(&J, &W, &right);
+
+    WarmStartSleSolver solver;
+    solver.solve(J, W, right, &result, nullptr);
+    const int coldIterations = solver.getLastIterations();
+
+    // A nearby right-hand side, as from the next simulation step
+    right.set(0, 0, right.get(0, 0) * 1.0001);
+    solver.solve(J, W, right, &result, nullptr);
+    EXPECT_LT(solver.getLastIterations(), coldIterations);
+
+    solver.reset();
+    solver.solve(J, W, right, &result, nullptr);
+    EXPECT_EQ(solver.getLastIterations(), coldIterations);
+}
+
+TEST(WarmStartSleSolverTests, RespectsLimits) {
+    atg_scs::SparseMatrix<3> J;
+    atg_scs::Matrix W, right, limits, result;
+    buildSystem(&J, &W, &right);
+
+    limits.initialize(2, Rows);
+    for (int i = 0; i < Rows; ++i) {
+        limits.set(0, i, -0.5);
+        limits.set(1, i, 0.5);
+    }
+
+    WarmStartSleSolver solver;
+    solver.solveWithLimits(J, W, right, limits, &result, nullptr);
+
+    for (int i = 0; i < Rows; ++i) {
+        EXPECT_GE(result.get(0, i), -0.5);
+        EXPECT_LE(result.get(0, i), 0.5);
+    }
+}
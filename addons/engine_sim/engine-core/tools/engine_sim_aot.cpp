@@ -0,0 +1,338 @@
+// engine-sim-aot: generates specialized simulator kernels for engine scripts.
+//
+// Usage:
+//   engine-sim-aot [options] <engine.mr | directory>...
+//
+// Options:
+//   --output <dir>        Where to write the kernels (default: current directory)
+//   --entry               Inputs are complete entry scripts (e.g. assets/main.mr)
+//
+// Each engine is compiled and its topology (cylinder, bank, exhaust and intake
+// counts and the per-cylinder exhaust routing) is written out as a C++ file
+// instantiating SpecializedPistonEngineSimulator with those values as
+// constants. Point ENGINE_SIM_KERNEL_DIR at the output directory when
+// configuring and the runtime uses the kernel whenever it loads an engine
+// with the same name, as long as the script hasn't changed since.
+//
+// Engine files are wrapped the same way as in engine-sim-dyno, except that the
+// wrapper is written to a temporary directory so the asset tree is never
+// touched. Two engines whose names map to the same kernel identifier are an
+// error rather than one silently overwriting the other.
+
+#include "../include/engine.h"
+#include "../include/piston_engine_simulator.h"
+#include "../include/transmission.h"
+#include "../include/vehicle.h"
+#include "../scripting/include/compiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::filesystem::path output = ".";
+    bool entry = false;
+    std::vector<std::filesystem::path> inputs;
+};
+
+// Kernel identifier -> script that generated it
+typedef std::map<std::string, std::filesystem::path> KernelMap;
+
+void printUsage() {
+    std::fprintf(stderr,
+        "usage: engine-sim-aot [--output dir] [--entry] <engine.mr | directory>...\n");
+}
+
+bool parseArguments(int argc, char **argv, Options *options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--output" && hasValue) options->output = argv[++i];
+        else if (arg == "--entry") options->entry = true;
+        else if (arg.size() > 1 && arg[0] == '-') return false;
+        else options->inputs.push_back(arg);
+    }
+
+    return !options->inputs.empty();
+}
+
+bool definesMain(const std::filesystem::path &path) {
+    std::ifstream file(path);
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str().find("public node main") != std::string::npos;
+}
+
+void collectScripts(const Options &options, std::vector<std::filesystem::path> *scripts) {
+    namespace fs = std::filesystem;
+
+    for (const fs::path &input : options.inputs) {
+        if (!fs::is_directory(input)) {
+            scripts->push_back(input);
+            continue;
+        }
+
+        std::vector<fs::path> found;
+        for (const fs::directory_entry &entry : fs::recursive_directory_iterator(input)) {
+            if (entry.is_regular_file()
+                && entry.path().extension() == ".mr"
+                && definesMain(entry.path()))
+            {
+                found.push_back(entry.path());
+            }
+        }
+
+        std::sort(found.begin(), found.end());
+        scripts->insert(scripts->end(), found.begin(), found.end());
+    }
+}
+
+// Kernel file stem and registration function suffix
+std::string kernelIdentifier(const std::string &engineName) {
+    std::string id;
+    for (const char c : engineName) {
+        if (std::isalnum(static_cast<unsigned char>(c))) {
+            id += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        else if (!id.empty() && id.back() != '_') {
+            id += '_';
+        }
+    }
+
+    while (!id.empty() && id.back() == '_') id.pop_back();
+    return id;
+}
+
+std::string quoted(const std::string &s) {
+    std::string out = "\"";
+    for (const char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+
+    return out + "\"";
+}
+
+bool writeKernel(
+    Engine *engine,
+    const std::filesystem::path &script,
+    const std::filesystem::path &outputDir,
+    KernelMap *kernels)
+{
+    const std::string id = kernelIdentifier(engine->getName());
+    if (id.empty()) {
+        std::fprintf(stderr, "engine-sim-aot: %s has no engine name\n", script.string().c_str());
+        return false;
+    }
+    else if (engine->getCylinderCount() <= 0) {
+        std::fprintf(stderr, "engine-sim-aot: %s has no cylinders\n", script.string().c_str());
+        return false;
+    }
+
+    const KernelMap::const_iterator existing = kernels->find(id);
+    if (existing != kernels->end()) {
+        std::fprintf(stderr,
+            "engine-sim-aot: %s and %s both generate kernel '%s'; rename one of the engines\n",
+            existing->second.string().c_str(),
+            script.string().c_str(),
+            id.c_str());
+        return false;
+    }
+
+    (*kernels)[id] = script;
+
+    const int cylinderCount = engine->getCylinderCount();
+    std::vector<PistonEngineSimulator::ExhaustRoute> routes(cylinderCount);
+    PistonEngineSimulator::resolveExhaustRoutes(engine, routes.data());
+
+    const std::filesystem::path path = outputDir / (id + ".cpp");
+    std::FILE *file = std::fopen(path.string().c_str(), "w");
+    if (file == nullptr) return false;
+
+    std::fprintf(file,
+        "// Generated by engine-sim-aot from %s.\n"
+        "// Regenerate whenever the engine script changes; a stale kernel is ignored.\n\n"
+        "#include \"engine_kernel_registry.h\"\n"
+        "#include \"specialized_piston_engine_simulator.h\"\n\n"
+        "namespace {\n\n"
+        "struct Layout {\n"
+        "    static constexpr int CylinderCount = %d;\n"
+        "    static constexpr int CylinderBankCount = %d;\n"
+        "    static constexpr int ExhaustSystemCount = %d;\n"
+        "    static constexpr int IntakeCount = %d;\n\n"
+        "    // { channel, tap, gain, delay (s) }\n"
+        "    static constexpr PistonEngineSimulator::ExhaustRoute ExhaustRoutes[CylinderCount] = {\n",
+        script.filename().string().c_str(),
+        cylinderCount,
+        engine->getCylinderBankCount(),
+        engine->getExhaustSystemCount(),
+        engine->getIntakeCount());
+
+    for (int i = 0; i < cylinderCount; ++i) {
+        std::fprintf(file,
+            "        { %d, %d, %.17g, %.17g },\n",
+            routes[i].channel,
+            routes[i].tap,
+            routes[i].gain,
+            routes[i].delay);
+    }
+
+    std::fprintf(file,
+        "    };\n"
+        "};\n\n"
+        "typedef SpecializedPistonEngineSimulator<Layout> KernelSimulator;\n\n"
+        "PistonEngineSimulator *createSimulator() {\n"
+        "    return new KernelSimulator;\n"
+        "}\n\n"
+        "} // namespace\n\n"
+        "void registerEngineKernel_%s() {\n"
+        "    EngineKernelRegistry::Kernel kernel;\n"
+        "    kernel.engineName = %s;\n"
+        "    kernel.matches = &KernelSimulator::matches;\n"
+        "    kernel.create = &createSimulator;\n"
+        "    EngineKernelRegistry::add(kernel);\n"
+        "}\n",
+        id.c_str(),
+        quoted(engine->getName()).c_str());
+
+    const bool written = std::ferror(file) == 0;
+    std::fclose(file);
+
+    std::fprintf(stderr, "engine-sim-aot: %s -> %s\n", engine->getName().c_str(), path.string().c_str());
+    return written;
+}
+
+bool generateKernel(
+    const std::string &scriptPath,
+    const std::filesystem::path &script,
+    const std::filesystem::path &outputDir,
+    KernelMap *kernels)
+{
+    es_script::Compiler compiler;
+    compiler.initialize();
+
+    // The wrapper lives outside the asset tree, so resolve imports as if it
+    // sat next to the engine script
+    for (const std::string &searchPath : es_script::Compiler::getSearchPaths(script.string())) {
+        compiler.addSearchPath(searchPath);
+    }
+
+    if (!compiler.compile(scriptPath.c_str())) {
+        compiler.destroy();
+        return false;
+    }
+
+    const es_script::Compiler::Output output = compiler.execute();
+    compiler.destroy();
+
+    bool result = false;
+    if (output.engine != nullptr) {
+        result = writeKernel(output.engine, script, outputDir, kernels);
+
+        output.engine->destroy();
+        delete output.engine;
+    }
+
+    delete output.vehicle;
+    delete output.transmission;
+
+    return result;
+}
+
+bool createTemporaryDirectory(std::filesystem::path *path) {
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    const fs::path base = fs::temp_directory_path(ec);
+    if (ec) return false;
+
+    std::random_device random;
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "engine_sim_aot_%08x", static_cast<unsigned int>(random()));
+
+        if (fs::create_directory(base / name, ec)) {
+            *path = base / name;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool processScript(
+    const std::filesystem::path &script,
+    const Options &options,
+    const std::filesystem::path &workDir,
+    KernelMap *kernels)
+{
+    namespace fs = std::filesystem;
+
+    if (options.entry) {
+        return generateKernel(script.string(), script, options.output, kernels);
+    }
+
+    const fs::path wrapper = workDir / (".engine_sim_aot_" + script.stem().string() + ".mr");
+    {
+        std::ofstream file(wrapper, std::ios::out);
+        if (!file) return false;
+
+        file << "import \"engine_sim.mr\"\n";
+        file << "import \"" << script.filename().generic_string() << "\"\n\n";
+        file << "main()\n";
+    }
+
+    const bool result = generateKernel(wrapper.string(), script, options.output, kernels);
+
+    std::error_code ec;
+    fs::remove(wrapper, ec);
+
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseArguments(argc, argv, &options)) {
+        printUsage();
+        return 2;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.output, ec);
+
+    std::filesystem::path workDir;
+    if (!options.entry && !createTemporaryDirectory(&workDir)) {
+        std::fprintf(stderr, "engine-sim-aot: could not create a temporary directory\n");
+        return 1;
+    }
+
+    std::vector<std::filesystem::path> scripts;
+    collectScripts(options, &scripts);
+
+    KernelMap kernels;
+    int failures = 0;
+    for (const std::filesystem::path &script : scripts) {
+        if (!processScript(script, options, workDir, &kernels)) {
+            std::fprintf(stderr, "engine-sim-aot: failed to generate a kernel for %s\n", script.string().c_str());
+            ++failures;
+        }
+    }
+
+    if (!workDir.empty()) {
+        std::filesystem::remove_all(workDir, ec);
+    }
+
+    return (failures > 0) ? 1 : 0;
+}
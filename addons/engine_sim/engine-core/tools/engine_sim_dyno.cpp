@@ -0,0 +1,253 @@
+// engine-sim-dyno: headless full-load power curves.
+//
+// Usage:
+//   engine-sim-dyno [options] <engine.mr | directory>...
+//
+// Options:
+//   --format csv|json     Output format (default csv)
+//   --output <path>       Write to a file instead of stdout
+//   --min-rpm <rpm>       Sweep range and step; defaults to the engine's dyno settings
+//   --max-rpm <rpm>
+//   --step-rpm <rpm>
+//   --instances <n>       Parallel simulators per engine (default: hardware threads)
+//   --entry               Inputs are complete entry scripts (e.g. assets/main.mr)
+//
+// Engine files (everything under assets/engines) only define a `main` node, so
+// each one is run through a small generated script placed next to it that
+// imports the engine and calls main(). Directories are searched recursively and
+// files without a public main node are skipped.
+
+#include "../include/engine_sim_runtime_c.h"
+#include "../include/units.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int InitialPointCapacity = 1024;
+
+struct Options {
+    std::string format = "csv";
+    std::string output;
+    double minRpm = 0;
+    double maxRpm = 0;
+    double stepRpm = 0;
+    int instances = 0;
+    bool entry = false;
+    std::vector<std::filesystem::path> inputs;
+};
+
+struct Curve {
+    std::string script;
+    std::vector<es_dyno_point_t> points;
+};
+
+void printUsage() {
+    std::fprintf(stderr,
+        "usage: engine-sim-dyno [--format csv|json] [--output path] [--min-rpm rpm]\n"
+        "                       [--max-rpm rpm] [--step-rpm rpm] [--instances n] [--entry]\n"
+        "                       <engine.mr | directory>...\n");
+}
+
+bool parseArguments(int argc, char **argv, Options *options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--format" && hasValue) options->format = argv[++i];
+        else if (arg == "--output" && hasValue) options->output = argv[++i];
+        else if (arg == "--min-rpm" && hasValue) options->minRpm = std::atof(argv[++i]);
+        else if (arg == "--max-rpm" && hasValue) options->maxRpm = std::atof(argv[++i]);
+        else if (arg == "--step-rpm" && hasValue) options->stepRpm = std::atof(argv[++i]);
+        else if (arg == "--instances" && hasValue) options->instances = std::atoi(argv[++i]);
+        else if (arg == "--entry") options->entry = true;
+        else if (arg.size() > 1 && arg[0] == '-') return false;
+        else options->inputs.push_back(arg);
+    }
+
+    return !options->inputs.empty()
+        && (options->format == "csv" || options->format == "json");
+}
+
+std::string readTextFile(const std::filesystem::path &path) {
+    std::ifstream file(path);
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+bool definesMain(const std::filesystem::path &path) {
+    return readTextFile(path).find("public node main") != std::string::npos;
+}
+
+void collectScripts(const Options &options, std::vector<std::filesystem::path> *scripts) {
+    namespace fs = std::filesystem;
+
+    for (const fs::path &input : options.inputs) {
+        if (!fs::is_directory(input)) {
+            scripts->push_back(input);
+            continue;
+        }
+
+        std::vector<fs::path> found;
+        for (const fs::directory_entry &entry : fs::recursive_directory_iterator(input)) {
+            if (entry.is_regular_file()
+                && entry.path().extension() == ".mr"
+                && definesMain(entry.path()))
+            {
+                found.push_back(entry.path());
+            }
+        }
+
+        std::sort(found.begin(), found.end());
+        scripts->insert(scripts->end(), found.begin(), found.end());
+    }
+}
+
+bool runSweep(const std::string &scriptPath, const Options &options, std::vector<es_dyno_point_t> *points) {
+    // Enough for any stock dyno step; only a very fine --step-rpm needs a second pass
+    points->resize(InitialPointCapacity);
+
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        const int count = es_runtime_dyno_sweep(
+            scriptPath.c_str(),
+            options.minRpm,
+            options.maxRpm,
+            options.stepRpm,
+            options.instances,
+            points->data(),
+            static_cast<int>(points->size()));
+        if (count < 0) return false;
+
+        const bool complete = count <= static_cast<int>(points->size());
+        points->resize(count);
+        if (complete) return true;
+    }
+
+    return false;
+}
+
+bool sweepScript(const std::filesystem::path &script, const Options &options, Curve *curve) {
+    namespace fs = std::filesystem;
+
+    curve->script = script.generic_string();
+    if (options.entry) {
+        return runSweep(script.string(), options, &curve->points);
+    }
+
+    const fs::path wrapper =
+        script.parent_path() / (".engine_sim_dyno_" + script.stem().string() + ".mr");
+    {
+        std::ofstream file(wrapper, std::ios::out);
+        if (!file) return false;
+
+        file << "import \"engine_sim.mr\"\n";
+        file << "import \"" << script.filename().generic_string() << "\"\n\n";
+        file << "main()\n";
+    }
+
+    const bool result = runSweep(wrapper.string(), options, &curve->points);
+
+    std::error_code ec;
+    fs::remove(wrapper, ec);
+
+    return result;
+}
+
+std::string escapeJson(const std::string &s) {
+    std::string result;
+    for (const char c : s) {
+        if (c == '"' || c == '\\') result.push_back('\\');
+        result.push_back(c);
+    }
+
+    return result;
+}
+
+void writeCsv(std::FILE *out, const std::vector<Curve> &curves) {
+    std::fprintf(out, "script,rpm,torque_nm,torque_ft_lb,power_kw,power_hp,settled\n");
+    for (const Curve &curve : curves) {
+        for (const es_dyno_point_t &point : curve.points) {
+            std::fprintf(out, "%s,%.0f,%.3f,%.3f,%.3f,%.3f,%d\n",
+                curve.script.c_str(),
+                point.rpm,
+                point.torque_nm,
+                units::convert(point.torque_nm, units::ft_lb),
+                units::convert(point.power_w, units::kW),
+                units::convert(point.power_w, units::hp),
+                point.settled ? 1 : 0);
+        }
+    }
+}
+
+void writeJson(std::FILE *out, const std::vector<Curve> &curves) {
+    std::fprintf(out, "[\n");
+    for (size_t i = 0; i < curves.size(); ++i) {
+        const Curve &curve = curves[i];
+        std::fprintf(out, "  {\n    \"script\": \"%s\",\n    \"points\": [\n",
+            escapeJson(curve.script).c_str());
+
+        for (size_t j = 0; j < curve.points.size(); ++j) {
+            const es_dyno_point_t &point = curve.points[j];
+            std::fprintf(out,
+                "      { \"rpm\": %.0f, \"torque_nm\": %.3f, \"power_kw\": %.3f, \"settled\": %s }%s\n",
+                point.rpm,
+                point.torque_nm,
+                units::convert(point.power_w, units::kW),
+                point.settled ? "true" : "false",
+                (j + 1 < curve.points.size()) ? "," : "");
+        }
+
+        std::fprintf(out, "    ]\n  }%s\n", (i + 1 < curves.size()) ? "," : "");
+    }
+    std::fprintf(out, "]\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseArguments(argc, argv, &options)) {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<std::filesystem::path> scripts;
+    collectScripts(options, &scripts);
+
+    std::vector<Curve> curves;
+    int failures = 0;
+    for (const std::filesystem::path &script : scripts) {
+        Curve curve;
+        if (!sweepScript(script, options, &curve)) {
+            std::fprintf(stderr, "engine-sim-dyno: failed to sweep %s\n", script.string().c_str());
+            ++failures;
+            continue;
+        }
+
+        curves.push_back(curve);
+    }
+
+    std::FILE *out = stdout;
+    if (!options.output.empty()) {
+        out = std::fopen(options.output.c_str(), "w");
+        if (out == nullptr) {
+            std::fprintf(stderr, "engine-sim-dyno: can't open %s\n", options.output.c_str());
+            return 1;
+        }
+    }
+
+    if (options.format == "json") writeJson(out, curves);
+    else writeCsv(out, curves);
+
+    if (out != stdout) std::fclose(out);
+
+    return (failures > 0) ? 1 : 0;
+}
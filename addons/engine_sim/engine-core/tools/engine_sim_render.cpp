@@ -0,0 +1,250 @@
+// engine-sim-render: faster than real-time engine audio previews.
+//
+// Usage:
+//   engine-sim-render [options] <engine.mr | directory>...
+//
+// Options:
+//   --duration <s>        Length of each render (default: end of the track)
+//   --track <path>        Control track CSV (default: start, idle, rev, idle)
+//   --output-dir <path>   Where to write <script>.wav (default: next to the script)
+//   --entry               Inputs are complete entry scripts (e.g. assets/main.mr)
+//
+// Control track rows are `time,speed_control,starter,ignition,gear,clutch`;
+// blank lines, comments (#) and a header row are ignored. Speed control is
+// interpolated between rows, the other columns hold until the next row.
+//
+// Engine files are wrapped the same way as in engine-sim-dyno.
+
+#include "../include/engine_sim_runtime_c.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    double duration = 0.0;
+    std::string track;
+    std::filesystem::path outputDir;
+    bool entry = false;
+    std::vector<std::filesystem::path> inputs;
+};
+
+void printUsage() {
+    std::fprintf(stderr,
+        "usage: engine-sim-render [--duration s] [--track path] [--output-dir path] [--entry]\n"
+        "                         <engine.mr | directory>...\n");
+}
+
+bool parseArguments(int argc, char **argv, Options *options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--duration" && hasValue) options->duration = std::atof(argv[++i]);
+        else if (arg == "--track" && hasValue) options->track = argv[++i];
+        else if (arg == "--output-dir" && hasValue) options->outputDir = argv[++i];
+        else if (arg == "--entry") options->entry = true;
+        else if (arg.size() > 1 && arg[0] == '-') return false;
+        else options->inputs.push_back(arg);
+    }
+
+    return !options->inputs.empty();
+}
+
+es_control_point_t controlPoint(double time, double speedControl, bool starter) {
+    es_control_point_t point;
+    point.time = time;
+    point.speed_control = speedControl;
+    point.starter_enabled = starter;
+    point.ignition_enabled = true;
+    point.gear = -1;
+    point.clutch_pressure = 1.0;
+
+    return point;
+}
+
+void defaultTrack(std::vector<es_control_point_t> *track) {
+    track->push_back(controlPoint(0.0, 0.0, true));
+    track->push_back(controlPoint(1.5, 0.0, false));
+    track->push_back(controlPoint(3.0, 0.0, false));
+    track->push_back(controlPoint(4.5, 1.0, false));
+    track->push_back(controlPoint(5.5, 1.0, false));
+    track->push_back(controlPoint(5.6, 0.0, false));
+    track->push_back(controlPoint(8.0, 0.0, false));
+}
+
+bool readTrack(const std::string &path, std::vector<es_control_point_t> *track) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] == '#') continue;
+        if (!std::isdigit(static_cast<unsigned char>(line[start])) && line[start] != '.') continue;
+
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream ss(line);
+
+        es_control_point_t point = controlPoint(0.0, 0.0, false);
+        int starter = 0, ignition = 1;
+        ss >> point.time >> point.speed_control >> starter >> ignition >> point.gear >> point.clutch_pressure;
+        if (ss.fail() && !ss.eof()) return false;
+
+        point.starter_enabled = starter != 0;
+        point.ignition_enabled = ignition != 0;
+        track->push_back(point);
+    }
+
+    std::stable_sort(track->begin(), track->end(),
+        [](const es_control_point_t &a, const es_control_point_t &b) { return a.time < b.time; });
+
+    return !track->empty();
+}
+
+bool definesMain(const std::filesystem::path &path) {
+    std::ifstream file(path);
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str().find("public node main") != std::string::npos;
+}
+
+void collectScripts(const Options &options, std::vector<std::filesystem::path> *scripts) {
+    namespace fs = std::filesystem;
+
+    for (const fs::path &input : options.inputs) {
+        if (!fs::is_directory(input)) {
+            scripts->push_back(input);
+            continue;
+        }
+
+        std::vector<fs::path> found;
+        for (const fs::directory_entry &entry : fs::recursive_directory_iterator(input)) {
+            if (entry.is_regular_file()
+                && entry.path().extension() == ".mr"
+                && definesMain(entry.path()))
+            {
+                found.push_back(entry.path());
+            }
+        }
+
+        std::sort(found.begin(), found.end());
+        scripts->insert(scripts->end(), found.begin(), found.end());
+    }
+}
+
+bool renderScript(
+    const std::string &scriptPath,
+    const std::filesystem::path &wavPath,
+    const std::vector<es_control_point_t> &track,
+    double duration)
+{
+    es_runtime_t *rt = es_runtime_create();
+    if (!es_runtime_load_script(rt, scriptPath.c_str())) {
+        es_runtime_destroy(rt);
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const bool result = es_runtime_render_offline(
+        rt,
+        track.data(),
+        static_cast<int>(track.size()),
+        duration,
+        wavPath.string().c_str());
+    const double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (result) {
+        std::fprintf(stderr, "engine-sim-render: %s (%.1fs audio in %.1fs)\n",
+            wavPath.string().c_str(), duration, elapsed);
+    }
+
+    es_runtime_destroy(rt);
+    return result;
+}
+
+bool processScript(
+    const std::filesystem::path &script,
+    const Options &options,
+    const std::vector<es_control_point_t> &track,
+    double duration)
+{
+    namespace fs = std::filesystem;
+
+    const fs::path outputDir = options.outputDir.empty() ? script.parent_path() : options.outputDir;
+    const fs::path wavPath = outputDir / (script.stem().string() + ".wav");
+    if (options.entry) {
+        return renderScript(script.string(), wavPath, track, duration);
+    }
+
+    const fs::path wrapper =
+        script.parent_path() / (".engine_sim_render_" + script.stem().string() + ".mr");
+    {
+        std::ofstream file(wrapper, std::ios::out);
+        if (!file) return false;
+
+        file << "import \"engine_sim.mr\"\n";
+        file << "import \"" << script.filename().generic_string() << "\"\n\n";
+        file << "main()\n";
+    }
+
+    const bool result = renderScript(wrapper.string(), wavPath, track, duration);
+
+    std::error_code ec;
+    fs::remove(wrapper, ec);
+
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseArguments(argc, argv, &options)) {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<es_control_point_t> track;
+    if (options.track.empty()) {
+        defaultTrack(&track);
+    }
+    else if (!readTrack(options.track, &track)) {
+        std::fprintf(stderr, "engine-sim-render: can't read control track %s\n", options.track.c_str());
+        return 1;
+    }
+
+    const double duration = (options.duration > 0) ? options.duration : track.back().time;
+    if (duration <= 0) {
+        std::fprintf(stderr, "engine-sim-render: nothing to render, pass --duration\n");
+        return 1;
+    }
+
+    if (!options.outputDir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(options.outputDir, ec);
+    }
+
+    std::vector<std::filesystem::path> scripts;
+    collectScripts(options, &scripts);
+
+    int failures = 0;
+    for (const std::filesystem::path &script : scripts) {
+        if (!processScript(script, options, track, duration)) {
+            std::fprintf(stderr, "engine-sim-render: failed to render %s\n", script.string().c_str());
+            ++failures;
+        }
+    }
+
+    return (failures > 0) ? 1 : 0;
+}
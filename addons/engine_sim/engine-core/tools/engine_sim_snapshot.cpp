@@ -0,0 +1,194 @@
+// engine-sim-snapshot: generates idle snapshots used to warm start engines.
+//
+// Usage:
+//   engine-sim-snapshot [options] <engine.mr | directory>...
+//
+// Options:
+//   --crank-time <s>      Time spent on the starter (default 2)
+//   --idle-time <s>       Time left to settle at idle afterwards (default 4)
+//   --entry               Inputs are complete entry scripts (e.g. assets/main.mr)
+//
+// Each engine is cranked, left to settle at idle with the audio drained as a
+// game would, and saved as `<script>.idle.state` next to the script. Runtimes
+// that load the same script can then restore it with es_runtime_load_state()
+// instead of cranking and pre-filling the audio buffer themselves.
+//
+// Engine files are wrapped the same way as in engine-sim-dyno.
+
+#include "../include/engine_sim_runtime_c.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr double FrameTime = 1 / 60.0;
+constexpr int AudioSampleRate = 44100;
+constexpr double MinimumIdleRpm = 200.0;
+
+struct Options {
+    double crankTime = 2.0;
+    double idleTime = 4.0;
+    bool entry = false;
+    std::vector<std::filesystem::path> inputs;
+};
+
+void printUsage() {
+    std::fprintf(stderr,
+        "usage: engine-sim-snapshot [--crank-time s] [--idle-time s] [--entry]\n"
+        "                           <engine.mr | directory>...\n");
+}
+
+bool parseArguments(int argc, char **argv, Options *options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--crank-time" && hasValue) options->crankTime = std::atof(argv[++i]);
+        else if (arg == "--idle-time" && hasValue) options->idleTime = std::atof(argv[++i]);
+        else if (arg == "--entry") options->entry = true;
+        else if (arg.size() > 1 && arg[0] == '-') return false;
+        else options->inputs.push_back(arg);
+    }
+
+    return !options->inputs.empty();
+}
+
+bool definesMain(const std::filesystem::path &path) {
+    std::ifstream file(path);
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return ss.str().find("public node main") != std::string::npos;
+}
+
+void collectScripts(const Options &options, std::vector<std::filesystem::path> *scripts) {
+    namespace fs = std::filesystem;
+
+    for (const fs::path &input : options.inputs) {
+        if (!fs::is_directory(input)) {
+            scripts->push_back(input);
+            continue;
+        }
+
+        std::vector<fs::path> found;
+        for (const fs::directory_entry &entry : fs::recursive_directory_iterator(input)) {
+            if (entry.is_regular_file()
+                && entry.path().extension() == ".mr"
+                && definesMain(entry.path()))
+            {
+                found.push_back(entry.path());
+            }
+        }
+
+        std::sort(found.begin(), found.end());
+        scripts->insert(scripts->end(), found.begin(), found.end());
+    }
+}
+
+// Runs frames in real time so that the audio thread keeps up with the simulation
+void runFor(es_runtime_t *rt, double seconds, std::vector<int16_t> *audio) {
+    const auto frameDuration = std::chrono::duration<double>(FrameTime);
+    const int frames = static_cast<int>(seconds / FrameTime);
+    const int samplesPerFrame = static_cast<int>(AudioSampleRate * FrameTime);
+
+    for (int i = 0; i < frames; ++i) {
+        const auto frameStart = std::chrono::steady_clock::now();
+
+        es_runtime_start_frame(rt, FrameTime);
+        while (es_runtime_simulate_step(rt)) {}
+        es_runtime_end_frame(rt);
+
+        es_runtime_read_audio(rt, samplesPerFrame, audio->data());
+
+        std::this_thread::sleep_until(frameStart + frameDuration);
+    }
+}
+
+bool snapshotScript(const std::string &scriptPath, const std::filesystem::path &statePath, const Options &options) {
+    es_runtime_t *rt = es_runtime_create();
+    if (!es_runtime_load_script(rt, scriptPath.c_str())) {
+        es_runtime_destroy(rt);
+        return false;
+    }
+
+    std::vector<int16_t> audio(static_cast<size_t>(AudioSampleRate * FrameTime) + 1);
+
+    es_runtime_set_speed_control(rt, 0.0);
+    es_runtime_set_ignition_enabled(rt, true);
+    es_runtime_set_starter_enabled(rt, true);
+    runFor(rt, options.crankTime, &audio);
+
+    es_runtime_set_starter_enabled(rt, false);
+    runFor(rt, options.idleTime, &audio);
+
+    const double rpm = es_runtime_get_engine_speed(rt);
+    bool result = false;
+    if (rpm < MinimumIdleRpm) {
+        std::fprintf(stderr, "engine-sim-snapshot: %s didn't start (%.0f rpm)\n", scriptPath.c_str(), rpm);
+    }
+    else {
+        result = es_runtime_save_state(rt, statePath.string().c_str());
+        std::fprintf(stderr, "engine-sim-snapshot: %s idling at %.0f rpm\n", statePath.string().c_str(), rpm);
+    }
+
+    es_runtime_destroy(rt);
+    return result;
+}
+
+bool processScript(const std::filesystem::path &script, const Options &options) {
+    namespace fs = std::filesystem;
+
+    const fs::path statePath = script.parent_path() / (script.stem().string() + ".idle.state");
+    if (options.entry) {
+        return snapshotScript(script.string(), statePath, options);
+    }
+
+    const fs::path wrapper =
+        script.parent_path() / (".engine_sim_snapshot_" + script.stem().string() + ".mr");
+    {
+        std::ofstream file(wrapper, std::ios::out);
+        if (!file) return false;
+
+        file << "import \"engine_sim.mr\"\n";
+        file << "import \"" << script.filename().generic_string() << "\"\n\n";
+        file << "main()\n";
+    }
+
+    const bool result = snapshotScript(wrapper.string(), statePath, options);
+
+    std::error_code ec;
+    fs::remove(wrapper, ec);
+
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseArguments(argc, argv, &options)) {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<std::filesystem::path> scripts;
+    collectScripts(options, &scripts);
+
+    int failures = 0;
+    for (const std::filesystem::path &script : scripts) {
+        if (!processScript(script, options)) {
+            std::fprintf(stderr, "engine-sim-snapshot: failed to snapshot %s\n", script.string().c_str());
+            ++failures;
+        }
+    }
+
+    return (failures > 0) ? 1 : 0;
+}
@@ -3,8 +3,12 @@
 #include <godot_cpp/classes/audio_stream_generator.hpp>
 #include <godot_cpp/classes/audio_stream_generator_playback.hpp>
 #include <godot_cpp/classes/audio_stream_player.hpp>
+#include <godot_cpp/classes/audio_stream_player3d.hpp>
 #include <godot_cpp/classes/audio_stream_playback.hpp>
+#include <godot_cpp/classes/camera3d.hpp>
+#include <godot_cpp/classes/file_access.hpp>
 #include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/classes/viewport.hpp>
 #include <godot_cpp/core/object.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
@@ -35,7 +39,15 @@ EngineSimRuntime::EngineSimRuntime() {
 }
 
 EngineSimRuntime::~EngineSimRuntime() {
+    for (const Preload &preload : m_preloads) {
+        es_load_release(preload.load);
+    }
+    m_preloads.clear();
+
     if (m_rt != nullptr) {
+        // Nothing may step the simulation once its audio thread is gone
+        es_runtime_set_simulation_thread_enabled(m_rt, false);
+
         es_runtime_mirror_t *mirror = reinterpret_cast<es_runtime_mirror_t *>(m_rt);
         if (mirror && mirror->simulator) {
             mirror->simulator->endAudioRenderingThread();
@@ -63,8 +75,20 @@ AudioStreamPlayer *EngineSimRuntime::get_audio_player() const {
     return Object::cast_to<AudioStreamPlayer>(obj);
 }
 
+AudioStreamPlayer3D *EngineSimRuntime::get_audio_player_3d() const {
+    if (m_audio_player_3d_path.is_empty() || !is_inside_tree()) {
+        return nullptr;
+    }
+    return Object::cast_to<AudioStreamPlayer3D>(get_node_or_null(m_audio_player_3d_path));
+}
+
 void EngineSimRuntime::_bind_methods() {
     ClassDB::bind_method(D_METHOD("load_mr_script", "path"), &EngineSimRuntime::load_mr_script);
+    ClassDB::bind_method(D_METHOD("load_engine_pack", "path"), &EngineSimRuntime::load_engine_pack);
+    ClassDB::bind_method(D_METHOD("preload_mr_script", "path"), &EngineSimRuntime::preload_mr_script);
+    ClassDB::bind_method(D_METHOD("is_preload_ready", "path"), &EngineSimRuntime::is_preload_ready);
+    ClassDB::bind_method(D_METHOD("swap_to_preloaded", "path", "crossfade_seconds"), &EngineSimRuntime::swap_to_preloaded, DEFVAL(0.25));
+    ClassDB::bind_method(D_METHOD("cancel_preload", "path"), &EngineSimRuntime::cancel_preload);
     ClassDB::bind_method(D_METHOD("set_speed_control", "speed_control_0_to_1"), &EngineSimRuntime::set_speed_control);
     ClassDB::bind_method(D_METHOD("set_throttle", "throttle_0_to_1"), &EngineSimRuntime::set_throttle);
     ClassDB::bind_method(D_METHOD("get_throttle"), &EngineSimRuntime::get_throttle);
@@ -78,6 +102,15 @@ void EngineSimRuntime::_bind_methods() {
     ClassDB::bind_method(D_METHOD("set_clutch_pressure", "pressure_0_to_1"), &EngineSimRuntime::set_clutch_pressure);
     ClassDB::bind_method(D_METHOD("get_clutch_pressure"), &EngineSimRuntime::get_clutch_pressure);
 
+    ClassDB::bind_method(D_METHOD("save_state", "path"), &EngineSimRuntime::save_state);
+    ClassDB::bind_method(D_METHOD("load_state", "path"), &EngineSimRuntime::load_state);
+    ClassDB::bind_method(D_METHOD("set_warm_start_enabled", "enabled"), &EngineSimRuntime::set_warm_start_enabled);
+    ClassDB::bind_method(D_METHOD("is_warm_start_enabled"), &EngineSimRuntime::is_warm_start_enabled);
+    ClassDB::bind_method(D_METHOD("set_reduced_kinematics", "enabled"), &EngineSimRuntime::set_reduced_kinematics);
+    ClassDB::bind_method(D_METHOD("is_reduced_kinematics"), &EngineSimRuntime::is_reduced_kinematics);
+    ClassDB::bind_method(D_METHOD("set_simulation_thread_enabled", "enabled"), &EngineSimRuntime::set_simulation_thread_enabled);
+    ClassDB::bind_method(D_METHOD("is_simulation_thread_enabled"), &EngineSimRuntime::is_simulation_thread_enabled);
+
     ClassDB::bind_method(D_METHOD("start_audio", "mix_rate", "buffer_length"), &EngineSimRuntime::start_audio);
     ClassDB::bind_method(D_METHOD("stop_audio"), &EngineSimRuntime::stop_audio);
     ClassDB::bind_method(D_METHOD("is_audio_running"), &EngineSimRuntime::is_audio_running);
@@ -97,6 +130,33 @@ void EngineSimRuntime::_bind_methods() {
 
     ClassDB::bind_method(D_METHOD("set_simulation_speed", "speed"), &EngineSimRuntime::set_simulation_speed);
     ClassDB::bind_method(D_METHOD("get_simulation_speed"), &EngineSimRuntime::get_simulation_speed);
+    ClassDB::bind_method(D_METHOD("set_mechanical_step_divisor", "divisor"), &EngineSimRuntime::set_mechanical_step_divisor);
+    ClassDB::bind_method(D_METHOD("get_mechanical_step_divisor"), &EngineSimRuntime::get_mechanical_step_divisor);
+
+    ClassDB::bind_method(D_METHOD("set_quality_tier", "tier"), &EngineSimRuntime::set_quality_tier);
+    ClassDB::bind_method(D_METHOD("get_quality_tier"), &EngineSimRuntime::get_quality_tier);
+    ClassDB::bind_method(D_METHOD("get_solver_stats"), &EngineSimRuntime::get_solver_stats);
+    ClassDB::bind_method(D_METHOD("get_memory_usage"), &EngineSimRuntime::get_memory_usage);
+    ClassDB::bind_method(D_METHOD("get_telemetry", "include_cylinders"), &EngineSimRuntime::get_telemetry, DEFVAL(false));
+    ClassDB::bind_method(D_METHOD("set_audio_player_3d_path", "path"), &EngineSimRuntime::set_audio_player_3d_path);
+    ClassDB::bind_method(D_METHOD("get_audio_player_3d_path"), &EngineSimRuntime::get_audio_player_3d_path);
+    ClassDB::bind_method(D_METHOD("set_distance_lod_enabled", "enabled"), &EngineSimRuntime::set_distance_lod_enabled);
+    ClassDB::bind_method(D_METHOD("is_distance_lod_enabled"), &EngineSimRuntime::is_distance_lod_enabled);
+    ClassDB::bind_method(D_METHOD("set_lod_distances", "distances"), &EngineSimRuntime::set_lod_distances);
+    ClassDB::bind_method(D_METHOD("get_lod_distances"), &EngineSimRuntime::get_lod_distances);
+
+    BIND_CONSTANT(TELEMETRY_FRAME);
+    BIND_CONSTANT(TELEMETRY_ENGINE_SPEED);
+    BIND_CONSTANT(TELEMETRY_ENGINE_SPEED_RAW);
+    BIND_CONSTANT(TELEMETRY_THROTTLE);
+    BIND_CONSTANT(TELEMETRY_CLUTCH_PRESSURE);
+    BIND_CONSTANT(TELEMETRY_GEAR);
+    BIND_CONSTANT(TELEMETRY_MANIFOLD_PRESSURE);
+    BIND_CONSTANT(TELEMETRY_INTAKE_AFR);
+    BIND_CONSTANT(TELEMETRY_DYNO_TORQUE);
+    BIND_CONSTANT(TELEMETRY_VEHICLE_SPEED);
+    BIND_CONSTANT(TELEMETRY_CYLINDER_COUNT);
+    BIND_CONSTANT(TELEMETRY_CYLINDERS);
 }
 
 void EngineSimRuntime::set_max_sim_steps_per_frame(int steps) {
@@ -121,6 +181,130 @@ double EngineSimRuntime::get_simulation_speed() const {
     return es_runtime_get_simulation_speed(m_rt);
 }
 
+void EngineSimRuntime::set_mechanical_step_divisor(int divisor) {
+    if (m_rt == nullptr) {
+        return;
+    }
+    es_runtime_set_mechanical_step_divisor(m_rt, divisor);
+}
+
+int EngineSimRuntime::get_mechanical_step_divisor() const {
+    if (m_rt == nullptr) {
+        return 1;
+    }
+    return es_runtime_get_mechanical_step_divisor(m_rt);
+}
+
+void EngineSimRuntime::set_quality_tier(int tier) {
+    if (m_rt == nullptr) {
+        return;
+    }
+    m_lod_tier = CLAMP(tier, 0, 3);
+    es_runtime_set_quality_tier(m_rt, static_cast<es_quality_tier_t>(m_lod_tier));
+}
+
+int EngineSimRuntime::get_quality_tier() const {
+    if (m_rt == nullptr) {
+        return 0;
+    }
+    return static_cast<int>(es_runtime_get_quality_tier(m_rt));
+}
+
+Dictionary EngineSimRuntime::get_solver_stats() const {
+    Dictionary result;
+
+    es_solver_stats_t stats;
+    if (!es_runtime_get_solver_stats(m_rt, &stats)) {
+        return result;
+    }
+
+    result["last_iterations"] = stats.last_iterations;
+    result["last_residual"] = stats.last_residual;
+    result["frame_steps"] = stats.frame_steps;
+    result["frame_mean_iterations"] = stats.frame_mean_iterations;
+    result["frame_max_iterations"] = stats.frame_max_iterations;
+    result["frame_max_residual"] = stats.frame_max_residual;
+    result["frame_unconverged_steps"] = stats.frame_unconverged_steps;
+
+    return result;
+}
+
+Dictionary EngineSimRuntime::get_memory_usage() const {
+    Dictionary result;
+
+    es_memory_usage_t usage;
+    if (!es_runtime_get_memory_usage(m_rt, &usage)) {
+        return result;
+    }
+
+    result["engine_bytes"] = static_cast<int64_t>(usage.engine_bytes);
+    result["simulation_bytes"] = static_cast<int64_t>(usage.simulation_bytes);
+    result["synthesizer_bytes"] = static_cast<int64_t>(usage.synthesizer_bytes);
+    result["arena_used_bytes"] = static_cast<int64_t>(usage.arena_used_bytes);
+    result["arena_reserved_bytes"] = static_cast<int64_t>(usage.arena_reserved_bytes);
+
+    return result;
+}
+
+PackedFloat64Array EngineSimRuntime::get_telemetry(bool include_cylinders) const {
+    PackedFloat64Array result;
+
+    es_telemetry_t telemetry;
+    telemetry.size = sizeof(es_telemetry_t);
+    if (!es_runtime_get_telemetry(m_rt, &telemetry, include_cylinders ? ES_TELEMETRY_CYLINDERS : 0)) {
+        return result;
+    }
+
+    const int cylinders = telemetry.cylinder_count;
+    result.resize(TELEMETRY_CYLINDERS + 2 * cylinders);
+
+    double *data = result.ptrw();
+    data[TELEMETRY_FRAME] = static_cast<double>(telemetry.frame);
+    data[TELEMETRY_ENGINE_SPEED] = telemetry.engine_speed_rpm;
+    data[TELEMETRY_ENGINE_SPEED_RAW] = telemetry.engine_speed_raw_rpm;
+    data[TELEMETRY_THROTTLE] = telemetry.throttle;
+    data[TELEMETRY_CLUTCH_PRESSURE] = telemetry.clutch_pressure;
+    data[TELEMETRY_GEAR] = telemetry.gear;
+    data[TELEMETRY_MANIFOLD_PRESSURE] = telemetry.manifold_pressure_pa;
+    data[TELEMETRY_INTAKE_AFR] = telemetry.intake_afr;
+    data[TELEMETRY_DYNO_TORQUE] = telemetry.dyno_torque_nm;
+    data[TELEMETRY_VEHICLE_SPEED] = telemetry.vehicle_speed_mps;
+    data[TELEMETRY_CYLINDER_COUNT] = cylinders;
+    for (int i = 0; i < cylinders; ++i) {
+        data[TELEMETRY_CYLINDERS + i] = telemetry.cylinder_pressure_pa[i];
+        data[TELEMETRY_CYLINDERS + cylinders + i] = telemetry.cylinder_temperature_k[i];
+    }
+
+    return result;
+}
+
+void EngineSimRuntime::set_audio_player_3d_path(const NodePath &path) {
+    m_audio_player_3d_path = path;
+}
+
+NodePath EngineSimRuntime::get_audio_player_3d_path() const {
+    return m_audio_player_3d_path;
+}
+
+void EngineSimRuntime::set_distance_lod_enabled(bool enabled) {
+    m_distance_lod_enabled = enabled;
+    if (!enabled) {
+        set_quality_tier(0);
+    }
+}
+
+bool EngineSimRuntime::is_distance_lod_enabled() const {
+    return m_distance_lod_enabled;
+}
+
+void EngineSimRuntime::set_lod_distances(const Vector3 &distances) {
+    m_lod_distances = distances;
+}
+
+Vector3 EngineSimRuntime::get_lod_distances() const {
+    return m_lod_distances;
+}
+
 void EngineSimRuntime::set_audio_debug_enabled(bool enabled) {
     m_audio_debug_enabled = enabled;
     m_audio_debug_accum_s = 0.0;
@@ -147,15 +331,110 @@ bool EngineSimRuntime::load_mr_script(const String &path) {
     const String abs_path = ProjectSettings::get_singleton()->globalize_path(path);
     const CharString utf8 = abs_path.utf8();
 
-    const bool ok = es_runtime_load_script(m_rt, utf8.get_data());
+    return finish_load(path, es_runtime_load_script(m_rt, utf8.get_data()));
+}
+
+bool EngineSimRuntime::load_engine_pack(const String &path) {
+    if (m_rt == nullptr) {
+        return false;
+    }
+
+    const String abs_path = ProjectSettings::get_singleton()->globalize_path(path);
+    const CharString utf8 = abs_path.utf8();
+
+    return finish_load(path, es_runtime_load_pack(m_rt, utf8.get_data()));
+}
+
+bool EngineSimRuntime::preload_mr_script(const String &path) {
+    if (m_rt == nullptr) {
+        return false;
+    }
+
+    if (find_preload(path) >= 0) {
+        return true;
+    }
+
+    const String abs_path = ProjectSettings::get_singleton()->globalize_path(path);
+    const CharString utf8 = abs_path.utf8();
+
+    Preload preload;
+    preload.path = path;
+    preload.load = es_runtime_load_script_async(m_rt, utf8.get_data());
+    if (preload.load == nullptr) {
+        UtilityFunctions::printerr(String("engine-sim: failed to start loading: ") + abs_path);
+        return false;
+    }
+
+    m_preloads.push_back(preload);
+    return true;
+}
+
+bool EngineSimRuntime::is_preload_ready(const String &path) const {
+    const int index = find_preload(path);
+    return index >= 0 && es_load_get_status(m_preloads[index].load) != ES_LOAD_PENDING;
+}
+
+bool EngineSimRuntime::swap_to_preloaded(const String &path, double crossfade_seconds) {
+    const int index = find_preload(path);
+    if (m_rt == nullptr || index < 0) {
+        return false;
+    }
+
+    es_load_t *load = m_preloads[index].load;
+    m_preloads.erase(m_preloads.begin() + index);
+
+    // Blocks if the load is still running. Audio is read on this thread too
+    // (pump_audio), so the swap can't race it.
+    const bool swapped = es_runtime_swap_load(m_rt, load, crossfade_seconds);
+    es_load_release(load);
+
+    if (!swapped) {
+        UtilityFunctions::printerr(String("engine-sim: failed to load: ") + ProjectSettings::get_singleton()->globalize_path(path));
+        return false;
+    }
+
+    return finish_load(path, swapped);
+}
+
+void EngineSimRuntime::cancel_preload(const String &path) {
+    const int index = find_preload(path);
+    if (index < 0) {
+        return;
+    }
+
+    es_load_release(m_preloads[index].load);
+    m_preloads.erase(m_preloads.begin() + index);
+}
+
+int EngineSimRuntime::find_preload(const String &path) const {
+    for (int i = 0; i < static_cast<int>(m_preloads.size()); ++i) {
+        if (m_preloads[i].path == path) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+bool EngineSimRuntime::finish_load(const String &path, bool ok) {
     m_loaded = ok && es_runtime_has_simulation(m_rt);
+    m_warm_started = false;
+
+    // A frame split across _physics_process calls belonged to the old engine
+    m_sim_frame_active = false;
 
     if (!m_loaded) {
-        UtilityFunctions::printerr(String("engine-sim: failed to load script: ") + abs_path);
+        UtilityFunctions::printerr(String("engine-sim: failed to load: ") + ProjectSettings::get_singleton()->globalize_path(path));
         return false;
     }
 
-    // Audio rendering thread is already started by es_runtime_load_script()
+    // Idle snapshot generated by engine-sim-snapshot
+    const String idle_state_path = path.get_basename() + ".idle.state";
+    if (m_warm_start_enabled && FileAccess::file_exists(idle_state_path)) {
+        m_warm_started = load_state(idle_state_path);
+    }
+
+    // Audio rendering thread is already started by the runtime's load call
     // No need to start it again here
 
     return m_loaded;
@@ -236,6 +515,57 @@ double EngineSimRuntime::get_clutch_pressure() const {
     return es_runtime_get_clutch_pressure(m_rt);
 }
 
+bool EngineSimRuntime::save_state(const String &path) {
+    if (m_rt == nullptr || !m_loaded) {
+        return false;
+    }
+
+    const CharString utf8 = ProjectSettings::get_singleton()->globalize_path(path).utf8();
+    return es_runtime_save_state(m_rt, utf8.get_data());
+}
+
+bool EngineSimRuntime::load_state(const String &path) {
+    if (m_rt == nullptr || !m_loaded) {
+        return false;
+    }
+
+    const CharString utf8 = ProjectSettings::get_singleton()->globalize_path(path).utf8();
+    return es_runtime_load_state(m_rt, utf8.get_data());
+}
+
+void EngineSimRuntime::set_warm_start_enabled(bool enabled) {
+    m_warm_start_enabled = enabled;
+}
+
+bool EngineSimRuntime::is_warm_start_enabled() const {
+    return m_warm_start_enabled;
+}
+
+void EngineSimRuntime::set_reduced_kinematics(bool enabled) {
+    m_reduced_kinematics = enabled;
+    es_runtime_set_reduced_kinematics(m_rt, enabled);
+}
+
+bool EngineSimRuntime::is_reduced_kinematics() const {
+    return m_reduced_kinematics;
+}
+
+void EngineSimRuntime::set_simulation_thread_enabled(bool enabled) {
+    if (m_rt == nullptr) {
+        return;
+    }
+
+    // A frame split across _physics_process calls is abandoned either way
+    m_sim_frame_active = false;
+    m_sim_accumulated_delta = 0.0;
+
+    es_runtime_set_simulation_thread_enabled(m_rt, enabled);
+}
+
+bool EngineSimRuntime::is_simulation_thread_enabled() const {
+    return m_rt != nullptr && es_runtime_is_simulation_thread_enabled(m_rt);
+}
+
 void EngineSimRuntime::start_audio(double mix_rate, double buffer_length) {
     if (mix_rate <= 0.0) {
         mix_rate = 44100.0;
@@ -257,8 +587,9 @@ void EngineSimRuntime::start_audio(double mix_rate, double buffer_length) {
     // Allow enough per-frame push budget to recover from hitching.
     m_audio_budget_frames = MAX(m_audio_budget_frames, m_audio_buffer_capacity_frames);
 
+    AudioStreamPlayer3D *audio_player_3d = get_audio_player_3d();
     AudioStreamPlayer *audio_player = get_audio_player();
-    if (audio_player == nullptr) {
+    if (audio_player == nullptr && audio_player_3d == nullptr) {
         audio_player = memnew(AudioStreamPlayer);
         audio_player->set_name("EngineSimAudioPlayer");
         add_child(audio_player);
@@ -269,15 +600,21 @@ void EngineSimRuntime::start_audio(double mix_rate, double buffer_length) {
     m_audio_generator->set_mix_rate(mix_rate);
     m_audio_generator->set_buffer_length(buffer_length);
 
-    audio_player->set_stream(m_audio_generator);
+    if (audio_player_3d != nullptr) {
+        audio_player_3d->set_stream(m_audio_generator);
+    }
+    else {
+        audio_player->set_stream(m_audio_generator);
+    }
 
     // The synthesizer is now initialized at 44100 Hz in simulator.cpp,
     // so no re-initialization is needed here. This preserves the IR data.
 
     // Prefill: Run a few simulation frames to build up the synthesizer's internal buffer
     // before starting playback. This creates headroom so continuous consumption doesn't
-    // cause immediate underruns.
-    for (int i = 0; i < 3; ++i) {
+    // cause immediate underruns. A restored idle snapshot already carries rendered audio,
+    // and the simulation thread keeps the buffer at its latency target by itself.
+    for (int i = 0; i < 3 && !m_warm_started && !is_simulation_thread_enabled(); ++i) {
         _physics_process(0.1);
         if (m_rt) {
             es_runtime_wait_audio_processed(m_rt);
@@ -285,9 +622,15 @@ void EngineSimRuntime::start_audio(double mix_rate, double buffer_length) {
     }
     
     // Now start playback, which will immediately begin consuming audio.
-    audio_player->play();
-
-    Ref<AudioStreamPlayback> playback = audio_player->get_stream_playback();
+    Ref<AudioStreamPlayback> playback;
+    if (audio_player_3d != nullptr) {
+        audio_player_3d->play();
+        playback = audio_player_3d->get_stream_playback();
+    }
+    else {
+        audio_player->play();
+        playback = audio_player->get_stream_playback();
+    }
     m_audio_playback = playback;
     if (m_audio_playback.is_null()) {
         UtilityFunctions::printerr("engine-sim: AudioStreamGeneratorPlayback unavailable (stream playback is null)");
@@ -323,6 +666,12 @@ void EngineSimRuntime::stop_audio() {
         audio_player->set_stream(Ref<AudioStreamGenerator>());
     }
 
+    AudioStreamPlayer3D *audio_player_3d = get_audio_player_3d();
+    if (audio_player_3d != nullptr && audio_player_3d->get_stream().ptr() == m_audio_generator.ptr()) {
+        audio_player_3d->stop();
+        audio_player_3d->set_stream(Ref<AudioStreamGenerator>());
+    }
+
     m_audio_playback.unref();
     m_audio_generator.unref();
 
@@ -330,18 +679,59 @@ void EngineSimRuntime::stop_audio() {
 }
 
 bool EngineSimRuntime::is_audio_running() const {
+    AudioStreamPlayer3D *audio_player_3d = get_audio_player_3d();
+    if (audio_player_3d != nullptr && audio_player_3d->is_playing()) {
+        return true;
+    }
+
     AudioStreamPlayer *audio_player = get_audio_player();
     return audio_player != nullptr && audio_player->is_playing();
 }
 
 void EngineSimRuntime::_process(double delta) {
+    update_distance_lod();
+
     // Pump audio every render frame (often faster than physics) to keep Godot's buffer fed.
     // This helps bridge gaps between physics frames when Godot's audio thread is consuming.
     pump_audio();
 }
 
+void EngineSimRuntime::update_distance_lod() {
+    if (!m_distance_lod_enabled || !m_loaded || m_rt == nullptr) {
+        return;
+    }
+
+    AudioStreamPlayer3D *audio_player_3d = get_audio_player_3d();
+    if (audio_player_3d == nullptr) {
+        return;
+    }
+
+    Viewport *viewport = audio_player_3d->get_viewport();
+    Camera3D *camera = (viewport != nullptr) ? viewport->get_camera_3d() : nullptr;
+    if (camera == nullptr) {
+        return;
+    }
+
+    const double distance =
+        audio_player_3d->get_global_position().distance_to(camera->get_global_position());
+
+    // Returning to a richer tier requires getting 10% closer than the
+    // threshold so the tier doesn't flap at a boundary.
+    int tier = 0;
+    for (int i = 0; i < 3; ++i) {
+        const double threshold = m_lod_distances[i] * ((m_lod_tier > i) ? 0.9 : 1.0);
+        if (distance > threshold) {
+            tier = i + 1;
+        }
+    }
+
+    if (tier != m_lod_tier) {
+        set_quality_tier(tier);
+    }
+}
+
 void EngineSimRuntime::_physics_process(double delta) {
-    if (!m_loaded || m_rt == nullptr) {
+    if (!m_loaded || m_rt == nullptr || es_runtime_is_simulation_thread_enabled(m_rt)) {
         return;
     }
 
@@ -4,7 +4,11 @@
 #include <godot_cpp/classes/node.hpp>
 #include <godot_cpp/classes/ref.hpp>
 #include <godot_cpp/core/object_id.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/node_path.hpp>
+#include <godot_cpp/variant/packed_float64_array.hpp>
 #include <godot_cpp/variant/packed_vector2_array.hpp>
+#include <godot_cpp/variant/vector3.hpp>
 
 #include <vector>
 
@@ -15,15 +19,42 @@ namespace godot {
 class AudioStreamGenerator;
 class AudioStreamGeneratorPlayback;
 class AudioStreamPlayer;
+class AudioStreamPlayer3D;
 
 class EngineSimRuntime : public Node {
     GDCLASS(EngineSimRuntime, Node)
 
 public:
+    // Layout of get_telemetry(). With cylinders, TELEMETRY_CYLINDERS is
+    // followed by the cylinder pressures and then their temperatures, each
+    // TELEMETRY_CYLINDER_COUNT long.
+    enum TelemetryIndex {
+        TELEMETRY_FRAME,
+        TELEMETRY_ENGINE_SPEED,
+        TELEMETRY_ENGINE_SPEED_RAW,
+        TELEMETRY_THROTTLE,
+        TELEMETRY_CLUTCH_PRESSURE,
+        TELEMETRY_GEAR,
+        TELEMETRY_MANIFOLD_PRESSURE,
+        TELEMETRY_INTAKE_AFR,
+        TELEMETRY_DYNO_TORQUE,
+        TELEMETRY_VEHICLE_SPEED,
+        TELEMETRY_CYLINDER_COUNT,
+        TELEMETRY_CYLINDERS
+    };
+
     EngineSimRuntime();
     ~EngineSimRuntime();
 
     bool load_mr_script(const String &path);
+    bool load_engine_pack(const String &path);  // Exported with es_runtime_export_pack()
+
+    // Background loading: preload_mr_script() compiles on a worker thread while
+    // the current engine keeps running, swap_to_preloaded() makes it active.
+    bool preload_mr_script(const String &path);
+    bool is_preload_ready(const String &path) const;  // Finished, successfully or not
+    bool swap_to_preloaded(const String &path, double crossfade_seconds = 0.25);
+    void cancel_preload(const String &path);
     void set_speed_control(double speed_control_0_to_1);
     void set_throttle(double throttle_0_to_1);  // Direct throttle control (0=closed, 1=wide open)
     double get_throttle() const;  // Get current throttle position
@@ -37,6 +68,21 @@ public:
     void set_clutch_pressure(double pressure_0_to_1);  // 0=disengaged, 1=fully engaged
     double get_clutch_pressure() const;
 
+    // Simulation snapshots. With warm start enabled, load_mr_script() and
+    // load_engine_pack() restore `<name>.idle.state` when one exists and start_audio() skips its prefill.
+    bool save_state(const String &path);
+    bool load_state(const String &path);
+    void set_warm_start_enabled(bool enabled);
+    bool is_warm_start_enabled() const;
+
+    // Analytic piston/rod motion instead of constraints; applies to the next load
+    void set_reduced_kinematics(bool enabled);
+    bool is_reduced_kinematics() const;
+
+    // Steps the simulation on its own thread instead of in _physics_process
+    void set_simulation_thread_enabled(bool enabled);
+    bool is_simulation_thread_enabled() const;
+
     void start_audio(double mix_rate = 44100.0, double buffer_length = 0.1);
     void stop_audio();
     bool is_audio_running() const;
@@ -52,6 +98,33 @@ public:
     void set_simulation_speed(double speed);
     double get_simulation_speed() const;
 
+    // Rigid-body solve every N simulation steps, see es_runtime_set_mechanical_step_divisor
+    void set_mechanical_step_divisor(int divisor);
+    int get_mechanical_step_divisor() const;
+
+    // Level-of-detail, see es_quality_tier_t (0=full ... 3=frozen)
+    void set_quality_tier(int tier);
+    int get_quality_tier() const;
+
+    // Constraint solver convergence, see es_solver_stats_t. Empty if unavailable.
+    Dictionary get_solver_stats() const;
+
+    // Bytes held by the loaded engine, see es_memory_usage_t. Empty if nothing is loaded.
+    Dictionary get_memory_usage() const;
+
+    // Last published frame in one call, see es_telemetry_t and TelemetryIndex.
+    // Empty if nothing is loaded.
+    PackedFloat64Array get_telemetry(bool include_cylinders = false) const;
+
+    // Optional AudioStreamPlayer3D to stream into instead of the internal
+    // AudioStreamPlayer. Distance LOD measures from it to the active camera.
+    void set_audio_player_3d_path(const NodePath &path);
+    NodePath get_audio_player_3d_path() const;
+    void set_distance_lod_enabled(bool enabled);
+    bool is_distance_lod_enabled() const;
+    void set_lod_distances(const Vector3 &distances);  // reduced, physics-only, frozen (meters)
+    Vector3 get_lod_distances() const;
+
     PackedVector2Array read_audio_stereo(int frames);
     void wait_audio_processed();
     
@@ -65,11 +138,25 @@ protected:
     static void _bind_methods();
 
 private:
+    struct Preload {
+        String path;
+        es_load_t *load = nullptr;
+    };
+
+    bool finish_load(const String &path, bool ok);
+    int find_preload(const String &path) const;
     void pump_audio();
+    void update_distance_lod();
     AudioStreamPlayer *get_audio_player() const;
+    AudioStreamPlayer3D *get_audio_player_3d() const;
 
     es_runtime_t *m_rt = nullptr;
     bool m_loaded = false;
+    bool m_warm_start_enabled = true;
+    bool m_warm_started = false;
+    bool m_reduced_kinematics = false;
+
+    std::vector<Preload> m_preloads;
 
     ObjectID m_audio_player_id;
     Ref<AudioStreamGenerator> m_audio_generator;
@@ -89,6 +176,11 @@ private:
     int m_sim_steps_per_process = 50000;
     double m_sim_accumulated_delta = 0.0;
 
+    NodePath m_audio_player_3d_path;
+    bool m_distance_lod_enabled = false;
+    Vector3 m_lod_distances = Vector3(30.0, 120.0, 300.0);
+    int m_lod_tier = 0;
+
     bool m_audio_debug_enabled = false;
     double m_audio_debug_interval_s = 1.0;
     double m_audio_debug_accum_s = 0.0;
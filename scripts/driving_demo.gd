@@ -264,7 +264,8 @@ func _process(delta: float) -> void:
 	else:
 		runtime.set_clutch_pressure(clutch_engaged)
 	
-	# Get engine RPM
+	# Get engine RPM. The stall and shift logic below acts on it this frame, so it
+	# uses the live getter rather than telemetry from the last end_frame.
 	engine_rpm = runtime.get_engine_speed()
 	
 	# Auto-start: check if engine has caught